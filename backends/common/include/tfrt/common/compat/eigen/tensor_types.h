@@ -26,8 +26,13 @@
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+
 #include "tfrt/tensor/dense_host_tensor_view.h"
 #include "tfrt/tensor/dense_view.h"
+#include "tfrt/tensor/strided_host_tensor.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
 namespace tfrt {
@@ -138,6 +143,52 @@ EigenTensor<T, TargetRank> AsEigenTensor(
   return EigenTensor<T, TargetRank>(tensor.data(), AsEigenDSizes(target_shape));
 }
 
+// Maps a strided view as an Eigen expression over its underlying buffer, so
+// strided inputs feed Eigen kernels without being materialized first. The
+// view's strides must form a (possibly permuted) nested row-major layout with
+// unit innermost stride, which holds for every view produced by
+// dht.slice_view and dht.transpose_view; this is asserted.
+template <typename T, size_t Rank, typename IndexType = Eigen::Index>
+auto AsEigenConstTensor(const StridedTensorView<T, Rank>& view) {
+  auto dims = view.FixedShape();
+  auto strides = view.Strides();
+
+  // Order the dimensions by decreasing stride to recover the memory order of
+  // the underlying layout.
+  std::array<size_t, Rank> order;
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return strides[a] > strides[b];
+  });
+  assert(Rank == 0 || strides[order[Rank - 1]] == 1);
+
+  // Synthesize, in memory order, the dims of a contiguous tensor that the
+  // view is a slice of: each inner dimension spans the stride of the
+  // dimension before it. Out of bounds reads are impossible because the slice
+  // below restricts indexing to the view's extents.
+  Eigen::DSizes<IndexType, Rank> base_dims, slice_begin, slice_sizes, shuffle;
+  for (size_t k = 0; k < Rank; ++k) {
+    size_t d = order[k];
+    if (k == 0) {
+      base_dims[k] = dims[d];
+    } else {
+      size_t prev = order[k - 1];
+      assert(strides[prev] % strides[d] == 0 && "unsupported stride layout");
+      base_dims[k] = strides[prev] / strides[d];
+    }
+    assert(dims[d] <= base_dims[k] && "view extent exceeds its stride span");
+    slice_begin[k] = 0;
+    slice_sizes[k] = dims[d];
+    // Restore the view's dimension order: output dimension `d` of the
+    // shuffle reads memory-order dimension `k`.
+    shuffle[d] = k;
+  }
+
+  Eigen::TensorMap<const Eigen::Tensor<T, Rank, Eigen::RowMajor, IndexType>>
+      base(view.data(), base_dims);
+  return base.slice(slice_begin, slice_sizes).shuffle(shuffle);
+}
+
 template <typename T>
 EigenConstTensor<T, 1> AsEigenConstTensor(DHTArrayView<T> tensor) {
   return EigenConstTensor<T, 1>(tensor.data(),
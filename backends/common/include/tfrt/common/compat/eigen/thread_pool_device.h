@@ -26,29 +26,134 @@
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
 #include "llvm/ADT/FunctionExtras.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/shared_context.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
 namespace tfrt {
 namespace compat {
 
+//===----------------------------------------------------------------------===//
+// Scratch allocator for Eigen expression temporaries.
+//===----------------------------------------------------------------------===//
+
+// A size-bucketed cache of Eigen evaluation temporaries (e.g. the im2col
+// scratch buffers spatial convolutions allocate per call). Temporaries have
+// short lives and recur with the same handful of sizes, so serving them from
+// power-of-two buckets turns a malloc/free pair per kernel into a mutex-
+// protected pop/push. The cache is shared by all devices of one
+// EigenHostContext; evaluations on long-lived shared devices interleave, so
+// the blocks are recycled on deallocation rather than by a per-kernel reset.
+// Oversized blocks, and frees beyond the cache budget, go to the heap.
+class EigenScratchAllocator : public Eigen::Allocator {
+ public:
+  EigenScratchAllocator() = default;
+  EigenScratchAllocator(const EigenScratchAllocator&) = delete;
+  void operator=(const EigenScratchAllocator&) = delete;
+
+  ~EigenScratchAllocator() override {
+    for (auto& blocks : buckets_) {
+      for (void* block : blocks)
+        Eigen::internal::aligned_free(static_cast<char*>(block) -
+                                      kHeaderBytes);
+    }
+  }
+
+  void* allocate(size_t num_bytes) const override {
+    const int bucket = BucketFor(num_bytes);
+    if (bucket >= 0) {
+      mutex_lock lock(mu_);
+      auto& blocks = buckets_[bucket];
+      if (!blocks.empty()) {
+        void* block = blocks.back();
+        blocks.pop_back();
+        cached_bytes_ -= BucketBytes(bucket);
+        return block;
+      }
+    }
+    // Each block carries its bucket in an alignment-sized header, so
+    // deallocate() can recycle it without being told the size.
+    const size_t payload = bucket >= 0 ? BucketBytes(bucket) : num_bytes;
+    char* base = static_cast<char*>(
+        Eigen::internal::aligned_malloc(kHeaderBytes + payload));
+    *reinterpret_cast<int*>(base) = bucket;
+    return base + kHeaderBytes;
+  }
+
+  void deallocate(void* buffer) const override {
+    if (buffer == nullptr) return;
+    char* base = static_cast<char*>(buffer) - kHeaderBytes;
+    const int bucket = *reinterpret_cast<int*>(base);
+    if (bucket >= 0) {
+      mutex_lock lock(mu_);
+      if (cached_bytes_ + BucketBytes(bucket) <= kMaxCachedBytes) {
+        buckets_[bucket].push_back(buffer);
+        cached_bytes_ += BucketBytes(bucket);
+        return;
+      }
+    }
+    Eigen::internal::aligned_free(base);
+  }
+
+ private:
+  static constexpr size_t kMaxCachedBytes = 64 << 20;  // 64 MiB
+  static constexpr int kMinBucketBits = 8;             // 256 bytes
+  static constexpr int kMaxBucketBits = 28;            // 256 MiB
+  static constexpr int kNumBuckets = kMaxBucketBits - kMinBucketBits + 1;
+  static constexpr size_t kHeaderBytes =
+      EIGEN_MAX_ALIGN_BYTES > 16 ? EIGEN_MAX_ALIGN_BYTES : 16;
+
+  static size_t BucketBytes(int bucket) {
+    return size_t{1} << (bucket + kMinBucketBits);
+  }
+
+  // Returns the bucket whose block size is the smallest power of two holding
+  // `num_bytes`, or -1 if the request is empty or too large to cache.
+  static int BucketFor(size_t num_bytes) {
+    if (num_bytes == 0 || num_bytes > (size_t{1} << kMaxBucketBits)) return -1;
+    int bits = kMinBucketBits;
+    while ((size_t{1} << bits) < num_bytes) ++bits;
+    return bits - kMinBucketBits;
+  }
+
+  mutable mutex mu_;
+  mutable std::array<std::vector<void*>, kNumBuckets> buckets_
+      TFRT_GUARDED_BY(mu_);
+  mutable size_t cached_bytes_ TFRT_GUARDED_BY(mu_) = 0;
+};
+
 //===----------------------------------------------------------------------===//
 // Context that manages Eigen thread pool and ThreadPoolDevice lifetime.
 //===----------------------------------------------------------------------===//
 
 class EigenHostContext : public SharedContext {
  public:
-  // TODO(ezhulenev): Pass a custom Eigen::Allocator that wraps HostContext
-  // AllocateBytes/DeallocateBytes.
   explicit EigenHostContext(HostContext* host_context)
       : host_context_(host_context),
         thread_pool_(host_context),
-        device_(&thread_pool_, thread_pool_.NumThreads()) {}
+        device_(&thread_pool_, thread_pool_.NumThreads(),
+                &scratch_allocator_) {
+    // One long-lived device per parallelism level, so CooperativeDevice() can
+    // hand out a device sized for any capacity without a per-launch
+    // allocation. Eigen keeps a reference to the device for the duration of
+    // an asynchronous evaluation, so the devices must outlive all launches.
+    const int num_levels = std::max(thread_pool_.NumThreads(), 1);
+    leveled_devices_.reserve(num_levels);
+    for (int i = 1; i <= num_levels; ++i)
+      leveled_devices_.push_back(std::make_unique<Eigen::ThreadPoolDevice>(
+          &thread_pool_, i, &scratch_allocator_));
+  }
 
   EigenHostContext(const EigenHostContext&) = delete;
   void operator=(const EigenHostContext&) = delete;
@@ -56,6 +161,20 @@ class EigenHostContext : public SharedContext {
   const Eigen::ThreadPoolInterface& ThreadPool() const { return thread_pool_; }
   const Eigen::ThreadPoolDevice& Device() const { return device_; }
 
+  // Returns a device whose parallelism is sized from the work queue's
+  // instantaneous idle-worker count, plus the calling thread. An expensive
+  // expression (e.g. a contraction) launched through this device while other
+  // kernels keep workers busy shards itself for the free capacity instead of
+  // carving up the whole machine; its shards are still ordinary stealable
+  // tasks, so workers that free up later can join in. On an idle machine this
+  // degenerates to the full-parallelism Device().
+  const Eigen::ThreadPoolDevice& CooperativeDevice() const {
+    const int idle = host_context_->GetNumIdleWorkerThreads();
+    const int level = std::min(static_cast<int>(leveled_devices_.size()),
+                               std::max(idle + 1, 1));
+    return *leveled_devices_[level - 1];
+  }
+
   HostContext* host() const { return host_context_; };
 
  private:
@@ -91,7 +210,10 @@ class EigenHostContext : public SharedContext {
 
   HostContext* host_context_;
   EigenHostContextThreadPool thread_pool_;
+  // Declared before the devices, which hold a pointer to it.
+  EigenScratchAllocator scratch_allocator_;
   Eigen::ThreadPoolDevice device_;
+  std::vector<std::unique_ptr<Eigen::ThreadPoolDevice>> leveled_devices_;
 };
 
 namespace internal {
@@ -150,6 +272,21 @@ void AsyncAssign(const EigenHostContext& ctx, Output out, Expr expr,
   out.device(ctx.Device(), std::move(callback)) = expr;
 }
 
+// As the `AsyncAssign` above, but evaluates on `device` instead of the
+// context's default device. Used to launch expensive expressions with
+// cooperative parallelism (see EigenHostContext::CooperativeDevice). The
+// device must outlive the evaluation, so it should be one of the devices
+// owned by the EigenHostContext, never a stack-local copy.
+template <
+    typename Output, typename Expr, typename DoneCallback,
+    typename = std::enable_if_t<internal::is_invocable<DoneCallback>::value>>
+void AsyncAssign(const EigenHostContext& ctx,
+                 const Eigen::ThreadPoolDevice& device, Output out, Expr expr,
+                 DoneCallback done) {
+  auto callback = [done = std::move(done)]() mutable { done(); };
+  out.device(device, std::move(callback)) = expr;
+}
+
 // Syntactic sugar for the `AsyncAssign` defined above, that does output
 // chain allocation.
 //
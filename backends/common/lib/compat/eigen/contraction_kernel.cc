@@ -20,7 +20,12 @@
 
 #include "contraction_kernel.h"
 
+#include <atomic>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 // We need a pair of compile time and runtime flags to disable compilation of
 // custom contraction kernels for unsupported architectures (e.g. Android,
@@ -54,6 +59,140 @@ bool UseCustomContractionKernelsTFRT() {
   return use_custom_contraction_kernel;
 }
 
+namespace {
+
+// Identifies a packed block by the base buffer of the underlying tensor and
+// the position of the block within it. Contractions with different blocking
+// parameters produce disjoint keys, so a published block is only ever reused
+// for the exact same sub-block.
+struct PackedBlockKey {
+  const void* base;
+  Index vert_offset;
+  Index horiz_offset;
+  Index depth;
+  Index cols;
+  size_t element_size;
+
+  bool operator==(const PackedBlockKey& other) const {
+    return base == other.base && vert_offset == other.vert_offset &&
+           horiz_offset == other.horiz_offset && depth == other.depth &&
+           cols == other.cols && element_size == other.element_size;
+  }
+};
+
+struct PackedBlockKeyHash {
+  size_t operator()(const PackedBlockKey& key) const {
+    size_t hash = std::hash<const void*>()(key.base);
+    auto combine = [&hash](size_t value) {
+      hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    };
+    combine(static_cast<size_t>(key.vert_offset));
+    combine(static_cast<size_t>(key.horiz_offset));
+    combine(static_cast<size_t>(key.depth));
+    combine(static_cast<size_t>(key.cols));
+    combine(key.element_size);
+    return hash;
+  }
+};
+
+// Published blocks are kept until process exit (enabled buffers are weights
+// that live as long as their model), so the cache is bounded by a byte budget
+// instead of an eviction policy.
+constexpr size_t kMaxPackedWeightCacheBytes = 256 << 20;  // 256 MiB
+
+struct PackedWeightCache {
+  std::mutex mu;
+  std::unordered_set<const void*> bases;
+  std::unordered_map<PackedBlockKey, std::unique_ptr<char[]>,
+                     PackedBlockKeyHash>
+      blocks;
+  size_t cached_bytes = 0;
+
+  // Number of enabled bases, readable without taking `mu` so that packRhs can
+  // skip cache probes when the cache was never enabled.
+  std::atomic<int> num_bases{0};
+};
+
+PackedWeightCache& GetPackedWeightCache() {
+  static auto* cache = new PackedWeightCache();
+  return *cache;
+}
+
+}  // namespace
+
+bool UsePackedWeightCacheTFRT() {
+  static bool use_packed_weight_cache = false;
+
+  static std::once_flag initialized;
+  std::call_once(initialized, [&] {
+    char* flag = std::getenv("TFRT_EIGEN_PREPACKED_WEIGHT_CACHE");
+    if (flag && (strcmp(flag, "true") == 0 || strcmp(flag, "1") == 0)) {
+      use_packed_weight_cache = true;
+    }
+  });
+  return use_packed_weight_cache;
+}
+
+bool HasPackedWeightBasesTFRT() {
+  return GetPackedWeightCache().num_bases.load(std::memory_order_relaxed) != 0;
+}
+
+void EnablePackedWeightBaseTFRT(const void* base) {
+  auto& cache = GetPackedWeightCache();
+  std::lock_guard<std::mutex> lock(cache.mu);
+  if (cache.bases.insert(base).second)
+    cache.num_bases.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FindPackedWeightBlockTFRT(const void* base, Index vert_offset,
+                               Index horiz_offset, Index depth, Index cols,
+                               size_t element_size, void* dst) {
+  PackedBlockKey key{base, vert_offset, horiz_offset, depth, cols,
+                     element_size};
+
+  const char* packed = nullptr;
+  auto& cache = GetPackedWeightCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mu);
+    auto it = cache.blocks.find(key);
+    if (it != cache.blocks.end()) packed = it->second.get();
+  }
+  if (packed == nullptr) return false;
+
+  // Published blocks are never evicted, so the copy is safe outside the lock.
+  std::memcpy(dst, packed,
+              static_cast<size_t>(depth) * static_cast<size_t>(cols) *
+                  element_size);
+  return true;
+}
+
+void InsertPackedWeightBlockTFRT(const void* base, Index vert_offset,
+                                 Index horiz_offset, Index depth, Index cols,
+                                 size_t element_size, const void* src) {
+  PackedBlockKey key{base, vert_offset, horiz_offset, depth, cols,
+                     element_size};
+  const size_t bytes =
+      static_cast<size_t>(depth) * static_cast<size_t>(cols) * element_size;
+
+  auto& cache = GetPackedWeightCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mu);
+    if (cache.bases.count(base) == 0) return;
+    if (cache.cached_bytes + bytes > kMaxPackedWeightCacheBytes) return;
+    if (cache.blocks.count(key) != 0) return;
+  }
+
+  // Copy outside the lock; concurrent publishers for the same block produce
+  // identical bytes and the first one wins.
+  std::unique_ptr<char[]> packed(new char[bytes]);
+  std::memcpy(packed.get(), src, bytes);
+
+  std::lock_guard<std::mutex> lock(cache.mu);
+  if (cache.cached_bytes + bytes > kMaxPackedWeightCacheBytes) return;
+  if (cache.blocks.emplace(key, std::move(packed)).second)
+    cache.cached_bytes += bytes;
+}
+
 }  // namespace internal
 }  // namespace Eigen
 #endif
@@ -59,6 +59,46 @@ namespace internal {
 // is open sourced.
 bool UseCustomContractionKernelsTFRT();
 
+// Weight pre-packing cache for tensor contractions.
+//
+// In inference-style workloads the rhs argument of a contraction is typically
+// an immutable weight matrix that is multiplied over and over, yet every
+// contraction re-packs it into the internal block format. When the cache is
+// enabled for the underlying tensor buffer (see EnablePackedWeightBaseTFRT),
+// the first contraction publishes each packed rhs block, and subsequent
+// contractions replace the strided packing pass with a linear copy of the
+// published block.
+//
+// The cache is opt-in at runtime (TFRT_EIGEN_PREPACKED_WEIGHT_CACHE=true),
+// because it is only sound if enabled buffers are never written again, which
+// the runtime cannot verify. Callers that enable a buffer must also keep it
+// alive, so its address cannot be recycled for an unrelated tensor.
+
+// Returns `true` iff the weight pre-packing cache was enabled with an
+// environment variable.
+bool UsePackedWeightCacheTFRT();
+
+// Returns `true` if any buffer was enabled for weight pre-packing. This is a
+// cheap check that lets packRhs skip cache probes entirely in the common case.
+bool HasPackedWeightBasesTFRT();
+
+// Enables the weight pre-packing cache for the tensor buffer at `base`.
+void EnablePackedWeightBaseTFRT(const void* base);
+
+// Copies the published packed block for the given sub-block of `base` into
+// `dst`. Returns `false` if `base` is not enabled or the block has not been
+// published yet.
+bool FindPackedWeightBlockTFRT(const void* base, Index vert_offset,
+                               Index horiz_offset, Index depth, Index cols,
+                               size_t element_size, void* dst);
+
+// Publishes a freshly packed block for the given sub-block of `base`. A no-op
+// if `base` is not enabled, the block was already published, or the cache
+// reached its memory budget. The first publisher wins.
+void InsertPackedWeightBlockTFRT(const void* base, Index vert_offset,
+                                 Index horiz_offset, Index depth, Index cols,
+                                 size_t element_size, const void* src);
+
 // Pack a 2D block of a Tensor expression into a contiguous block of memory with
 // col-major storage order. We do not have access to the underlying Tensor
 // expression, we only have a DataMapper (TensorContractionInputMapper for
@@ -287,6 +327,13 @@ struct DirectColMajorAccess {
                     ColMajorBlock<Scalar, IndexType>* block) {
     return false;
   }
+
+  template <typename IndexType>
+  static const void* base_data(
+      const typename DataMapper::SubMapper& data_mapper,
+      IndexType* vert_offset, IndexType* horiz_offset) {
+    return nullptr;
+  }
 };
 
 // If we have an access to raw memory of the contraction input, we can safely
@@ -355,6 +402,16 @@ struct DirectColMajorAccess {
         return true;                                                           \
       }                                                                        \
       return false;                                                            \
+    }                                                                          \
+                                                                               \
+    /* Identifies the sub-block for the weight pre-packing cache: the base */  \
+    /* buffer of the underlying tensor plus the block's offsets within it. */  \
+    static const void* base_data(                                              \
+        const typename DataMapper::SubMapper& data_mapper,                     \
+        IndexType* vert_offset, IndexType* horiz_offset) {                     \
+      *vert_offset = data_mapper.vert_offset();                                \
+      *horiz_offset = data_mapper.horiz_offset();                              \
+      return data_mapper.base_mapper().tensor().data();                        \
     }                                                                          \
   }
 
@@ -409,6 +466,42 @@ struct GemmKernelProvider<float, float, float, IndexType, OutputMapper> {
   using GemmKernel = mkldnn_gemm_kernel<float, IndexType, OutputMapper>;
 };
 
+// Loads the rhs block from the weight pre-packing cache if it was published by
+// a previous contraction over the same buffer. `DirectRhsAccess` gives access
+// to the underlying tensor buffer when the rhs is a plain tensor; for all
+// other expressions the cache is bypassed.
+template <typename DirectRhsAccess, typename Scalar, typename IndexType,
+          typename SubMapper>
+bool LoadPackedRhsBlockTFRT(ColMajorBlock<Scalar, IndexType>* block,
+                            const SubMapper& data_mapper, IndexType depth,
+                            IndexType cols) {
+  if (!DirectRhsAccess::value || !HasPackedWeightBasesTFRT()) return false;
+  IndexType vert_offset = 0;
+  IndexType horiz_offset = 0;
+  const void* base =
+      DirectRhsAccess::base_data(data_mapper, &vert_offset, &horiz_offset);
+  if (base == nullptr) return false;
+  return FindPackedWeightBlockTFRT(base, vert_offset, horiz_offset, depth,
+                                   cols, sizeof(Scalar), block->packed_data);
+}
+
+// Publishes a just-packed rhs block, so that later contractions over the same
+// buffer can skip the packing pass.
+template <typename DirectRhsAccess, typename Scalar, typename IndexType,
+          typename SubMapper>
+void StorePackedRhsBlockTFRT(const ColMajorBlock<Scalar, IndexType>& block,
+                             const SubMapper& data_mapper, IndexType depth,
+                             IndexType cols) {
+  if (!DirectRhsAccess::value || !HasPackedWeightBasesTFRT()) return;
+  IndexType vert_offset = 0;
+  IndexType horiz_offset = 0;
+  const void* base =
+      DirectRhsAccess::base_data(data_mapper, &vert_offset, &horiz_offset);
+  if (base == nullptr) return;
+  InsertPackedWeightBlockTFRT(base, vert_offset, horiz_offset, depth, cols,
+                              sizeof(Scalar), block.packed_data);
+}
+
 // Tensor contraction kernel that can fallback on Eigen gebp_kernel at runtime.
 //
 // For some data types we can't fallback on Eigen, e.g. Eigen does not have
@@ -548,7 +641,12 @@ struct GemmKernelProvider<float, float, float, IndexType, OutputMapper> {
                                                                                \
         if (!is_direct_access) {                                               \
           rhsBlock->is_direct_access = false;                                  \
-          RhsPacker()(rhsBlock->packed_data, data_mapper, depth, cols);        \
+          if (!LoadPackedRhsBlockTFRT<DirectRhsAccess>(rhsBlock, data_mapper,  \
+                                                       depth, cols)) {        \
+            RhsPacker()(rhsBlock->packed_data, data_mapper, depth, cols);      \
+            StorePackedRhsBlockTFRT<DirectRhsAccess>(*rhsBlock, data_mapper,   \
+                                                     depth, cols);            \
+          }                                                                    \
         }                                                                      \
       } else {                                                                 \
         rhsBlock->is_direct_access = false;                                    \
@@ -18,10 +18,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <type_traits>
+
 #include "../contraction_kernel.h"
+#include "llvm/ADT/DenseMap.h"
 #include "tfrt/common/compat/eigen/eigen_kernel.h"
 #include "tfrt/common/compat/eigen/tensor_types.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/tensor/dense_host_tensor.h"
 
 namespace tfrt {
 namespace compat {
@@ -30,6 +35,46 @@ using ::Eigen::Index;
 using ::tfrt::compat::AsEigenConstTensor;
 using ::tfrt::compat::AsEigenTensor;
 
+#if defined(TFRT_EIGEN_USE_CUSTOM_CONTRACTION_KERNEL)
+// Weights in inference graphs are immutable tensors multiplied over and over,
+// and Eigen's contraction path re-packs them on every call. When the opt-in
+// weight pre-packing cache is on (TFRT_EIGEN_PREPACKED_WEIGHT_CACHE=true), a
+// buffer seen repeatedly as the rhs operand is pinned and enabled for the
+// cache, so later matmuls replace the strided packing pass with a linear copy
+// of the published blocks (see contraction_kernel.h).
+static void MaybeEnableWeightPrepacking(const DenseHostTensor& weights) {
+  if (!Eigen::internal::UsePackedWeightCacheTFRT()) return;
+
+  // Stop pinning buffers once the budget is reached; the packed-block cache in
+  // contraction_kernel.cc has its own byte budget on top of this one.
+  static constexpr size_t kMaxPinnedWeightBytes = 256 << 20;  // 256 MiB
+
+  struct Sighting {
+    int count = 0;
+    RCReference<HostBuffer> pinned;
+  };
+
+  static mutex* mu = new mutex();
+  static auto* sightings = new llvm::DenseMap<const void*, Sighting>();
+  static size_t pinned_bytes = 0;
+
+  const void* data = weights.data();
+  if (data == nullptr) return;
+
+  mutex_lock lock(*mu);
+  Sighting& sighting = (*sightings)[data];
+  if (sighting.pinned) return;
+  if (++sighting.count < 2) return;
+  if (pinned_bytes + weights.DataSizeInBytes() > kMaxPinnedWeightBytes) return;
+
+  // Pinning the buffer keeps its address from being recycled for an unrelated
+  // tensor, which would poison the cache.
+  sighting.pinned = weights.buffer().CopyRef();
+  pinned_bytes += weights.DataSizeInBytes();
+  Eigen::internal::EnablePackedWeightBaseTFRT(data);
+}
+#endif  // TFRT_EIGEN_USE_CUSTOM_CONTRACTION_KERNEL
+
 // General matrix multiplication kernel:
 //   C = alpha * AB + beta * C
 //
@@ -55,6 +100,12 @@ void MatMul(Argument<T> alpha, ArgumentView<DHTIndexableView<T, 2>> a,
     return;
   }
 
+#if defined(TFRT_EIGEN_USE_CUSTOM_CONTRACTION_KERNEL)
+  // Only the float contraction goes through the custom packing path.
+  if (std::is_same<T, float>::value)
+    MaybeEnableWeightPrepacking(b.value()->template get<DenseHostTensor>());
+#endif
+
   // Contraction dimension.
   Eigen::array<Eigen::IndexPair<Eigen::Index>, 1> contract_dim({1, 0});
 
@@ -68,19 +119,26 @@ void MatMul(Argument<T> alpha, ArgumentView<DHTIndexableView<T, 2>> a,
   const EigenHostContext& cpu =
       host->GetOrCreateSharedContext<EigenHostContext>();
 
+  // Shard the contraction for the currently free worker capacity, so a large
+  // matmul does not starve other ready kernels of all cores.
+  const Eigen::ThreadPoolDevice& device = cpu.CooperativeDevice();
+
   if (alpha.get() == 1.0 && beta.get() == 0.0) {
     auto expr = in0.contract(in1, contract_dim);
-    AsyncAssign(cpu, std::move(out), std::move(expr), std::move(on_done));
+    AsyncAssign(cpu, device, std::move(out), std::move(expr),
+                std::move(on_done));
 
   } else if (alpha.get() == 1.0) {
     auto expr =
         in0.contract(in1, contract_dim) + out.constant(beta.get()) * out;
-    AsyncAssign(cpu, std::move(out), std::move(expr), std::move(on_done));
+    AsyncAssign(cpu, device, std::move(out), std::move(expr),
+                std::move(on_done));
 
   } else {
     auto expr = out.constant(alpha.get()) * in0.contract(in1, contract_dim) +
                 out.constant(beta.get()) * out;
-    AsyncAssign(cpu, std::move(out), std::move(expr), std::move(on_done));
+    AsyncAssign(cpu, device, std::move(out), std::move(expr),
+                std::move(on_done));
   }
 }
 
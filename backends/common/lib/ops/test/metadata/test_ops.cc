@@ -256,6 +256,7 @@ GetAllTestMetadataFunctions() {
     result->emplace_back("tfrt_test.create_dense_tensor",
                          TFRT_METADATA(CreateDenseTensorMD));
     result->emplace_back("tfrt_test.add", TFRT_METADATA(TestAddMD));
+    result->emplace_back("tfrt_test.mul", TFRT_METADATA(ElementwiseOpMD));
     result->emplace_back("tfrt_test.add.denseonly", TFRT_METADATA(TestAddMD));
     result->emplace_back("tfrt_test.add.denseonly2", TFRT_METADATA(TestAddMD));
     result->emplace_back("tfrt_test.add.denseonly3", TFRT_METADATA(TestAddMD));
@@ -248,6 +248,26 @@ static Expected<TensorMetadata> TfBiasAddOpMd(const TensorMetadata& value,
   return value;
 }
 
+// Fused Conv2D + BiasAdd + Relu op. The output shape matches the unfused
+// convolution; the bias vector must match the output channels dimension.
+static Expected<TensorMetadata> TfFusedConv2DBiasReluOpMd(
+    const TensorMetadata& input, const TensorMetadata& filter,
+    const TensorMetadata& bias, const OpAttrsRef& attrs) {
+  TFRT_ASSIGN_OR_RETURN(auto conv_md, TfConvOpMd(input, filter, attrs));
+
+  if (bias.shape.GetRank() != 1) {
+    return MakeStringError("bias must be 1-D");
+  }
+
+  if (bias.shape.GetDimensionSize(0) !=
+      conv_md.shape.GetDimensionSize(conv_md.shape.GetRank() - 1)) {
+    return MakeStringError(
+        "bias must have the size of the output channels dimension");
+  }
+
+  return conv_md;
+}
+
 static Expected<std::tuple<TensorMetadata, TensorMetadata, TensorMetadata,
                            TensorMetadata, TensorMetadata, TensorMetadata>>
 TfBatchNormOpMd(const TensorMetadata& input, const TensorMetadata& mean,
@@ -369,9 +389,12 @@ static Expected<TensorMetadata> TfTransposeOpMdImpl(const TensorMetadata& input,
         "tf.Transpose `perm` must size must match input rank");
   }
 
+  // Decode the shape once instead of re-branching over its representation on
+  // every dimension access.
+  DecodedTensorShape input_shape(input.shape);
   llvm::SmallVector<ssize_t, 4> output_dims;
-  for (int i = 0; i < input.shape.GetRank(); ++i) {
-    output_dims.push_back(input.shape.GetDimensionSize(perm[i]));
+  for (int i = 0; i < input_shape.GetRank(); ++i) {
+    output_dims.push_back(input_shape[perm[i]]);
   }
 
   return TensorMetadata(input.dtype, output_dims);
@@ -445,9 +468,10 @@ static Expected<TensorMetadata> TfMeanOpMdImpl(
     reduced_dim[reduction_index] = true;
   }
 
+  DecodedTensorShape input_shape(input.shape);
   llvm::SmallVector<ssize_t, 4> output_dims;
-  for (int i = 0; i < input.shape.GetRank(); ++i) {
-    if (!reduced_dim[i]) output_dims.push_back(input.shape.GetDimensionSize(i));
+  for (int i = 0; i < input_shape.GetRank(); ++i) {
+    if (!reduced_dim[i]) output_dims.push_back(input_shape[i]);
   }
 
   return TensorMetadata(input.dtype, output_dims);
@@ -502,6 +526,8 @@ GetAllTFMetadataFunctions() {
     result->emplace_back("_tf.Mean", TFRT_METADATA(TfMeanOpFoldedMd));
     result->emplace_back("tf.Softmax", TFRT_METADATA(UnaryIdentityMd));
     result->emplace_back("tf.BiasAdd", TFRT_METADATA(TfBiasAddOpMd));
+    result->emplace_back("tf._FusedConv2DBiasRelu",
+                         TFRT_METADATA(TfFusedConv2DBiasReluOpMd));
     result->emplace_back("tf.FusedBatchNormV3", TFRT_METADATA(TfBatchNormOpMd));
     result->emplace_back("tf._FusedBatchNormEx",
                          TFRT_METADATA(TfFusedBatchNormExOpMd));
@@ -90,6 +90,13 @@ struct CpuOpFlags {
     // If this is set, the op dispatch function is prepared to deal with
     // tensor inputs in TfLiteHostTensor format.
     AllowsTfLite = 1 << 3,
+
+    // If this is set, the op implementation declares that its dispatch
+    // function is cheap (e.g. shape manipulation or small elementwise work).
+    // When its arguments resolve asynchronously, an inexpensive op runs
+    // inline on the thread that fulfills its last argument instead of taking
+    // a work queue round-trip, which would otherwise dominate its latency.
+    Inexpensive = 1 << 4,
   } flags;
 
   explicit CpuOpFlags() : flags(None) {}
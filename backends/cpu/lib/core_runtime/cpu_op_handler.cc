@@ -20,6 +20,9 @@
 
 #include "cpu_op_handler.h"  // NOLINT
 
+#include <memory>
+#include <string>
+
 #include "cpu_op_registry_impl.h"
 #include "llvm/ADT/FunctionExtras.h"
 #include "llvm/Support/Compiler.h"
@@ -32,8 +35,11 @@
 #include "tfrt/core_runtime/tensor_handle.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/diagnostic.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/host_tensor.h"
 
@@ -76,8 +82,10 @@ struct CpuOpHandlerTraits {
                                  const ExecutionContext& exec_ctx,
                                  RCReference<AsyncValue>* converted) {
     if (auto allowed_formats = TensorNeedsConversion(arg_tensor, op_entry)) {
-      *converted =
-          arg_tensor.ConvertToHostTensor(exec_ctx.host(), allowed_formats);
+      // Memoized on the tensor, so a tensor fed to many ops (e.g. a weight)
+      // is converted at most once per format mask.
+      *converted = arg_tensor.ConvertToHostTensorCached(exec_ctx.host(),
+                                                        allowed_formats);
       return true;
     }
     return false;
@@ -89,11 +97,226 @@ struct CpuOpHandlerTraits {
                        MutableArrayRef<RCReference<AsyncValue>> results,
                        AsyncValueRef<Chain>* chain,
                        const ExecutionContext& exec_ctx) {
+    // Attribute the result tensors' footprint to the request, if it carries a
+    // stats block. The metadata is already resolved here, so this is a cheap
+    // sum rather than an allocator hook.
+    if (RequestContext* req = exec_ctx.request_ctx()) {
+      int64_t bytes = 0;
+      for (const TensorMetadata& md : result_mds)
+        bytes += md.GetHostSizeInBytes();
+      req->RecordBytesAllocated(bytes);
+    }
     op_entry.dispatch_fn(exec_ctx.host(), inputs, attrs, result_mds, results,
                          chain, exec_ctx);
   }
+
+  static bool DispatchIsInexpensive(const CpuOpEntry& op_entry) {
+    return static_cast<bool>(op_entry.flags & CpuOpFlags::Inexpensive);
+  }
+};
+
+// Variant of CpuOpHandlerTraits with the OpHandlerInfoTy hook filled with a
+// dummy int, needed to call the internal dispatch helpers directly from the
+// speculative metadata path.
+struct SpeculativeCpuOpHandlerTraits {
+  using InputTensorTy = AsyncValue;
+  using OpEntryTy = CpuOpEntry;
+  using OpHandlerInfoTy = int;
+
+  static bool MaybeConvertTensor(const CpuOpEntry& op_entry, int,
+                                 const Tensor& arg_tensor,
+                                 const ExecutionContext& exec_ctx,
+                                 RCReference<AsyncValue>* converted) {
+    return CpuOpHandlerTraits::MaybeConvertTensor(op_entry, arg_tensor,
+                                                  exec_ctx, converted);
+  }
+
+  static void Dispatch(const CpuOpEntry& op_entry, int,
+                       ArrayRef<AsyncValue*> inputs, const OpAttrsRef& attrs,
+                       ArrayRef<TensorMetadata> result_mds,
+                       MutableArrayRef<RCReference<AsyncValue>> results,
+                       AsyncValueRef<Chain>* chain,
+                       const ExecutionContext& exec_ctx) {
+    CpuOpHandlerTraits::Dispatch(op_entry, inputs, attrs, result_mds, results,
+                                 chain, exec_ctx);
+  }
+
+  static bool DispatchIsInexpensive(const CpuOpEntry& op_entry) {
+    return CpuOpHandlerTraits::DispatchIsInexpensive(op_entry);
+  }
 };
 
+// The result metadata observed on the last completed invocation of one op
+// instance. Shapes are static across steps for most inference workloads, so
+// the last step's results double as a prediction for the next step.
+struct MetadataSpeculationState {
+  mutex mu;
+  SmallVector<TensorMetadata, 4> last_result_mds TFRT_GUARDED_BY(mu);
+};
+
+// Records the result metadata of a completed invocation, if it is already
+// fully available, to seed the next step's speculation.
+void RecordResultMetadata(MetadataSpeculationState* state,
+                          MutableArrayRef<TensorHandle> results) {
+  SmallVector<TensorMetadata, 4> result_mds;
+  result_mds.reserve(results.size());
+  for (auto& result : results) {
+    if (!result.IsMetadataAvailable()) return;
+    result_mds.push_back(result.GetAvailableMetadata());
+  }
+  mutex_lock lock(state->mu);
+  state->last_result_mds = std::move(result_mds);
+}
+
+// Runs one invocation with speculated result metadata when some input
+// metadata is not yet available. The speculated metadata is published to the
+// result TensorHandles immediately, so downstream metadata functions run now
+// instead of waiting for this op - this is what collapses a serial metadata
+// chain. When the real input metadata resolves, the metadata function runs
+// and its results are validated against the speculation. Published metadata
+// cannot be retracted, so a mismatch poisons the (still pending) result
+// tensors with an error rather than producing tensors under a wrong shape.
+//
+// Returns false without touching the invocation if speculation does not
+// apply.
+bool TrySpeculativeExecute(
+    const CpuOpEntry* op_entry,
+    const std::shared_ptr<MetadataSpeculationState>& state,
+    const OpInvocation& invocation, bool update_chain) {
+  // Speculation only helps when some input metadata is missing; otherwise the
+  // normal path runs the metadata function synchronously anyway. Inputs in
+  // error state take the normal propagation path.
+  bool missing_metadata = false;
+  for (auto& argument : invocation.arguments) {
+    if (argument.IsMetadataAvailable()) continue;
+    auto arg_state = argument.GetAsyncMetadata().GetAsyncValue()->state();
+    if (arg_state.IsError()) return false;
+    if (!arg_state.IsConcrete()) missing_metadata = true;
+  }
+  if (!missing_metadata) return false;
+
+  SmallVector<TensorMetadata, 4> speculated_mds;
+  {
+    mutex_lock lock(state->mu);
+    if (state->last_result_mds.size() != invocation.results.size())
+      return false;
+    speculated_mds.assign(state->last_result_mds.begin(),
+                          state->last_result_mds.end());
+  }
+
+  auto* host = invocation.exec_ctx.host();
+  auto arguments = invocation.arguments;
+  auto results = invocation.results;
+
+  // Collect the unavailable inputs and take the arguments so they live until
+  // the dispatch runs.
+  SmallVector<AsyncValue*, 8> async_mds;
+  SmallVector<TensorHandle, 4> arguments_copy;
+  arguments_copy.reserve(arguments.size());
+  for (size_t i = 0, e = arguments.size(); i != e; ++i) {
+    if (!arguments[i].IsMetadataAvailable()) {
+      const auto& md = arguments[i].GetAsyncMetadata();
+      if (md.IsUnavailable()) async_mds.push_back(md.GetAsyncValue());
+    }
+    arguments_copy.push_back(std::move(arguments[i]));
+  }
+
+  // Publish the speculated metadata to the results immediately. The result
+  // tensors stay pending until the dispatch runs.
+  SmallVector<RCReference<IndirectAsyncValue>, 4> result_ind_avs;
+  result_ind_avs.reserve(results.size());
+  for (size_t i = 0, e = results.size(); i != e; ++i) {
+    auto tensor = host->MakeIndirectAsyncValue();
+    result_ind_avs.push_back(tensor.CopyRef());
+    results[i] = TensorHandle(speculated_mds[i],
+                              AsyncValueRef<Tensor>(std::move(tensor)));
+  }
+
+  AsyncValueRef<Chain> in_chain;
+  AsyncValueRef<Chain> chain_ref;
+  if (update_chain) {
+    in_chain = invocation.chain->CopyRef();
+    if (!in_chain.IsAvailable()) async_mds.push_back(in_chain.GetAsyncValue());
+    chain_ref = host->MakeUnconstructedAsyncValueRef<Chain>();
+    *invocation.chain = chain_ref.CopyRef();
+  }
+
+  host->RunWhenReady(async_mds, [op_entry, state, update_chain,
+                                 exec_ctx = invocation.exec_ctx,
+                                 op_name = invocation.op_name.str(),
+                                 frozen_attrs = invocation.attrs.freeze(),
+                                 in_chain = std::move(in_chain),
+                                 chain = std::move(chain_ref),
+                                 result_ind_avs = std::move(result_ind_avs),
+                                 arguments = std::move(arguments_copy),
+                                 speculated_mds =
+                                     std::move(speculated_mds)]() mutable {
+    auto propagate_error = [&](const DecodedDiagnostic& diag) {
+      for (auto& result : result_ind_avs) result->SetError(diag);
+      if (chain) chain.SetError(diag);
+    };
+
+    if (in_chain && in_chain.IsError())
+      return propagate_error(in_chain.GetError());
+
+    SmallVector<TensorMetadata, 4> argument_mds;
+    argument_mds.reserve(arguments.size());
+    for (auto& argument : arguments) {
+      if (argument.IsMetadataAvailable()) {
+        argument_mds.push_back(argument.GetAvailableMetadata());
+        continue;
+      }
+      const auto& md = argument.GetAsyncMetadata();
+      if (md.IsError()) return propagate_error(md.GetError());
+      argument_mds.push_back(md.get());
+    }
+
+    // Run the real metadata function and validate the speculation. The real
+    // results are recorded either way so the next step speculates correctly.
+    SmallVector<TensorMetadata, 4> result_mds(result_ind_avs.size());
+    if (auto error = op_entry->metadata_fn(argument_mds, frozen_attrs,
+                                           result_mds, exec_ctx))
+      return propagate_error(error->GetError());
+
+    {
+      mutex_lock lock(state->mu);
+      state->last_result_mds.assign(result_mds.begin(), result_mds.end());
+    }
+
+    if (!std::equal(result_mds.begin(), result_mds.end(),
+                    speculated_mds.begin(), speculated_mds.end())) {
+      return propagate_error(EmitError(
+          exec_ctx, "speculated result metadata mismatch for op ", op_name));
+    }
+
+    // The speculation held; run the op with the validated metadata. The in
+    // chain has already resolved, so hand the dispatch a ready chain and
+    // forward its out chain to the one we published.
+    AsyncValueRef<Chain> dispatch_chain;
+    if (update_chain) dispatch_chain = exec_ctx.host()->GetReadyChain();
+    SmallVector<AsyncValueRef<Tensor>, 8> result_tensor_avs;
+    internal::ExecuteWithResultMetadataResolved<SpeculativeCpuOpHandlerTraits>(
+        exec_ctx, arguments, frozen_attrs, result_ind_avs.size(), result_mds,
+        /*result_md_avs=*/nullptr, &result_tensor_avs,
+        update_chain ? &dispatch_chain : nullptr, update_chain, *op_entry,
+        /*op_handler_info=*/0);
+
+    for (size_t i = 0, e = result_ind_avs.size(); i != e; ++i)
+      result_ind_avs[i]->ForwardTo(result_tensor_avs[i].ReleaseRCRef());
+
+    if (update_chain) {
+      dispatch_chain.AndThen([dispatch_chain = dispatch_chain.CopyRef(),
+                              chain = std::move(chain)]() {
+        if (dispatch_chain.IsError())
+          chain.SetError(dispatch_chain.GetError());
+        else
+          chain.emplace();
+      });
+    }
+  });
+  return true;
+}
+
 }  // namespace
 
 llvm::Expected<std::unique_ptr<CpuOpHandler>> CpuOpHandler::Create(
@@ -150,12 +373,21 @@ Expected<CoreRuntimeOp> CpuOpHandler::MakeOp(string_view op_name) {
   // fallback device.
   if (op_entry->dispatch_fn == nullptr) return GetFallback()->MakeOp(op_name);
 
+  // Each op handle carries the speculation state for its own invocations.
+  auto state = std::make_shared<MetadataSpeculationState>();
+
   // NOTE(fishx): To avoid introducing an extra heap allocation, we need to
   // ensure that the size of captured variable is smaller than 3 pointers.
-  return CoreRuntimeOp([op_entry](const OpInvocation& invocation) {
+  return CoreRuntimeOp([op_entry, state = std::move(state)](
+                           const OpInvocation& invocation) {
     bool update_chain = !(op_entry->flags & CpuOpFlags::NoSideEffects);
+    if (op_entry->metadata_fn &&
+        TrySpeculativeExecute(op_entry, state, invocation, update_chain))
+      return;
     // TODO(fishx): ExecuteOnOpHandler should return void.
     ExecuteOnOpHandler<CpuOpHandlerTraits>(update_chain, invocation, *op_entry);
+    if (op_entry->metadata_fn)
+      RecordResultMetadata(state.get(), invocation.results);
   });
 }
 
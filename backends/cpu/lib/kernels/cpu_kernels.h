@@ -23,10 +23,20 @@
 #ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CPU_KERNELS_H_
 #define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CPU_KERNELS_H_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "mkldnn.h"  // from @mkl_dnn
 #include "tfrt/common/compat/eigen/eigen_kernel.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/support/msan.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
@@ -34,13 +44,30 @@
 
 namespace tfrt {
 namespace cpu {
+namespace internal {
+
+// Flat Eigen array views over dense host tensors. Elementwise expressions
+// evaluated through these maps vectorize, and for fp16 Eigen computes in fp32
+// internally, converting packets with hardware F16C/NEON-FP16 instructions
+// when the build enables them.
+template <typename T>
+Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> AsFlatArray(
+    DHTArrayView<T> view) {
+  return {view.data(), static_cast<Eigen::Index>(view.NumElements())};
+}
+
+template <typename T>
+Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>> AsFlatArray(
+    MutableDHTArrayView<T> view) {
+  return {view.data(), static_cast<Eigen::Index>(view.NumElements())};
+}
+
+}  // namespace internal
 
 //===----------------------------------------------------------------------===//
 // CPU Add kernels
 //===----------------------------------------------------------------------===//
 
-// TODO(tf-runtime-team): Add should be implemented using eigen kernels.
-// TODO(fishx): Let this kernel support fp16.
 template <typename T>
 AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
                               const HostTensor& rhs_ref, HostContext* host) {
@@ -60,6 +87,14 @@ AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
         slhs->metadata(), result);
   }
 
+  // Adding a zero splat is an identity, so alias the dense operand instead of
+  // materializing a new tensor.  This is common with zero-initialized biases.
+  if (auto* slhs = dyn_cast<ScalarHostTensor<T>>(lhs)) {
+    if (slhs->GetValue() == T(0))
+      return host->template MakeConcreteAsyncValueRef<DenseHostTensor>(
+          cast<DenseHostTensor>(rhs)->CopyRef());
+  }
+
   auto dest = DenseHostTensor::CreateUninitialized(lhs->metadata(), host);
   if (!dest)
     return host->MakeErrorAsyncValueRef("out of memory allocating result");
@@ -70,14 +105,70 @@ AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
   DHTArrayView<T> rhs_view(cast<DenseHostTensor>(rhs));
   if (auto* slhs = dyn_cast<ScalarHostTensor<T>>(lhs)) {
     // Add a scalar to a dense tensor.
-    auto lhs = slhs->GetValue();
-    for (size_t i = 0, e = dest_view.NumElements(); i != e; ++i)
-      dest_view[i] = lhs + rhs_view[i];
+    internal::AsFlatArray(dest_view) =
+        internal::AsFlatArray(rhs_view) + slhs->GetValue();
   } else {
     // Add two dense tensors.
     DHTArrayView<T> lhs_view(cast<DenseHostTensor>(lhs));
-    for (size_t i = 0, e = dest_view.NumElements(); i != e; ++i)
-      dest_view[i] = lhs_view[i] + rhs_view[i];
+    internal::AsFlatArray(dest_view) =
+        internal::AsFlatArray(lhs_view) + internal::AsFlatArray(rhs_view);
+  }
+  return host->MakeConcreteAsyncValueRef<DenseHostTensor>(
+      std::move(dest.getValue()));
+}
+
+//===----------------------------------------------------------------------===//
+// CPU Mul kernels
+//===----------------------------------------------------------------------===//
+
+// Like Add above, Mul keeps splat operands symbolic where it can: scalar*
+// scalar stays a ScalarHostTensor, and a splat against a dense tensor is a
+// single fused pass (or no pass at all for the multiplicative identity)
+// rather than materializing the splat first.
+template <typename T>
+AsyncValueRef<HostTensor> Mul(const HostTensor& lhs_ref,
+                              const HostTensor& rhs_ref, HostContext* host) {
+  auto* lhs = &lhs_ref;
+  auto* rhs = &rhs_ref;
+
+  // We handle Scalar*Scalar, Scalar*Dense, Dense*Dense below. Swap
+  // Dense*Scalar to simplify the logic since mul is commutative.
+  if (isa<DenseHostTensor>(lhs) && isa<AnyScalarHostTensor>(rhs))
+    std::swap(lhs, rhs);
+
+  // Handle scalar*scalar.
+  if (auto* srhs = dyn_cast<ScalarHostTensor<T>>(rhs)) {
+    auto* slhs = cast<ScalarHostTensor<T>>(lhs);
+    auto result = slhs->GetValue() * srhs->GetValue();
+    return host->template MakeConcreteAsyncValueRef<ScalarHostTensor<T>>(
+        slhs->metadata(), result);
+  }
+
+  // Multiplying by a one splat is an identity, so alias the dense operand
+  // instead of materializing a new tensor.
+  if (auto* slhs = dyn_cast<ScalarHostTensor<T>>(lhs)) {
+    if (slhs->GetValue() == T(1))
+      return host->template MakeConcreteAsyncValueRef<DenseHostTensor>(
+          cast<DenseHostTensor>(rhs)->CopyRef());
+  }
+
+  auto dest = DenseHostTensor::CreateUninitialized(lhs->metadata(), host);
+  if (!dest)
+    return host->MakeErrorAsyncValueRef("out of memory allocating result");
+
+  MutableDHTArrayView<T> dest_view(dest.getPointer());
+
+  // Handle scalar*dense.
+  DHTArrayView<T> rhs_view(cast<DenseHostTensor>(rhs));
+  if (auto* slhs = dyn_cast<ScalarHostTensor<T>>(lhs)) {
+    // Multiply a dense tensor by a scalar.
+    internal::AsFlatArray(dest_view) =
+        internal::AsFlatArray(rhs_view) * slhs->GetValue();
+  } else {
+    // Multiply two dense tensors.
+    DHTArrayView<T> lhs_view(cast<DenseHostTensor>(lhs));
+    internal::AsFlatArray(dest_view) =
+        internal::AsFlatArray(lhs_view) * internal::AsFlatArray(rhs_view);
   }
   return host->MakeConcreteAsyncValueRef<DenseHostTensor>(
       std::move(dest.getValue()));
@@ -114,11 +205,14 @@ void MatMul2DKernel(T alpha, DHTIndexableView<T, 2> A, DHTIndexableView<T, 2> B,
   }
 }
 
-template <>
-inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
-                                  DHTIndexableView<float, 2> B, float beta,
-                                  MutableDHTIndexableView<float, 2>& C,
-                                  bool transpose_a, bool transpose_b) {
+namespace internal {
+
+// Computes C = alpha * op(A) @ op(B) + beta * C with MKL-DNN sgemm over
+// row-major matrices given by raw pointers. Shared by the fp32 matmul kernel
+// and the fp16 kernel that stages its operands through fp32 buffers.
+inline void MatMulSgemm(bool transpose_a, bool transpose_b, int m, int k,
+                        int n, float alpha, const float* a, const float* b,
+                        float beta, float* c) {
   // MKL-DNN sgemm computes C = alpha * A @ B + beta * C, assuming all matrices
   // are column-major. MLIR tensors are row-major. We compute,
   //   C_rowmajor = C_colmajor^T = B_colmajor^T * A_colmajor^T,
@@ -130,26 +224,7 @@ inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
   // trans_a = 'C' or 'c',  op( A ) = A**T.
   char trans_a = transpose_a ? 'T' : 'N';
   char trans_b = transpose_b ? 'T' : 'N';
-  std::array<int, 2> dim_pair;
-  dim_pair[0] = transpose_a ? 0 : 1;
-  dim_pair[1] = transpose_b ? 1 : 0;
 
-  const auto& shape_A = A.FixedShape();
-  const auto& shape_B = B.FixedShape();
-  assert(shape_A[dim_pair[0]] == shape_B[dim_pair[1]] &&
-         "matmul arguments have incompatible shapes");
-
-  // m: Specifies the number of rows of the matrix op(a) and of the matrix c.
-  // The value of m must be at least zero.
-  //
-  // n: Specifies the number of columns of the matrix op(b) and the number of
-  // columns of the matrix c. The value of n must be at least zero.
-  //
-  // k: Specifies the number of columns of the matrix op(a) and the number of
-  // rows of the matrix op(b)
-  int m = shape_A[1 - dim_pair[0]];
-  int k = shape_A[dim_pair[0]];
-  int n = shape_B[1 - dim_pair[1]];
   assert(m >= 0 && n >= 0 && k >= 0);
 
   // lda: Leading dimension of 'a' matrix. This is set at calling site depending
@@ -170,9 +245,8 @@ inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
 
   // MKL DNN only supports the Fortran api and requires column major while we
   // use row major so we reverse the order A and B.
-  mkldnn_status_t status =
-      mkldnn_sgemm(&trans_b, &trans_a, &n, &m, &k, &alpha, B.data(), &ldb,
-                   A.data(), &lda, &beta, C.data(), &ldc);
+  mkldnn_status_t status = mkldnn_sgemm(&trans_b, &trans_a, &n, &m, &k, &alpha,
+                                        b, &ldb, a, &lda, &beta, c, &ldc);
   assert(status == mkldnn_status_t::mkldnn_success);
 
   // assert is a no-op in optimized mode so we add this to avoid compiler's
@@ -181,7 +255,174 @@ inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
 
   // Since MKL is pre-built library, it causes "use-of-uninitialized-value" msan
   // warning.
-  TFRT_MSAN_MEMORY_IS_INITIALIZED(C.data(), C.NumElements() * sizeof(float));
+  TFRT_MSAN_MEMORY_IS_INITIALIZED(c, static_cast<size_t>(m) * n *
+                                         sizeof(float));
+}
+
+// Computes C = alpha * op(A) @ op(B) + beta * C with Eigen over the same
+// row-major raw pointer interface as MatMulSgemm. Used for shape classes
+// where oneDNN's per-call setup outweighs its blocking, i.e. tiny GEMMs.
+inline void MatMulEigen(bool transpose_a, bool transpose_b, int m, int k,
+                        int n, float alpha, const float* a, const float* b,
+                        float beta, float* c) {
+  using ConstMatrix = Eigen::Map<
+      const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic,
+                          Eigen::RowMajor>>;
+  using Matrix = Eigen::Map<
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+  ConstMatrix A(a, transpose_a ? k : m, transpose_a ? m : k);
+  ConstMatrix B(b, transpose_b ? n : k, transpose_b ? k : n);
+  Matrix C(c, m, n);
+
+  auto compute = [&](const auto& op_a, const auto& op_b) {
+    if (beta == 0.0f) {
+      C.noalias() = alpha * (op_a * op_b);
+    } else {
+      C = alpha * (op_a * op_b) + beta * C;
+    }
+  };
+  if (!transpose_a && !transpose_b) {
+    compute(A, B);
+  } else if (transpose_a && !transpose_b) {
+    compute(A.transpose(), B);
+  } else if (!transpose_a && transpose_b) {
+    compute(A, B.transpose());
+  } else {
+    compute(A.transpose(), B.transpose());
+  }
+}
+
+// Backend policy hook for the float matmul: returns true if the oneDNN sgemm
+// should handle an (m x k) @ (k x n) product, false for the Eigen path.
+using MatMulBackendPolicy = bool (*)(int m, int k, int n);
+
+// The default policy routes everything to oneDNN except tiny GEMMs, where its
+// per-call setup costs more than the whole product. The cutoff can be forced
+// with TFRT_CPU_MATMUL_BACKEND=eigen|mkldnn (anything else means auto).
+inline bool DefaultMatMulBackendPolicy(int m, int k, int n) {
+  enum class ForcedBackend { kAuto, kEigen, kMklDnn };
+  static const ForcedBackend forced = [] {
+    const char* value = getenv("TFRT_CPU_MATMUL_BACKEND");
+    if (value == nullptr) return ForcedBackend::kAuto;
+    if (strcmp(value, "eigen") == 0) return ForcedBackend::kEigen;
+    if (strcmp(value, "mkldnn") == 0) return ForcedBackend::kMklDnn;
+    return ForcedBackend::kAuto;
+  }();
+  if (forced == ForcedBackend::kEigen) return false;
+  if (forced == ForcedBackend::kMklDnn) return true;
+
+  constexpr int64_t kTinyGemmProductElems = 32 * 32 * 32;
+  return static_cast<int64_t>(m) * k * n >= kTinyGemmProductElems;
+}
+
+inline std::atomic<MatMulBackendPolicy>& MatMulBackendPolicyStorage() {
+  static std::atomic<MatMulBackendPolicy> policy{DefaultMatMulBackendPolicy};
+  return policy;
+}
+
+}  // namespace internal
+
+// Replaces the float matmul backend policy, e.g. with a model-specific shape
+// classifier. Passing nullptr restores the default policy.
+inline void SetMatMulBackendPolicy(internal::MatMulBackendPolicy policy) {
+  internal::MatMulBackendPolicyStorage().store(
+      policy != nullptr ? policy : internal::DefaultMatMulBackendPolicy,
+      std::memory_order_relaxed);
+}
+
+template <>
+inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
+                                  DHTIndexableView<float, 2> B, float beta,
+                                  MutableDHTIndexableView<float, 2>& C,
+                                  bool transpose_a, bool transpose_b) {
+  std::array<int, 2> dim_pair;
+  dim_pair[0] = transpose_a ? 0 : 1;
+  dim_pair[1] = transpose_b ? 1 : 0;
+
+  const auto& shape_A = A.FixedShape();
+  const auto& shape_B = B.FixedShape();
+  assert(shape_A[dim_pair[0]] == shape_B[dim_pair[1]] &&
+         "matmul arguments have incompatible shapes");
+
+  // m: Specifies the number of rows of the matrix op(a) and of the matrix c.
+  // The value of m must be at least zero.
+  //
+  // n: Specifies the number of columns of the matrix op(b) and the number of
+  // columns of the matrix c. The value of n must be at least zero.
+  //
+  // k: Specifies the number of columns of the matrix op(a) and the number of
+  // rows of the matrix op(b)
+  int m = shape_A[1 - dim_pair[0]];
+  int k = shape_A[dim_pair[0]];
+  int n = shape_B[1 - dim_pair[1]];
+
+  if (internal::MatMulBackendPolicyStorage().load(std::memory_order_relaxed)(
+          m, k, n)) {
+    internal::MatMulSgemm(transpose_a, transpose_b, m, k, n, alpha, A.data(),
+                          B.data(), beta, C.data());
+  } else {
+    internal::MatMulEigen(transpose_a, transpose_b, m, k, n, alpha, A.data(),
+                          B.data(), beta, C.data());
+  }
+}
+
+// Fp16 matmul stores half but computes in fp32: both operands are expanded to
+// fp32 staging buffers with Eigen's vectorized casts (hardware F16C/NEON-FP16
+// conversions when the build enables them), multiplied with the fp32 sgemm,
+// and the result is rounded back to half. This keeps the memory-bound
+// operands in half storage without giving up fp32 accumulation in the inner
+// loop.
+template <>
+inline void MatMul2DKernel<Eigen::half>(
+    Eigen::half alpha, DHTIndexableView<Eigen::half, 2> A,
+    DHTIndexableView<Eigen::half, 2> B, Eigen::half beta,
+    MutableDHTIndexableView<Eigen::half, 2>& C, bool transpose_a,
+    bool transpose_b) {
+  using ConstHalfArray =
+      Eigen::Map<const Eigen::Array<Eigen::half, Eigen::Dynamic, 1>>;
+  using HalfArray = Eigen::Map<Eigen::Array<Eigen::half, Eigen::Dynamic, 1>>;
+  using ConstFloatArray =
+      Eigen::Map<const Eigen::Array<float, Eigen::Dynamic, 1>>;
+  using FloatArray = Eigen::Map<Eigen::Array<float, Eigen::Dynamic, 1>>;
+
+  std::array<int, 2> dim_pair;
+  dim_pair[0] = transpose_a ? 0 : 1;
+  dim_pair[1] = transpose_b ? 1 : 0;
+
+  const auto& shape_A = A.FixedShape();
+  const auto& shape_B = B.FixedShape();
+  assert(shape_A[dim_pair[0]] == shape_B[dim_pair[1]] &&
+         "matmul arguments have incompatible shapes");
+
+  int m = shape_A[1 - dim_pair[0]];
+  int k = shape_A[dim_pair[0]];
+  int n = shape_B[1 - dim_pair[1]];
+
+  std::vector<float> a_f32(A.NumElements());
+  std::vector<float> b_f32(B.NumElements());
+  std::vector<float> c_f32(C.NumElements());
+
+  FloatArray(a_f32.data(), a_f32.size()) =
+      ConstHalfArray(A.data(), A.NumElements()).cast<float>();
+  FloatArray(b_f32.data(), b_f32.size()) =
+      ConstHalfArray(B.data(), B.NumElements()).cast<float>();
+
+  // C is uninitialized when beta is zero, so only expand it when sgemm will
+  // actually read it.
+  const float beta_f32 = static_cast<float>(beta);
+  if (beta_f32 != 0.0f) {
+    FloatArray(c_f32.data(), c_f32.size()) =
+        ConstHalfArray(C.data(), C.NumElements()).cast<float>();
+  }
+
+  internal::MatMulSgemm(transpose_a, transpose_b, m, k, n,
+                        static_cast<float>(alpha), a_f32.data(), b_f32.data(),
+                        beta_f32, c_f32.data());
+
+  // Round the fp32 result back to half storage.
+  HalfArray(C.data(), C.NumElements()) =
+      ConstFloatArray(c_f32.data(), c_f32.size()).cast<Eigen::half>();
 }
 
 // TODO(tf-runtime-team): Merge this into the matmul kernel interface layer, or
@@ -225,6 +466,170 @@ static AsyncValueRef<Chain> Relu(const DenseHostTensor& A, DenseHostTensor* B,
                                                      exec_ctx);
 }
 
+//===----------------------------------------------------------------------===//
+// CPU Reduction kernels
+//===----------------------------------------------------------------------===//
+
+namespace internal {
+
+// Number of input bytes one reduction shard processes. Large enough that a
+// shard's Eigen reduction runs at memory bandwidth, small enough that a 1GB
+// tensor fans out across every worker.
+constexpr size_t kReductionBytesPerShard = 1 << 20;  // 1 MiB
+
+// Reduction policies. `Reduce` collapses one contiguous shard through a
+// vectorized Eigen expression, `Combine` merges two partial accumulators, and
+// `Finalize` maps the combined value to the result (where Mean divides by the
+// element count).
+template <typename T>
+struct SumReducer {
+  static T Identity() { return static_cast<T>(0); }
+  template <typename Array>
+  static T Reduce(const Array& a) {
+    return a.sum();
+  }
+  static T Combine(T a, T b) { return a + b; }
+  static T Finalize(T value, size_t num_elements) { return value; }
+};
+
+template <typename T>
+struct MeanReducer : SumReducer<T> {
+  static T Finalize(T value, size_t num_elements) {
+    return num_elements == 0 ? static_cast<T>(0)
+                             : static_cast<T>(value / num_elements);
+  }
+};
+
+template <typename T>
+struct MaxReducer {
+  static T Identity() { return std::numeric_limits<T>::lowest(); }
+  template <typename Array>
+  static T Reduce(const Array& a) {
+    return a.maxCoeff();
+  }
+  static T Combine(T a, T b) { return a < b ? b : a; }
+  static T Finalize(T value, size_t num_elements) { return value; }
+};
+
+// Merges per-shard partials pairwise, so the combining order forms a balanced
+// tree: floating point rounding is deterministic and independent of task
+// completion order, and the error grows with log(shards) rather than shards.
+template <typename Reducer, typename T>
+T TreeCombine(llvm::MutableArrayRef<T> partials) {
+  size_t n = partials.size();
+  while (n > 1) {
+    const size_t half = (n + 1) / 2;
+    for (size_t i = 0; i + half < n; ++i)
+      partials[i] = Reducer::Combine(partials[i], partials[i + half]);
+    n = half;
+  }
+  return partials[0];
+}
+
+}  // namespace internal
+
+// Computes dest = reduce(src) over all elements of src into a single-element
+// dest, with the reduction defined by the Reducer policy. The input is
+// partitioned into contiguous shards fanned across the work queue; each shard
+// reduces through a vectorized Eigen expression into its own partial
+// accumulator, and the last shard to finish merges the partials in a pairwise
+// tree and publishes the chain. Contiguous shards keep each worker streaming
+// one memory range, which is as NUMA-friendly as the flat view allows.
+template <typename T, typename Reducer>
+AsyncValueRef<Chain> Reduce(const DenseHostTensor& src, DenseHostTensor* dest,
+                            const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+  DHTArrayView<T> src_view(&src);
+  MutableDHTArrayView<T> dest_view(dest);
+  assert(dest_view.NumElements() == 1 && "reduction dest must be a scalar");
+
+  const size_t num_elements = src_view.NumElements();
+  constexpr size_t kElementsPerShard =
+      internal::kReductionBytesPerShard / sizeof(T);
+  const size_t num_shards =
+      std::max<size_t>(1, (num_elements + kElementsPerShard - 1) /
+                              kElementsPerShard);
+
+  if (num_shards == 1) {
+    T value = num_elements == 0
+                  ? Reducer::Identity()
+                  : Reducer::Reduce(internal::AsFlatArray(src_view));
+    dest_view.data()[0] = Reducer::Finalize(value, num_elements);
+    return host->MakeConcreteAsyncValueRef<Chain>();
+  }
+
+  struct ReduceState {
+    ReduceState(size_t num_shards, AsyncValueRef<Chain> chain,
+                RCReference<HostBuffer> src_buffer,
+                RCReference<HostBuffer> dest_buffer)
+        : partials(num_shards),
+          remaining(num_shards),
+          chain(std::move(chain)),
+          src_buffer(std::move(src_buffer)),
+          dest_buffer(std::move(dest_buffer)) {}
+
+    std::vector<T> partials;
+    std::atomic<size_t> remaining;
+    AsyncValueRef<Chain> chain;
+    // Keep the tensors alive until the last shard has written the result.
+    RCReference<HostBuffer> src_buffer;
+    RCReference<HostBuffer> dest_buffer;
+  };
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto state = std::make_shared<ReduceState>(num_shards, chain.CopyRef(),
+                                             src.buffer().CopyRef(),
+                                             dest->buffer().CopyRef());
+
+  const T* src_data = src_view.data();
+  T* dest_data = dest_view.data();
+
+  auto run_shard = [state, src_data, dest_data, num_elements,
+                    num_shards](size_t shard) {
+    const size_t begin = shard * kElementsPerShard;
+    const size_t end = std::min(begin + kElementsPerShard, num_elements);
+    Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> block(
+        src_data + begin, static_cast<Eigen::Index>(end - begin));
+    state->partials[shard] = Reducer::Reduce(block);
+
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      T value = internal::TreeCombine<Reducer>(
+          llvm::MutableArrayRef<T>(state->partials));
+      dest_data[0] = Reducer::Finalize(value, num_elements);
+      state->chain.emplace();
+    }
+  };
+
+  // Enqueue all but the first shard, then run the first one inline.
+  for (size_t shard = 1; shard < num_shards; ++shard) {
+    host->EnqueueWork([run_shard, shard] { run_shard(shard); });
+  }
+  run_shard(0);
+
+  return chain;
+}
+
+// Computes dest = sum(src) over all elements.
+template <typename T>
+AsyncValueRef<Chain> Sum(const DenseHostTensor& src, DenseHostTensor* dest,
+                         const ExecutionContext& exec_ctx) {
+  return Reduce<T, internal::SumReducer<T>>(src, dest, exec_ctx);
+}
+
+// Computes dest = mean(src) over all elements.
+template <typename T>
+AsyncValueRef<Chain> Mean(const DenseHostTensor& src, DenseHostTensor* dest,
+                          const ExecutionContext& exec_ctx) {
+  return Reduce<T, internal::MeanReducer<T>>(src, dest, exec_ctx);
+}
+
+// Computes dest = max(src) over all elements.
+template <typename T>
+AsyncValueRef<Chain> Max(const DenseHostTensor& src, DenseHostTensor* dest,
+                         const ExecutionContext& exec_ctx) {
+  return Reduce<T, internal::MaxReducer<T>>(src, dest, exec_ctx);
+}
+
 }  // namespace cpu
 }  // namespace tfrt
 
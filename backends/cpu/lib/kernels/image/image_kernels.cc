@@ -18,10 +18,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <memory>
+
 #include "jpeg/jpeg_mem.h"
 #include "resize_bilinear_op.h"
 #include "tfrt/host_context/function.h"
+#include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/support/ref_count.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
@@ -30,17 +35,15 @@
 namespace tfrt {
 namespace image {
 
-// Returns tf.image.decode_jpeg(data, channels=3)
-static AsyncValueRef<DenseHostTensor> DecodeJpeg(
-    const std::string& data, const ExecutionContext& exec_ctx) {
+// Decodes a single jpeg image into a [height, width, channels] tensor with
+// the given uncompress flags.
+static AsyncValueRef<DenseHostTensor> DecodeJpegWithFlags(
+    const std::string& data, const jpeg::UncompressFlags& flags,
+    const ExecutionContext& exec_ctx) {
   if (!llvm::StringRef(data).startswith("\xff\xd8\xff")) {
     return EmitErrorAsync(exec_ctx, "image does not have jpeg format");
   }
 
-  jpeg::UncompressFlags flags;
-  flags.components = 3;
-  flags.dct_method = JDCT_IFAST;
-
   AsyncValueRef<DenseHostTensor> result;
 
   jpeg::Uncompress(
@@ -59,23 +62,83 @@ static AsyncValueRef<DenseHostTensor> DecodeJpeg(
   return result;
 }
 
+// Returns tf.image.decode_jpeg(data, channels=3)
+static AsyncValueRef<DenseHostTensor> DecodeJpeg(
+    const std::string& data, const ExecutionContext& exec_ctx) {
+  jpeg::UncompressFlags flags;
+  flags.components = 3;
+  flags.dct_method = JDCT_IFAST;
+  return DecodeJpegWithFlags(data, flags, exec_ctx);
+}
+
+// Decodes a batch of jpeg images in parallel on the blocking work queue. Each
+// result is a [height, width, 3] tensor. If the target height and width
+// attributes are positive, each image is downscaled during decode to the
+// largest libjpeg ratio (2, 4 or 8) that still covers the target size, so a
+// pipeline that resizes to e.g. 224x224 never decodes the full pixels of a 4K
+// image; libjpeg skips the IDCT work for the dropped resolution.
+static void BatchDecodeJpeg(RemainingArguments images, RemainingResults results,
+                            Attribute<int64_t> target_height,
+                            Attribute<int64_t> target_width,
+                            const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  for (int i = 0, e = images.size(); i != e; ++i) {
+    auto result = results.AllocateIndirectResultAt(i);
+    bool enqueued = host->EnqueueBlockingWork(
+        [exec_ctx, image = FormRef(images[i]), result = result.CopyRef(),
+         target_height = *target_height, target_width = *target_width] {
+          const std::string& data = image->get<std::string>();
+
+          jpeg::UncompressFlags flags;
+          flags.components = 3;
+          flags.dct_method = JDCT_IFAST;
+
+          // Pick the downscale ratio from the jpeg header; reading the header
+          // does not decode any pixel data.
+          int width, height;
+          if (target_height > 0 && target_width > 0 &&
+              jpeg::GetImageInfo(data.data(), data.size(), &width, &height,
+                                 /*components=*/nullptr)) {
+            while (flags.ratio < 8 &&
+                   height >= flags.ratio * 2 * target_height &&
+                   width >= flags.ratio * 2 * target_width) {
+              flags.ratio *= 2;
+            }
+          }
+
+          result->ForwardTo(
+              DecodeJpegWithFlags(data, flags, exec_ctx).ReleaseRCRef());
+        });
+    if (!enqueued) {
+      result->ForwardTo(EmitErrorAsync(
+          exec_ctx, "failed to enqueue blocking work for jpeg decode"));
+    }
+  }
+}
+
+// Number of output rows one resize shard handles.
+constexpr ssize_t kResizeRowsPerShard = 64;
+
 // TODO(donglin): allocate tensor buffer outside this kernel
-// Returns tf.compat.v1.image.resize(input, [height, width])
-static llvm::Expected<DenseHostTensor> ResizeBilinear(
-    const DenseHostTensor& input, int64_t height, int64_t width,
-    const ExecutionContext& exec_ctx) {
+// Resizes the `crop` window of `input` to [height, width], sharding the output
+// rows across the work queue. The crop is read in place, so cropping costs no
+// extra pass over the pixels.
+static AsyncValueRef<DenseHostTensor> ResizeImageAsync(
+    const DenseHostTensor& input, const CropWindow& crop, int64_t height,
+    int64_t width, const ExecutionContext& exec_ctx) {
   auto host = exec_ctx.host();
   const TensorShape& shape = input.shape();
   if (shape.GetRank() != 3) {
-    return MakeStringError("input tensor shape must be 3");
+    return EmitErrorAsync(exec_ctx, "input tensor shape must be 3");
+  }
+  if (crop.y < 0 || crop.x < 0 || crop.height <= 0 || crop.width <= 0 ||
+      crop.y + crop.height > shape.GetDimensionSize(0) ||
+      crop.x + crop.width > shape.GetDimensionSize(1)) {
+    return EmitErrorAsync(exec_ctx, "crop window is outside the input image");
   }
 
-  ssize_t batch_size = 1;
-  ssize_t input_height = shape.GetDimensionSize(0);
-  ssize_t input_width = shape.GetDimensionSize(1);
   ssize_t channels = shape.GetDimensionSize(2);
-  float height_scale = input_height / static_cast<float>(height);
-  float width_scale = input_width / static_cast<float>(width);
 
   // Create the temporary output tensor with batch_size=1. This follows the same
   // logic in tf.image.resize which adds a batch dimension if the input image
@@ -83,23 +146,101 @@ static llvm::Expected<DenseHostTensor> ResizeBilinear(
   // to TFRT by following the same logic. And in the future we may also want
   // this kernel to process input image with or without the batch dimension.
   auto dht = DenseHostTensor::CreateUninitialized<float>(
-      TensorShape({batch_size, height, width, channels}), host);
+      TensorShape({1, height, width, channels}), host);
   if (!dht) {
-    return MakeStringError("cannot allocate tensor");
+    return EmitErrorAsync(exec_ctx, "cannot allocate tensor");
   }
-  resize_image(input, height_scale, width_scale, *dht);
 
-  // Remove the batch_size dimension before returning the result.
-  TensorMetadata output_metadata(GetDType<float>(), {height, width, channels});
-  DenseHostTensor output(output_metadata, dht->ReleaseBuffer());
+  auto result = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+
+  // Shards write disjoint row ranges of the output; the last shard to finish
+  // removes the batch dimension and publishes the result.
+  struct ResizeState {
+    ResizeState(DenseHostTensor input, DenseHostTensor output, CropWindow crop,
+                AsyncValueRef<DenseHostTensor> result, ssize_t num_shards)
+        : input(std::move(input)),
+          output(std::move(output)),
+          crop(crop),
+          result(std::move(result)),
+          remaining(num_shards) {}
+
+    DenseHostTensor input;
+    DenseHostTensor output;
+    CropWindow crop;
+    AsyncValueRef<DenseHostTensor> result;
+    std::atomic<ssize_t> remaining;
+  };
+
+  const ssize_t num_shards =
+      (height + kResizeRowsPerShard - 1) / kResizeRowsPerShard;
+  auto state = std::make_shared<ResizeState>(input.CopyRef(), std::move(*dht),
+                                             crop, result.CopyRef(),
+                                             num_shards);
+
+  auto run_shard = [state](ssize_t row_begin, ssize_t row_end) {
+    resize_image_rows(state->input, state->crop, state->output, row_begin,
+                      row_end);
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // Remove the batch_size dimension before returning the result.
+      const TensorShape& out_shape = state->output.shape();
+      TensorMetadata output_metadata(GetDType<float>(),
+                                     {out_shape.GetDimensionSize(1),
+                                      out_shape.GetDimensionSize(2),
+                                      out_shape.GetDimensionSize(3)});
+      state->result.emplace(
+          DenseHostTensor(output_metadata, state->output.ReleaseBuffer()));
+    }
+  };
+
+  // Enqueue all but the first shard, then run the first one inline: a resize
+  // smaller than one shard never pays for a thread hop.
+  for (ssize_t shard = 1; shard < num_shards; ++shard) {
+    const ssize_t row_begin = shard * kResizeRowsPerShard;
+    const ssize_t row_end =
+        std::min<ssize_t>(row_begin + kResizeRowsPerShard, height);
+    host->EnqueueWork(
+        [run_shard, row_begin, row_end] { run_shard(row_begin, row_end); });
+  }
+  run_shard(0, std::min<ssize_t>(kResizeRowsPerShard, height));
 
-  return output;
+  return result;
+}
+
+// Returns tf.compat.v1.image.resize(input, [height, width])
+static AsyncValueRef<DenseHostTensor> ResizeBilinear(
+    const DenseHostTensor& input, int64_t height, int64_t width,
+    const ExecutionContext& exec_ctx) {
+  CropWindow crop;
+  const TensorShape& shape = input.shape();
+  if (shape.GetRank() == 3) {
+    crop.height = shape.GetDimensionSize(0);
+    crop.width = shape.GetDimensionSize(1);
+  }
+  return ResizeImageAsync(input, crop, height, width, exec_ctx);
+}
+
+// Crops [crop_y : crop_y + crop_height, crop_x : crop_x + crop_width] from the
+// input and resizes it to [height, width] in one fused pass; the cropped
+// region is never copied out before resizing.
+static AsyncValueRef<DenseHostTensor> CropAndResizeBilinear(
+    const DenseHostTensor& input, int64_t crop_y, int64_t crop_x,
+    int64_t crop_height, int64_t crop_width, int64_t height, int64_t width,
+    const ExecutionContext& exec_ctx) {
+  CropWindow crop;
+  crop.y = crop_y;
+  crop.x = crop_x;
+  crop.height = crop_height;
+  crop.width = crop_width;
+  return ResizeImageAsync(input, crop, height, width, exec_ctx);
 }
 
 // This is the entrypoint to the library.
 void RegisterImageKernels(KernelRegistry* registry) {
   registry->AddKernel("image.decode_jpeg", TFRT_KERNEL(DecodeJpeg));
+  registry->AddKernel("image.batch_decode_jpeg", TFRT_KERNEL(BatchDecodeJpeg));
   registry->AddKernel("image.resize_bilinear", TFRT_KERNEL(ResizeBilinear));
+  registry->AddKernel("image.crop_and_resize",
+                      TFRT_KERNEL(CropAndResizeBilinear));
 }
 
 }  // namespace image
@@ -436,6 +436,40 @@ uint8_t* Uncompress(const void* srcdata, int datasize,
   return dstdata;
 }
 
+bool GetImageInfo(const void* srcdata, int datasize, int* width, int* height,
+                  int* components) {
+  if (width != nullptr) *width = 0;
+  if (height != nullptr) *height = 0;
+  if (components != nullptr) *components = 0;
+
+  // if empty image, return
+  if (datasize == 0 || srcdata == nullptr) return false;
+
+  // Initialize libjpeg structures to have a memory source
+  // Modify the usual jpeg error manager to catch fatal errors.
+  struct jpeg_decompress_struct cinfo;
+  struct jpeg_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr);
+  jerr.error_exit = CatchError;
+
+  jmp_buf jpeg_jmpbuf;
+  cinfo.client_data = &jpeg_jmpbuf;
+  if (setjmp(jpeg_jmpbuf)) {
+    return false;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  SetSrc(&cinfo, srcdata, datasize, false);
+  jpeg_read_header(&cinfo, TRUE);
+
+  if (width != nullptr) *width = cinfo.image_width;
+  if (height != nullptr) *height = cinfo.image_height;
+  if (components != nullptr) *components = cinfo.num_components;
+
+  jpeg_destroy_decompress(&cinfo);
+  return true;
+}
+
 }  // namespace jpeg
 }  // namespace image
 }  // namespace tfrt
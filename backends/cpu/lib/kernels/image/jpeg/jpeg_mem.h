@@ -90,6 +90,12 @@ uint8_t* Uncompress(const void* srcdata, int datasize,
                     const UncompressFlags& flags, int64_t* nwarn,
                     std::function<uint8_t*(int, int, int)> allocate_output);
 
+// Reads the JPEG header and returns the image dimensions and number of
+// components without decoding any pixel data. Any of the output pointers may
+// be null. Returns false if the header cannot be parsed.
+bool GetImageInfo(const void* srcdata, int datasize, int* width, int* height,
+                  int* components);
+
 }  // namespace jpeg
 }  // namespace image
 }  // namespace tfrt
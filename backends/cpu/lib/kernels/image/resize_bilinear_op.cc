@@ -48,20 +48,17 @@ void compute_interpolation_weights(const ssize_t out_size,
   }
 }
 
-float compute_lerp(const float top_left, const float top_right,
-                   const float bottom_left, const float bottom_right,
-                   const float x_lerp, const float y_lerp) {
-  const float top = top_left + (top_right - top_left) * x_lerp;
-  const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
-  return top + (bottom - top) * y_lerp;
-}
-}  // namespace
-
-void resize_image(const DenseHostTensor& input, const float height_scale,
-                  const float width_scale, DenseHostTensor& output) {
+// Resizes output rows [out_row_begin, out_row_end), reading from the `crop`
+// window of the input. The interpolation is separable: each needed source row
+// is horizontally interpolated once into a contiguous float row, and the
+// vertical pass then blends two such rows with a single lerp per element,
+// which vectorizes. Consecutive output rows usually share source rows when
+// upscaling, so the two interpolated rows are cached and reused.
+void resize_rows_impl(const DenseHostTensor& input, const CropWindow& crop,
+                      const float height_scale, const float width_scale,
+                      DenseHostTensor& output, const ssize_t out_row_begin,
+                      const ssize_t out_row_end) {
   const TensorShape& input_shape = input.shape();
-  ssize_t batch_size = 1;
-  ssize_t input_height = input_shape.GetDimensionSize(0);
   ssize_t input_width = input_shape.GetDimensionSize(1);
   ssize_t channels = input_shape.GetDimensionSize(2);
 
@@ -72,69 +69,101 @@ void resize_image(const DenseHostTensor& input, const float height_scale,
   std::vector<CachedInterpolation> ys(output_height + 1);
   std::vector<CachedInterpolation> xs(output_width + 1);
 
-  compute_interpolation_weights(output_height, input_height, height_scale,
+  compute_interpolation_weights(output_height, crop.height, height_scale,
                                 ys.data());
-  compute_interpolation_weights(output_width, input_width, width_scale,
+  compute_interpolation_weights(output_width, crop.width, width_scale,
                                 xs.data());
 
-  // Scale x interpolation weights to avoid a multiplication during iteration.
+  // Shift the indices into the crop window, and scale x indices to element
+  // offsets to avoid a multiplication during iteration.
+  for (int i = 0; i < ys.size(); ++i) {
+    ys[i].lower += crop.y;
+    ys[i].upper += crop.y;
+  }
   for (int i = 0; i < xs.size(); ++i) {
-    xs[i].lower *= channels;
-    xs[i].upper *= channels;
+    xs[i].lower = (xs[i].lower + crop.x) * channels;
+    xs[i].upper = (xs[i].upper + crop.x) * channels;
   }
 
   const ssize_t in_row_size = input_width * channels;
-  const ssize_t in_batch_num_values = input_height * in_row_size;
   const ssize_t out_row_size = output_width * channels;
-  const uint8_t* input_b_ptr = static_cast<const uint8_t*>(input.data());
-  float* output_y_ptr = static_cast<float*>(output.data());
-
-  for (int b = 0; b < batch_size; ++b) {
-    for (ssize_t y = 0; y < output_height; ++y) {
-      const uint8_t* ys_input_lower_ptr =
-          input_b_ptr + ys[y].lower * in_row_size;
-      const uint8_t* ys_input_upper_ptr =
-          input_b_ptr + ys[y].upper * in_row_size;
-      const float ys_lerp = ys[y].lerp;
-      for (ssize_t x = 0; x < output_width; ++x) {
-        const ssize_t xs_lower = xs[x].lower;
-        const ssize_t xs_upper = xs[x].upper;
-        const float xs_lerp = xs[x].lerp;
-
-        // Read channel 0.
-        const float top_left0(ys_input_lower_ptr[xs_lower + 0]);
-        const float top_right0(ys_input_lower_ptr[xs_upper + 0]);
-        const float bottom_left0(ys_input_upper_ptr[xs_lower + 0]);
-        const float bottom_right0(ys_input_upper_ptr[xs_upper + 0]);
-
-        // Read channel 1.
-        const float top_left1(ys_input_lower_ptr[xs_lower + 1]);
-        const float top_right1(ys_input_lower_ptr[xs_upper + 1]);
-        const float bottom_left1(ys_input_upper_ptr[xs_lower + 1]);
-        const float bottom_right1(ys_input_upper_ptr[xs_upper + 1]);
-
-        // Read channel 2.
-        const float top_left2(ys_input_lower_ptr[xs_lower + 2]);
-        const float top_right2(ys_input_lower_ptr[xs_upper + 2]);
-        const float bottom_left2(ys_input_upper_ptr[xs_lower + 2]);
-        const float bottom_right2(ys_input_upper_ptr[xs_upper + 2]);
-
-        // Compute output.
-        output_y_ptr[x * channels + 0] =
-            compute_lerp(top_left0, top_right0, bottom_left0, bottom_right0,
-                         xs_lerp, ys_lerp);
-        output_y_ptr[x * channels + 1] =
-            compute_lerp(top_left1, top_right1, bottom_left1, bottom_right1,
-                         xs_lerp, ys_lerp);
-        output_y_ptr[x * channels + 2] =
-            compute_lerp(top_left2, top_right2, bottom_left2, bottom_right2,
-                         xs_lerp, ys_lerp);
+  const uint8_t* input_ptr = static_cast<const uint8_t*>(input.data());
+  float* output_y_ptr =
+      static_cast<float*>(output.data()) + out_row_begin * out_row_size;
+
+  // Horizontally interpolates one source row into a contiguous float row.
+  auto interpolate_row = [&](const uint8_t* in_row, float* out) {
+    for (ssize_t x = 0; x < output_width; ++x) {
+      const ssize_t xs_lower = xs[x].lower;
+      const ssize_t xs_upper = xs[x].upper;
+      const float xs_lerp = xs[x].lerp;
+      for (ssize_t c = 0; c < channels; ++c) {
+        const float left(in_row[xs_lower + c]);
+        const float right(in_row[xs_upper + c]);
+        out[x * channels + c] = left + (right - left) * xs_lerp;
       }
-      output_y_ptr += out_row_size;
     }
-    input_b_ptr += in_batch_num_values;
+  };
+
+  std::vector<float> row_top(out_row_size);
+  std::vector<float> row_bottom(out_row_size);
+  ssize_t cached_top = -1;
+  ssize_t cached_bottom = -1;
+
+  for (ssize_t y = out_row_begin; y < out_row_end; ++y) {
+    const ssize_t lower = ys[y].lower;
+    const ssize_t upper = ys[y].upper;
+    const float ys_lerp = ys[y].lerp;
+
+    // Reuse the previous bottom row when it becomes this row's top row.
+    if (lower == cached_bottom) {
+      std::swap(row_top, row_bottom);
+      std::swap(cached_top, cached_bottom);
+    }
+    if (lower != cached_top) {
+      interpolate_row(input_ptr + lower * in_row_size, row_top.data());
+      cached_top = lower;
+    }
+    const float* top = row_top.data();
+    const float* bottom = top;
+    if (upper != lower) {
+      if (upper != cached_bottom) {
+        interpolate_row(input_ptr + upper * in_row_size, row_bottom.data());
+        cached_bottom = upper;
+      }
+      bottom = row_bottom.data();
+    }
+
+    // Vertical pass over contiguous float rows; vectorizes.
+    for (ssize_t i = 0; i < out_row_size; ++i) {
+      output_y_ptr[i] = top[i] + (bottom[i] - top[i]) * ys_lerp;
+    }
+    output_y_ptr += out_row_size;
   }
 }
 
+}  // namespace
+
+void resize_image(const DenseHostTensor& input, const float height_scale,
+                  const float width_scale, DenseHostTensor& output) {
+  CropWindow crop;
+  crop.height = input.shape().GetDimensionSize(0);
+  crop.width = input.shape().GetDimensionSize(1);
+  resize_rows_impl(input, crop, height_scale, width_scale, output, 0,
+                   output.shape().GetDimensionSize(1));
+}
+
+void resize_image_rows(const DenseHostTensor& input, const CropWindow& crop,
+                       DenseHostTensor& output, ssize_t out_row_begin,
+                       ssize_t out_row_end) {
+  const TensorShape& output_shape = output.shape();
+  const float height_scale =
+      crop.height / static_cast<float>(output_shape.GetDimensionSize(1));
+  const float width_scale =
+      crop.width / static_cast<float>(output_shape.GetDimensionSize(2));
+  resize_rows_impl(input, crop, height_scale, width_scale, output,
+                   out_row_begin, out_row_end);
+}
+
 }  // namespace image
 }  // namespace tfrt
@@ -34,9 +34,27 @@
 namespace tfrt {
 namespace image {
 
+// A crop window in the input image, in pixels. The window must lie entirely
+// inside the input image.
+struct CropWindow {
+  ssize_t y = 0;
+  ssize_t x = 0;
+  ssize_t height = 0;
+  ssize_t width = 0;
+};
+
 void resize_image(const DenseHostTensor& input, const float height_scale,
                   const float width_scale, DenseHostTensor& output);
 
+// Resizes the `crop` window of `input` ([height, width, channels], uint8)
+// into output rows [out_row_begin, out_row_end) of `output` ([1, height,
+// width, channels], float). The crop is read in place; it is never copied out
+// first. The row range lets one resize be sharded across worker threads; each
+// call computes its own weight tables, so shards need no shared state.
+void resize_image_rows(const DenseHostTensor& input, const CropWindow& crop,
+                       DenseHostTensor& output, ssize_t out_row_begin,
+                       ssize_t out_row_end);
+
 }  // namespace image
 }  // namespace tfrt
 
@@ -21,6 +21,7 @@
 #include "tfrt/cpu/ops/test/cpu_ops_and_kernels.h"
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/tensor/btf_mmap_reader.h"
 #include "tfrt/tensor/btf_reader_util.h"
 
 namespace tfrt {
@@ -59,6 +60,20 @@ void RegisterDenseTensorReaders(KernelRegistry* registry) {
       TFRT_KERNEL(
           ReadTensorFromBTF<ParseDenseHostTensorTraits<uint8_t, Rank>>));
 }
+
+// The mmap variants return tensors that alias the mapped file instead of
+// copying the payload into a fresh buffer.
+template <size_t Rank>
+void RegisterDenseTensorMmapReaders(KernelRegistry* registry) {
+  registry->AddKernel("btf.mmap_dense_tensor.f32." + std::to_string(Rank),
+                      TFRT_KERNEL(MmapTensorFromBTF<float, Rank>));
+  registry->AddKernel("btf.mmap_dense_tensor.i32." + std::to_string(Rank),
+                      TFRT_KERNEL(MmapTensorFromBTF<int32_t, Rank>));
+  registry->AddKernel("btf.mmap_dense_tensor.i8." + std::to_string(Rank),
+                      TFRT_KERNEL(MmapTensorFromBTF<int8_t, Rank>));
+  registry->AddKernel("btf.mmap_dense_tensor.ui8." + std::to_string(Rank),
+                      TFRT_KERNEL(MmapTensorFromBTF<uint8_t, Rank>));
+}
 }  // namespace
 
 void RegisterBTFIOKernels(KernelRegistry* registry) {
@@ -67,6 +82,11 @@ void RegisterBTFIOKernels(KernelRegistry* registry) {
   RegisterDenseTensorReaders<2>(registry);
   RegisterDenseTensorReaders<3>(registry);
   RegisterDenseTensorReaders<4>(registry);
+  RegisterDenseTensorMmapReaders<0>(registry);
+  RegisterDenseTensorMmapReaders<1>(registry);
+  RegisterDenseTensorMmapReaders<2>(registry);
+  RegisterDenseTensorMmapReaders<3>(registry);
+  RegisterDenseTensorMmapReaders<4>(registry);
 }
 
 }  // namespace tfrt
@@ -117,6 +117,26 @@ static AsyncValueRef<HostTensor> TestAddOp(const HostTensor& lhs,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// test.mul op
+//===----------------------------------------------------------------------===//
+
+// This implements the test.mul op.
+//
+static AsyncValueRef<HostTensor> TestMulOp(const HostTensor& lhs,
+                                           const HostTensor& rhs,
+                                           HostContext* host) {
+  switch (lhs.dtype().kind()) {
+    default:
+      assert(0 && "shape function failure");
+      return {};
+#define DTYPE_TRIVIAL(ENUM) \
+  case DType::ENUM:         \
+    return cpu::Mul<TypeForDTypeKind<DType::ENUM>>(lhs, rhs, host);
+#include "tfrt/tensor/dtype.def"
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // test.add.denseonly op
 //===----------------------------------------------------------------------===//
@@ -290,6 +310,8 @@ void RegisterTestCpuOps(CpuOpRegistry* op_registry) {
                      CpuOpFlags::NoSideEffects, {"value"});
   op_registry->AddOp("tfrt_test.add", TFRT_CPU_OP(TestAddOp),
                      CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
+  op_registry->AddOp("tfrt_test.mul", TFRT_CPU_OP(TestMulOp),
+                     CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
   op_registry->AddOp("tfrt_test.add.denseonly", TFRT_CPU_OP(TestAddDenseOnlyOp),
                      CpuOpFlags::NoSideEffects);
   op_registry->AddOp("tfrt_test.add.denseonly2",
@@ -301,7 +323,7 @@ void RegisterTestCpuOps(CpuOpRegistry* op_registry) {
   op_registry->AddOp("tfrt_test.print", TFRT_CPU_OP(PrintOp),
                      CpuOpFlags::AllowsScalar | CpuOpFlags::AllowsCoo);
   op_registry->AddOp("tfrt_test.identity", TFRT_CPU_OP(IdentityOp),
-                     CpuOpFlags::NoSideEffects);
+                     CpuOpFlags::NoSideEffects | CpuOpFlags::Inexpensive);
   op_registry->AddOp("tfrt_test.async.noop", TFRT_CPU_OP(AsyncNoopOp),
                      CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
   // Register another AsyncNoopOp but with no metadata function.
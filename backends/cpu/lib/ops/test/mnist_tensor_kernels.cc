@@ -34,6 +34,7 @@
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/tensor/btf.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/scalar_host_tensor.h"
 
 using ::tfrt::compat::AsEigenConstTensor;
 using ::tfrt::compat::AsEigenTensor;
@@ -384,12 +385,33 @@ static Expected<DenseHostTensor> Broadcast1D(const DenseHostTensor& A,
 // Computes dest = tf.broadcast_to(src, dest_md.shape)
 // src should be a 1-D tensor. dest_md should have a 2-D shape and its last
 // dimension should have same size as src.
-static void Broadcast1DOp(const DenseHostTensor& src,
-                          const TensorMetadata& dest_md,
+static void Broadcast1DOp(const HostTensor& src, const TensorMetadata& dest_md,
                           RCReference<AsyncValue>* dest,
                           const ExecutionContext& exec_ctx) {
   auto* host = exec_ctx.host();
 
+  // Broadcasting a splat produces a splat of the target shape, so stay in
+  // ScalarHostTensor form instead of materializing the result.
+  if (auto* scalar = dyn_cast<AnyScalarHostTensor>(&src)) {
+    switch (scalar->dtype().kind()) {
+      default:
+        *dest = EmitErrorAsync(exec_ctx, "unsupported dtype for broadcast");
+        return;
+#define DTYPE_NUMERIC(ENUM)                                                 \
+  case DType::ENUM: {                                                       \
+    using T = TypeForDTypeKind<DType::ENUM>;                                \
+    *dest = host                                                            \
+                ->MakeConcreteAsyncValueRef<ScalarHostTensor<T>>(           \
+                    dest_md, cast<ScalarHostTensor<T>>(scalar)->GetValue()) \
+                .ReleaseRCRef();                                            \
+    return;                                                                 \
+  }
+#include "tfrt/tensor/dtype.def"
+    }
+  }
+
+  auto& src_dht = cast<DenseHostTensor>(src);
+
   auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
   if (!dest_alloc) {
     *dest = EmitErrorAsync(exec_ctx, "out of memory allocating result");
@@ -398,14 +420,14 @@ static void Broadcast1DOp(const DenseHostTensor& src,
 
   auto& dest_tensor = dest_alloc.getValue();
 
-  switch (src.dtype().kind()) {
+  switch (src_dht.dtype().kind()) {
     default:
       *dest = EmitErrorAsync(exec_ctx, "unsupported dtype for broadcast");
       return;
-#define DTYPE_NUMERIC(ENUM)                                                 \
-  case DType::ENUM:                                                         \
-    Broadcast1DKernel<EigenTypeForDTypeKind<DType::ENUM>, 2>(src,           \
-                                                             &dest_tensor); \
+#define DTYPE_NUMERIC(ENUM)                                       \
+  case DType::ENUM:                                               \
+    Broadcast1DKernel<EigenTypeForDTypeKind<DType::ENUM>, 2>(     \
+        src_dht, &dest_tensor);                                   \
     break;
 #include "tfrt/tensor/dtype.def"
   }
@@ -749,7 +771,7 @@ void RegisterTestMnistCpuOps(CpuOpRegistry* op_registry) {
   op_registry->AddOp("tfrt_test.cast", TFRT_CPU_OP(CastOp),
                      CpuOpFlags::NoSideEffects);
   op_registry->AddOp("tfrt_test.broadcast", TFRT_CPU_OP(Broadcast1DOp),
-                     CpuOpFlags::NoSideEffects);
+                     CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
   op_registry->AddOp("tfrt_test.argmax", TFRT_CPU_OP(ArgmaxOp),
                      CpuOpFlags::NoSideEffects, {"axis"});
   op_registry->AddOp("tfrt_test.reduce_mean", TFRT_CPU_OP(ReduceMeanOp),
@@ -21,7 +21,12 @@
 #include "tfrt/cpu/ops/tf/cpu_ops.h"
 
 #include "../../kernels/cpu_kernels.h"
+#include "backends/common/lib/compat/eigen/contraction_output_kernel.h"
+#include "backends/common/lib/compat/eigen/spatial_convolution.h"
 #include "tfrt/common/compat/eigen/eigen_dtype.h"
+#include "tfrt/common/compat/eigen/tensor_types.h"
+#include "tfrt/common/compat/eigen/thread_pool_device.h"
+#include "tfrt/common/ops/tf/dnn_ops_util.h"
 #include "tfrt/common/ops/tf/metadata_functions.h"
 #include "tfrt/core_runtime/op_attrs.h"
 #include "tfrt/core_runtime/op_utils.h"
@@ -115,6 +120,91 @@ static void TfMatMulOp(const DenseHostTensor& lhs, const DenseHostTensor& rhs,
       host->MakeConcreteAsyncValueRef<DenseHostTensor>(std::move(dest_tensor));
 }
 
+//===----------------------------------------------------------------------===//
+// tf._FusedConv2DBiasRelu op
+//===----------------------------------------------------------------------===//
+
+// Computes a Conv2D, then adds `bias` and applies Relu inside the
+// contraction's output kernel, while the output tile is still in cache. This
+// saves two full round trips over the activation tensor compared to
+// dispatching the three ops separately.
+static AsyncValueRef<DenseHostTensor> TfFusedConv2DBiasReluOp(
+    const DenseHostTensor& input, const DenseHostTensor& filter,
+    const DenseHostTensor& bias, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  if (input.dtype().kind() != DType::F32) {
+    return EmitErrorAsync(exec_ctx, "unsupported dtype for fused conv2d");
+  }
+
+  auto channel_order =
+      GetTfChannelOrder(attrs.GetStringOptional("data_format"));
+  if (channel_order != ChannelOrder::ChannelLast) {
+    return EmitErrorAsync(exec_ctx,
+                          "fused conv2d only supports NHWC data format");
+  }
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc) {
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  }
+  auto& dest_tensor = dest_alloc.getValue();
+
+  // Recover strides, dilations and paddings from the TF attributes, the same
+  // way the metadata function computed the output shape.
+  auto input_dims_nchw = GetDimensions(input.shape());
+  RotateRight(llvm::MutableArrayRef<ssize_t>(input_dims_nchw).drop_front());
+
+  auto filter_dims = GetDimensions(filter.shape());
+  // TF filter is HWIO, convert to OIHW.
+  RotateRight(filter_dims, 2);
+  std::swap(filter_dims[0], filter_dims[1]);
+
+  auto windowed_output_data = GetTfWindowedOutputData(
+      input_dims_nchw, filter_dims, channel_order,
+      attrs.GetStringAsserting("padding"),
+      attrs.GetArrayOptional<int>("explicit_paddings"),
+      attrs.GetArrayOptional<ssize_t>("strides"),
+      attrs.GetArrayOptional<ssize_t>("dilations"));
+  if (!windowed_output_data) {
+    return EmitErrorAsync(exec_ctx, windowed_output_data.takeError());
+  }
+  const WindowedOutputData& data = *windowed_output_data;
+
+  DHTIndexableView<float, 4> input_view(&input);
+  DHTIndexableView<float, 4> filter_view(&filter);
+  DHTIndexableView<float, 1> bias_view(&bias);
+  MutableDHTIndexableView<float, 4> dest_view(&dest_tensor);
+
+  compat::BiasAddOutputKernel<float, compat::Relu> output_kernel(
+      compat::AsEigenConstTensor(bias_view));
+
+  // clang-format off
+  auto expr = compat::SpatialConvolution(
+      compat::AsEigenConstTensor(input_view), input_view.FixedShape(),
+      compat::AsEigenConstTensor(filter_view), filter_view.FixedShape(),
+      /*strides=*/{data.strides[0], data.strides[1]},
+      /*paddings=*/{data.paddings_before[0], data.paddings_after[0],
+                    data.paddings_before[1], data.paddings_after[1]},
+      /*dilations=*/{data.dilations[0], data.dilations[1]},
+      /*inflations=*/{1, 1},
+      /*output_kernel=*/output_kernel);
+  // clang-format on
+
+  auto result = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  compat::AsyncAssign(
+      host->GetOrCreateSharedContext<compat::EigenHostContext>(),
+      compat::AsEigenTensor(dest_view), std::move(expr),
+      [result = result.CopyRef(), dest = std::move(dest_tensor),
+       input = input.buffer().CopyRef(), filter = filter.buffer().CopyRef(),
+       bias = bias.buffer().CopyRef()]() mutable {
+        result.emplace(std::move(dest));
+      });
+
+  return result;
+}
+
 //===----------------------------------------------------------------------===//
 // tf.Relu op
 //===----------------------------------------------------------------------===//
@@ -164,11 +254,15 @@ void RegisterTfCpuOps(CpuOpRegistry* op_registry) {
     op_registry->AddMetadataFn(md_function.first, md_function.second);
   }
   op_registry->AddOp("tf.Const", TFRT_CPU_OP(TfConstOp),
-                     CpuOpFlags::NoSideEffects, {"value"});
+                     CpuOpFlags::NoSideEffects | CpuOpFlags::Inexpensive,
+                     {"value"});
   op_registry->AddOp("tf.AddV2", TFRT_CPU_OP(TfAddOp),
                      CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
   op_registry->AddOp("tf.MatMul", TFRT_CPU_OP(TfMatMulOp),
                      CpuOpFlags::NoSideEffects, {"transpose_a", "transpose_b"});
+  op_registry->AddOp("tf._FusedConv2DBiasRelu",
+                     TFRT_CPU_OP(TfFusedConv2DBiasReluOp),
+                     CpuOpFlags::NoSideEffects, {"padding", "strides"});
   op_registry->AddOp("tf.Relu", TFRT_CPU_OP(TfReluOp),
                      CpuOpFlags::NoSideEffects);
 }
@@ -0,0 +1,105 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- work_queue_benchmark.cc --------------------------------------------===//
+//
+// Microbenchmarks for the multi-threaded work queue driven through
+// HostContext (the runtime's submission interface): enqueue throughput and
+// submit-to-completion handoff latency across worker counts. Scheduling
+// overhead bounds how small a kernel can usefully be made asynchronous, so
+// regressions here matter to every workload.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/latch.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateHostContext(int num_threads) {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) { abort(); }, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads,
+                                   /*num_blocking_threads=*/1));
+}
+
+// Fire-and-forget submission throughput from one producer, with the given
+// number of workers draining concurrently. This is the executor's
+// ProcessReadyKernels handoff path.
+void BM_EnqueueWork(benchmark::State& state) {
+  auto host = CreateHostContext(state.range(0));
+  std::atomic<int64_t> completed{0};
+  for (auto _ : state) {
+    host->EnqueueWork(
+        [&completed] { completed.fetch_add(1, std::memory_order_relaxed); });
+  }
+  host->Quiesce();
+  benchmark::DoNotOptimize(completed.load());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EnqueueWork)->Arg(1)->Arg(4)->Arg(8)->Arg(16);
+
+// Submit-to-completion latency of a single task: enqueue, then wait for the
+// task to run. With an otherwise idle queue this measures wakeup plus steal
+// latency - the minimum end-to-end cost of moving work to another thread.
+void BM_EnqueueWorkLatency(benchmark::State& state) {
+  auto host = CreateHostContext(state.range(0));
+  for (auto _ : state) {
+    latch done(1);
+    host->EnqueueWork([&done] { done.count_down(); });
+    done.wait();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EnqueueWorkLatency)->Arg(1)->Arg(4)->Arg(8)->Arg(16);
+
+// A task fan-out tree: each task splits its leaf count and enqueues half
+// until single leaves remain. Exercises worker-to-worker stealing rather
+// than the producer-to-worker handoff above.
+void BM_TaskFanOut(benchmark::State& state) {
+  auto host = CreateHostContext(state.range(0));
+  const int64_t num_leaves = state.range(1);
+  for (auto _ : state) {
+    latch done(num_leaves);
+    std::function<void(int64_t)> run = [&](int64_t leaves) {
+      while (leaves > 1) {
+        int64_t half = leaves / 2;
+        host->EnqueueWork([&run, half] { run(half); });
+        leaves -= half;
+      }
+      done.count_down();
+    };
+    host->EnqueueWork([&run, num_leaves] { run(num_leaves); });
+    done.wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_leaves);
+}
+BENCHMARK(BM_TaskFanOut)
+    ->Args({4, 256})
+    ->Args({8, 256})
+    ->Args({16, 256})
+    ->Args({16, 4096});
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,79 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- parallel_for_test.cc -------------------------------------*- C++ -*-===//
+//
+// Unit test for HostContext::ParallelFor and its grain sizing.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/support/latch.h"
+
+namespace tfrt {
+namespace {
+
+TEST(ParallelForTest, CoversRangeExactlyOnce) {
+  auto host = CreateHostContext();
+
+  constexpr size_t kCount = 10000;
+  std::vector<std::atomic<int>> visits(kCount);
+  latch done(1);
+
+  HostContext::ParallelForCost cost;
+  cost.bytes_per_element = sizeof(int);
+  host->ParallelFor(
+      kCount, cost,
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i != end; ++i)
+          visits[i].fetch_add(1, std::memory_order_relaxed);
+      },
+      [&] { done.count_down(); });
+  done.wait();
+
+  for (size_t i = 0; i != kCount; ++i) EXPECT_EQ(1, visits[i].load());
+}
+
+TEST(ParallelForTest, BlockSizeAmortizesTaskOverhead) {
+  auto host = CreateHostContext();
+
+  // Cheap elements get large blocks; expensive elements get small ones.
+  HostContext::ParallelForCost cheap;
+  cheap.cycles_per_element = 1;
+  HostContext::ParallelForCost expensive;
+  expensive.cycles_per_element = 100000;
+
+  constexpr size_t kCount = 1024;
+  EXPECT_GT(host->ChooseParallelForBlockSize(kCount, cheap),
+            host->ChooseParallelForBlockSize(kCount, expensive));
+
+  // The block size never exceeds the range.
+  EXPECT_LE(host->ChooseParallelForBlockSize(10, cheap), 10);
+}
+
+TEST(ParallelForTest, BlockBoundariesFallOnCacheLines) {
+  auto host = CreateHostContext();
+
+  HostContext::ParallelForCost cost;
+  cost.bytes_per_element = 4;
+  size_t block_size = host->ChooseParallelForBlockSize(1 << 24, cost);
+  EXPECT_EQ(0, block_size % (64 / cost.bytes_per_element));
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,147 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- concurrent_block_vector_test.cc --------------------------*- C++ -*-===//
+//
+// Unit test for ConcurrentBlockVector
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/concurrent_block_vector.h"
+
+#include <memory>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(ConcurrentBlockVectorTest, SingleThreaded) {
+  tfrt::ConcurrentBlockVector<int> vec(2);
+
+  constexpr int kCount = 100;
+
+  for (int i = 0; i < kCount; ++i) {
+    ASSERT_EQ(i, vec.emplace_back(i));
+  }
+
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(i, vec[i]);
+  }
+}
+
+TEST(ConcurrentBlockVectorTest, ReferencesStableAcrossGrowth) {
+  tfrt::ConcurrentBlockVector<int> vec(2);
+
+  int& first = vec[vec.emplace_back(42)];
+  // Force several block allocations.
+  for (int i = 0; i < 1000; ++i) vec.emplace_back(i);
+
+  EXPECT_EQ(42, first);
+  EXPECT_EQ(&first, &vec[0]);
+}
+
+TEST(ConcurrentBlockVectorTest, MoveOnlyElements) {
+  tfrt::ConcurrentBlockVector<std::unique_ptr<int>> vec(2);
+
+  constexpr int kCount = 100;
+  for (int i = 0; i < kCount; ++i) {
+    vec.emplace_back(std::make_unique<int>(i));
+  }
+
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(i, *vec[i]);
+  }
+}
+
+TEST(ConcurrentBlockVectorTest, ReserveThenForEach) {
+  tfrt::ConcurrentBlockVector<int> vec(2);
+  vec.reserve(1000);
+
+  constexpr int kCount = 1000;
+  for (int i = 0; i < kCount; ++i) vec.emplace_back(i);
+
+  int expected = 0;
+  vec.ForEach([&](size_t index, const int& value) {
+    EXPECT_EQ(expected, static_cast<int>(index));
+    EXPECT_EQ(expected, value);
+    ++expected;
+  });
+  EXPECT_EQ(kCount, expected);
+}
+
+TEST(ConcurrentBlockVectorTest, OneWriterOneReader) {
+  tfrt::ConcurrentBlockVector<int> vec(2);
+
+  std::atomic<int> cur_count{0};
+  constexpr int kCount = 100;
+
+  std::thread writer([&] {
+    for (int i = 0; i < kCount; ++i) {
+      ASSERT_EQ(i, vec.emplace_back(i));
+      ++cur_count;
+    }
+  });
+
+  std::thread reader([&] {
+    for (int i = 0; i < kCount; ++i) {
+      while (i >= cur_count)
+        ;
+      EXPECT_EQ(i, vec[i]);
+    }
+  });
+
+  writer.join();
+  reader.join();
+}
+
+TEST(ConcurrentBlockVectorTest, TwoWritersTwoReaders) {
+  tfrt::ConcurrentBlockVector<int> vec(2);
+
+  std::atomic<int> cur_count{0};
+  constexpr int kCount = 100;
+
+  // Each writer stores from 0 to kCount/2 - 1 to the vector.
+  auto writer = [&] {
+    for (int i = 0; i < kCount / 2; ++i) {
+      vec.emplace_back(i);
+      ++cur_count;
+    }
+  };
+
+  // Each reader waits until elements become available and checks that each
+  // element is in the expected range.
+  auto reader = [&] {
+    for (int i = 0; i < kCount; ++i) {
+      while (i >= cur_count)
+        ;
+      int value = vec[i];
+      EXPECT_GE(value, 0);
+      EXPECT_LT(value, kCount / 2);
+    }
+  };
+
+  std::thread writer1(writer);
+  std::thread writer2(writer);
+  std::thread reader1(reader);
+  std::thread reader2(reader);
+
+  writer1.join();
+  writer2.join();
+  reader1.join();
+  reader2.join();
+}
+
+}  // namespace
@@ -0,0 +1,97 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- rc_array_test.cc -----------------------------------------*- C++ -*-===//
+//
+// Unit test for RCArray
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/rc_array.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/support/ref_count.h"
+
+namespace {
+
+class Counted : public tfrt::ReferenceCounted<Counted> {
+ public:
+  explicit Counted(int* live_count) : live_count_(live_count) {
+    ++*live_count_;
+  }
+  ~Counted() { --*live_count_; }
+
+ private:
+  friend class tfrt::ReferenceCounted<Counted>;
+  int* live_count_;
+};
+
+TEST(RCArrayTest, ConstructCopiesRefs) {
+  int live_count = 0;
+  auto ref = tfrt::TakeRef(new Counted(&live_count));
+
+  {
+    tfrt::RCArray<Counted> array(llvm::makeArrayRef(ref.get()));
+    ASSERT_EQ(1, array.size());
+    EXPECT_EQ(ref.get(), array[0]);
+    EXPECT_EQ(1, live_count);
+  }
+
+  // The array's reference is gone; ours keeps the object alive.
+  EXPECT_EQ(1, live_count);
+  ref.reset();
+  EXPECT_EQ(0, live_count);
+}
+
+TEST(RCArrayTest, TakeRefAdoptsWithoutCopying) {
+  int live_count = 0;
+  llvm::SmallVector<tfrt::RCReference<Counted>, 4> refs;
+  refs.push_back(tfrt::TakeRef(new Counted(&live_count)));
+  refs.push_back(tfrt::TakeRef(new Counted(&live_count)));
+  EXPECT_EQ(2, live_count);
+
+  {
+    auto array = tfrt::RCArray<Counted>::TakeRef(refs);
+    // The sources are emptied, not copied; the array now owns the only refs.
+    EXPECT_EQ(nullptr, refs[0].get());
+    EXPECT_EQ(nullptr, refs[1].get());
+    ASSERT_EQ(2, array.size());
+    EXPECT_EQ(2, live_count);
+  }
+
+  EXPECT_EQ(0, live_count);
+}
+
+TEST(RCArrayTest, MoveAndCopyRef) {
+  int live_count = 0;
+  auto ref = tfrt::TakeRef(new Counted(&live_count));
+
+  tfrt::RCArray<Counted> array(llvm::makeArrayRef(ref.get()));
+  ref.reset();
+  EXPECT_EQ(1, live_count);
+
+  auto copy = array.CopyRef();
+  EXPECT_EQ(1, live_count);
+
+  auto moved = std::move(array);
+  ASSERT_EQ(1, moved.size());
+  EXPECT_EQ(1, live_count);
+
+  copy = std::move(moved);
+  EXPECT_EQ(1, live_count);
+}
+
+}  // namespace
@@ -0,0 +1,90 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- string_interner_test.cc ----------------------------------*- C++ -*-===//
+//
+// Unit test for StringInterner
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/string_interner.h"
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace {
+
+TEST(StringInternerTest, InternIsIdempotent) {
+  tfrt::StringInterner interner;
+
+  auto id = interner.Intern("tfrt_test.some_kernel");
+  EXPECT_EQ(id, interner.Intern("tfrt_test.some_kernel"));
+  EXPECT_EQ(id, interner.Find("tfrt_test.some_kernel"));
+  EXPECT_EQ("tfrt_test.some_kernel", interner.GetString(id));
+  EXPECT_STREQ("tfrt_test.some_kernel", interner.GetCString(id));
+}
+
+TEST(StringInternerTest, DistinctStringsGetDenseIds) {
+  tfrt::StringInterner interner;
+
+  constexpr int kCount = 1000;
+  std::vector<tfrt::StringInterner::Id> ids;
+  for (int i = 0; i < kCount; ++i) {
+    ids.push_back(interner.Intern("kernel." + std::to_string(i)));
+  }
+
+  EXPECT_EQ(kCount, interner.size());
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_LT(ids[i], interner.size());
+    EXPECT_EQ("kernel." + std::to_string(i),
+              interner.GetString(ids[i]).str());
+  }
+}
+
+TEST(StringInternerTest, FindMissingReturnsInvalid) {
+  tfrt::StringInterner interner;
+  EXPECT_EQ(tfrt::StringInterner::kInvalidId, interner.Find("never.interned"));
+}
+
+TEST(StringInternerTest, ConcurrentInterning) {
+  tfrt::StringInterner interner;
+
+  constexpr int kThreads = 4;
+  constexpr int kCount = 200;
+
+  // All threads intern the same strings; each string must get exactly one id.
+  std::vector<std::thread> threads;
+  std::vector<std::vector<tfrt::StringInterner::Id>> ids(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&interner, &ids, t] {
+      for (int i = 0; i < kCount; ++i) {
+        ids[t].push_back(interner.Intern("shared." + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(kCount, interner.size());
+  for (int t = 1; t < kThreads; ++t) {
+    EXPECT_EQ(ids[0], ids[t]);
+  }
+}
+
+}  // namespace
@@ -26,6 +26,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "tfrt/support/forward_decls.h"
+
 namespace mlir {
 class ModuleOp;
 }
@@ -36,10 +38,45 @@ namespace tfrt {
 // compatible program to the BinaryExecutableFormat (BEF) format, which is the
 // low level format that the executor takes.
 //
+// If num_function_threads is greater than one, function bodies are translated
+// concurrently on that many threads and merged in index order. The output is
+// deterministic and does not depend on scheduling or thread count, but its
+// padding bytes may differ from single-threaded output.
+//
+// If compact_function_bodies is set, the output uses BEF format version 1,
+// which stores the kernel words of each function body as a VBR stream instead
+// of fixed 4-byte words. This shrinks function-heavy files substantially at
+// the cost of a one-time decode when each function is first read; readers
+// older than format version 1 reject such files.
+//
 // On error, this emits the error message through the MLIR error handler, and
 // returns an empty std:vector.
 std::vector<uint8_t> ConvertMLIRToBEF(mlir::ModuleOp module,
-                                      bool disable_optional_sections);
+                                      bool disable_optional_sections,
+                                      int num_function_threads = 1,
+                                      bool compact_function_bodies = false);
+
+// Output sink for ConvertMLIRToBEFStream.  Write is called with consecutive
+// chunks of the BEF output; concatenating all chunks in call order yields the
+// same bytes ConvertMLIRToBEF would return.
+class BEFBytesSink {
+ public:
+  virtual ~BEFBytesSink();
+
+  // Append data to the output.  Returning false indicates a write failure and
+  // aborts the conversion.
+  virtual bool Write(ArrayRef<uint8_t> data) = 0;
+};
+
+// Streaming variant of ConvertMLIRToBEF that hands each completed section of
+// the output to `sink` instead of accumulating the whole file, bounding
+// converter memory to the largest single section rather than the file size.
+// Returns false on conversion failure (reported through the MLIR error
+// handler) or on a failed sink write.
+bool ConvertMLIRToBEFStream(mlir::ModuleOp module,
+                            bool disable_optional_sections, BEFBytesSink* sink,
+                            int num_function_threads = 1,
+                            bool compact_function_bodies = false);
 
 }  // namespace tfrt
 
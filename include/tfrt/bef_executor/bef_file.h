@@ -26,6 +26,7 @@
 
 #include <functional>
 
+#include "llvm/ADT/StringRef.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/ref_count.h"
 
@@ -51,10 +52,57 @@ class BEFFile : public ReferenceCounted<BEFFile> {
   // TODO: This should (optionally) manage ownership of the underlying data
   // passed in, taking a closure to run when the lifetime of the BEFFile is
   // done.
+  // If `kernel_resolution_cache` names a cache previously written by
+  // SaveKernelResolutionCache with the same registry, the kernel table is
+  // resolved through integer registry ordinals from the cache instead of one
+  // name lookup per kernel. A missing or stale cache silently falls back to
+  // name resolution.
   static RCReference<BEFFile> Open(ArrayRef<uint8_t> file,
                                    KernelRegistry* registry,
                                    ErrorHandler error_handler,
-                                   HostAllocator* host_allocator);
+                                   HostAllocator* host_allocator,
+                                   string_view kernel_resolution_cache = "");
+
+  // Open a BEF file by memory-mapping it from `path`, with lazy decoding:
+  // function bodies are decoded and their kernels resolved on first Execute
+  // of each function, instead of for the whole file up front. For a large
+  // multi-model bundle where one process serves only a few of the functions,
+  // this keeps both open time and the number of touched pages proportional
+  // to the functions actually used. The mapping is owned by the returned
+  // BEFFile and released with it.
+  //
+  // On failure, an error message is emitted to the error_handler and nullptr
+  // is returned.
+  static RCReference<BEFFile> OpenFile(string_view path,
+                                       KernelRegistry* registry,
+                                       ErrorHandler error_handler,
+                                       HostAllocator* host_allocator,
+                                       string_view kernel_resolution_cache = "");
+
+  // Write a kernel resolution cache to `path`, mapping each kernel table
+  // entry of this file to its registry ordinal and keyed by the registry
+  // fingerprint, so subsequent opens passing the same path skip per-kernel
+  // name resolution. Typically written once after the first load of a
+  // deployment and read by every replica. Returns false if the cache could
+  // not be written (e.g. I/O error or unresolved kernels).
+  bool SaveKernelResolutionCache(string_view path) const;
+
+  // Incrementally reload this file from `file`, an updated BEF buffer
+  // produced from a newer version of the same module. All sections other than
+  // Functions and FunctionIndex must be byte-identical, and existing
+  // functions must keep their positions in the function index (new functions
+  // may be appended), since kernels reference functions by index. Functions
+  // whose bodies are unchanged keep their decoded scheduling state and warm
+  // invocation arenas; changed and added functions are decoded from the new
+  // buffer.
+  //
+  // Returns false, leaving this file untouched, if the buffer is malformed or
+  // differs beyond the function sections; the caller should then fall back to
+  // Open. Like the buffer passed to Open, `file` must stay live for the life
+  // of this object - and so must the previous buffer, which executions
+  // already in flight may still reference. The caller must prevent new
+  // Execute calls from racing with the reload itself.
+  bool ReloadFunctions(ArrayRef<uint8_t> file);
 
   // Get a list of functions out of the BEF file.
   void GetFunctionList(SmallVectorImpl<const Function*>* result) const;
@@ -57,6 +57,20 @@ struct RunBefConfig {
   ArrayRef<std::string> functions;
   std::string work_queue_type;
   tfrt::HostAllocatorType host_allocator_type;
+
+  // When set, benchmark each function instead of printing its results: run
+  // bench_warmup_runs untimed repetitions to absorb load effects, then
+  // bench_num_runs timed ones, and report p50/p90/p99 wall time plus
+  // allocations per run (when the host allocator counts them, e.g.
+  // kProfiledMalloc).
+  bool bench = false;
+  int bench_warmup_runs = 2;
+  int bench_num_runs = 50;
+
+  // When non-empty, route tracing into the chrome tracing sink and write the
+  // collected timeline to this file as Chrome trace-event JSON (loadable in
+  // chrome://tracing or Perfetto) when the run completes.
+  std::string chrome_trace_filename;
 };
 
 int RunBefExecutor(const RunBefConfig& run_config);
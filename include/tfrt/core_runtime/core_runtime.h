@@ -25,6 +25,7 @@
 
 #include <functional>
 
+#include "llvm/ADT/ArrayRef.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -42,6 +43,17 @@ class CoreRuntimeOp;
 class OpHandler;
 class TensorHandle;
 
+// Describes one invocation in a homogeneous batch passed to
+// CoreRuntime::ExecuteBatch. All invocations in a batch share the same op and
+// op_handler; each entry supplies its own arguments, attributes, results and
+// chain, with the same semantics as the corresponding Execute parameters.
+struct BatchedOpInvocation {
+  MutableArrayRef<TensorHandle> arguments;
+  const OpAttrsRef* attrs;
+  MutableArrayRef<TensorHandle> results;
+  AsyncValueRef<Chain>* chain;
+};
+
 class CoreRuntime final {
  public:
   // Create a CoreRuntime object. `op_handler_chains` is an array of strings
@@ -95,6 +107,16 @@ class CoreRuntime final {
                MutableArrayRef<TensorHandle> results,
                AsyncValueRef<Chain>* chain);
 
+  // [Experimental]
+  // Execute a batch of invocations of the same op on the same op_handler.
+  // This behaves like calling Execute once per entry of `invocations`, but
+  // the op is resolved only once for the whole batch, so the per-invocation
+  // dispatch overhead is amortized across homogeneous invocations (e.g.
+  // hundreds of identical lookups per serving request). The kernel bodies
+  // still flow through the work queue via the op's own asynchronous dispatch.
+  void ExecuteBatch(string_view op_name, OpHandler* op_handler, Location loc,
+                    MutableArrayRef<BatchedOpInvocation> invocations);
+
   // [Experimental]
   // Return an CoreRuntimeOp (a callable) that clients can use to execute an op
   // directly, or an error if it cannot find the op in the op registry.
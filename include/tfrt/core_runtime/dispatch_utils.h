@@ -83,6 +83,12 @@ namespace tfrt {
 //                        MutableArrayRef<RCReference<AsyncValue>> results,
 //                        AsyncValueRef<Chain>* chain,
 //                        const ExecutionContext& exec_ctx);
+//
+//   // Returns true if the dispatch function for `op_entry` is cheap enough to
+//   // run inline on the thread that makes its last asynchronous argument
+//   // available.  Dispatches that return false are handed to the work queue
+//   // instead, so a producer thread is not hijacked for long-running work.
+//   static bool DispatchIsInexpensive(const OpEntryTy& op_entry);
 // };
 //
 // This overload will be SFINAE'ed out if OpHandlerTraits::OpHandlerInfoTy
@@ -173,6 +179,12 @@ class AsyncOpDispatcher {
 
   void RunDispatchFunction();
 
+  const typename OpHandlerTraits::OpEntryTy& op_entry() const {
+    return op_entry_;
+  }
+
+  const ExecutionContext& exec_ctx() const { return exec_ctx_; }
+
   const OpAttrsRef& frozen_attrs() const { return frozen_attrs_; }
 
   const SmallVectorImpl<TensorMetadata>& result_mds() const {
@@ -518,9 +530,19 @@ void ExecuteWithResultMetadataResolved(
     }
   }
 
+  // An op flagged inexpensive runs inline on the thread that makes its last
+  // argument available; anything else takes a work queue round-trip so a
+  // producer thread is not hijacked for a long-running dispatch.
+  const bool dispatch_inline =
+      OpHandlerTraits::DispatchIsInexpensive(op_dispatcher.op_entry());
   exec_ctx.host()->RunWhenReady(
-      async_args, [op_dispatcher = std::move(op_dispatcher)]() mutable {
-        op_dispatcher.RunDispatchFunction();
+      async_args,
+      [op_dispatcher = std::move(op_dispatcher), dispatch_inline]() mutable {
+        if (dispatch_inline) return op_dispatcher.RunDispatchFunction();
+        HostContext* host = op_dispatcher.exec_ctx().host();
+        host->EnqueueWork([op_dispatcher = std::move(op_dispatcher)]() mutable {
+          op_dispatcher.RunDispatchFunction();
+        });
       });
 }
 
@@ -652,6 +674,10 @@ bool ExecuteOnOpHandler(bool update_chain, const OpInvocation& invocation,
       OpHandlerTraits::Dispatch(op_entry, inputs, attrs, result_mds, results,
                                 chain, exec_ctx);
     }
+
+    static bool DispatchIsInexpensive(const OpEntryTy& op_entry) {
+      return OpHandlerTraits::DispatchIsInexpensive(op_entry);
+    }
   };
 
   return internal::ExecuteOnOpHandlerImpl<InnerOpHandlerTraits>(
@@ -43,6 +43,12 @@ namespace tfrt {
 class OpAttrsRef;
 class ImmutableOpAttrs;
 
+// Returns a process-lifetime pointer to a null terminated copy of `name`,
+// interned in a global attribute-name table. Repeated calls with equal
+// strings return the same pointer, so interned names can be compared by
+// pointer instead of by content. Frozen attribute sets store interned names.
+const char* GetInternedAttrName(string_view name);
+
 // This describes a single attribute entry maintained by OpAttrs. It is a 'raw'
 // attribute, meaning that it is type erased and may or may not be an array.
 struct OpAttrsRawEntry final {
@@ -424,6 +430,12 @@ class OpAttrsRef {
     return *result;
   }
 
+  // Return an order-independent hash of the full contents (names, types and
+  // payloads) of this attribute set. For frozen sets the hash is precomputed
+  // at freeze time, which makes it cheap enough to serve as part of a
+  // dispatch-cache key.
+  size_t GetHash() const;
+
   // Return a reference that is guaranteed stable on the heap.
   OpAttrsRef freeze() const;
 
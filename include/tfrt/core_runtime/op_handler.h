@@ -55,6 +55,13 @@ class OpHandler {
 
   OpHandler *GetFallback() const { return fallback_; }
 
+  // Return true if this op_handler is an interposer (an op_handler that wraps
+  // its fallback purely for instrumentation, e.g. logging) that is currently
+  // disabled. Chain construction drops a bypassed op_handler and links callers
+  // directly to its fallback, so a disabled interposer adds no per-op
+  // dispatch overhead.
+  virtual bool IsBypassed() const { return false; }
+
   virtual Expected<CoreRuntimeOp> MakeOp(string_view op_name) = 0;
 
   // Copy device tensor to host.
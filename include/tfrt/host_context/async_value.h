@@ -412,6 +412,18 @@ class AsyncValue {
 };
 
 // We only optimize the code for 64-bit architectures for now.
+//
+// The compact 16 byte layout is deliberate: refcount_, the type/state word
+// and waiters_and_state_ share the value's single cache line with the start
+// of the payload, which is what makes the single-owner fast path cheap.
+// Splitting the refcount onto its own line for multi-waiter values would
+// break kDataOrErrorOffset, which kernels address through directly. Instead,
+// isolation between *distinct* values is provided by the allocator:
+// HostContext hands out AsyncValue storage in cache-line-multiple size
+// classes, so a thread spinning on one value's state never false-shares
+// with refcount traffic on a neighboring value, and the executor gives each
+// consumer of an unproduced register a private placeholder so concurrent
+// waiters do not spin on a shared line.
 static_assert(sizeof(AsyncValue) == 16 || sizeof(void*) != 8,
               "Unexpected size for AsyncValue");
 
@@ -157,6 +157,12 @@ class AggregateAttribute {
 
   size_t size() const { return element_descriptors_.size(); }
 
+  // Return a pointer that uniquely identifies this aggregate within its BEF
+  // file, suitable as a memoization key for decoded forms of the aggregate.
+  const void* data() const {
+    return static_cast<const void*>(element_descriptors_.data());
+  }
+
  private:
   std::pair<const void*, BEFAttributeType> GetDescriptor(int index) const {
     assert(index < element_descriptors_.size());
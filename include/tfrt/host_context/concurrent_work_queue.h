@@ -84,6 +84,47 @@ class ConcurrentWorkQueue {
   // thread.
   virtual void AddTask(TaskFunction work) = 0;
 
+  // Enqueue a batch of work in one operation. Thread-safe.
+  //
+  // Implementations may insert the whole span with a single queue operation
+  // and wake up to tasks.size() workers with a single notification, which is
+  // significantly cheaper than tasks.size() AddTask calls for wide fan-outs.
+  // The tasks are consumed (moved from) regardless of whether they were
+  // queued or executed in the caller thread. The default implementation adds
+  // the tasks one by one.
+  virtual void AddTasks(MutableArrayRef<TaskFunction> work) {
+    for (TaskFunction& task : work) AddTask(std::move(task));
+  }
+
+  // Enqueue a latency-critical block of work. Thread-safe.
+  //
+  // Where the implementation supports it, critical work goes into a
+  // dedicated high-priority lane that workers check ahead of regular tasks,
+  // so interactive requests do not queue behind bulk work submitted through
+  // the same queue. The default implementation treats it as regular work.
+  virtual void AddCriticalTask(TaskFunction work) { AddTask(std::move(work)); }
+
+  // Enqueue a block of work with a locality hint. Thread-safe.
+  //
+  // Work submitted with the same affinity tag is steered to the same worker
+  // where the implementation supports it, so kernels touching the same hot
+  // data can prefer same-worker execution. This is only a hint: the default
+  // implementation ignores it, and work stealing may still migrate tasks.
+  virtual void AddTaskWithAffinity(TaskFunction work, uint32_t affinity_tag) {
+    AddTask(std::move(work));
+  }
+
+  // Enqueue a block of work with a NUMA domain hint. Thread-safe.
+  //
+  // Where the implementation partitions its workers into NUMA domains, work
+  // submitted with the same domain hint is steered to workers of the same
+  // domain, so tasks stay on the socket that owns the buffers they touch.
+  // This is only a hint: the default implementation ignores it, and work
+  // stealing may still migrate tasks across domains.
+  virtual void AddTaskInDomain(TaskFunction work, uint32_t domain_hint) {
+    AddTask(std::move(work));
+  }
+
   // Enqueue a blocking task. Thread-safe.
   //
   // If `allow_queuing` is false, implementation must guarantee that work will
@@ -106,6 +147,14 @@ class ConcurrentWorkQueue {
   // This should not be called by a thread managed by the work queue.
   virtual void Quiesce() = 0;
 
+  // Pin the worker spin-then-park policy to fixed values, for deployments
+  // with known-bursty traffic where adaptive tuning is not wanted.
+  // `max_spinning_threads` bounds the number of workers that spin in a steal
+  // loop instead of parking, and `spin_count` is the number of steal
+  // iterations each of them runs before parking. The default implementation
+  // ignores the request.
+  virtual void PinWorkerSpinPolicy(int max_spinning_threads, int spin_count) {}
+
   // Return the number of parallel tasks maintained by this work queue.
   // Kernels can use this as a hint indicating the maximum useful number of
   // work items they should break themselves into - e.g. zero means it is best
@@ -113,6 +162,14 @@ class ConcurrentWorkQueue {
   // TODO(clattner): this is a terrible name.
   virtual int GetParallelismLevel() const = 0;
 
+  // Returns the instantaneous number of worker threads that are idle and
+  // could pick up new parallel work. This is a weak signal -- workers can
+  // park or unpark at any moment -- so it is only suitable for sizing
+  // heuristics (e.g. choosing a shard count for a large computation), never
+  // for correctness decisions. The default conservatively reports full
+  // parallelism.
+  virtual int GetIdleParallelismLevel() const { return GetParallelismLevel(); }
+
   ConcurrentWorkQueue() = default;
 
  private:
@@ -140,9 +197,23 @@ std::unique_ptr<ConcurrentWorkQueue> CreateSingleThreadedWorkQueue();
 // num_blocking_threads: Number of pre-allocated threads used in blocking
 // work queue.
 //
+// num_steal_domains: Number of NUMA domains the non-blocking workers are
+// partitioned into. Workers steal within their own domain first, and tasks
+// submitted with a domain hint are steered to workers of that domain. The
+// default of 1 keeps flat random-victim stealing.
+//
 // Requires `num_threads` > 0 and `num_blocking_threads` > 0.
 std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
-    int num_threads, int num_blocking_threads);
+    int num_threads, int num_blocking_threads, int num_steal_domains = 1);
+
+// Create a multi-threaded work queue whose worker count is chosen by a short
+// startup calibration instead of a config string: a synthetic task mix
+// (compute, fan-out, blocking) is run across candidate worker counts and the
+// count maximizing throughput within a handoff-latency bound wins. When the
+// TFRT_WORK_QUEUE_CALIBRATION_FILE environment variable names a writable
+// file, results are persisted there per machine profile and reused on later
+// startups. Registered under the "auto" work queue name.
+std::unique_ptr<ConcurrentWorkQueue> CreateCalibratedWorkQueue();
 
 // A factory function for creating ConcurrentWorkQueue objects. The factory
 // function defines the semantics of the argument string.
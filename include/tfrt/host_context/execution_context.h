@@ -23,12 +23,149 @@
 #ifndef TFRT_HOST_CONTEXT_EXECUTION_CONTEXT_H_
 #define TFRT_HOST_CONTEXT_EXECUTION_CONTEXT_H_
 
+#include <atomic>
+#include <chrono>
+
+#include "llvm/ADT/Optional.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/ref_count.h"
 
 namespace tfrt {
 
+class AsyncValue;
 class HostContext;
 
+// Per-request cancellation state, shared by every ExecutionContext derived
+// from the same request. Unlike HostContext::CancelExecution, which cancels
+// every execution on the host, canceling this state only affects the BEF
+// executions that carry it, so one request can be abandoned on deadline
+// expiry without disturbing the others sharing the HostContext.
+class RequestCancellationState
+    : public ReferenceCounted<RequestCancellationState> {
+ public:
+  explicit RequestCancellationState(HostContext* host) : host_(host) {}
+  ~RequestCancellationState();
+
+  // Transition this request to the canceled state. The BEF executor checks
+  // the state before dispatching each ready kernel, so a canceled request
+  // stops consuming worker-thread time after at most the kernel currently
+  // running, instead of executing the rest of the graph.
+  void Cancel(string_view msg);
+
+  // Returns a non-null AsyncValue containing the cancellation message if
+  // this request has been canceled. Otherwise, returns nullptr.
+  AsyncValue* GetCancelAsyncValue() const {
+    return cancel_value_.load(std::memory_order_acquire);
+  }
+
+ private:
+  HostContext* host_;
+  std::atomic<AsyncValue*> cancel_value_{nullptr};
+};
+
+// Counts the work queue tasks spawned on behalf of one request, so the
+// request's teardown can wait for just those tasks to finish. This is much
+// cheaper than HostContext::Quiesce, which blocks until the entire queue
+// drains - something a multi-tenant process may never reach while other
+// requests keep submitting work.
+class RequestCompletionGroup
+    : public ReferenceCounted<RequestCompletionGroup> {
+ public:
+  RequestCompletionGroup() = default;
+
+  // Must be called before a task attributed to this request is submitted to
+  // the work queue.
+  void TaskAdded() { outstanding_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Must be called when an attributed task has finished running.
+  void TaskDone() {
+    if (outstanding_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      mutex_lock lock(mu_);
+      cv_.notify_all();
+    }
+  }
+
+  // Blocks until every task added to this group has finished, including tasks
+  // added while waiting. Must not be called from inside the work queue, where
+  // blocking a worker thread can deadlock the pool.
+  void AwaitCompletion() {
+    if (outstanding_.load(std::memory_order_acquire) == 0) return;
+    mutex_lock lock(mu_);
+    cv_.wait(lock, [this]() {
+      return outstanding_.load(std::memory_order_acquire) == 0;
+    });
+  }
+
+ private:
+  std::atomic<int64_t> outstanding_{0};
+  mutex mu_;
+  condition_variable cv_;
+};
+
+// Identity, deadline and accounting for one client request, shared by every
+// ExecutionContext derived from it. The executor and the op handlers update
+// the stats with relaxed atomic increments while the request runs; the
+// request owner reads them once the request completes, which separates time
+// spent waiting in the work queue from time spent computing.
+class RequestContext : public ReferenceCounted<RequestContext> {
+ public:
+  explicit RequestContext(int64_t id) : id_(id) {}
+
+  int64_t id() const { return id_; }
+
+  // The request's deadline in steady-clock time. Must be set before the
+  // context is shared with other threads; kernels and op handlers may consult
+  // it to shed doomed work. Enforcement is the owner's job, typically by
+  // pairing this context with a RequestCancellationState and canceling when
+  // the deadline expires.
+  void set_deadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+  llvm::Optional<std::chrono::steady_clock::time_point> deadline() const {
+    return deadline_;
+  }
+  bool PastDeadline() const {
+    return deadline_.hasValue() &&
+           std::chrono::steady_clock::now() > deadline_.getValue();
+  }
+
+  // Called by the BEF executor once per kernel dispatched for this request.
+  void RecordKernelRun() {
+    kernels_run_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Called when a task enqueued for this request starts running, with the
+  // time it spent sitting in the work queue.
+  void RecordQueueWait(int64_t ns) {
+    queue_wait_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  // Called by op handlers (and any kernel that wants to participate) with
+  // the size of tensors allocated on behalf of this request.
+  void RecordBytesAllocated(int64_t bytes) {
+    bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  int64_t kernels_run() const {
+    return kernels_run_.load(std::memory_order_relaxed);
+  }
+  int64_t queue_wait_ns() const {
+    return queue_wait_ns_.load(std::memory_order_relaxed);
+  }
+  int64_t bytes_allocated() const {
+    return bytes_allocated_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const int64_t id_;
+  llvm::Optional<std::chrono::steady_clock::time_point> deadline_;
+  std::atomic<int64_t> kernels_run_{0};
+  std::atomic<int64_t> queue_wait_ns_{0};
+  std::atomic<int64_t> bytes_allocated_{0};
+};
+
 // ExecutionContext holds the context information for kernel and op execution,
 // which currently includes the memory allocator, thread pool (memory allocator
 // and thread pool are part of HostContext), and the location information. In
@@ -44,14 +181,83 @@ class ExecutionContext {
  public:
   explicit ExecutionContext(HostContext* host) : host_{host} {}
 
+  // ExecutionContext is copied into kernel frames and async closures, so it
+  // stays explicitly copyable despite owning a reference to the cancellation
+  // state.
+  ExecutionContext(const ExecutionContext& other)
+      : location_(other.location_),
+        host_(other.host_),
+        is_critical_(other.is_critical_),
+        cancellation_state_(other.cancellation_state_.CopyRef()),
+        completion_group_(other.completion_group_.CopyRef()),
+        request_ctx_(other.request_ctx_.CopyRef()) {}
+  ExecutionContext& operator=(const ExecutionContext& other) {
+    location_ = other.location_;
+    host_ = other.host_;
+    is_critical_ = other.is_critical_;
+    cancellation_state_ = other.cancellation_state_.CopyRef();
+    completion_group_ = other.completion_group_.CopyRef();
+    request_ctx_ = other.request_ctx_.CopyRef();
+    return *this;
+  }
+  ExecutionContext(ExecutionContext&&) = default;
+  ExecutionContext& operator=(ExecutionContext&&) = default;
+
   Location location() const { return location_; }
   HostContext* host() const { return host_; }
 
   void set_location(Location location) { location_ = location; }
 
+  // Mark this request as latency-critical. The BEF executor routes work it
+  // enqueues for a critical request into the work queue's high-priority
+  // lane, so interactive requests do not queue behind bulk work.
+  void set_critical(bool is_critical) { is_critical_ = is_critical; }
+  bool is_critical() const { return is_critical_; }
+
+  // Attach per-request cancellation state. Requests that never need
+  // cancellation skip this and pay nothing for the check.
+  void set_cancellation_state(RCReference<RequestCancellationState> state) {
+    cancellation_state_ = std::move(state);
+  }
+  RequestCancellationState* cancellation_state() const {
+    return cancellation_state_.get();
+  }
+
+  // Attach a completion group. Tasks the BEF executor spawns under this
+  // context are counted into the group, so the request owner can await them
+  // with RequestCompletionGroup::AwaitCompletion instead of draining the
+  // whole queue. Requests that never need this skip it and pay nothing.
+  void set_completion_group(RCReference<RequestCompletionGroup> group) {
+    completion_group_ = std::move(group);
+  }
+  RequestCompletionGroup* completion_group() const {
+    return completion_group_.get();
+  }
+
+  // Attach a request context carrying the request's id, deadline and stats
+  // block. As with the other request state, executions that never set one pay
+  // only a null test.
+  void set_request_ctx(RCReference<RequestContext> request_ctx) {
+    request_ctx_ = std::move(request_ctx);
+  }
+  RequestContext* request_ctx() const { return request_ctx_.get(); }
+
+  // Returns a non-null AsyncValue containing the cancellation message if the
+  // request this execution belongs to has been canceled. Otherwise, returns
+  // nullptr. Host-wide cancellation is separate; see
+  // HostContext::GetCancelAsyncValue.
+  AsyncValue* GetCancelAsyncValue() const {
+    return cancellation_state_ ? cancellation_state_->GetCancelAsyncValue()
+                               : nullptr;
+  }
+
  private:
   Location location_;
   HostContext* host_ = nullptr;
+  bool is_critical_ = false;
+  RCReference<RequestCancellationState> cancellation_state_;
+  RCReference<RequestCompletionGroup> completion_group_;
+  RCReference<RequestContext> request_ctx_;
 };
 
 }  // namespace tfrt
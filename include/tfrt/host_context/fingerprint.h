@@ -0,0 +1,55 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- fingerprint.h --------------------------------------------*- C++ -*-===//
+//
+// This file declares utilities for fingerprinting large buffers (tensor
+// contents, serialized attributes), optionally in parallel chunks over the
+// work queue.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_FINGERPRINT_H_
+#define TFRT_HOST_CONTEXT_FINGERPRINT_H_
+
+#include <cstdint>
+
+#include "tfrt/host_context/async_value_ref.h"
+
+namespace tfrt {
+
+class HostContext;
+
+// Chunk size used to define the fingerprint. Fixed so the value does not
+// depend on how many workers computed it.
+constexpr size_t kFingerprintChunkSize = 4 * 1024 * 1024;
+
+// Returns a stable 64-bit fingerprint of `size` bytes at `data`, defined as
+// the in-order combination of Hash64Bulk over kFingerprintChunkSize chunks.
+// Computed on the calling thread.
+uint64_t FingerprintBuffer(const char* data, size_t size);
+
+// Computes FingerprintBuffer with one work queue task per chunk, so a large
+// tensor is hashed at aggregate memory bandwidth. The combination is ordered
+// by chunk index, so the result equals FingerprintBuffer regardless of task
+// scheduling. The caller must keep the buffer alive until the returned value
+// becomes available.
+AsyncValueRef<uint64_t> FingerprintBufferAsync(const char* data, size_t size,
+                                               HostContext* host);
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_FINGERPRINT_H_
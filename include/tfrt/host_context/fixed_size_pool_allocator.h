@@ -0,0 +1,209 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- fixed_size_pool_allocator.h - Fixed-size object pool -----*- C++ -*-===//
+//
+// This file declares FixedSizePoolAllocator and the
+// HostAllocator::CreateFixedSizeAllocator<T> factory.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_FIXED_SIZE_POOL_ALLOCATOR_H_
+#define TFRT_HOST_CONTEXT_FIXED_SIZE_POOL_ALLOCATOR_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/alloc.h"
+
+namespace tfrt {
+
+// A lock-free pool allocator for objects of one fixed size, sized for T.
+// Allocations that fit a block of sizeof(T) are served from the calling
+// thread's cache of free blocks with no synchronization; the cache refills
+// from a central lock-free store in batches, and the central store carves
+// fresh slabs when it runs empty. Anything that does not fit forwards to the
+// fallback allocator. This suits small objects allocated and freed at high
+// rate with a stable size, e.g. AsyncValue payloads or TensorMetadata.
+//
+// The central store and the per-thread caches are shared by every pool
+// instance of the same T, and pooled slab memory is retained for the process
+// lifetime, like in a thread-caching malloc; it is never returned to the
+// system.
+//
+// The central store is a Treiber stack of free blocks. Refill takes the whole
+// stack with an atomic exchange and pushes the surplus back, so the pop side
+// never dereferences a head it has not claimed and the classic ABA problem
+// cannot arise.
+template <typename T>
+class FixedSizePoolAllocator : public HostAllocator {
+ public:
+  explicit FixedSizePoolAllocator(std::unique_ptr<HostAllocator> fallback)
+      : fallback_(std::move(fallback)) {}
+
+  void* AllocateBytes(size_t size, size_t alignment) override {
+    if (LLVM_UNLIKELY(size == 0 || size > kBlockSize ||
+                      alignment > kBlockAlignment))
+      return fallback_->AllocateBytes(size, alignment);
+
+    ThreadCache& cache = GetThreadCache();
+    if (LLVM_UNLIKELY(cache.head == nullptr)) Refill(&cache);
+    if (LLVM_UNLIKELY(cache.head == nullptr))
+      return fallback_->AllocateBytes(kBlockSize, kBlockAlignment);
+
+    FreeBlock* block = cache.head;
+    cache.head = block->next;
+    --cache.count;
+    return block;
+  }
+
+  void DeallocateBytes(void* ptr, size_t size) override {
+    if (LLVM_UNLIKELY(size == 0 || size > kBlockSize)) {
+      fallback_->DeallocateBytes(ptr, size);
+      return;
+    }
+
+    ThreadCache& cache = GetThreadCache();
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = cache.head;
+    cache.head = block;
+    ++cache.count;
+
+    // Past the watermark, hand a batch back to the central store so
+    // cross-thread producer/consumer patterns do not strand blocks in the
+    // consumer's cache.
+    if (LLVM_UNLIKELY(cache.count > 2 * kTransferBatchSize)) {
+      FreeBlock* head = cache.head;
+      FreeBlock* tail = head;
+      for (int i = 1; i < kTransferBatchSize; ++i) tail = tail->next;
+      cache.head = tail->next;
+      cache.count -= kTransferBatchSize;
+      PushCentral(head, tail);
+    }
+  }
+
+ private:
+  // Every block can hold a T or a free list link, at T's alignment. Blocks
+  // are laid out back to back in slabs, so the size is rounded up to a
+  // multiple of the alignment.
+  static constexpr size_t kBlockAlignment =
+      alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+  static constexpr size_t kBlockSize = llvm::alignTo<kBlockAlignment>(
+      sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*));
+
+  // Number of blocks moved between a thread cache and the central store at a
+  // time, amortizing the central CAS traffic over many allocations.
+  static constexpr int kTransferBatchSize = 32;
+
+  // Slabs hold a few refill batches worth of blocks.
+  static constexpr size_t kBlocksPerSlab = 4 * kTransferBatchSize;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct ThreadCache {
+    FreeBlock* head = nullptr;
+    int count = 0;
+
+    // Return everything to the central store when the thread exits, so
+    // memory cached by short-lived threads is not stranded.
+    ~ThreadCache() {
+      if (head == nullptr) return;
+      FreeBlock* tail = head;
+      while (tail->next != nullptr) tail = tail->next;
+      PushCentral(head, tail);
+      head = nullptr;
+      count = 0;
+    }
+  };
+
+  static std::atomic<FreeBlock*>& CentralHead() {
+    static std::atomic<FreeBlock*> head{nullptr};
+    return head;
+  }
+
+  static ThreadCache& GetThreadCache() {
+    static thread_local ThreadCache cache;
+    return cache;
+  }
+
+  // Pushes a chain of blocks (linked through FreeBlock::next, ending at
+  // `tail`) onto the central stack. Pushing is ABA-free: the CAS only
+  // publishes a new head, it never dereferences the old one.
+  static void PushCentral(FreeBlock* head, FreeBlock* tail) {
+    std::atomic<FreeBlock*>& central = CentralHead();
+    FreeBlock* old_head = central.load(std::memory_order_relaxed);
+    do {
+      tail->next = old_head;
+    } while (!central.compare_exchange_weak(old_head, head,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+  }
+
+  // Refills `cache` with up to kTransferBatchSize blocks: takes the whole
+  // central stack, keeps one batch and pushes the surplus back, carving a
+  // fresh slab if the stack was empty. Leaves the cache empty only if slab
+  // allocation failed.
+  static void Refill(ThreadCache* cache) {
+    std::atomic<FreeBlock*>& central = CentralHead();
+    FreeBlock* head = central.exchange(nullptr, std::memory_order_acquire);
+
+    if (head == nullptr) {
+      void* slab = AlignedAlloc(kBlockAlignment, kBlockSize * kBlocksPerSlab);
+      if (slab == nullptr) return;
+      char* base = static_cast<char*>(slab);
+      for (size_t i = 0; i < kBlocksPerSlab; ++i) {
+        auto* block = reinterpret_cast<FreeBlock*>(base + i * kBlockSize);
+        block->next = head;
+        head = block;
+      }
+    }
+
+    FreeBlock* tail = head;
+    int taken = 1;
+    while (taken < kTransferBatchSize && tail->next != nullptr) {
+      tail = tail->next;
+      ++taken;
+    }
+    if (tail->next != nullptr) {
+      FreeBlock* surplus = tail->next;
+      FreeBlock* surplus_tail = surplus;
+      while (surplus_tail->next != nullptr) surplus_tail = surplus_tail->next;
+      PushCentral(surplus, surplus_tail);
+    }
+    tail->next = nullptr;
+    cache->head = head;
+    cache->count = taken;
+  }
+
+  std::unique_ptr<HostAllocator> fallback_;
+};
+
+template <typename T>
+std::unique_ptr<HostAllocator> HostAllocator::CreateFixedSizeAllocator(
+    std::unique_ptr<HostAllocator> fallback) {
+  return std::make_unique<FixedSizePoolAllocator<T>>(std::move(fallback));
+}
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_FIXED_SIZE_POOL_ALLOCATOR_H_
@@ -26,6 +26,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/type_name.h"
 #include "tfrt/support/forward_decls.h"
 
@@ -50,11 +51,23 @@ class Function {
     return ArrayRef<TypeName>(argument_result_types_).drop_front(num_argument_);
   }
 
-  // Execute this function on the specified HostContext, passing the specified
-  // arguments. This returns one AsyncValue for each result.
-  virtual void Execute(ArrayRef<AsyncValue*> arguments,
-                       MutableArrayRef<RCReference<AsyncValue>> results,
-                       HostContext* host) const = 0;
+  // Execute this function, passing the specified arguments. This returns one
+  // AsyncValue for each result. `exec_ctx` carries the per-request state -
+  // most importantly the cancellation state, which implementations check so
+  // a canceled request stops early instead of running to completion.
+  virtual void Execute(const ExecutionContext& exec_ctx,
+                       ArrayRef<AsyncValue*> arguments,
+                       MutableArrayRef<RCReference<AsyncValue>> results)
+      const = 0;
+
+  // Convenience overload for callers that have no per-request context. The
+  // resulting execution can only be canceled host-wide with
+  // HostContext::CancelExecution.
+  void Execute(ArrayRef<AsyncValue*> arguments,
+               MutableArrayRef<RCReference<AsyncValue>> results,
+               HostContext* host) const {
+    Execute(ExecutionContext{host}, arguments, results);
+  }
 
   // Reference counting operations, used by async kernels to keep the underlying
   // storage for a function alive.
@@ -23,6 +23,7 @@
 #ifndef TFRT_HOST_CONTEXT_HOST_ALLOCATOR_H_
 #define TFRT_HOST_CONTEXT_HOST_ALLOCATOR_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "llvm/ADT/ArrayRef.h"
@@ -63,6 +64,26 @@ class HostAllocator {
   // Deallocate the specified pointer that has the specified size.
   virtual void DeallocateBytes(void* ptr, size_t size) = 0;
 
+  // Return the total number of allocations made through this allocator since
+  // its creation, or -1 if this allocator does not count them. The profiled
+  // allocator (CreateProfiledAllocator) counts them; benchmark drivers use
+  // the difference across a run to report allocations per run.
+  virtual int64_t GetCumulativeAllocationCount() const { return -1; }
+
+  // Return the total number of bytes allocated through this allocator since
+  // its creation, or -1 if this allocator does not count them. The profiled
+  // allocator counts them; the benchmark kernels use the difference across a
+  // run to report bytes allocated per iteration.
+  virtual int64_t GetCumulativeAllocatedBytes() const { return -1; }
+
+  // Create a lock-free pool allocator for objects of T's size, with
+  // per-thread caches and batched refill from a central store. Allocations
+  // that do not fit a T-sized block forward to `fallback`. Defined in
+  // fixed_size_pool_allocator.h, which callers must include.
+  template <typename T>
+  static std::unique_ptr<HostAllocator> CreateFixedSizeAllocator(
+      std::unique_ptr<HostAllocator> fallback);
+
  protected:
   friend class HostContext;
   friend class FixedSizeAllocator;
@@ -75,9 +96,39 @@ class HostAllocator {
   virtual void VtableAnchor();
 };
 
+// Attributes allocations made on the current thread to a subsystem while in
+// scope, e.g. `AllocationTagScope scope("AsyncValue");`. The profiled
+// allocator reads the innermost tag to break allocation statistics down by
+// subsystem; other allocators ignore it. `tag` must be a string literal (the
+// profiler keys on pointer identity). Scopes nest; the enclosing tag is
+// restored on destruction.
+class AllocationTagScope {
+ public:
+  explicit AllocationTagScope(const char* tag);
+  ~AllocationTagScope();
+
+  AllocationTagScope(const AllocationTagScope&) = delete;
+  AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+
+ private:
+  const char* prev_tag_;
+};
+
+// Returns the innermost allocation tag on the current thread, or "untagged"
+// if no AllocationTagScope is live.
+const char* CurrentAllocationTag();
+
 // Create an allocator that just calls malloc/free.
 std::unique_ptr<HostAllocator> CreateMallocAllocator();
 
+// Decorate an allocator with per-thread caches over central size-class free
+// lists. Small allocations (up to 4KB) are served from the calling thread's
+// cache with no synchronization in the common case; larger or specially
+// aligned allocations forward to the underlying allocator. Pooled slab memory
+// is retained for the process lifetime.
+std::unique_ptr<HostAllocator> CreateThreadCachingAllocator(
+    std::unique_ptr<HostAllocator> allocator);
+
 // Create an allocator of fixed size for testing.
 std::unique_ptr<HostAllocator> CreateFixedSizeAllocator(size_t capacity = 1024);
 
@@ -85,6 +136,15 @@ std::unique_ptr<HostAllocator> CreateFixedSizeAllocator(size_t capacity = 1024);
 std::unique_ptr<HostAllocator> CreateProfiledAllocator(
     std::unique_ptr<HostAllocator> allocator);
 
+// Decorate an allocator with live-byte accounting, high-watermark tracking
+// (exported as the /tfrt/host_allocator/watermark_bytes metric) and a hard
+// byte budget. Allocations that would push the live total past the budget
+// fail by returning nullptr, which the runtime's allocation paths surface as
+// error AsyncValues. Wrapping each HostContext's allocator with one of these
+// keeps one tenant's tensor bloat from taking down a multi-tenant process.
+std::unique_ptr<HostAllocator> CreateBudgetedAllocator(
+    std::unique_ptr<HostAllocator> allocator, size_t budget_bytes);
+
 // Decorate an allocator with memory leak check.
 std::unique_ptr<HostAllocator> CreateLeakCheckAllocator(
     std::unique_ptr<HostAllocator> allocator);
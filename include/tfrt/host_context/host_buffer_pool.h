@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- host_buffer_pool.h - Pool of recycled buffer memory ------*- C++ -*-===//
+//
+// This file declares HostBufferPool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_HOST_BUFFER_POOL_H_
+#define TFRT_HOST_CONTEXT_HOST_BUFFER_POOL_H_
+
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+// A size-bucketed pool of recycled buffer memory, for workloads that allocate
+// and free buffers of the same few sizes over and over (e.g. fixed-shape
+// activation tensors in an inference loop). Recycling a warm buffer skips
+// both the underlying allocator and the page faults of touching fresh pages.
+//
+// The pool is itself a HostAllocator: pass it as the allocator to
+// HostBuffer::CreateUninitialized (or any other allocation site) and freed
+// memory transparently returns to the pool. Allocations between 4KB and 64MB
+// are rounded up to a power-of-two bucket; freed buffers are retained up to a
+// per-bucket high watermark and released to the underlying allocator beyond
+// it. Sizes and alignments outside the pooled range forward directly to the
+// underlying allocator.
+//
+// All methods are thread-safe.
+class HostBufferPool : public HostAllocator {
+ public:
+  // `allocator` is not owned and must outlive the pool. Typically this is
+  // the HostContext's allocator, and the pool is owned by the HostContext.
+  explicit HostBufferPool(HostAllocator* allocator) : allocator_(allocator) {}
+
+  // Releases all retained buffers to the underlying allocator.
+  ~HostBufferPool() override;
+
+  void* AllocateBytes(size_t size, size_t alignment) override;
+  void DeallocateBytes(void* ptr, size_t size) override;
+
+ private:
+  // Pooled sizes are power-of-two buckets in [kMinPooledSize, kMaxPooledSize].
+  static constexpr size_t kMinPooledSize = 4 * 1024;
+  static constexpr size_t kMaxPooledSize = 64 * 1024 * 1024;
+  static constexpr int kNumBuckets = 15;  // log2 range [12, 26].
+
+  // High watermark: number of freed buffers retained per bucket. Frees past
+  // the watermark go back to the underlying allocator, bounding how much
+  // memory an allocation burst leaves stranded in the pool.
+  static constexpr size_t kMaxBuffersPerBucket = 8;
+
+  // Returns the bucket index for `size`, which must be in the pooled range.
+  static int BucketIndex(size_t size);
+  // Returns the allocation size of the bucket at `index`.
+  static size_t BucketSize(int index) { return kMinPooledSize << index; }
+
+  HostAllocator* const allocator_;
+
+  mutex mu_;
+  llvm::SmallVector<void*, 8> buckets_[kNumBuckets] TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_HOST_BUFFER_POOL_H_
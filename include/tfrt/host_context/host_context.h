@@ -28,6 +28,8 @@
 #include "llvm/Support/Compiler.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
@@ -36,6 +38,7 @@ class DecodedDiagnostic;
 class Chain;
 class ConcurrentWorkQueue;
 class HostAllocator;
+class HostBufferPool;
 class TypeDescriptor;
 class IndirectAsyncValue;
 class SharedContext;
@@ -119,12 +122,31 @@ class HostContext {
 
   HostAllocator* allocator() { return allocator_.get(); }
 
+  // An allocator that recycles freed buffer memory through size-bucketed free
+  // lists under a high-watermark policy. Pass it as the allocator to
+  // HostBuffer::CreateUninitialized for buffers whose sizes recur, e.g.
+  // fixed-shape tensors allocated once per request, to skip the underlying
+  // allocator and reuse warm pages. Falls through to allocator() for sizes
+  // outside the pooled range.
+  HostAllocator* host_buffer_pool();
+
   // Allocate the specified number of bytes with the specified alignment.
   void* AllocateBytes(size_t size, size_t alignment);
 
   // Deallocate the specified pointer that had the specified size.
   void DeallocateBytes(void* ptr, size_t size);
 
+  // Allocate storage for an AsyncValue object. Small AsyncValues - e.g. a
+  // ConcreteAsyncValue<int32_t> produced and consumed by synchronous kernels
+  // - are served from a free list of recycled fixed-size blocks, turning the
+  // allocate/deallocate cycle on the result path of scalar-heavy graphs into
+  // a couple of pointer updates instead of a general-purpose allocator round
+  // trip. Larger AsyncValues fall through to AllocateBytes.
+  void* AllocateAsyncValueBytes(size_t size, size_t alignment);
+
+  // Return AsyncValue storage allocated by AllocateAsyncValueBytes.
+  void DeallocateAsyncValueBytes(void* ptr, size_t size);
+
   // Allocate memory for one or more entries of type T.
   template <typename T>
   T* Allocate(size_t num_elements = 1) {
@@ -192,6 +214,22 @@ class HostContext {
   // Add some non-blocking work to the work_queue managed by this CPU device.
   void EnqueueWork(llvm::unique_function<void()> work);
 
+  // Add some non-blocking work to the work_queue managed by this CPU device,
+  // steering work with the same affinity tag to the same worker where the
+  // queue implementation supports it.
+  void EnqueueWorkWithAffinity(llvm::unique_function<void()> work,
+                               uint32_t affinity_tag);
+
+  // Add some latency-critical non-blocking work to the work_queue managed by
+  // this CPU device. Where the queue supports it, the work runs ahead of
+  // regular tasks instead of queueing behind them.
+  void EnqueueCriticalWork(llvm::unique_function<void()> work);
+
+  // Pin the work queue's worker spin-then-park policy to fixed values, for
+  // deployments with known-bursty traffic where the queue's adaptive tuning
+  // is not wanted. Ignored by queue implementations without a spin policy.
+  void PinWorkerSpinPolicy(int max_spinning_threads, int spin_count);
+
   // Add some non-blocking work to the work_queue managed by this CPU device.
   // Return AsyncValueRef<R> for work that returns R. R cannot be void.
   //
@@ -215,10 +253,34 @@ class HostContext {
   // created to handle blocking work (enqueued by EnqueueBlockingWork).
   int GetNumWorkerThreads() const;
 
+  // Returns the instantaneous number of idle worker threads in the work
+  // queue. Only a sizing heuristic; see
+  // ConcurrentWorkQueue::GetIdleParallelismLevel.
+  int GetNumIdleWorkerThreads() const;
+
   // Run the specified function when the specified set of AsyncValue's are all
-  // resolved.  This is a set-version of "AndThen".
+  // resolved.  This is a set-version of "AndThen". Joining N values costs one
+  // shared counter allocation and one atomic decrement per value, so this is
+  // the preferred way to await wide fan-ins.
   void RunWhenReady(ArrayRef<AsyncValue*> values,
                     llvm::unique_function<void()>&& callee);
+  void RunWhenReady(ArrayRef<RCReference<AsyncValue>> values,
+                    llvm::unique_function<void()>&& callee);
+
+  // Run `waiter` with `value` once it resolves. The value passed to `waiter`
+  // may hold an error, which the waiter is responsible for propagating. If
+  // the value is already available, `waiter` runs inline with no allocation. Otherwise the
+  // continuation is re-enqueued onto the work queue when the value becomes
+  // available, so long chains of stages resume on worker threads instead of
+  // running on the producer's stack. This lets a multi-stage async kernel be
+  // written as a straight-line sequence of stages:
+  //
+  //   host->Await(Stage1(host, arg), [host, out](AsyncValueRef<T> v) {
+  //     host->Await(Stage2(host, v.get()),
+  //                 [out](AsyncValueRef<T> v) { out.emplace(v.get()); });
+  //   });
+  template <typename T, typename WaiterT>
+  void Await(AsyncValueRef<T> value, WaiterT&& waiter);
 
   // Calls `compute` in parallel for non-overlapping subranges [start, end) in
   // the [0, n) range. When all subtasks completed, calls `on_done` callback.
@@ -227,6 +289,29 @@ class HostContext {
                    llvm::unique_function<void()> on_done,
                    size_t min_block_size = 1);
 
+  // Cost hints for automatic ParallelFor grain sizing. bytes_per_element is
+  // the number of bytes `compute` reads and writes per index;
+  // cycles_per_element is a rough estimate of its arithmetic cost per index.
+  struct ParallelForCost {
+    size_t bytes_per_element = 0;
+    size_t cycles_per_element = 1;
+  };
+
+  // Returns a block size for ParallelFor over [0, n) such that each block
+  // does enough work to amortize a work queue operation against the
+  // estimated per-element cost, block boundaries fall on cache lines of the
+  // data when bytes_per_element is known (so adjacent blocks never write the
+  // same line), and the range still splits into enough blocks to keep the
+  // worker threads busy.
+  size_t ChooseParallelForBlockSize(size_t n,
+                                    const ParallelForCost& cost) const;
+
+  // Calls `compute` in parallel as above, with the block size chosen by
+  // ChooseParallelForBlockSize from the cost hints.
+  void ParallelFor(size_t n, const ParallelForCost& cost,
+                   llvm::unique_function<void(size_t, size_t)> compute,
+                   llvm::unique_function<void()> on_done);
+
   //===--------------------------------------------------------------------===//
   // Shared context
   //===--------------------------------------------------------------------===//
@@ -248,6 +333,9 @@ class HostContext {
 
   class SharedContextManager;
 
+  // We allow up to 256 SharedContext instances.
+  static constexpr int kNumSharedContextSlots = 256;
+
   // Dense ID for different shared context types.
   template <typename SharedContextType>
   static int DenseIdForSharedContext();
@@ -269,6 +357,46 @@ class HostContext {
   SharedContext& GetOrCreateSharedContext(int shared_context_id,
                                           SharedContextFactory factory);
 
+  // Allocate and construct an AsyncValue subclass, recycling small blocks
+  // through the AsyncValue free list.
+  template <typename T, typename... Args>
+  T* ConstructAsyncValue(Args&&... args) {
+    void* buf = AllocateAsyncValueBytes(sizeof(T), alignof(T));
+    return new (buf) T(std::forward<Args>(args)...);
+  }
+
+  // Slab allocator for AsyncValue objects. ConcreteAsyncValue sizes cluster
+  // into a few buckets, so allocations up to kMaxSlabAsyncValueSize bytes are
+  // rounded up to a size class and carved out of slabs by pointer bump, with a
+  // segregated free list per class for recycling. Blocks are aligned to their
+  // class size, so any AsyncValue whose size fits in a class also has its
+  // alignment satisfied. The slab caches are sharded by calling thread to
+  // keep different threads off the same list head and mutex.
+  static constexpr size_t kNumAsyncValueSizeClasses = 3;
+  static constexpr size_t kMaxSlabAsyncValueSize = 256;
+  static constexpr size_t kAsyncValueSlabSize = 4096;
+  static constexpr size_t kNumAsyncValueShards = 8;
+  struct AsyncValueFreeBlock {
+    AsyncValueFreeBlock* next;
+  };
+  struct AsyncValueSlab {
+    AsyncValueSlab* next;
+  };
+  struct alignas(64) AsyncValueCacheShard {
+    mutex mu;
+    // Recycled blocks, segregated by size class.
+    AsyncValueFreeBlock* free_lists[kNumAsyncValueSizeClasses] TFRT_GUARDED_BY(
+        mu) = {nullptr, nullptr, nullptr};
+    // Bump range of the slab currently being carved for each size class.
+    char* slab_next[kNumAsyncValueSizeClasses] TFRT_GUARDED_BY(mu) = {
+        nullptr, nullptr, nullptr};
+    char* slab_end[kNumAsyncValueSizeClasses] TFRT_GUARDED_BY(mu) = {
+        nullptr, nullptr, nullptr};
+    // All slabs ever carved by this shard, for deallocation at destruction.
+    AsyncValueSlab* slabs TFRT_GUARDED_BY(mu) = nullptr;
+  };
+  AsyncValueCacheShard async_value_cache_shards_[kNumAsyncValueShards];
+
   std::atomic<AsyncValue*> cancel_value_{nullptr};
   // Store a ready chain in HostContext to avoid repeated creations of ready
   // chains on the heap.
@@ -276,38 +404,58 @@ class HostContext {
   KernelRegistry registry_;
   std::function<void(const DecodedDiagnostic&)> diag_handler_;
   std::unique_ptr<HostAllocator> allocator_;
+  // Declared after allocator_ so the pool releases its retained buffers
+  // before the allocator is destroyed.
+  std::unique_ptr<HostBufferPool> host_buffer_pool_;
   std::unique_ptr<ConcurrentWorkQueue> work_queue_;
 
+  // Created shared context instances are published here with a release
+  // store, so the fast path of GetOrCreateSharedContext is a single array
+  // load (a plain load on x86) with no lock or call_once check. The
+  // instances themselves are owned by shared_context_mgr_, which fills a
+  // slot at most once under its lock.
+  std::atomic<SharedContext*> shared_context_slots_[kNumSharedContextSlots] =
+      {};
   std::unique_ptr<SharedContextManager> shared_context_mgr_;
   const HostContextPtr instance_ptr_;
 };
 
 template <typename T, typename... Args>
 AsyncValueRef<T> HostContext::MakeConstructedAsyncValueRef(Args&&... args) {
-  return AsyncValueRef<T>(TakeRef(Construct<internal::ConcreteAsyncValue<T>>(
-      instance_ptr_,
-      typename internal::ConcreteAsyncValue<T>::ConstructedPayload{},
-      std::forward<Args>(args)...)));
+  return AsyncValueRef<T>(
+      TakeRef(ConstructAsyncValue<internal::ConcreteAsyncValue<T>>(
+          instance_ptr_,
+          typename internal::ConcreteAsyncValue<T>::ConstructedPayload{},
+          std::forward<Args>(args)...)));
 }
 
 template <typename T, typename... Args>
 AsyncValueRef<T> HostContext::MakeConcreteAsyncValueRef(Args&&... args) {
-  return AsyncValueRef<T>(TakeRef(Construct<internal::ConcreteAsyncValue<T>>(
-      instance_ptr_,
-      typename internal::ConcreteAsyncValue<T>::ConcretePayload{},
-      std::forward<Args>(args)...)));
+  return AsyncValueRef<T>(
+      TakeRef(ConstructAsyncValue<internal::ConcreteAsyncValue<T>>(
+          instance_ptr_,
+          typename internal::ConcreteAsyncValue<T>::ConcretePayload{},
+          std::forward<Args>(args)...)));
 }
 
 template <typename T>
 AsyncValueRef<T> HostContext::MakeUnconstructedAsyncValueRef() {
-  return AsyncValueRef<T>(TakeRef(Construct<internal::ConcreteAsyncValue<T>>(
-      instance_ptr_,
-      typename internal::ConcreteAsyncValue<T>::UnconstructedPayload{})));
+  return AsyncValueRef<T>(
+      TakeRef(ConstructAsyncValue<internal::ConcreteAsyncValue<T>>(
+          instance_ptr_,
+          typename internal::ConcreteAsyncValue<T>::UnconstructedPayload{})));
 }
 
 template <typename SharedContextType>
 SharedContextType& HostContext::GetOrCreateSharedContext() {
   int shared_context_id = DenseIdForSharedContext<SharedContextType>();
+
+  // Fast path: the slot was already initialized. The acquire load pairs with
+  // the release store that published the instance.
+  if (SharedContext* context = shared_context_slots_[shared_context_id].load(
+          std::memory_order_acquire))
+    return static_cast<SharedContextType&>(*context);
+
   auto factory = [](HostContext* host) -> std::unique_ptr<SharedContext> {
     return std::make_unique<SharedContextType>(host);
   };
@@ -321,6 +469,24 @@ int HostContext::DenseIdForSharedContext() {
   return id;
 }
 
+template <typename T, typename WaiterT>
+void HostContext::Await(AsyncValueRef<T> value, WaiterT&& waiter) {
+  if (value.IsAvailable()) {
+    std::forward<WaiterT>(waiter)(std::move(value));
+    return;
+  }
+  // Copy the pointer here because the evaluation order of
+  // value.AndThen(std::move(value)) is not defined prior to C++17.
+  AsyncValue* async_value = value.GetAsyncValue();
+  async_value->AndThen([this, value = std::move(value),
+                        waiter = std::forward<WaiterT>(waiter)]() mutable {
+    this->EnqueueWork(
+        [value = std::move(value), waiter = std::move(waiter)]() mutable {
+          waiter(std::move(value));
+        });
+  });
+}
+
 template <typename F, typename R, std::enable_if_t<!std::is_void<R>(), int>>
 AsyncValueRef<R> HostContext::EnqueueWork(F&& work) {
   auto result = this->MakeUnconstructedAsyncValueRef<R>();
@@ -53,6 +53,8 @@ namespace tfrt {
 class KernelFrame {
  public:
   explicit KernelFrame(HostContext* host) : exec_ctx_{host} {}
+  explicit KernelFrame(ExecutionContext exec_ctx)
+      : exec_ctx_{std::move(exec_ctx)} {}
 
   const ExecutionContext& GetExecutionContext() const { return exec_ctx_; }
   HostContext* GetHostContext() const { return exec_ctx_.host(); }
@@ -264,6 +266,8 @@ class KernelFrame {
 class KernelFrameBuilder : public KernelFrame {
  public:
   explicit KernelFrameBuilder(HostContext* host) : KernelFrame{host} {}
+  explicit KernelFrameBuilder(ExecutionContext exec_ctx)
+      : KernelFrame{std::move(exec_ctx)} {}
 
   // Get result AsyncValue at the given index.
   AsyncValue* GetResultAt(int index) const { return GetResults()[index]; }
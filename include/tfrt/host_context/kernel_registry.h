@@ -23,9 +23,11 @@
 #ifndef TFRT_HOST_CONTEXT_KERNEL_REGISTRY_H_
 #define TFRT_HOST_CONTEXT_KERNEL_REGISTRY_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "llvm/ADT/StringRef.h"
+#include "tfrt/support/cpu_features.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -38,6 +40,17 @@ class HostContext;
 // performing some computation and updating results.
 using KernelImplementation = void (*)(KernelFrame* frame);
 
+// Coarse estimate of a kernel's execution cost, attached at registration
+// time. The BEF executor uses it when deciding whether dispatching ready
+// kernels to the work queue is worthwhile: kTiny kernels (e.g. integer
+// arithmetic, whose execution costs less than a queue operation) do not count
+// towards offload thresholds, so runs of them coalesce into one task instead
+// of paying enqueue/steal overhead per kernel.
+enum class KernelCostClass : uint8_t {
+  kNormal,
+  kTiny,
+};
+
 namespace internal {
 
 template <typename TraitT>
@@ -53,14 +66,64 @@ class KernelRegistry {
   KernelRegistry(const KernelRegistry&) = delete;
   KernelRegistry& operator=(const KernelRegistry&) = delete;
 
-  void AddKernel(string_view name, KernelImplementation fn);
+  void AddKernel(string_view name, KernelImplementation fn,
+                 KernelCostClass cost_class = KernelCostClass::kNormal);
+  template <typename KernelTraitT>
+  void AddKernel(string_view name,
+                 KernelCostClass cost_class = KernelCostClass::kNormal) {
+    AddKernel(name, internal::AsBEFKernel<KernelTraitT>(), cost_class);
+  }
+
+  // Registers an ISA-specialized variant of an already-registered kernel.
+  // Variants requiring features the host CPU lacks are ignored; among the
+  // usable ones, the variant requiring the most features wins, independent of
+  // registration order. The winning variant is bound here, once, so kernel
+  // resolution at BEFFile::Open time sees it through the normal GetKernel /
+  // ordinal paths with no extra cost. Variants do not change the kernel's
+  // ordinal, cost class or the registry fingerprint.
+  void AddKernelVariant(string_view name, KernelImplementation fn,
+                        CpuFeatures required_features);
   template <typename KernelTraitT>
-  void AddKernel(string_view name) {
-    AddKernel(name, internal::AsBEFKernel<KernelTraitT>());
+  void AddKernelVariant(string_view name, CpuFeatures required_features) {
+    AddKernelVariant(name, internal::AsBEFKernel<KernelTraitT>(),
+                     required_features);
   }
 
   KernelImplementation GetKernel(string_view name) const;
 
+  // Returns the cost class recorded for the kernel, or kNormal if the kernel
+  // is unknown.
+  KernelCostClass GetKernelCostClass(string_view name) const;
+
+  // Kernels are also addressable by ordinal: a dense index assigned in
+  // registration order. Resolution caches persisted across process starts
+  // record ordinals instead of names, so reloads cost an index lookup per
+  // kernel instead of a string hash. Ordinals are only meaningful together
+  // with the registry fingerprint below.
+  static constexpr size_t kInvalidKernelOrdinal = ~size_t(0);
+
+  // Returns the ordinal of the kernel, or kInvalidKernelOrdinal if the
+  // kernel is unknown.
+  size_t GetKernelOrdinal(string_view name) const;
+
+  // Return the implementation / cost class of the kernel with the given
+  // ordinal, which must be less than GetNumKernels().
+  KernelImplementation GetKernelByOrdinal(size_t ordinal) const;
+  KernelCostClass GetKernelCostClassByOrdinal(size_t ordinal) const;
+
+  size_t GetNumKernels() const;
+
+  // A fingerprint over the names and registration order of all registered
+  // kernels. Any change to the kernel set invalidates previously persisted
+  // ordinals, so caches must be keyed by this value.
+  uint64_t GetFingerprint() const;
+
+  // Returns the StringInterner::Global() id of the name of the kernel with
+  // the given ordinal. Kernel names are interned at registration, so caches
+  // keyed across subsystems (op dispatch, BEF binding) can compare 32-bit
+  // ids instead of hashing strings.
+  uint32_t GetKernelNameIdByOrdinal(size_t ordinal) const;
+
   TypeName GetType(string_view type) const;
 
  private:
@@ -139,13 +139,23 @@ class Argument {
   AsyncValueRef<T> ValueRef() const {
     return AsyncValueRef<T>(FormRef(value_));
   }
-  T& get() const { return value_->template get<T>(); }
+  // The payload pointer is materialized on first access and cached in the
+  // kernel frame, so kernels that read an argument multiple times pay the
+  // state and kind checks in AsyncValue::get() only once.
+  T& get() const {
+    if (!payload_) payload_ = &value_->template get<T>();
+    return *payload_;
+  }
   T* operator->() const { return &get(); }
   T& operator*() const { return get(); }
 
  private:
   // Does not own the async value.
   AsyncValue* value_;
+  // Cached payload pointer. This is resolved lazily rather than in the
+  // constructor because non-strict kernels may be invoked with unavailable
+  // arguments that they never read.
+  mutable T* payload_ = nullptr;
 };
 
 // ArgumentView is used to project the payload of an AsyncValue via a view
@@ -407,6 +417,63 @@ class KernelErrorHandler {
   KernelFrame* frame_;
 };
 
+namespace internal {
+
+// Classifies kernel parameter types for the flat invocation fast path below.
+// A "simple sync" parameter is a plain value type whose payload can be loaded
+// directly from the frame by index: not a wrapper (Argument, Result,
+// attributes, ...), not a view, not a pointer or reference, and not variadic.
+template <typename T>
+using UnderlyingTOf = typename T::UnderlyingT;
+
+template <typename T>
+struct IsSimpleSyncArg
+    : std::integral_constant<bool,
+                             !std::is_pointer<T>::value &&
+                                 !std::is_reference<T>::value &&
+                                 !is_detected<UnderlyingTOf, T>::value> {};
+
+template <typename T>
+struct IsSimpleSyncArg<Argument<T>> : std::false_type {};
+template <typename T>
+struct IsSimpleSyncArg<ArgumentView<T>> : std::false_type {};
+template <typename T>
+struct IsSimpleSyncArg<Result<T>> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<RemainingArguments> : std::false_type {};
+template <typename T>
+struct IsSimpleSyncArg<RepeatedArguments<T>> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<RemainingResults> : std::false_type {};
+template <typename T>
+struct IsSimpleSyncArg<Attribute<T>> : std::false_type {};
+template <typename T>
+struct IsSimpleSyncArg<ArrayAttribute<T>> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<StringAttribute> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<DenseAttr> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<AggregateAttribute> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<RemainingAttributes> : std::false_type {};
+template <>
+struct IsSimpleSyncArg<KernelErrorHandler> : std::false_type {};
+
+// C++14 conjunction over a parameter pack of bools.
+template <bool...>
+struct BoolPack {};
+template <bool... bs>
+using AllTrue = std::is_same<BoolPack<bs..., true>, BoolPack<true, bs...>>;
+
+// Top-level cv-qualifiers are already stripped from function parameter
+// types, so the pack is applied as-is; references must stay visible to the
+// trait (e.g. `const ExecutionContext&` is not a simple sync argument).
+template <typename... Ts>
+using AllSimpleSyncArgs = AllTrue<IsSimpleSyncArg<Ts>::value...>;
+
+}  // namespace internal
+
 // This class is an implementation detail of TFRT_KERNEL.
 template <typename F, F f>
 struct TfrtKernelImpl;
@@ -414,12 +481,47 @@ struct TfrtKernelImpl;
 template <typename Return, typename... Args, Return (*impl_fn)(Args...)>
 struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
   // This is the main entry point that gets registered as a kernel.
+  //
+  // Kernels with static arity whose parameters are all plain synchronous
+  // values (e.g. `int32_t Add(int32_t, int32_t)`) take a flat path that
+  // expands to a direct argument-load sequence, instead of instantiating one
+  // recursion step of SyncKernelCallHelper per parameter. The flat path is
+  // selected at compile time, does all its index bookkeeping in constants,
+  // and folds the per-argument debug checks into a single availability sweep
+  // - fewer instructions per call and noticeably less generated code across
+  // a large kernel registry.
   static void Invoke(KernelFrame* frame) {
-    SyncKernelCallHelper<Args...>::template Invoke<0, 0, 0, false, false>(
-        frame);
+    InvokeImpl(frame, internal::AllSimpleSyncArgs<Args...>());
   }
 
  private:
+  // Flat path for all-sync fixed-arity kernels.
+  static void InvokeImpl(KernelFrame* frame, std::true_type) {
+    assert((frame->GetNumArgs() == sizeof...(Args) ||
+            (frame->GetNumArgs() == sizeof...(Args) + 1 &&
+             frame->GetArgAt(sizeof...(Args))->template IsType<Chain>())) &&
+           "Incorrect number of arguments passed to kernel.");
+#ifndef NDEBUG
+    // Single availability sweep instead of a check per argument access.
+    bool all_available = true;
+    for (size_t i = 0; i < sizeof...(Args); ++i)
+      all_available &= frame->GetArgAt(i)->IsAvailable();
+    assert(all_available && "sync kernel invoked with unavailable argument");
+#endif
+    InvokeFlat(frame, std::make_index_sequence<sizeof...(Args)>());
+  }
+
+  template <size_t... I>
+  static void InvokeFlat(KernelFrame* frame, std::index_sequence<I...>) {
+    SyncKernelReturnHelper<false, Return>::Invoke(
+        frame, frame->template GetArgAt<Args>(I)...);
+  }
+
+  // General path: recursively unpack wrapper types, attributes and results.
+  static void InvokeImpl(KernelFrame* frame, std::false_type) {
+    SyncKernelCallHelper<Args...>::template Invoke<0, 0, 0, false, false>(
+        frame);
+  }
   // Check whether a type T has an internal UnderlyingT type.
   template <typename T>
   using UnderlyingT = typename T::UnderlyingT;
@@ -71,9 +71,10 @@ class NativeFunction : public Function {
                  ArrayRef<TypeName> result_types, NativeCallable callable)
       : Function(name, argument_types, result_types), callable_(callable) {}
 
-  void Execute(ArrayRef<AsyncValue*> arguments,
-               MutableArrayRef<RCReference<AsyncValue>> results,
-               HostContext* host) const final;
+  void Execute(const ExecutionContext& exec_ctx,
+               ArrayRef<AsyncValue*> arguments,
+               MutableArrayRef<RCReference<AsyncValue>> results) const final;
+  using Function::Execute;
 
   // Do nothing with reference counting as a native function should be always
   // available.
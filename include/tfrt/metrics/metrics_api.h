@@ -23,6 +23,7 @@
 #ifndef TFRT_METRICS_METRICS_API_H_
 #define TFRT_METRICS_METRICS_API_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,40 @@ class Gauge {
 template <typename T>
 Gauge<T>* NewGauge(std::string name);
 
+// A monotonic counter. Add is safe to call from per-request hot paths: the
+// default implementation shards the count across padded per-thread atomic
+// cells and only merges them when Value is read.
+class Counter {
+ public:
+  virtual ~Counter() {}
+
+  virtual void Add(int64_t delta) = 0;
+
+  // The merged count. Concurrent Add calls may or may not be included.
+  virtual int64_t Value() = 0;
+};
+
+Counter* NewCounter(std::string name);
+
+// A histogram with power-of-two buckets: bucket 0 counts values <= 0 and
+// bucket i counts values in [2^(i-1), 2^i). Record uses the same per-thread
+// sharding as Counter, so latency samples can be recorded on every request.
+class Histogram {
+ public:
+  // Covers values up to 2^62; everything above lands in the last bucket.
+  static constexpr int kNumBuckets = 64;
+
+  virtual ~Histogram() {}
+
+  virtual void Record(int64_t value) = 0;
+
+  // The merged bucket counts, kNumBuckets entries. Concurrent Record calls
+  // may or may not be included.
+  virtual std::vector<int64_t> GetBuckets() = 0;
+};
+
+Histogram* NewHistogram(std::string name);
+
 }  // namespace metrics
 }  // namespace tfrt
 
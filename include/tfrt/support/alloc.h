@@ -17,7 +17,8 @@
 //===- alloc.h --------------------------------------------------*- C++ -*-===//
 //
 // This file declares AlignedAlloc() for allocating dynamic buffer with
-// explicit alignment.
+// explicit alignment, and HugePageAlloc()/HugePageFree() for large buffers
+// backed by transparent huge pages.
 //
 //===----------------------------------------------------------------------===//
 #ifndef TFRT_SUPPORT_ALLOC_H_
@@ -29,6 +30,14 @@ namespace tfrt {
 
 void* AlignedAlloc(size_t alignment, size_t size);
 
+// Allocate `size` bytes of page-aligned memory advised for transparent huge
+// page backing, to cut the TLB miss rate on large long-lived buffers such as
+// embedding tables. On platforms without transparent huge pages this is an
+// ordinary page-aligned allocation. Returns nullptr on failure. Memory from
+// HugePageAlloc must be freed with HugePageFree, with the same size.
+void* HugePageAlloc(size_t size);
+void HugePageFree(void* ptr, size_t size);
+
 }  // namespace tfrt
 
 #endif  // TFRT_SUPPORT_ALLOC_H_
@@ -38,9 +38,15 @@ enum : uint8_t {
   kBEFMagic1 = 0x0B,
   kBEFMagic2 = 0xEF,
 
-  // This is the only known version of BEF files at the moment, new numbers
-  // should be used when/if a format break is introduced.
+  // The original version of BEF files, with function bodies stored as fixed
+  // 4-byte kernel words read directly from the file.
   kBEFVersion0 = 0,
+
+  // Version 1 stores the kernel words of each function body as a VBR stream
+  // prefixed with a word count. The words are decoded into memory once at
+  // function decode time, trading that one-time decode for a substantially
+  // smaller file and mapped footprint.
+  kBEFVersion1 = 1,
 };
 
 // These are the section ID's for the standard sections.  Each section is
@@ -122,6 +128,18 @@ enum class SpecialAttribute : uint8_t {
   kNonStrict = 1,
 };
 
+enum : uint32_t {
+  // The upper bits of a kernel's special_metadata word form a bitmask over
+  // its attribute entries: if bit (kInlineAttributeShift + i) is set, the
+  // i'th attribute entry of the kernel holds the little-endian value of a
+  // scalar attribute of at most 4 bytes inline, instead of an offset into
+  // the attributes section. The executor then reads the value from the
+  // already-resident kernel entry word with no extra indirection. Only the
+  // first kNumInlineAttributeBits attributes of a kernel are eligible.
+  kInlineAttributeShift = 8,
+  kNumInlineAttributeBits = 24,
+};
+
 // This enum defined the function kind.
 enum class FunctionKind : uint8_t {
   // This is the normal BEF function that defines registers and kernels in BEF.
@@ -25,6 +25,7 @@
 #define TFRT_SUPPORT_BEF_READER_H_
 
 #include <cassert>
+#include <limits>
 
 #include "llvm/ADT/ArrayRef.h"
 #include "tfrt/support/bef_encoding.h"
@@ -39,6 +40,10 @@ namespace tfrt {
 // treats "true" as failure - without returning an error.
 class BEFReader {
  public:
+  // Maximum number of bytes in the VBR encoding of a 64-bit integer (64/7,
+  // rounded up).
+  static constexpr size_t kMaxVbrSize = 10;
+
   explicit BEFReader(ArrayRef<uint8_t> file) : file_(file) {}
 
   // Return true if we've read the entire file.
@@ -81,6 +86,42 @@ class BEFReader {
     return false;
   }
 
+  // Bulk-read count consecutive VBR encoded integers into values. When the
+  // remaining buffer is long enough that no read can run off the end, the
+  // per-byte bounds checks are hoisted into one comparison and the values are
+  // decoded with unchecked loads; otherwise this falls back to checked reads.
+  // If T is narrower than size_t, a decoded value that does not fit in T is a
+  // failure, as is an encoding longer than kMaxVbrSize bytes (the emitter
+  // never produces either).
+  template <typename T>
+  bool ReadInts(size_t count, T* values) {
+    constexpr size_t kMaxValue = std::numeric_limits<T>::max();
+    if (count > file_.size() / kMaxVbrSize) {
+      // The buffer may end mid-stream; decode with per-byte checks.
+      for (size_t i = 0; i != count; ++i) {
+        size_t value;
+        if (ReadInt(&value) || value > kMaxValue) return true;
+        values[i] = static_cast<T>(value);
+      }
+      return false;
+    }
+    const uint8_t* ptr = file_.data();
+    for (size_t i = 0; i != count; ++i) {
+      uint8_t byte = *ptr++;
+      size_t value = byte & 127;
+      size_t length = 1;
+      while ((byte & 128) != 0) {
+        if (++length > kMaxVbrSize) return true;
+        byte = *ptr++;
+        value = (value << 7) | size_t(byte & 127);
+      }
+      if (value > kMaxValue) return true;
+      values[i] = static_cast<T>(value);
+    }
+    file_ = file_.drop_front(ptr - file_.data());
+    return false;
+  }
+
   bool ReadInt8(uint64_t* value) {
     if (ReadAlignment(8) || file_.size() < 8) return true;
     ASSERT_LITTLE_ENDIAN();
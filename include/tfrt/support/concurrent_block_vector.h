@@ -0,0 +1,200 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- concurrent_block_vector.h --------------------------------*- C++ -*-===//
+//
+// A two-level concurrent sequential container with wait-free indexed reads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_SUPPORT_CONCURRENT_BLOCK_VECTOR_H_
+#define TFRT_SUPPORT_CONCURRENT_BLOCK_VECTOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <mutex>
+
+#include "llvm/Support/MathExtras.h"
+
+namespace tfrt {
+
+// A concurrent grow-only container for the insert-once, read-millions-of-times
+// pattern (kernel and location tables). It improves on ConcurrentVector in two
+// ways:
+//
+// - Growth appends a new block instead of copying every element into a larger
+//   buffer, so elements never move, references returned from operator[] are
+//   never invalidated, and T does not need to be copyable.
+// - Reads are wait-free: an index inside the first block costs a single
+//   pointer load from a non-atomic member; later blocks cost one extra atomic
+//   load of the block pointer. Sizing the first block to the expected table
+//   size makes the single-load fast path cover nearly all reads.
+//
+// Writers (emplace_back and reserve) are serialized on a mutex; readers never
+// take it. As with ConcurrentVector, readers must learn indices from a writer
+// through a release/acquire edge (e.g. a relaxed store of the index paired
+// with the fences below).
+//
+// Block b = 0 holds `first_block_size` elements and block b > 0 holds
+// first_block_size * 2^(b-1), so capacity doubles with each new block and an
+// index maps to its block with one Log2.
+template <typename T>
+class ConcurrentBlockVector {
+ public:
+  // Initialize the vector with the given first block size, which is rounded
+  // up to a power of two. Only the first block is allocated up front.
+  explicit ConcurrentBlockVector(size_t first_block_size) {
+    first_block_size_log2_ =
+        llvm::Log2_64_Ceil(std::max<size_t>(first_block_size, 2));
+    blocks_[0].store(AllocateBlock(0), std::memory_order_relaxed);
+  }
+
+  ~ConcurrentBlockVector() {
+    size_t remaining = num_elements_.load(std::memory_order_relaxed);
+    for (size_t b = 0; b < kMaxBlocks && remaining > 0; ++b) {
+      T* block = blocks_[b].load(std::memory_order_relaxed);
+      if (!block) break;
+      size_t constructed = std::min(remaining, BlockCapacity(b));
+      for (size_t i = 0; i < constructed; ++i) block[i].~T();
+      remaining -= constructed;
+    }
+    for (size_t b = 0; b < kMaxBlocks; ++b) {
+      if (T* block = blocks_[b].load(std::memory_order_relaxed))
+        std::allocator<T>().deallocate(block, BlockCapacity(b));
+    }
+  }
+
+  ConcurrentBlockVector(const ConcurrentBlockVector&) = delete;
+  ConcurrentBlockVector& operator=(const ConcurrentBlockVector&) = delete;
+
+  T& operator[](size_t index) {
+    assert(index < size() && "invalid ConcurrentBlockVector index");
+    const size_t first_block_size = size_t{1} << first_block_size_log2_;
+    // Fast path: indices in the first block need a single pointer load. The
+    // pointer is set once in the constructor, so no atomic is involved.
+    if (index < first_block_size) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return blocks_[0].load(std::memory_order_relaxed)[index];
+    }
+    size_t block = BlockIndex(index);
+    // The acquire load synchronizes with the release store publishing the
+    // block in GrowToBlock, making the allocation visible; the fence pairs
+    // with the release fence in emplace_back for the element itself.
+    T* elements = blocks_[block].load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return elements[index - BlockStart(block)];
+  }
+
+  const T& operator[](size_t index) const {
+    return (*const_cast<ConcurrentBlockVector*>(this))[index];
+  }
+
+  // Return the number of elements currently valid in this vector. The vector
+  // only grows, so this is conservative w.r.t. the execution of the current
+  // thread.
+  size_t size() const {
+    return num_elements_.load(std::memory_order_relaxed);
+  }
+
+  // Preallocate blocks covering at least `capacity` elements, so subsequent
+  // emplace_back calls up to that size never allocate. Loading a table whose
+  // size is known up front should reserve first.
+  void reserve(size_t capacity) {
+    if (capacity == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    GrowToBlock(BlockIndex(capacity - 1));
+  }
+
+  // Insert a new element at the end and return its index. Existing elements
+  // never move.
+  template <typename... Args>
+  size_t emplace_back(Args&&... args) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const size_t index = num_elements_.load(std::memory_order_relaxed);
+    const size_t block = BlockIndex(index);
+    GrowToBlock(block);
+
+    T* elements = blocks_[block].load(std::memory_order_relaxed);
+    new (elements + index - BlockStart(block)) T(std::forward<Args>(args)...);
+
+    // Pairs with the acquire fence in operator[]: a reader that learns
+    // `index` through a relaxed store/load (or stronger) sees the element.
+    std::atomic_thread_fence(std::memory_order_release);
+    num_elements_.store(index + 1, std::memory_order_relaxed);
+    return index;
+  }
+
+  // Invoke `fn(index, element)` for every element in index order, walking
+  // each block contiguously. This avoids the per-access block lookup of
+  // operator[] and lets scans stream cache lines within a block.
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    size_t remaining = num_elements_.load(std::memory_order_acquire);
+    size_t index = 0;
+    for (size_t b = 0; b < kMaxBlocks && remaining > 0; ++b) {
+      const T* block = blocks_[b].load(std::memory_order_acquire);
+      size_t valid = std::min(remaining, BlockCapacity(b));
+      for (size_t i = 0; i < valid; ++i) fn(index++, block[i]);
+      remaining -= valid;
+    }
+  }
+
+ private:
+  // 64 doubling blocks cover any address space.
+  static constexpr size_t kMaxBlocks = 64;
+
+  size_t BlockCapacity(size_t block) const {
+    return size_t{1} << (first_block_size_log2_ + (block == 0 ? 0 : block - 1));
+  }
+
+  // First element index covered by `block`.
+  size_t BlockStart(size_t block) const {
+    return block == 0 ? 0
+                      : size_t{1} << (first_block_size_log2_ + block - 1);
+  }
+
+  size_t BlockIndex(size_t index) const {
+    const size_t scaled = index >> first_block_size_log2_;
+    return scaled == 0 ? 0 : llvm::Log2_64(scaled) + 1;
+  }
+
+  T* AllocateBlock(size_t block) {
+    return std::allocator<T>().allocate(BlockCapacity(block));
+  }
+
+  // Allocates blocks up to and including `block`. Must be called with the
+  // mutex held. The release store publishes each allocation to readers.
+  void GrowToBlock(size_t block) {
+    assert(block < kMaxBlocks && "ConcurrentBlockVector overflow");
+    for (size_t b = 1; b <= block; ++b) {
+      if (blocks_[b].load(std::memory_order_relaxed) == nullptr)
+        blocks_[b].store(AllocateBlock(b), std::memory_order_release);
+    }
+  }
+
+  size_t first_block_size_log2_;
+  std::atomic<size_t> num_elements_{0};
+  std::atomic<T*> blocks_[kMaxBlocks] = {};
+
+  // Serializes writers; readers are wait-free and never touch it.
+  std::mutex mutex_;
+};
+
+}  // namespace tfrt
+#endif  // TFRT_SUPPORT_CONCURRENT_BLOCK_VECTOR_H_
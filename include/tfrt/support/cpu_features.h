@@ -0,0 +1,65 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- cpu_features.h -------------------------------------------*- C++ -*-===//
+//
+// This file declares runtime CPU feature detection, used to select among
+// ISA-specialized kernel variants in a single binary.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_SUPPORT_CPU_FEATURES_H_
+#define TFRT_SUPPORT_CPU_FEATURES_H_
+
+#include <cstdint>
+
+namespace tfrt {
+
+// Bitmask of ISA extensions beyond the build's baseline instruction set. A
+// kernel variant declares the set of features it requires; the host either
+// supports all of them or the variant is unusable.
+enum class CpuFeatures : uint32_t {
+  kBaseline = 0,
+  // x86.
+  kAVX = 1 << 0,
+  kAVX2 = 1 << 1,
+  kFMA = 1 << 2,
+  kAVX512F = 1 << 3,
+  // AArch64. NEON is part of the baseline there, but naming it lets a variant
+  // compiled for NEON coexist with x86 variants of the same kernel.
+  kNEON = 1 << 4,
+};
+
+inline CpuFeatures operator|(CpuFeatures a, CpuFeatures b) {
+  return static_cast<CpuFeatures>(static_cast<uint32_t>(a) |
+                                  static_cast<uint32_t>(b));
+}
+
+inline CpuFeatures operator&(CpuFeatures a, CpuFeatures b) {
+  return static_cast<CpuFeatures>(static_cast<uint32_t>(a) &
+                                  static_cast<uint32_t>(b));
+}
+
+// Returns the feature set of the host CPU. The CPUID probe runs once; later
+// calls return the cached result.
+CpuFeatures GetHostCpuFeatures();
+
+// Returns true if the host supports every feature in `features`.
+bool HostSupportsCpuFeatures(CpuFeatures features);
+
+}  // namespace tfrt
+
+#endif  // TFRT_SUPPORT_CPU_FEATURES_H_
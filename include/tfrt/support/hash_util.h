@@ -30,6 +30,15 @@ namespace tfrt {
 uint32_t Hash32(const char* data, size_t n, uint32_t seed);
 uint64_t Hash64(const char* data, size_t n, uint64_t seed);
 
+// A bulk hash for fingerprinting large buffers (tensor contents, serialized
+// attributes) at close to memory bandwidth. It consumes 64-byte stripes into
+// eight independent accumulators, so the inner loop vectorizes: an explicit
+// AVX2 path is selected with a byte_order.h-style compile-time guard, and the
+// generic path is written so the compiler auto-vectorizes it on NEON. All
+// paths produce identical results, and the result is stable across runs and
+// machines (but is not the same function as Hash64).
+uint64_t Hash64Bulk(const char* data, size_t n, uint64_t seed);
+
 inline uint64_t Hash64(const char* data, size_t n) {
   return Hash64(data, n, 0xDECAFCAFFE);
 }
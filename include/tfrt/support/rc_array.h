@@ -49,6 +49,17 @@ class RCArray {
     }
   }
 
+  // Construct an RCArray by taking over the +1 references held by
+  // `references`, leaving each of them null. Unlike the constructors above
+  // this performs no reference counting at all, so it is the preferred way to
+  // move a result list into a closure when the source is about to die.
+  static RCArray TakeRef(llvm::MutableArrayRef<RCReference<T>> references) {
+    RCArray array;
+    array.values_.reserve(references.size());
+    for (auto& ref : references) array.values_.push_back(ref.release());
+    return array;
+  }
+
   RCArray(RCArray&& other) : values_(std::move(other.values_)) {}
 
   RCArray& operator=(RCArray&& other) {
@@ -81,6 +92,11 @@ class RCArray {
   RCArray& operator=(const RCArray&) = delete;
 
  private:
+  // Used by TakeRef, which fills values_ with already-owned pointers.
+  RCArray() = default;
+
+  // Inline storage covers the 1-4 element arrays that dominate kernel
+  // argument and result lists, so those never allocate.
   llvm::SmallVector<T*, 4> values_;
 };
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- string_interner.h ----------------------------------------*- C++ -*-===//
+//
+// A process-wide string interning table with stable integer ids.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_SUPPORT_STRING_INTERNER_H_
+#define TFRT_SUPPORT_STRING_INTERNER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+// Interns strings (kernel names, op names, type names, attribute keys) into a
+// single shared table, so every subsystem that today keeps its own copy and
+// hashes on lookup can instead hold a 32-bit id and compare ids. Interning a
+// string hashes it exactly once, at registration; the stored bytes are never
+// copied again - GetString and GetCString return views into the table, and
+// ids are stable for the life of the process.
+//
+// Intern() is thread-safe behind a mutex (registration-time only); the
+// id-to-string direction is wait-free and safe to call from dispatch paths.
+class StringInterner {
+ public:
+  using Id = uint32_t;
+  static constexpr Id kInvalidId = ~Id(0);
+
+  // Returns the process-wide table. Never destroyed, so handed-out views
+  // remain valid at static destruction time.
+  static StringInterner& Global();
+
+  // Returns the id for `str`, inserting it if not present.
+  Id Intern(string_view str);
+
+  // Returns the id for `str` if it was interned, kInvalidId otherwise.
+  Id Find(string_view str) const;
+
+  // Returns the interned bytes for `id`. Wait-free.
+  string_view GetString(Id id) const;
+
+  // Like GetString, but NUL-terminated for C-style consumers.
+  const char* GetCString(Id id) const;
+
+  // Number of interned strings. Ids are dense: [0, size()).
+  size_t size() const;
+
+  StringInterner();
+  ~StringInterner();
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_SUPPORT_STRING_INTERNER_H_
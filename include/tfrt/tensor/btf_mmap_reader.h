@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- btf_mmap_reader.h ----------------------------------------*- C++ -*-===//
+//
+// This file contains a memory mapped reader for BTF (Binary Tensor Format).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_BTF_MMAP_READER_H_
+#define TFRT_TENSOR_BTF_MMAP_READER_H_
+
+#include <string>
+
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/btf.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dtype.h"
+
+namespace tfrt {
+
+// Memory maps a BTF file and constructs DenseHostTensors whose HostBuffers
+// alias the mapped region, so reading a tensor costs page table setup instead
+// of copying its payload. BTF dense records store their data contiguously and
+// 8-byte aligned, which satisfies the alignment of every supported dtype. The
+// mapping is reference counted: it stays alive until this object and every
+// tensor read from it are destroyed.
+class MappedBTFFile {
+ public:
+  // Map the BTF file at `path`. Returns an error on IO failure or if the file
+  // is too small to be a BTF file.
+  static Expected<MappedBTFFile> Open(const std::string& path);
+
+  MappedBTFFile(MappedBTFFile&&) = default;
+  MappedBTFFile& operator=(MappedBTFFile&&) = default;
+
+  // Number of tensor records in the file.
+  uint64_t NumTensors() const;
+
+  // Returns a dense tensor whose buffer aliases the payload of record
+  // `index`, without copying. Fails if the record's dtype, rank or layout do
+  // not match or the record is truncated.
+  template <typename DType, size_t Rank>
+  Expected<DenseHostTensor> ReadDenseTensor(int32_t index) const {
+    return ReadDenseTensorImpl(index, btf::GetTensorDType(DType()), Rank,
+                               GetDType<DType>());
+  }
+
+ private:
+  explicit MappedBTFFile(RCReference<HostBuffer> mapping)
+      : mapping_(std::move(mapping)) {}
+
+  Expected<DenseHostTensor> ReadDenseTensorImpl(int32_t index,
+                                                btf::TensorDType btf_dtype,
+                                                size_t rank, DType dtype) const;
+
+  RCReference<HostBuffer> mapping_;
+};
+
+// Kernel to read a tensor from a memory mapped BTF file. This takes the same
+// arguments as ReadTensorFromBTF, but the resulting tensor aliases the mapped
+// file instead of owning a copy of the data.
+template <typename DType, size_t Rank>
+AsyncValueRef<DenseHostTensor> MmapTensorFromBTF(std::string path,
+                                                 int32_t index,
+                                                 HostContext* host) {
+  return host->EnqueueBlockingWork(
+      [path = std::move(path), index]() -> Expected<DenseHostTensor> {
+        auto file = MappedBTFFile::Open(path);
+        if (!file) return file.takeError();
+        return file->ReadDenseTensor<DType, Rank>(index);
+      });
+}
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_BTF_MMAP_READER_H_
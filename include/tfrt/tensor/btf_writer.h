@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- btf_writer.h ---------------------------------------------*- C++ -*-===//
+//
+// This file contains a streaming writer for BTF (Binary Tensor Format).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_BTF_WRITER_H_
+#define TFRT_TENSOR_BTF_WRITER_H_
+
+#include <memory>
+#include <string>
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+class DenseHostTensor;
+class HostContext;
+
+// Output sink for the streaming BTF writer. Writes are positional and may be
+// issued concurrently from work queue threads, so implementations must
+// support concurrent writes at disjoint offsets (pwrite semantics).
+class BTFWriterSink {
+ public:
+  virtual ~BTFWriterSink();
+
+  // Write `data` at absolute byte `offset` in the output. Returns false on
+  // failure.
+  virtual bool Write(uint64_t offset, ArrayRef<uint8_t> data) = 0;
+};
+
+// A sink that writes to a file through pwrite.
+class BTFFileSink final : public BTFWriterSink {
+ public:
+  // Create (or truncate) the file at `path`.
+  static Expected<std::unique_ptr<BTFFileSink>> Create(const std::string& path);
+
+  ~BTFFileSink() override;
+
+  bool Write(uint64_t offset, ArrayRef<uint8_t> data) override;
+
+ private:
+  explicit BTFFileSink(int fd) : fd_(fd) {}
+
+  int fd_;
+};
+
+// Serialize `tensors` into `sink` in BTF layout. The offset table is computed
+// up front and written immediately; each tensor record is then written by its
+// own task on the host work queue, so dumping large outputs overlaps with
+// other work instead of serializing single-threaded. Record offsets are kept
+// 8-byte aligned so the payloads can later be memory mapped.
+//
+// `tensors` and `sink` must stay live until the returned chain resolves. The
+// chain is an error if a tensor has a dtype BTF cannot represent or any write
+// fails.
+AsyncValueRef<Chain> SerializeTensorsToBTF(
+    ArrayRef<const DenseHostTensor*> tensors, BTFWriterSink* sink,
+    HostContext* host);
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_BTF_WRITER_H_
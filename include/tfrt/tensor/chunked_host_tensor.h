@@ -0,0 +1,74 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- chunked_host_tensor.h ------------------------------------*- C++ -*-===//
+//
+// This file defines the ChunkedHostTensor class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_CHUNKED_HOST_TENSOR_H_
+#define TFRT_TENSOR_CHUNKED_HOST_TENSOR_H_
+
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/support/rc_array.h"
+#include "tfrt/tensor/host_tensor.h"
+
+namespace tfrt {
+
+void RegisterChunkedHostTensorKernels(KernelRegistry* registry);
+
+// Represents a dense tensor whose storage is split into reference counted
+// chunks along dimension zero. Chunk i holds chunk_rows()[i] leading-dimension
+// slices, stored contiguously in row-major order, and the chunk row counts sum
+// to the extent of dimension zero. Concatenating tensors along dimension zero
+// and splitting them back are metadata operations over the chunk array; no
+// element data is copied until the tensor is converted to a DenseHostTensor.
+class ChunkedHostTensor final : public HostTensor {
+ public:
+  ChunkedHostTensor(const TensorMetadata& metadata, RCArray<HostBuffer> chunks,
+                    SmallVector<ssize_t, 4> chunk_rows)
+      : HostTensor(Subclass::ChunkedHost, metadata),
+        chunks_(std::move(chunks)),
+        chunk_rows_(std::move(chunk_rows)) {}
+
+  size_t NumChunks() const { return chunks_.size(); }
+
+  // Raw access to the storage of chunk `i`.
+  HostBuffer* chunk(size_t i) const { return chunks_[i]; }
+
+  // Number of leading-dimension slices held by each chunk.
+  ArrayRef<ssize_t> chunk_rows() const { return chunk_rows_; }
+
+  const RCArray<HostBuffer>& chunks() const { return chunks_; }
+
+  void Print(raw_ostream& os) const override;
+
+  AsyncValueRef<HostTensor> ConvertToHostTensor(
+      HostContext* host, uint32_t allowed_formats) const override;
+
+  static bool classof(const Tensor* t) {
+    return t->subclass() == Subclass::ChunkedHost;
+  }
+
+ private:
+  RCArray<HostBuffer> chunks_;
+  SmallVector<ssize_t, 4> chunk_rows_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_CHUNKED_HOST_TENSOR_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- dense_tensor_transforms.h --------------------------------*- C++ -*-===//
+//
+// This file declares layout-transform primitives for dense host tensors:
+// cache-blocked parallel transpose, and slice/concat copies.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_DENSE_TENSOR_TRANSFORMS_H_
+#define TFRT_TENSOR_DENSE_TENSOR_TRANSFORMS_H_
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+class DenseHostTensor;
+class HostContext;
+class KernelRegistry;
+
+// Transposes `src` into `dst`: output dimension i is input dimension
+// permutation[i], so NHWC to NCHW is permutation (0, 3, 1, 2). `dst` must
+// already be allocated with the permuted shape and the same dtype. The copy
+// is cache-blocked, with tile sizes derived from the element size and the
+// cache line size, and is parallelized on the host work queue. The returned
+// chain resolves once `dst` is fully written; on rank, shape or dtype
+// mismatch an error async value is returned and `dst` is untouched.
+AsyncValueRef<Chain> TransposeTensor(const DenseHostTensor& src,
+                                     DenseHostTensor* dst,
+                                     ArrayRef<ssize_t> permutation,
+                                     HostContext* host);
+
+// Copies the region of `src` that starts at `begin` and has `dst`'s shape
+// into `dst`. Contiguous innermost runs are copied with memcpy and the outer
+// runs are parallelized on the host work queue. The returned chain resolves
+// once `dst` is fully written; on rank, bounds or dtype mismatch an error
+// async value is returned and `dst` is untouched.
+AsyncValueRef<Chain> SliceTensor(const DenseHostTensor& src,
+                                 ArrayRef<ssize_t> begin, DenseHostTensor* dst,
+                                 HostContext* host);
+
+// Concatenates `srcs` along dimension `axis` into `dst`, whose shape must
+// match the inputs on every other dimension and sum their extents on `axis`.
+// Each input contributes independent contiguous block copies, parallelized
+// on the host work queue. The returned chain resolves once `dst` is fully
+// written; on shape or dtype mismatch an error async value is returned and
+// `dst` is untouched.
+AsyncValueRef<Chain> ConcatTensors(ArrayRef<const DenseHostTensor*> srcs,
+                                   int axis, DenseHostTensor* dst,
+                                   HostContext* host);
+
+// Registers the dht.transpose, dht.slice and dht.concat kernels.
+void RegisterDenseTensorTransformKernels(KernelRegistry* registry);
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_DENSE_TENSOR_TRANSFORMS_H_
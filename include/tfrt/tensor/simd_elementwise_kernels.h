@@ -0,0 +1,40 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- simd_elementwise_kernels.h -------------------------------*- C++ -*-===//
+//
+// This file declares the SIMD elementwise kernels for dense host tensors.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_SIMD_ELEMENTWISE_KERNELS_H_
+#define TFRT_TENSOR_SIMD_ELEMENTWISE_KERNELS_H_
+
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+class KernelRegistry;
+
+// Registers the tfrt_dht.* SIMD elementwise kernels (add, mul, relu, sigmoid,
+// tanh over f32 dense host tensors). The widest instruction set the host
+// supports (AVX-512, AVX2, NEON, or a portable scalar fallback) is selected
+// once per process.
+void RegisterSimdElementwiseKernels(KernelRegistry* registry);
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_SIMD_ELEMENTWISE_KERNELS_H_
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- strided_host_tensor.h ------------------------------------*- C++ -*-===//
+//
+// This file defines the StridedHostTensor class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_STRIDED_HOST_TENSOR_H_
+#define TFRT_TENSOR_STRIDED_HOST_TENSOR_H_
+
+#include <array>
+
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/tensor/host_tensor.h"
+
+namespace tfrt {
+
+class DenseHostTensor;
+
+void RegisterStridedHostTensorKernels(KernelRegistry* registry);
+
+// Represents a rectangular view into a shared HostBuffer with an explicit
+// stride (in elements) per dimension. Slicing and transposing a
+// DenseHostTensor are metadata operations under this representation: the view
+// aliases the parent buffer and keeps it alive through reference counting, so
+// no element data is copied until the view is converted to a DenseHostTensor.
+class StridedHostTensor final : public HostTensor {
+ public:
+  StridedHostTensor(const TensorMetadata& metadata,
+                    RCReference<HostBuffer> buffer, size_t offset_in_bytes,
+                    SmallVector<ssize_t, 4> strides)
+      : HostTensor(Subclass::StridedHost, metadata),
+        buffer_(std::move(buffer)),
+        offset_in_bytes_(offset_in_bytes),
+        strides_(std::move(strides)) {}
+
+  // Creates a view of the region of `dht` starting at `begin` with extents
+  // `sizes`, in O(1). `begin` and `sizes` must be in bounds.
+  static StridedHostTensor SliceView(const DenseHostTensor& dht,
+                                     ArrayRef<ssize_t> begin,
+                                     ArrayRef<ssize_t> sizes);
+
+  // Creates a view of `dht` with its dimensions permuted so that result
+  // dimension i is source dimension perm[i], in O(1). `perm` must be a
+  // permutation of [0, rank).
+  static StridedHostTensor TransposeView(const DenseHostTensor& dht,
+                                         ArrayRef<ssize_t> perm);
+
+  // The element stride of each dimension, measured in elements of dtype().
+  ArrayRef<ssize_t> strides() const { return strides_; }
+
+  size_t offset_in_bytes() const { return offset_in_bytes_; }
+
+  const RCReference<HostBuffer>& buffer() const { return buffer_; }
+
+  // A pointer to the element at index (0, ..., 0).
+  const void* data() const {
+    return static_cast<const char*>(buffer_->data()) + offset_in_bytes_;
+  }
+
+  void Print(raw_ostream& os) const override;
+
+  AsyncValueRef<HostTensor> ConvertToHostTensor(
+      HostContext* host, uint32_t allowed_formats) const override;
+
+  static bool classof(const Tensor* t) {
+    return t->subclass() == Subclass::StridedHost;
+  }
+
+ private:
+  RCReference<HostBuffer> buffer_;
+  size_t offset_in_bytes_;
+  SmallVector<ssize_t, 4> strides_;
+};
+
+// StridedTensorView<DType, Rank> projects a StridedHostTensor as an indexable
+// tensor of the given dtype and rank, mirroring DHTIndexableView for
+// DenseHostTensor. The underlying StridedHostTensor must outlive the view.
+template <typename DType, size_t Rank>
+class StridedTensorView {
+ public:
+  // Used by Argument<> to get the underlying type.
+  using UnderlyingT = StridedHostTensor;
+
+  /*implicit*/ StridedTensorView(const StridedHostTensor* t) : tensor_(*t) {
+    assert(GetDType<DType>() == t->dtype() && "Incorrect dtype for tensor");
+    assert(t->shape().GetRank() == Rank && "Incorrect rank for tensor");
+  }
+
+  FixedRankShape<Rank> FixedShape() const {
+    return FixedRankShape<Rank>(tensor_.shape());
+  }
+
+  std::array<ssize_t, Rank> Strides() const {
+    std::array<ssize_t, Rank> result;
+    std::copy(tensor_.strides().begin(), tensor_.strides().end(),
+              result.begin());
+    return result;
+  }
+
+  // A pointer to the element at index (0, ..., 0).
+  const DType* data() const {
+    return static_cast<const DType*>(tensor_.data());
+  }
+
+  template <typename... Dims>
+  const DType& ElementAt(Dims... dims) const {
+    static_assert(sizeof...(Dims) == Rank, "invalid number of dimensions");
+    ssize_t indices[] = {static_cast<ssize_t>(dims)...};
+    ssize_t offset = 0;
+    for (size_t i = 0; i != Rank; ++i)
+      offset += indices[i] * tensor_.strides()[i];
+    return data()[offset];
+  }
+
+ private:
+  const StridedHostTensor& tensor_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_STRIDED_HOST_TENSOR_H_
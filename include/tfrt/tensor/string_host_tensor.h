@@ -23,30 +23,37 @@
 #ifndef TFRT_TENSOR_STRING_HOST_TENSOR_H_
 #define TFRT_TENSOR_STRING_HOST_TENSOR_H_
 
-#include <string>
-
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_buffer.h"
 #include "tfrt/tensor/host_tensor.h"
 
 namespace tfrt {
 
-// Represents a tensor of strings. The metadata of strings (pointer and size)
-// are stored contiguously in row major format with no padding or stride.
+// Represents a tensor of strings in an arena layout: the characters of all
+// elements are stored back to back in one contiguous HostBuffer, and element
+// i is the half-open byte range [offsets()[i], offsets()[i + 1]) of that
+// arena, in row major order. This costs two allocations for the whole tensor
+// instead of one std::string heap allocation per element, so elements are
+// immutable once the tensor is constructed.
 class StringHostTensor final : public HostTensor {
  public:
-  // Allocate a StringHostTensor with uninitialized data. Return None on
-  // failure.
-  static llvm::Optional<StringHostTensor> CreateUninitialized(
-      const TensorMetadata& metadata, HostContext* host);
+  // Create a StringHostTensor holding a copy of the given strings, which must
+  // have one entry per element of `metadata`, in row major order. Returns
+  // None on allocation failure.
+  static llvm::Optional<StringHostTensor> CreateFromStrings(
+      const TensorMetadata& metadata, ArrayRef<string_view> strings,
+      HostContext* host);
 
   // Make an AsyncValueRef<StringHostTensor> with kConstructed state.
   static AsyncValueRef<StringHostTensor> MakeConstructedAsyncValueRef(
-      const TensorMetadata& metadata, HostContext* host);
+      const TensorMetadata& metadata, ArrayRef<string_view> strings,
+      HostContext* host);
 
-  StringHostTensor(const TensorMetadata& metadata,
-                   HostArray<std::string> strings)
+  StringHostTensor(const TensorMetadata& metadata, HostArray<size_t> offsets,
+                   RCReference<HostBuffer> characters)
       : HostTensor(Subclass::StringHost, metadata),
-        strings_(std::move(strings)) {}
+        offsets_(std::move(offsets)),
+        characters_(std::move(characters)) {}
 
   StringHostTensor(StringHostTensor&& other);
   StringHostTensor& operator=(StringHostTensor&& other);
@@ -54,8 +61,20 @@ class StringHostTensor final : public HostTensor {
   StringHostTensor(const StringHostTensor& other) = delete;
   StringHostTensor& operator=(const StringHostTensor& other) = delete;
 
-  ArrayRef<std::string> strings() const { return strings_.array(); }
-  MutableArrayRef<std::string> strings() { return strings_.mutable_array(); }
+  // Element `i` as a view into the character arena. The view is valid for the
+  // lifetime of the arena buffer.
+  string_view GetString(ssize_t i) const {
+    auto offsets = offsets_.array();
+    return string_view(
+        static_cast<const char*>(characters_->data()) + offsets[i],
+        offsets[i + 1] - offsets[i]);
+  }
+
+  // Byte offset of each element in the character arena, with one extra
+  // trailing entry holding the total arena size.
+  ArrayRef<size_t> offsets() const { return offsets_.array(); }
+
+  const RCReference<HostBuffer>& characters() const { return characters_; }
 
   void Print(raw_ostream& os) const override;
 
@@ -67,8 +86,8 @@ class StringHostTensor final : public HostTensor {
   }
 
  private:
-  // TODO(tf-runtime-team): Consider making it reference counted.
-  HostArray<std::string> strings_;
+  HostArray<size_t> offsets_;
+  RCReference<HostBuffer> characters_;
 };
 
 inline StringHostTensor::StringHostTensor(StringHostTensor&& other) = default;
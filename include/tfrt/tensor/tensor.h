@@ -23,6 +23,8 @@
 #ifndef TFRT_TENSOR_TENSOR_H_
 #define TFRT_TENSOR_TENSOR_H_
 
+#include <atomic>
+
 #include "tfrt/tensor/tensor_metadata.h"
 
 namespace tfrt {
@@ -40,10 +42,12 @@ class Tensor {
   // is, allowing efficient downcasting with integer comparisons.  We are likely
   // to make this openly extensible, but for now we just use an enum.
   enum class Subclass {
-    DenseHost,   // This is a DenseHostTensor
-    ScalarHost,  // This is a ScalarHostTensor
-    CooHost,     // This is a CooHostTensor
-    StringHost,  // This is a StringHostTensor
+    DenseHost,    // This is a DenseHostTensor
+    ScalarHost,   // This is a ScalarHostTensor
+    CooHost,      // This is a CooHostTensor
+    StringHost,   // This is a StringHostTensor
+    ChunkedHost,  // This is a ChunkedHostTensor
+    StridedHost,  // This is a StridedHostTensor
 
     DenseGpu,           // This is a DenseGpuTensor
     TFRuntimeFallback,  // This is a TFRuntimeFallbackTensor
@@ -74,6 +78,21 @@ class Tensor {
   virtual AsyncValueRef<HostTensor> ConvertToHostTensor(
       HostContext* host, uint32_t allowed_formats) const = 0;
 
+  // Convert like ConvertToHostTensor, but memoize the result on this tensor:
+  // repeated conversions for the same set of allowed formats return the copy
+  // made the first time. This matters for tensors that many ops convert, e.g.
+  // a scalar weight tensor that would otherwise be densified by every op that
+  // touches it.
+  //
+  // Code that mutates a tensor's contents in place must call
+  // DropConversionMemo so stale copies do not outlive the data they were made
+  // from.
+  AsyncValueRef<HostTensor> ConvertToHostTensorCached(
+      HostContext* host, uint32_t allowed_formats) const;
+
+  // Invalidate any conversions memoized by ConvertToHostTensorCached.
+  void DropConversionMemo() const;
+
   virtual bool IsHostTensor() const { return false; }
 
   // Note: subclass() exists for implementations of classof(..), which allows
@@ -101,12 +120,33 @@ class Tensor {
   Tensor& operator=(Tensor&& other);
 
  private:
+  // Lazily allocated cache of host tensor conversions of this tensor, keyed
+  // by the allowed_formats they were requested with.
+  class ConversionMemo;
+
   TensorMetadata metadata_;
   Subclass subclass_;
+  mutable std::atomic<ConversionMemo*> conversion_memo_{nullptr};
 };
 
-inline Tensor::Tensor(Tensor&& other) = default;
-inline Tensor& Tensor::operator=(Tensor&& other) = default;
+inline Tensor::Tensor(Tensor&& other)
+    : metadata_(std::move(other.metadata_)),
+      subclass_(other.subclass_),
+      conversion_memo_(other.conversion_memo_.exchange(
+          nullptr, std::memory_order_acq_rel)) {}
+
+inline Tensor& Tensor::operator=(Tensor&& other) {
+  metadata_ = std::move(other.metadata_);
+  subclass_ = other.subclass_;
+  // This tensor's contents are being replaced, so any memoized conversions of
+  // them are stale. The source's memo describes the moved-in contents and
+  // moves along with them.
+  DropConversionMemo();
+  conversion_memo_.store(
+      other.conversion_memo_.exchange(nullptr, std::memory_order_acq_rel),
+      std::memory_order_release);
+  return *this;
+}
 
 inline raw_ostream& operator<<(raw_ostream& os, const Tensor& tensor) {
   tensor.Print(os);
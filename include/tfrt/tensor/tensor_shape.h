@@ -24,8 +24,10 @@
 #define TFRT_TENSOR_TENSOR_SHAPE_H_
 
 #include <array>
+#include <utility>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -80,7 +82,9 @@ class TensorShape {
 
   void GetDimensions(MutableArrayRef<ssize_t> result) const;
 
-  // `dim_idx` must be less than GetRank().
+  // `dim_idx` must be less than GetRank().  This branches over the storage
+  // representation on every call; decode the shape once into a
+  // DecodedTensorShape when indexing dimensions in a hot loop.
   ssize_t GetDimensionSize(int dim_idx) const;
 
  private:
@@ -142,8 +146,8 @@ class FixedRankShape {
   using const_iterator = typename Dims::const_iterator;
   using iterator = typename Dims::iterator;
 
-  FixedRankShape() { dims_.fill(0); }
-  FixedRankShape(const Dims& dims) : dims_(dims) {}
+  constexpr FixedRankShape() : dims_{} {}
+  constexpr FixedRankShape(const Dims& dims) : dims_(dims) {}
   explicit FixedRankShape(const TensorShape& shape);
 
   bool operator==(const FixedRankShape& other) const {
@@ -154,9 +158,20 @@ class FixedRankShape {
     return !(*this == other);
   }
 
-  size_t GetNumElements() const;
+  constexpr size_t GetNumElements() const { return NumElementsFromDim(0); }
+
+  // Returns the row-major stride, in elements, of dimension `i`.
+  constexpr ssize_t GetStride(size_t i) const {
+    return i + 1 == Rank ? 1 : dims_[i + 1] * GetStride(i + 1);
+  }
+
+  // Returns the row-major strides of all dimensions.  This is constexpr, so
+  // stride computation on compile-time shapes folds away entirely.
+  constexpr FixedRankShape GetStrides() const {
+    return GetStridesImpl(std::make_index_sequence<Rank>());
+  }
 
-  const ssize_t& operator[](size_t i) const { return dims_[i]; }
+  constexpr const ssize_t& operator[](size_t i) const { return dims_[i]; }
   ssize_t& operator[](size_t i) { return dims_[i]; }
 
   const_iterator begin() const { return dims_.begin(); }
@@ -167,9 +182,43 @@ class FixedRankShape {
   TensorShape ToTensorShape() const { return TensorShape(dims_); }
 
  private:
+  constexpr size_t NumElementsFromDim(size_t i) const {
+    return i == Rank ? 1 : dims_[i] * NumElementsFromDim(i + 1);
+  }
+
+  template <size_t... I>
+  constexpr FixedRankShape GetStridesImpl(std::index_sequence<I...>) const {
+    return FixedRankShape(Dims{{GetStride(I)...}});
+  }
+
   std::array<ssize_t, Rank> dims_;
 };
 
+// A TensorShape decoded into a flat dimension array.  TensorShape branches
+// over its storage representation on every dimension access, so hot loops
+// that index dimensions repeatedly should decode the shape once into this
+// view and index the result directly.
+class DecodedTensorShape {
+ public:
+  explicit DecodedTensorShape(const TensorShape& shape);
+
+  int GetRank() const { return dims_.size(); }
+
+  ssize_t GetNumElements() const {
+    ssize_t result = 1;
+    for (ssize_t dim : dims_) result *= dim;
+    return result;
+  }
+
+  ArrayRef<ssize_t> GetDimensions() const { return dims_; }
+
+  // `dim_idx` must be less than GetRank().
+  ssize_t operator[](size_t dim_idx) const { return dims_[dim_idx]; }
+
+ private:
+  SmallVector<ssize_t, 8> dims_;
+};
+
 //
 // Implementation details follow.
 //
@@ -254,13 +303,8 @@ inline TensorShape::~TensorShape() {
   if (IsRepresentationExternal()) delete[] representation_.rep_external.dims;
 }
 
-template <size_t Rank>
-size_t FixedRankShape<Rank>::GetNumElements() const {
-  std::size_t result = 1;
-  for (size_t d : dims_) {
-    result *= d;
-  }
-  return result;
+inline DecodedTensorShape::DecodedTensorShape(const TensorShape& shape) {
+  shape.GetDimensions(&dims_);
 }
 
 template <size_t Rank>
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- chrome_tracing_sink.h - Chrome Trace Event Sink ----------*- C++ -*-===//
+//
+// This file declares a tracing sink that collects activities per thread and
+// exports them as Chrome trace-event JSON, loadable in chrome://tracing or
+// Perfetto to visualize executor concurrency.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TRACING_CHROME_TRACING_SINK_H_
+#define TFRT_TRACING_CHROME_TRACING_SINK_H_
+
+#ifndef NO_TFRT_TRACING
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace internal {
+namespace tracing {
+
+// Records an activity into the calling thread's lane. Each recording thread
+// becomes one row of the exported timeline, so worker idle gaps and
+// scheduling bubbles are directly visible.
+void ChromeTracingRecordActivity(TracingActivity&);
+
+// Writes everything recorded so far to `path` as Chrome trace-event JSON.
+// Returns false after logging an error if the file cannot be written.
+bool WriteChromeTrace(string_view path);
+
+}  // namespace tracing
+}  // namespace internal
+}  // namespace tfrt
+
+#endif  // NO_TFRT_TRACING
+#endif  // TFRT_TRACING_CHROME_TRACING_SINK_H_
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- ring_buffer_tracing_sink.h - Binary Ring Tracing Sink ----*- C++ -*-===//
+//
+// This file declares a tracing sink that records 16-byte packed events into
+// per-thread ring buffers, cheap enough to leave enabled in production.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TRACING_RING_BUFFER_TRACING_SINK_H_
+#define TFRT_TRACING_RING_BUFFER_TRACING_SINK_H_
+
+#ifndef NO_TFRT_TRACING
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace internal {
+namespace tracing {
+
+// Records an activity as a packed event in the calling thread's ring buffer.
+// Titles are interned once; the steady-state cost per event is one hash
+// lookup and a 16-byte store, with no formatting or allocation.
+void RingBufferRecordActivity(TracingActivity&);
+
+// Logs the contents of all thread rings (including rings of exited threads)
+// with interned titles resolved. Also runs automatically at process exit.
+void DumpRingBufferTrace();
+
+}  // namespace tracing
+}  // namespace internal
+}  // namespace tfrt
+
+#endif  // NO_TFRT_TRACING
+#endif  // TFRT_TRACING_RING_BUFFER_TRACING_SINK_H_
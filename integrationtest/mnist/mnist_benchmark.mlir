@@ -0,0 +1,158 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Performance integration benchmark for MNIST inference on real weights.
+// Unlike mnist.mlir, which checks accuracy, this file gates CI on latency:
+// each benchmark runs a fixed iteration count (duration_secs = 0) so runs
+// are comparable, and the p99 SLO below fails the test when an executor
+// change slows real model inference. The SLO is deliberately loose - it is
+// a backstop against large regressions, not a tuning target.
+
+// RUN: tfrt_translate --mlir-to-bef %s | env TFRT_BENCHMARK_P99_SLO_US=1000000 bef_executor -work_queue_type=mstd | FileCheck %s --dump-input=fail
+
+func @mnist_compute(%w1 : !t.tensor,
+                    %b1 : !t.tensor,
+                    %w2 : !t.tensor,
+                    %b2 : !t.tensor,
+                    %test_input_features : !t.tensor,
+                    %test_input_labels : !t.tensor,
+                    %ch0 : !hex.chain) -> !t.tensor
+{
+  %one = hex.constant.f32 1.0
+
+  %target_shape_b1 = ts.build_shape [100 : i64, 512 : i64]
+  // Shape: [100, 512].
+  %activation1 = "tfrt_test.broadcast.f32.2"(%b1, %target_shape_b1, %ch0) : (!t.tensor, !ts.shape, !hex.chain) -> !t.tensor
+  // Shape: [100, 512].
+  %ch1 = "tfrt_test.matmul.f32.2"(%one, %test_input_features, %w1, %one, %activation1, %ch0) : (f32, !t.tensor, !t.tensor, f32, !t.tensor, !hex.chain) -> !hex.chain
+  // Shape: [100, 512].
+  %relu1_ch = "tfrt_test.relu_inplace.f32"(%activation1, %ch1) : (!t.tensor, !hex.chain) -> !hex.chain
+
+  %target_shape_b2 = ts.build_shape [100 : i64, 10 : i64]
+  // Shape: [100, 10].
+  %activation2 = "tfrt_test.broadcast.f32.2"(%b2, %target_shape_b2, %ch0) : (!t.tensor, !ts.shape, !hex.chain) ->  !t.tensor
+  // Shape: [100, 10].
+  %ch2 = "tfrt_test.matmul.f32.2"(%one, %activation1, %w2, %one, %activation2, %relu1_ch) :  (f32, !t.tensor, !t.tensor, f32, !t.tensor, !hex.chain) -> !hex.chain
+
+  // Shape: [100].
+  %argmax_h2 = "tfrt_test.argmax.f32.2"(%activation2, %ch2) : (!t.tensor, !hex.chain) ->  !t.tensor
+  hex.return %argmax_h2 : !t.tensor
+}
+
+// Single-stream inference latency: one request in flight at a time, so the
+// reported percentiles are pure model latency and Throughput(iters/s) is the
+// single-stream QPS.
+// CHECK-LABEL: --- Running 'benchmark_mnist'
+func @benchmark_mnist() {
+  %path = "tfrt_test.get_string"() { value = "integrationtest/mnist/test_data/mnist_tensors.btf" } : () -> !hex.string
+  %w1_index = hex.constant.i32 0
+  %b1_index = hex.constant.i32 1
+  %w2_index = hex.constant.i32 2
+  %b2_index = hex.constant.i32 3
+  %test_input_features_index = hex.constant.i32 4
+  %test_input_labels_index = hex.constant.i32 5
+  // Shape: [784, 512].
+  %w1 = "btf.read_dense_tensor.f32.2"(%path, %w1_index) : (!hex.string, i32) -> (!t.tensor)
+  // Shape: [512].
+  %b1 = "btf.read_dense_tensor.f32.1"(%path, %b1_index) : (!hex.string, i32) -> (!t.tensor)
+  // Shape: [512, 10].
+  %w2 = "btf.read_dense_tensor.f32.2"(%path, %w2_index) : (!hex.string, i32) -> (!t.tensor)
+  // Shape: [10].
+  %b2 = "btf.read_dense_tensor.f32.1"(%path, %b2_index) : (!hex.string, i32) -> (!t.tensor)
+  // Shape: [100, 784].
+  %test_input_features = "btf.read_dense_tensor.f32.2"(%path, %test_input_features_index) : (!hex.string, i32) -> (!t.tensor)
+  // Shape: [100].
+  %test_input_labels = "btf.read_dense_tensor.i32.1"(%path, %test_input_labels_index) : (!hex.string, i32) -> (!t.tensor)
+  %c = hex.new.chain
+
+  tfrt_test.benchmark "mnist_inference"(
+      %w1 : !t.tensor,
+      %b1 : !t.tensor,
+      %w2 : !t.tensor,
+      %b2 : !t.tensor,
+      %test_input_features : !t.tensor,
+      %test_input_labels : !t.tensor,
+      %c : !hex.chain)
+      duration_secs = 0, max_count = 200, num_warmup_runs = 10 {
+      %prediction = hex.call @mnist_compute(%w1, %b1, %w2, %b2, %test_input_features, %test_input_labels, %c)
+       : (!t.tensor, !t.tensor,
+          !t.tensor, !t.tensor,
+          !t.tensor, !t.tensor,
+          !hex.chain) -> !t.tensor
+
+      hex.return %prediction : !t.tensor
+  }
+
+  hex.return
+}
+// CHECK: BM:mnist_inference:Count: 200
+// CHECK: BM:mnist_inference:Throughput(iters/s):
+// CHECK: BM:mnist_inference:SLO(p99<=1000000us): PASS
+
+// Concurrent inference: four independent requests per iteration, which the
+// executor runs in parallel on the mstd work queue. Comparing this
+// throughput against four times the single-stream number shows how well
+// concurrent model execution scales.
+// CHECK-LABEL: --- Running 'benchmark_mnist_concurrent_x4'
+func @benchmark_mnist_concurrent_x4() {
+  %path = "tfrt_test.get_string"() { value = "integrationtest/mnist/test_data/mnist_tensors.btf" } : () -> !hex.string
+  %w1_index = hex.constant.i32 0
+  %b1_index = hex.constant.i32 1
+  %w2_index = hex.constant.i32 2
+  %b2_index = hex.constant.i32 3
+  %test_input_features_index = hex.constant.i32 4
+  %test_input_labels_index = hex.constant.i32 5
+  %w1 = "btf.read_dense_tensor.f32.2"(%path, %w1_index) : (!hex.string, i32) -> (!t.tensor)
+  %b1 = "btf.read_dense_tensor.f32.1"(%path, %b1_index) : (!hex.string, i32) -> (!t.tensor)
+  %w2 = "btf.read_dense_tensor.f32.2"(%path, %w2_index) : (!hex.string, i32) -> (!t.tensor)
+  %b2 = "btf.read_dense_tensor.f32.1"(%path, %b2_index) : (!hex.string, i32) -> (!t.tensor)
+  %test_input_features = "btf.read_dense_tensor.f32.2"(%path, %test_input_features_index) : (!hex.string, i32) -> (!t.tensor)
+  %test_input_labels = "btf.read_dense_tensor.i32.1"(%path, %test_input_labels_index) : (!hex.string, i32) -> (!t.tensor)
+  %c = hex.new.chain
+
+  tfrt_test.benchmark "mnist_concurrent_x4"(
+      %w1 : !t.tensor,
+      %b1 : !t.tensor,
+      %w2 : !t.tensor,
+      %b2 : !t.tensor,
+      %test_input_features : !t.tensor,
+      %test_input_labels : !t.tensor,
+      %c : !hex.chain)
+      duration_secs = 0, max_count = 100, num_warmup_runs = 5 {
+      %r1 = hex.call @mnist_compute(%w1, %b1, %w2, %b2, %test_input_features, %test_input_labels, %c)
+       : (!t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !t.tensor
+      %r2 = hex.call @mnist_compute(%w1, %b1, %w2, %b2, %test_input_features, %test_input_labels, %c)
+       : (!t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !t.tensor
+      %r3 = hex.call @mnist_compute(%w1, %b1, %w2, %b2, %test_input_features, %test_input_labels, %c)
+       : (!t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !t.tensor
+      %r4 = hex.call @mnist_compute(%w1, %b1, %w2, %b2, %test_input_features, %test_input_labels, %c)
+       : (!t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !t.tensor
+
+      // merge.chains only accepts chains, so turn each prediction into a
+      // chain that becomes available when that request has finished. The
+      // in-place relu on a discarded per-iteration result is a no-op as far
+      // as the benchmark is concerned.
+      %d1 = "tfrt_test.relu_inplace.f32"(%r1, %c) : (!t.tensor, !hex.chain) -> !hex.chain
+      %d2 = "tfrt_test.relu_inplace.f32"(%r2, %c) : (!t.tensor, !hex.chain) -> !hex.chain
+      %d3 = "tfrt_test.relu_inplace.f32"(%r3, %c) : (!t.tensor, !hex.chain) -> !hex.chain
+      %d4 = "tfrt_test.relu_inplace.f32"(%r4, %c) : (!t.tensor, !hex.chain) -> !hex.chain
+      %done = hex.merge.chains %d1, %d2, %d3, %d4
+      hex.return %done : !hex.chain
+  }
+
+  hex.return
+}
+// CHECK: BM:mnist_concurrent_x4:Count: 100
+// CHECK: BM:mnist_concurrent_x4:Throughput(iters/s):
+// CHECK: BM:mnist_concurrent_x4:SLO(p99<=1000000us): PASS
@@ -44,10 +44,15 @@ bool HexAnd(bool arg0, bool arg1) { return arg0 && arg1; }
 //===----------------------------------------------------------------------===//
 
 void RegisterBooleanKernels(KernelRegistry* registry) {
-  registry->AddKernel("hex.constant.i1", TFRT_KERNEL(HexConstantI1));
-  registry->AddKernel("hex.constant.bool", TFRT_KERNEL(HexConstantI1));
-
-  registry->AddKernel("hex.and.i1", TFRT_KERNEL(HexAnd));
+  // Scalar boolean kernels are tiny: runs of them are kept inline by the
+  // executor rather than dispatched through the work queue.
+  registry->AddKernel("hex.constant.i1", TFRT_KERNEL(HexConstantI1),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.constant.bool", TFRT_KERNEL(HexConstantI1),
+                      KernelCostClass::kTiny);
+
+  registry->AddKernel("hex.and.i1", TFRT_KERNEL(HexAnd),
+                      KernelCostClass::kTiny);
 }
 
 }  // namespace tfrt
@@ -37,13 +37,13 @@ static void HexMergeChains(Argument<Chain> chain_in,
 }
 
 static void HexCall(RemainingArguments args, RemainingResults results,
-                    Attribute<Function> fn, HostContext* host) {
+                    Attribute<Function> fn, const ExecutionContext& exec_ctx) {
   assert(fn->argument_types().size() == args.size() &&
          "argument count mismatch");
   assert(fn->result_types().size() == results.size() &&
          "result count mismatch");
 
-  fn->Execute(args.values(), results.values(), host);
+  fn->Execute(exec_ctx, args.values(), results.values());
 }
 
 // hex.if dispatches to a 'true' or 'false' function based on a condition.
@@ -61,7 +61,8 @@ static void HexCall(RemainingArguments args, RemainingResults results,
 // hex.if to make an invocation non-strict.
 static void HexIf(RemainingArguments args, RemainingResults results,
                   Attribute<Function> true_fn_const,
-                  Attribute<Function> false_fn_const, HostContext* host) {
+                  Attribute<Function> false_fn_const,
+                  const ExecutionContext& exec_ctx) {
   assert(args.size() > 0);
 
   const Function* true_fn = &(*true_fn_const);
@@ -75,9 +76,9 @@ static void HexIf(RemainingArguments args, RemainingResults results,
          true_fn->result_types() == false_fn->result_types() &&
          "true and false function types need to line up");
 
-  auto if_impl = [host](const Function* true_fn, const Function* false_fn,
-                        ArrayRef<AsyncValue*> args,
-                        MutableArrayRef<RCReference<AsyncValue>> results) {
+  auto if_impl = [exec_ctx](const Function* true_fn, const Function* false_fn,
+                            ArrayRef<AsyncValue*> args,
+                            MutableArrayRef<RCReference<AsyncValue>> results) {
     AsyncValue* condition = args[0];
     // If we have an error, then we can force propagate errors to all the
     // results.
@@ -88,7 +89,7 @@ static void HexIf(RemainingArguments args, RemainingResults results,
 
     // Otherwise, we know which way to go.
     const Function* fn = condition->get<bool>() ? true_fn : false_fn;
-    fn->Execute(args.drop_front(), results, host);
+    fn->Execute(exec_ctx, args.drop_front(), results);
   };
 
   // If the condition is already available, we can immediately dispatch the
@@ -141,8 +142,9 @@ static void HexIf(RemainingArguments args, RemainingResults results,
 // This is a helper function that runs a block of iterations and sets up a
 // callback to run the next block at the end.
 static void HexRepeatI32Block(
-    int32_t start, int32_t block_size, int32_t count_value, HostContext* host,
-    RCReference<const Function> body_fn_ref, RCArray<AsyncValue> args,
+    int32_t start, int32_t block_size, int32_t count_value,
+    ExecutionContext exec_ctx, RCReference<const Function> body_fn_ref,
+    RCArray<AsyncValue> args,
     SmallVector<RCReference<IndirectAsyncValue>, 4>&& result_refs) {
   // Temporary buffers to store intermediate arguments and results.
   SmallVector<AsyncValue*, 8> passed_args(args.values().begin(),
@@ -155,7 +157,9 @@ static void HexRepeatI32Block(
   auto end = std::min(start + block_size, count_value);
 
   for (int i = start; i < end; ++i) {
-    if (auto cancel_av = host->GetCancelAsyncValue()) {
+    AsyncValue* cancel_av = exec_ctx.GetCancelAsyncValue();
+    if (!cancel_av) cancel_av = exec_ctx.host()->GetCancelAsyncValue();
+    if (cancel_av) {
       // Cancellation detected. DropRef on args if needed, set results to
       // the cancel async value, and break out.
       for (int arg = 0; arg != num_fn_args; ++arg) {
@@ -171,7 +175,7 @@ static void HexRepeatI32Block(
       return;
     }
 
-    body_fn_ref->Execute(passed_args, results, host);
+    body_fn_ref->Execute(exec_ctx, passed_args, results);
 
     for (int arg = 0; arg != num_fn_args; ++arg) {
       // If this is not the first iteration, destroy the loop-carried
@@ -197,11 +201,11 @@ static void HexRepeatI32Block(
   } else {
     assert(num_fn_args > 0);
     passed_args[0]->AndThen(
-        [end, block_size, count_value, host,
+        [end, block_size, count_value, exec_ctx = std::move(exec_ctx),
          body_fn_ref = std::move(body_fn_ref),
          arg_refs = RCArray<AsyncValue>(llvm::makeArrayRef(passed_args)),
          result_refs = std::move(result_refs)]() mutable {
-          HexRepeatI32Block(end, block_size, count_value, host,
+          HexRepeatI32Block(end, block_size, count_value, std::move(exec_ctx),
                             std::move(body_fn_ref), std::move(arg_refs),
                             std::move(result_refs));
         });
@@ -211,7 +215,8 @@ static void HexRepeatI32Block(
 // This takes a single i32 iteration count, plus arguments that are passed to
 // the body_fn and eventually returned.
 static void HexRepeatI32(RemainingArguments args, RemainingResults results,
-                         Attribute<Function> body_fn_const, HostContext* host) {
+                         Attribute<Function> body_fn_const,
+                         const ExecutionContext& exec_ctx) {
   assert(args.size() > 0 && args.size() - 1 == results.size());
 
   const Function* body_fn = &(*body_fn_const);
@@ -221,7 +226,7 @@ static void HexRepeatI32(RemainingArguments args, RemainingResults results,
          "Argument and result types of repeat body_fn must match");
 
   auto while_impl =
-      [host](
+      [exec_ctx](
           RCReference<const Function> body_fn_ref, RCArray<AsyncValue> arg_refs,
           SmallVector<RCReference<IndirectAsyncValue>, 4> result_refs) mutable {
         // TODO(xldrx,jingdong): Get the block_size from an optional attribute.
@@ -259,7 +264,7 @@ static void HexRepeatI32(RemainingArguments args, RemainingResults results,
         // Run 'body_fn' at least once.
         assert(count_value > 0);
 
-        HexRepeatI32Block(0, block_size, count_value, host,
+        HexRepeatI32Block(0, block_size, count_value, exec_ctx,
                           std::move(body_fn_ref), RCArray<AsyncValue>(args),
                           std::move(result_refs));
       };
@@ -299,6 +304,184 @@ static void HexRepeatI32(RemainingArguments args, RemainingResults results,
   }
 }
 
+// This is a helper function that drives the pipelined repeat. It issues
+// iterations eagerly - passing iteration i's (possibly unavailable) results
+// directly as iteration i+1's arguments - and only pauses when max_in_flight
+// issued iterations have not yet retired. An iteration is considered retired
+// when its first result becomes available.
+static void HexRepeatI32PipelinedDriver(
+    int32_t next, int32_t count_value, int32_t max_in_flight,
+    ExecutionContext exec_ctx, RCReference<const Function> body_fn_ref,
+    RCArray<AsyncValue> args, SmallVector<RCReference<AsyncValue>, 8> in_flight,
+    SmallVector<RCReference<IndirectAsyncValue>, 4>&& result_refs) {
+  // Temporary buffers to store intermediate arguments and results.
+  SmallVector<AsyncValue*, 8> passed_args(args.values().begin(),
+                                          args.values().end());
+
+  SmallVector<RCReference<AsyncValue>, 4> results;
+  results.resize(result_refs.size());
+  auto num_fn_args = args.size();
+
+  for (int i = next; i < count_value; ++i) {
+    AsyncValue* cancel_av = exec_ctx.GetCancelAsyncValue();
+    if (!cancel_av) cancel_av = exec_ctx.host()->GetCancelAsyncValue();
+    if (cancel_av) {
+      // Cancellation detected. DropRef on args if needed, set results to
+      // the cancel async value, and break out.
+      for (int arg = 0; arg != num_fn_args; ++arg) {
+        // If this is not the first iteration, destroy the loop-carried
+        // args. The first iteration uses the caller's args, which we
+        // can't destroy.
+        if (i > 0) passed_args[arg]->DropRef();
+      }
+
+      for (auto& result : result_refs) {
+        result->ForwardTo(FormRef(cancel_av));
+      }
+      return;
+    }
+
+    // Retire the iterations that have already completed.
+    while (!in_flight.empty() && in_flight.front()->IsAvailable())
+      in_flight.erase(in_flight.begin());
+
+    // If the pipeline is full, come back when the oldest in-flight iteration
+    // retires.
+    if (in_flight.size() >= max_in_flight) {
+      AsyncValue* oldest = in_flight.front().get();
+      oldest->AndThen(
+          [i, count_value, max_in_flight, exec_ctx = std::move(exec_ctx),
+           body_fn_ref = std::move(body_fn_ref),
+           arg_refs = RCArray<AsyncValue>(llvm::makeArrayRef(passed_args)),
+           in_flight = std::move(in_flight),
+           result_refs = std::move(result_refs)]() mutable {
+            HexRepeatI32PipelinedDriver(i, count_value, max_in_flight,
+                                        std::move(exec_ctx),
+                                        std::move(body_fn_ref),
+                                        std::move(arg_refs),
+                                        std::move(in_flight),
+                                        std::move(result_refs));
+          });
+      return;
+    }
+
+    // Issue the next iteration without waiting for its arguments: the body
+    // function accepts unavailable arguments, so iteration i+1's head can
+    // overlap iteration i's async tail.
+    body_fn_ref->Execute(exec_ctx, passed_args, results);
+
+    if (num_fn_args > 0) in_flight.push_back(results[0].CopyRef());
+
+    for (int arg = 0; arg != num_fn_args; ++arg) {
+      // If this is not the first iteration, destroy the loop-carried
+      // args. The first iteration uses the caller's args, which we
+      // can't destroy.
+      if (i > 0) passed_args[arg]->DropRef();
+
+      // If this is not the last iteration, set up for the next
+      // iteration by copying this iteration's results to the next
+      // iteration's args.
+      if (i + 1 != count_value) {
+        passed_args[arg] = results[arg].release();
+      }
+    }
+  }
+
+  // Forward result_refs to the actual result values from the last iteration.
+  for (int i = 0, e = result_refs.size(); i != e; ++i) {
+    result_refs[i]->ForwardTo(std::move(results[i]));
+  }
+}
+
+// This is a pipelined variant of hex.repeat.i32 for throughput loops: instead
+// of draining all issued iterations before starting new ones, it keeps up to
+// max_in_flight iterations in flight at once. The loop-carried dependence is
+// still respected - iteration i+1 consumes iteration i's result values - but
+// issuing does not wait for them to become available.
+static void HexRepeatI32Pipelined(RemainingArguments args,
+                                  RemainingResults results,
+                                  Attribute<Function> body_fn_const,
+                                  const ExecutionContext& exec_ctx) {
+  assert(args.size() > 0 && args.size() - 1 == results.size());
+
+  const Function* body_fn = &(*body_fn_const);
+
+  // Repeat gets a single function constant for its body_fn.
+  assert(body_fn->argument_types() == body_fn->result_types() &&
+         "Argument and result types of repeat body_fn must match");
+
+  auto repeat_impl =
+      [exec_ctx](
+          RCReference<const Function> body_fn_ref, RCArray<AsyncValue> arg_refs,
+          SmallVector<RCReference<IndirectAsyncValue>, 4> result_refs) mutable {
+        // TODO(xldrx,jingdong): Get max_in_flight from an optional attribute.
+        int32_t max_in_flight = 4;
+        auto args = arg_refs.values();
+        auto* count = args[0];
+        args = args.drop_front();
+
+        // If we have an error, then we can force propagate errors to all the
+        // results.
+        if (count->IsError()) {
+          for (auto& result : result_refs) {
+            result->ForwardTo(FormRef(count));
+          }
+          return;
+        }
+
+        auto count_value = count->get<int32_t>();
+        auto num_fn_args = args.size();
+
+        // Special case: "Repeat 0" just copies args to results.
+        if (count_value == 0) {
+          for (int arg = 0; arg != num_fn_args; ++arg) {
+            result_refs[arg]->ForwardTo(FormRef(args[arg]));
+          }
+          return;
+        }
+
+        assert(result_refs.size() == num_fn_args);
+        assert(count_value > 0);
+
+        HexRepeatI32PipelinedDriver(0, count_value, max_in_flight, exec_ctx,
+                                    std::move(body_fn_ref),
+                                    RCArray<AsyncValue>(args), {},
+                                    std::move(result_refs));
+      };
+
+  AsyncValue* count = args[0];
+
+  // Copy `args` and add a ref to each arg. These refs will be dropped when the
+  // RCArray is destroyed. arg_refs is captured by the lambda so the kernel's
+  // arguments will be available when the closure runs.
+  RCArray<AsyncValue> arg_refs(args.values());
+
+  // Create a RCRef of Function to extend its lifetime into the lambda.
+  RCReference<const Function> body_fn_ref = FormRef(body_fn);
+
+  // Define results as IndirectAsync values. The actual results is set in the
+  // last iteration of the loop.
+  SmallVector<RCReference<IndirectAsyncValue>, 4> result_refs;
+  result_refs.reserve(results.size());
+  for (int i = 0, e = results.size(); i != e; ++i) {
+    auto result = results.AllocateIndirectResultAt(i);
+    result_refs.push_back(std::move(result));
+  }
+
+  // Dispatch when the count becomes available.
+  if (count->IsAvailable()) {
+    repeat_impl(std::move(body_fn_ref), std::move(arg_refs),
+                std::move(result_refs));
+  } else {
+    count->AndThen([repeat_impl, body_fn_ref = std::move(body_fn_ref),
+                    arg_refs = std::move(arg_refs),
+                    result_refs = std::move(result_refs)]() mutable {
+      repeat_impl(std::move(body_fn_ref), std::move(arg_refs),
+                  std::move(result_refs));
+    });
+  }
+}
+
 // This kernel takes a Chain and an AsyncValue. Then it returns the same
 // AsyncValue. A function can use this kernel to return a value that depends on
 // a given chain.
@@ -315,6 +498,8 @@ void RegisterControlFlowKernels(KernelRegistry* registry) {
   registry->AddKernel("hex.merge.chains", TFRT_KERNEL(HexMergeChains));
   registry->AddKernel("hex.alias.value", TFRT_KERNEL(HexAliasValue));
   registry->AddKernel("hex.repeat.i32", TFRT_KERNEL(HexRepeatI32));
+  registry->AddKernel("hex.repeat.i32.pipelined",
+                      TFRT_KERNEL(HexRepeatI32Pipelined));
   registry->AddKernel("hex.call", TFRT_KERNEL(HexCall));
   registry->AddKernel("hex.if", TFRT_KERNEL(HexIf));
 }
@@ -116,32 +116,50 @@ static Tout HexCast(Tin value) {
 //===----------------------------------------------------------------------===//
 
 void RegisterIntegerKernels(KernelRegistry* registry) {
-  registry->AddKernel("hex.constant.i32", TFRT_KERNEL(HexConstant<int32_t>));
-  registry->AddKernel("hex.constant.i64", TFRT_KERNEL(HexConstant<int64_t>));
-
-  registry->AddKernel("hex.add.i32", TFRT_KERNEL(HexAdd<int32_t>));
-  registry->AddKernel("hex.add.i64", TFRT_KERNEL(HexAdd<int64_t>));
-
-  registry->AddKernel("hex.minus.i32", TFRT_KERNEL(HexMinus<int32_t>));
-  registry->AddKernel("hex.minus.i64", TFRT_KERNEL(HexMinus<int64_t>));
-
-  registry->AddKernel("hex.equal.i32", TFRT_KERNEL(HexEqual<int32_t>));
-  registry->AddKernel("hex.equal.i64", TFRT_KERNEL(HexEqual<int64_t>));
-
-  registry->AddKernel("hex.lessequal.i32", TFRT_KERNEL(HexLessEqual<int32_t>));
-  registry->AddKernel("hex.lessequal.i64", TFRT_KERNEL(HexLessEqual<int64_t>));
-
-  registry->AddKernel("hex.div.i32", TFRT_KERNEL(HexDiv<int32_t>));
-  registry->AddKernel("hex.div.i64", TFRT_KERNEL(HexDiv<int64_t>));
+  // These kernels do a few instructions of scalar arithmetic, so they are
+  // registered as tiny: the executor keeps runs of them inline instead of
+  // paying work queue overhead per kernel. The print kernels do I/O and stay
+  // at the default cost class.
+  registry->AddKernel("hex.constant.i32", TFRT_KERNEL(HexConstant<int32_t>),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.constant.i64", TFRT_KERNEL(HexConstant<int64_t>),
+                      KernelCostClass::kTiny);
+
+  registry->AddKernel("hex.add.i32", TFRT_KERNEL(HexAdd<int32_t>),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.add.i64", TFRT_KERNEL(HexAdd<int64_t>),
+                      KernelCostClass::kTiny);
+
+  registry->AddKernel("hex.minus.i32", TFRT_KERNEL(HexMinus<int32_t>),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.minus.i64", TFRT_KERNEL(HexMinus<int64_t>),
+                      KernelCostClass::kTiny);
+
+  registry->AddKernel("hex.equal.i32", TFRT_KERNEL(HexEqual<int32_t>),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.equal.i64", TFRT_KERNEL(HexEqual<int64_t>),
+                      KernelCostClass::kTiny);
+
+  registry->AddKernel("hex.lessequal.i32", TFRT_KERNEL(HexLessEqual<int32_t>),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.lessequal.i64", TFRT_KERNEL(HexLessEqual<int64_t>),
+                      KernelCostClass::kTiny);
+
+  registry->AddKernel("hex.div.i32", TFRT_KERNEL(HexDiv<int32_t>),
+                      KernelCostClass::kTiny);
+  registry->AddKernel("hex.div.i64", TFRT_KERNEL(HexDiv<int64_t>),
+                      KernelCostClass::kTiny);
 
   registry->AddKernel("hex.print.i1", TFRT_KERNEL(HexPrintI1));
   registry->AddKernel("hex.print.i32", TFRT_KERNEL(HexPrintI32));
   registry->AddKernel("hex.print.i64", TFRT_KERNEL(HexPrintI64));
 
   registry->AddKernel("hex.cast.i64_to_f64",
-                      TFRT_KERNEL(HexCast<int64_t, double>));
+                      TFRT_KERNEL(HexCast<int64_t, double>),
+                      KernelCostClass::kTiny);
   registry->AddKernel("hex.cast.f64_to_i64",
-                      TFRT_KERNEL(HexCast<double, int64_t>));
+                      TFRT_KERNEL(HexCast<double, int64_t>),
+                      KernelCostClass::kTiny);
 }
 
 }  // namespace tfrt
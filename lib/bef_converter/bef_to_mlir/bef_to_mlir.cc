@@ -1183,6 +1183,17 @@ mlir::Operation* BEFFunctionReader::ReadKernel(ArrayRef<uint32_t> kernels,
         attr_name = std::string(*n);
       }
     }
+    // Inline attributes carry their scalar value in the kernel entry word;
+    // the offset of the equivalent attributes-section entry follows the name
+    // in the attribute names section.
+    if (i < kNumInlineAttributeBits &&
+        (kernel.special_metadata() & (1u << (kInlineAttributeShift + i)))) {
+      if (attribute_names->ReadInt(&attribute_offset)) {
+        EmitError(bef_file_.location,
+                  "Missing attribute offset for inline attribute.");
+        return nullptr;
+      }
+    }
     auto attr = bef_file_.GetAttribute(attribute_offset);
     if (!attr)
       // Use dummy values for unknown attributes.
@@ -27,9 +27,15 @@
 
 #include "tfrt/bef_converter/mlir_to_bef.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <thread>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -43,6 +49,7 @@
 #include "mlir/IR/StandardTypes.h"
 #include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/hash_util.h"
 
 #ifdef DEBUG_MLIR_TO_BEF
 #define DEBUG_PRINT(...) fprintf(stderr, __VA_ARGS__)
@@ -685,6 +692,13 @@ namespace {
 // this tracks the alignment requirement of the contents.  If this is a
 // subsection of the file, then the enclosing container is required to provide
 // at least this alignment.
+//
+// The first kInlineCapacity bytes are stored inline, so the many tiny
+// emitters created per kernel and per function never touch the heap.  Once an
+// emitter outgrows the inline storage it spills to the vector, which then
+// grows geometrically; ReserveHint lets callers that know how many bytes are
+// coming (e.g. when concatenating already-emitted chunks) size that vector in
+// one step instead of paying several realloc copies.
 class BEFEmitter {
  public:
   static constexpr uint8_t kDummyByte = 0xCC;
@@ -698,11 +712,43 @@ class BEFEmitter {
   // Return the alignment required by this chunk of a BEF file.
   unsigned GetRequiredAlignment() const { return required_alignment_; }
 
-  size_t size() const { return result_.size(); }
+  // Return the number of bytes emitted so far, including any bytes already
+  // handed out by TakeFlushedChunk.  This keeps offsets and alignment
+  // computations file-absolute across flushes.
+  size_t size() const { return flushed_size_ + buffered_size(); }
+
+  // Make room for at least num_bytes of upcoming emission.  Spills the inline
+  // storage if needed and grows the spilled vector by at least a factor of
+  // two, so a stream of small hints still gives geometric growth.
+  void ReserveHint(size_t num_bytes) {
+    size_t needed = buffered_size() + num_bytes;
+    if (!spilled_) {
+      if (needed > kInlineCapacity) Spill(needed);
+      return;
+    }
+    if (needed > result_.capacity())
+      result_.reserve(std::max(needed, result_.capacity() * 2));
+  }
 
-  void EmitByte(uint8_t byte) { result_.push_back(byte); }
+  void EmitByte(uint8_t byte) {
+    if (!spilled_) {
+      if (inline_size_ < kInlineCapacity) {
+        inline_buffer_[inline_size_++] = byte;
+        return;
+      }
+      Spill(kInlineCapacity + 1);
+    }
+    result_.push_back(byte);
+  }
 
   void EmitBytes(llvm::ArrayRef<uint8_t> bytes) {
+    if (bytes.empty()) return;
+    ReserveHint(bytes.size());
+    if (!spilled_) {
+      memcpy(inline_buffer_ + inline_size_, bytes.data(), bytes.size());
+      inline_size_ += bytes.size();
+      return;
+    }
     result_.insert(result_.end(), bytes.begin(), bytes.end());
   }
 
@@ -751,7 +797,9 @@ class BEFEmitter {
   void EmitInt(size_t value) { EmitIntImpl(value, false); }
   // Emit a vbr encoded integer with low byte first
   void EmitIntLowByteFirst(size_t value) {
-    EmitBEFArrayLength(value, &result_);
+    llvm::SmallVector<uint8_t, 8> bytes;
+    EmitBEFArrayLength(value, &bytes);
+    EmitBytes(bytes);
   }
 
   // Many parts of the emitter logic includes forward references into stuff
@@ -760,15 +808,22 @@ class BEFEmitter {
   // constructed, ensuring that alignment requirements of the nested emitter
   // are maintained correctly.
   void EmitEmitter(const BEFEmitter& emitter) {
+    // Reserve for the payload and any alignment padding in one step, so
+    // concatenating many nested emitters does at most one realloc each.
+    ReserveHint(emitter.buffered_size() + emitter.GetRequiredAlignment());
     EmitAlignment(emitter.GetRequiredAlignment());
-    EmitBytes(emitter.result_);
+    EmitBytes(emitter.result());
   }
 
   void EmitSection(BEFSectionID section_id,
                    llvm::ArrayRef<uint8_t> section_data,
                    unsigned alignment = 1) {
+    // The section header is at most the id, a vbr length, the alignment byte
+    // and the alignment padding.
+    ReserveHint(section_data.size() + 16 + alignment);
+
     // Section start with an identifier.
-    result_.push_back(static_cast<uint8_t>(section_id));
+    EmitByte(static_cast<uint8_t>(section_id));
 
     bool has_alignment = alignment > 1;
 
@@ -792,10 +847,46 @@ class BEFEmitter {
   }
 
   void EmitSection(BEFSectionID section_id, const BEFEmitter& emitter) {
-    EmitSection(section_id, emitter.result_, emitter.GetRequiredAlignment());
+    EmitSection(section_id, emitter.result(), emitter.GetRequiredAlignment());
+  }
+
+  std::vector<uint8_t> TakeResult() {
+    if (!spilled_)
+      return std::vector<uint8_t>(inline_buffer_, inline_buffer_ + inline_size_);
+    return std::move(result_);
+  }
+
+  // For streaming emission: return the bytes buffered since the last call and
+  // release their memory.  size() keeps counting them so later offsets stay
+  // file-absolute, but MoveResult/SetResult/TruncateResult and result() must
+  // not be used to reach back into flushed bytes.
+  std::vector<uint8_t> TakeFlushedChunk() {
+    std::vector<uint8_t> chunk;
+    if (!spilled_) {
+      chunk.assign(inline_buffer_, inline_buffer_ + inline_size_);
+      inline_size_ = 0;
+    } else {
+      std::swap(chunk, result_);
+      spilled_ = false;
+    }
+    flushed_size_ += chunk.size();
+    return chunk;
   }
 
-  std::vector<uint8_t> TakeResult() { return std::move(result_); }
+  // Return the bytes emitted so far.
+  llvm::ArrayRef<uint8_t> result() const {
+    return llvm::makeArrayRef(data(), buffered_size());
+  }
+
+  // Discard all bytes at and after offset. Only valid if nothing emitted yet
+  // refers to the discarded bytes.
+  void TruncateResult(size_t offset) {
+    assert(offset <= buffered_size());
+    if (!spilled_)
+      inline_size_ = offset;
+    else
+      result_.resize(offset);
+  }
 
   // Move size bytes in the result from src_offset to dst_offset.
   void MoveResult(size_t dst_offset, size_t src_offset, size_t size);
@@ -804,20 +895,49 @@ class BEFEmitter {
   void SetResult(size_t offset, uint8_t value, size_t size);
 
  private:
+  // Most nested emitters (per-kernel bodies, attribute/function operand
+  // lists) stay under this size, so they never allocate.
+  static constexpr size_t kInlineCapacity = 64;
+
   void EmitIntImpl(size_t value, bool is_high_part);
+
+  const uint8_t* data() const {
+    return spilled_ ? result_.data() : inline_buffer_;
+  }
+  uint8_t* data() { return spilled_ ? result_.data() : inline_buffer_; }
+  size_t buffered_size() const {
+    return spilled_ ? result_.size() : inline_size_;
+  }
+
+  // Move the inline bytes into the heap vector, with capacity for at least
+  // min_capacity bytes.
+  void Spill(size_t min_capacity) {
+    assert(!spilled_);
+    result_.reserve(std::max(min_capacity, 2 * kInlineCapacity));
+    result_.assign(inline_buffer_, inline_buffer_ + inline_size_);
+    inline_size_ = 0;
+    spilled_ = true;
+  }
+
   // Keep track of the alignment required for the start of this object.
   unsigned required_alignment_ = 1;
+  // Number of bytes already handed out by TakeFlushedChunk.
+  size_t flushed_size_ = 0;
+  // Whether emission has outgrown inline_buffer_ and moved to result_.
+  bool spilled_ = false;
+  size_t inline_size_ = 0;
+  uint8_t inline_buffer_[kInlineCapacity];
   std::vector<uint8_t> result_;
 };
 
 }  // namespace
 
 void BEFEmitter::MoveResult(size_t dst_offset, size_t src_offset, size_t size) {
-  memmove(result_.data() + dst_offset, result_.data() + src_offset, size);
+  memmove(data() + dst_offset, data() + src_offset, size);
 }
 
 void BEFEmitter::SetResult(size_t offset, uint8_t value, size_t size) {
-  memset(result_.data() + offset, value, size);
+  memset(data() + offset, value, size);
 }
 
 // Our fundamental unit is a bytestream, but we want to be able to emit large
@@ -826,26 +946,37 @@ void BEFEmitter::SetResult(size_t offset, uint8_t value, size_t size) {
 void BEFEmitter::EmitIntImpl(size_t value, bool is_high_part) {
   if ((value >> 7) != 0) EmitIntImpl(value >> 7, /*is_high_part=*/true);
 
-  result_.push_back(
-      static_cast<uint8_t>((value & 127) | (is_high_part ? 128 : 0)));
+  EmitByte(static_cast<uint8_t>((value & 127) | (is_high_part ? 128 : 0)));
 }
 
-// This is the emitter that builds a BEF into an std::vector.
+// This is the emitter that builds a BEF into an std::vector, or streams it
+// through a BEFBytesSink when one is provided.
 class BEFModuleEmitter : public BEFEmitter {
  public:
-  explicit BEFModuleEmitter(mlir::ModuleOp module) : module_(module) {}
+  explicit BEFModuleEmitter(mlir::ModuleOp module,
+                            BEFBytesSink* sink = nullptr)
+      : module_(module), sink_(sink) {}
 
   LogicalResult CollectEntities(bool collect_attribute_types_and_names) {
     return entities_.Collect(module_, collect_attribute_types_and_names);
   }
 
-  void EmitFormatVersion();
+  // Hand the bytes buffered since the last flush to the sink, if one was
+  // provided.  Returns false if the sink reported a write failure.
+  bool Flush() {
+    if (!sink_) return true;
+    auto chunk = TakeFlushedChunk();
+    return chunk.empty() || sink_->Write(chunk);
+  }
+
+  void EmitFormatVersion(uint8_t version);
   void EmitLocationInfo();
   void EmitStrings();
   void EmitAttributes(BEFEmitter* attribute_types);
   void EmitKernels();
   void EmitTypes();
-  void EmitFunctions(BEFEmitter* attribute_names, BEFEmitter* register_types);
+  void EmitFunctions(BEFEmitter* attribute_names, BEFEmitter* register_types,
+                     int num_threads, bool compact_function_bodies);
   void EmitFunctionIndex();
   void EmitAttributeTypes(const BEFEmitter& attribute_types);
   void EmitAttributeNames(const BEFEmitter& attribute_names);
@@ -853,12 +984,12 @@ class BEFModuleEmitter : public BEFEmitter {
 
  private:
   mlir::ModuleOp module_;
+  BEFBytesSink* sink_;
   EntityTable entities_;
   EntityIndex entity_index_;
 };
 
-void BEFModuleEmitter::EmitFormatVersion() {
-  uint8_t version = kBEFVersion0;
+void BEFModuleEmitter::EmitFormatVersion(uint8_t version) {
   EmitSection(BEFSectionID::kFormatVersion, version);
 }
 
@@ -953,6 +1084,32 @@ class BEFAttributesEmitter : public BEFEmitter {
   BEFEmitter& attribute_type_emitter_;
 
   int num_attributes_ = 0;
+
+  // Content deduplication state.  MLIR uniques structurally equal attributes
+  // within a context, and EmitAttribute exploits that, but attribute payloads
+  // with identical bytes can still be emitted many times for attributes that
+  // are distinct at the MLIR level, e.g. signed and signless integers of the
+  // same width and value, or splat and explicit dense attributes with the
+  // same elements.  The maps below let a later occurrence reuse the offset of
+  // an earlier payload with the same bytes.  Only self-contained leaf
+  // payloads are deduplicated; arrays and aggregates are not, since emitting
+  // them has side effects on the entity index.
+  //
+  // Scalar payloads are keyed by (BEF attribute type, payload value) rather
+  // than by bytes alone: the attribute types section maps each offset to one
+  // type, so sharing an offset between e.g. a kI64 and a bit-identical kF64
+  // would make decoding ambiguous.  Reused offsets keep their natural
+  // alignment because the original emission aligned them.
+  llvm::DenseMap<std::pair<uint64_t, uint64_t>, size_t> scalar_offsets_;
+  llvm::StringMap<size_t> string_offsets_;
+  // Dense element payloads are emitted first and matched afterwards by a hash
+  // of the emitted region, keeping a list of (offset, length) per hash value
+  // to resolve collisions by byte comparison.
+  llvm::DenseMap<uint64_t, llvm::SmallVector<std::pair<size_t, size_t>, 1>>
+      dense_offsets_;
+  // Deduplication must be suspended while emitting the elements of a typed
+  // array or dense elements attribute, which have to stay consecutive.
+  bool dedup_enabled_ = true;
 };
 size_t BEFAttributesEmitter::EmitAttribute(mlir::Attribute attr) {
   // Since there might be nested array attributes, they might have been already
@@ -1018,22 +1175,28 @@ OffsetAndType BEFAttributesEmitter::EmitStandardAttribute(
 }
 
 OffsetAndType BEFAttributesEmitter::EmitBoolAttribute(bool value) {
+  auto key = std::make_pair(
+      static_cast<uint64_t>(BEFAttributeType::kBool), uint64_t{value});
+  if (dedup_enabled_) {
+    auto it = scalar_offsets_.find(key);
+    if (it != scalar_offsets_.end())
+      return {it->second, BEFAttributeType::kBool};
+  }
+
   auto offset = size();
   EmitByte(static_cast<uint8_t>(value));
+  if (dedup_enabled_) scalar_offsets_[key] = offset;
   return {offset, BEFAttributeType::kBool};
 }
 
 OffsetAndType BEFAttributesEmitter::EmitIntegerAttribute(
     const llvm::APInt& value) {
-  if (value.getBitWidth() == 1) {
-    auto offset = size();
-    EmitByte(static_cast<uint8_t>(value.getLimitedValue()));
-    return {offset, BEFAttributeType::kI1};
-  }
-
   BEFAttributeType attribute_type;
   int bytes;
-  if (value.getBitWidth() == 32) {
+  if (value.getBitWidth() == 1) {
+    bytes = 1;
+    attribute_type = BEFAttributeType::kI1;
+  } else if (value.getBitWidth() == 32) {
     bytes = 4;
     attribute_type = BEFAttributeType::kI32;
   } else {
@@ -1042,29 +1205,57 @@ OffsetAndType BEFAttributesEmitter::EmitIntegerAttribute(
     attribute_type = BEFAttributeType::kI64;
   }
 
+  uint64_t v = value.getLimitedValue();
+  auto key = std::make_pair(static_cast<uint64_t>(attribute_type), v);
+  if (dedup_enabled_) {
+    auto it = scalar_offsets_.find(key);
+    if (it != scalar_offsets_.end()) return {it->second, attribute_type};
+  }
+
   EmitAlignment(bytes);
 
   auto offset = size();
 
-  uint64_t v = value.getLimitedValue();
   for (unsigned i = 0; i != bytes; ++i) {
     EmitByte(static_cast<uint8_t>(v & 255));
     v >>= 8;
   }
+  if (dedup_enabled_) scalar_offsets_[key] = offset;
   return {offset, attribute_type};
 }
 
 OffsetAndType BEFAttributesEmitter::EmitFloatAttribute(
     mlir::FloatAttr float_attr) {
   llvm::APInt int_val = float_attr.getValue().bitcastToAPInt();
-  auto offset_and_type = EmitIntegerAttribute(int_val);
 
   // TODO(chky): add support for other float types.
   auto type = float_attr.getType();
-  if (type.isF32()) return {offset_and_type.offset, BEFAttributeType::kF32};
-  if (type.isF64()) return {offset_and_type.offset, BEFAttributeType::kF64};
+  BEFAttributeType attribute_type;
+  if (type.isF32()) {
+    attribute_type = BEFAttributeType::kF32;
+  } else if (type.isF64()) {
+    attribute_type = BEFAttributeType::kF64;
+  } else {
+    llvm_unreachable("unknown type for float attributes.");
+  }
+
+  auto key = std::make_pair(static_cast<uint64_t>(attribute_type),
+                            int_val.getLimitedValue());
+  if (dedup_enabled_) {
+    auto it = scalar_offsets_.find(key);
+    if (it != scalar_offsets_.end()) return {it->second, attribute_type};
+  }
+
+  // Suspend deduplication around the integer emission so the payload does not
+  // get shared with (or registered as) an integer attribute of the same bit
+  // pattern.
+  bool saved_dedup_enabled = dedup_enabled_;
+  dedup_enabled_ = false;
+  auto offset_and_type = EmitIntegerAttribute(int_val);
+  dedup_enabled_ = saved_dedup_enabled;
 
-  llvm_unreachable("unknown type for float attributes.");
+  if (dedup_enabled_) scalar_offsets_[key] = offset_and_type.offset;
+  return {offset_and_type.offset, attribute_type};
 }
 
 OffsetAndType BEFAttributesEmitter::EmitStringAttribute(string_view value) {
@@ -1073,20 +1264,40 @@ OffsetAndType BEFAttributesEmitter::EmitStringAttribute(string_view value) {
   // length.  The string passed to the function points to the start of the data,
   // but the bytes before it specify how long the string is.  To enforce this
   // notion, we don't emit a zero byte at the end of the string data.
+  if (dedup_enabled_) {
+    // An earlier string with the same contents also has the same length
+    // prefix before its offset, so its payload can be shared outright.
+    auto it = string_offsets_.find(value);
+    if (it != string_offsets_.end())
+      return {it->second, BEFAttributeType::kString};
+  }
+
   EmitIntLowByteFirst(value.size());
 
   size_t offset = size();
   EmitBytes(llvm::ArrayRef<uint8_t>(
       reinterpret_cast<const uint8_t*>(value.data()), value.size()));
 
+  if (dedup_enabled_) string_offsets_[value] = offset;
   return {offset, BEFAttributeType::kString};
 }
 
 OffsetAndType BEFAttributesEmitter::EmitTypeAttribute(
     mlir::TypeAttr type_attr) {
+  auto encoding =
+      static_cast<uint8_t>(EncodeTypeAttribute(type_attr.getValue()));
+  auto key = std::make_pair(
+      static_cast<uint64_t>(BEFAttributeType::kType), uint64_t{encoding});
+  if (dedup_enabled_) {
+    auto it = scalar_offsets_.find(key);
+    if (it != scalar_offsets_.end())
+      return {it->second, BEFAttributeType::kType};
+  }
+
   size_t offset = size();
 
-  EmitByte(static_cast<uint8_t>(EncodeTypeAttribute(type_attr.getValue())));
+  EmitByte(encoding);
+  if (dedup_enabled_) scalar_offsets_[key] = offset;
   return {offset, BEFAttributeType::kType};
 }
 
@@ -1126,6 +1337,11 @@ OffsetAndType BEFAttributesEmitter::EmitArrayAttribute(
   BEFAttributeType attribute_type;
   size_t array_attribute_offset;
   if (is_array) {
+    // The elements of a typed array must be emitted consecutively, so content
+    // deduplication of the individual elements is suspended here.
+    bool saved_dedup_enabled = dedup_enabled_;
+    dedup_enabled_ = false;
+
     // For array attributes, its offset is the offset of the first
     // element.
     auto offset_and_type = EmitAttributeInternal(elts.front());
@@ -1134,6 +1350,8 @@ OffsetAndType BEFAttributesEmitter::EmitArrayAttribute(
     attribute_type = GetArrayAttributeType(offset_and_type.attribute_type);
 
     for (auto elt : elts.drop_front()) (void)EmitAttributeInternal(elt);
+
+    dedup_enabled_ = saved_dedup_enabled;
   } else {
     // Emit alignment paddings to the correct offset of this array attribute.
     EmitAlignment(aggregate_element_emitter.GetRequiredAlignment());
@@ -1158,6 +1376,8 @@ OffsetAndType BEFAttributesEmitter::EmitArrayAttribute(
 // TODO(tf-runtime-team): Consider using an encoding scheme similar to array.
 OffsetAndType BEFAttributesEmitter::EmitDenseElementsAttribute(
     mlir::DenseElementsAttr dense_elements_attr) {
+  size_t unaligned_offset = size();
+
   // Align to uint64_t since the attribute header starts with uint64_t.
   EmitAlignment(8);
   size_t start_offset = size();
@@ -1183,13 +1403,43 @@ OffsetAndType BEFAttributesEmitter::EmitDenseElementsAttribute(
     EmitInt8(shape_elt);
   }
 
-  // Emit payload elements.
+  // The header, element count and shape are all uint64_t, so the payload
+  // starts 8-byte aligned and kernels can read it with aligned typed loads
+  // straight out of the section.
+  assert(size() % 8 == 0 && "dense payload must start naturally aligned");
+
+  // Emit payload elements.  They must stay consecutive, so content
+  // deduplication of the individual elements is suspended here; the whole
+  // attribute is deduplicated as one region below instead.
   // TODO(zhangqiaorjc): Check element alignment <= 8.
+  bool saved_dedup_enabled = dedup_enabled_;
+  dedup_enabled_ = false;
   auto elts_iter = dense_elements_attr.attr_value_begin();
   while (elts_iter != dense_elements_attr.attr_value_end()) {
     EmitStandardAttribute(*elts_iter);
     ++elts_iter;
   }
+  dedup_enabled_ = saved_dedup_enabled;
+
+  if (dedup_enabled_) {
+    // If an identical dense attribute region was emitted before, discard this
+    // one and reuse the earlier offset.  Discarding is safe because the region
+    // is self-contained and nothing refers to it yet, and the reused offset
+    // has the same 8-byte alignment this emission established.
+    auto region = result().drop_front(start_offset);
+    auto hash = Hash64(reinterpret_cast<const char*>(region.data()),
+                       region.size());
+    auto& candidates = dense_offsets_[hash];
+    for (const auto& candidate : candidates) {
+      if (candidate.second == region.size() &&
+          memcmp(result().data() + candidate.first, region.data(),
+                 region.size()) == 0) {
+        TruncateResult(unaligned_offset);
+        return {candidate.first, BEFAttributeType::kDenseElements};
+      }
+    }
+    candidates.push_back({start_offset, region.size()});
+  }
 
   return {start_offset, BEFAttributeType::kDenseElements};
 }
@@ -1254,8 +1504,11 @@ void BEFModuleEmitter::EmitTypes() {
 class BEFFunctionEmitter : public BEFEmitter {
  public:
   BEFFunctionEmitter(const EntityTable& entities,
-                     const EntityIndex& entity_index)
-      : entities_(entities), entity_index_(entity_index) {}
+                     const EntityIndex& entity_index,
+                     bool compact_function_bodies = false)
+      : entities_(entities),
+        entity_index_(entity_index),
+        compact_function_bodies_(compact_function_bodies) {}
 
   void EmitFunction(mlir::Region* region, BEFEmitter* attribute_names,
                     BEFEmitter* register_types);
@@ -1279,6 +1532,9 @@ class BEFFunctionEmitter : public BEFEmitter {
 
   const EntityTable& entities_;
   const EntityIndex& entity_index_;
+  // Emit kernel words as a VBR stream (BEF format version 1) instead of
+  // fixed 4-byte words.
+  const bool compact_function_bodies_;
 };
 
 void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
@@ -1375,33 +1631,114 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
   }
 
   // Once we're done, we can emit the kernel data after the kernel index
-  // list. Note that kernel entries are fixed32 integers with 4-byte alignment.
-  EmitAlignment(4);
-  EmitEmitter(kernel_list);
+  // list.
+  if (compact_function_bodies_) {
+    // Compact encoding (format version 1): re-emit the fixed32 kernel words
+    // as a VBR stream prefixed with the word count. The kernel offsets
+    // emitted above are byte offsets into the decoded word array, which is
+    // identical to the version 0 kernel list, so the reader decodes the
+    // stream once and everything downstream is unchanged.
+    auto words = kernel_list.result();
+    assert(words.size() % 4 == 0);
+    EmitInt(words.size() / 4);
+    for (size_t i = 0, e = words.size(); i != e; i += 4) {
+      uint32_t word = uint32_t(words[i]) | (uint32_t(words[i + 1]) << 8) |
+                      (uint32_t(words[i + 2]) << 16) |
+                      (uint32_t(words[i + 3]) << 24);
+      EmitInt(word);
+    }
+  } else {
+    // Note that kernel entries are fixed32 integers with 4-byte alignment.
+    EmitAlignment(4);
+    EmitEmitter(kernel_list);
+  }
 
   kernel_index_.clear();
 }
 
 void BEFFunctionEmitter::EmitRegisterTable(mlir::Block* block,
                                            BEFEmitter* register_types) {
+  // Collect the registers in definition order along with their live range in
+  // program order.  The executor touches a register's entry at its definition
+  // and at each use, so we renumber for locality: registers that stay live
+  // across a large stretch of the function are grouped at the front, where
+  // their few cache lines stay hot for the whole run, and the remaining
+  // short-lived registers follow in definition order, making the executor's
+  // accesses to them nearly sequential.
+  llvm::DenseMap<mlir::Operation*, unsigned> op_position;
+  unsigned position = 0;
+  for (auto& op : *block) op_position[&op] = position++;
+
+  struct RegisterEntry {
+    mlir::Value reg;
+    unsigned def_position;
+    unsigned last_use;
+  };
+  llvm::SmallVector<RegisterEntry, 16> registers;
+
+  auto collect_register = [&](mlir::Value reg, unsigned def_position) {
+    unsigned last_use = def_position;
+    for (auto* user : reg.getUsers())
+      last_use = std::max(last_use, op_position[user]);
+    registers.push_back({reg, def_position, last_use});
+  };
+
+  for (auto arg : block->getArguments()) collect_register(arg, 0);
+
+  for (auto& op : *block)
+    for (auto result : op.getResults())
+      collect_register(result, op_position[&op]);
+
+  // A register is long-lived if it stays live across more than a cache line's
+  // worth of kernel entries.  The stable partition keeps definition order
+  // within each group.
+  constexpr unsigned kLongLivedDistance = 16;
+  std::stable_partition(registers.begin(), registers.end(),
+                        [](const RegisterEntry& entry) {
+                          return entry.last_use - entry.def_position >
+                                 kLongLivedDistance;
+                        });
+
+  // Refcount elision analysis: a register whose only use is a strict kernel
+  // can skip the executor's atomic publish protocol. The consumer becomes
+  // ready through the producer's completion edge, i.e. strictly after the
+  // register is set, so no reader can park a waiter on it or race the store.
+  // The return op reads result registers at function completion and
+  // non-strict kernels read registers early, so neither qualifies; block
+  // arguments are set up outside the publish protocol and are excluded too.
+  auto has_single_ordered_use = [&](mlir::Value reg) {
+    if (reg.isa<mlir::BlockArgument>()) return false;
+    if (!reg.hasOneUse()) return false;
+    mlir::Operation* user = *reg.getUsers().begin();
+    if (IsReturn(user)) return false;
+    for (auto attr_and_name : user->getAttrs())
+      if (ClassifyAttribute(attr_and_name.first) ==
+          SpecialAttribute::kNonStrict)
+        return false;
+    return true;
+  };
+
   BEFEmitter reg_table;
   BEFEmitter reg_type_table;
   unsigned num_registers = 0;
 
-  auto emit_register = [&](mlir::Value reg) {
-    // Then the use-count.
-    reg_table.EmitInt(std::distance(reg.use_begin(), reg.use_end()));
+  for (const auto& entry : registers) {
+    auto reg = entry.reg;
+
+    // Then the use-count. Format version 1 packs the elision bit into the
+    // low bit of the register word.
+    size_t use_count = std::distance(reg.use_begin(), reg.use_end());
+    if (compact_function_bodies_)
+      reg_table.EmitInt((use_count << 1) |
+                        (has_single_ordered_use(reg) ? 1 : 0));
+    else
+      reg_table.EmitInt(use_count);
 
     // Emit the type index into register types section.
     reg_type_table.EmitInt(entities_.GetTypeIndex(reg.getType()));
 
     register_number_[reg] = num_registers++;
-  };
-
-  for (auto arg : block->getArguments()) emit_register(arg);
-
-  for (auto& op : *block)
-    for (auto result : op.getResults()) emit_register(result);
+  }
 
   // Emit the number of registers, then the register table.
   EmitInt(num_registers);
@@ -1460,6 +1797,33 @@ void BEFFunctionEmitter::EmitArgumentsPseudoOp(mlir::Block* block,
   kernel_list->EmitEmitter(kernel_body);
 }
 
+// Return true if `attr` is a scalar attribute of at most 4 bytes whose value
+// can be stored inline in a kernel entry word, setting *value to the word
+// holding the attribute's payload in little-endian order.
+static bool GetInlineAttributeWord(mlir::Attribute attr, uint32_t* value) {
+  if (auto bool_attr = attr.dyn_cast<mlir::BoolAttr>()) {
+    *value = bool_attr.getValue() ? 1 : 0;
+    return true;
+  }
+  if (auto int_attr = attr.dyn_cast<mlir::IntegerAttr>()) {
+    auto width = int_attr.getValue().getBitWidth();
+    if (width != 1 && width != 32) return false;
+    *value = static_cast<uint32_t>(int_attr.getValue().getLimitedValue());
+    return true;
+  }
+  if (auto float_attr = attr.dyn_cast<mlir::FloatAttr>()) {
+    if (!float_attr.getType().isF32()) return false;
+    *value = static_cast<uint32_t>(
+        float_attr.getValue().bitcastToAPInt().getLimitedValue());
+    return true;
+  }
+  if (auto type_attr = attr.dyn_cast<mlir::TypeAttr>()) {
+    *value = static_cast<uint8_t>(EncodeTypeAttribute(type_attr.getValue()));
+    return true;
+  }
+  return false;
+}
+
 void BEFFunctionEmitter::EmitKernel(mlir::Operation* op,
                                     BEFEmitter* kernel_list,
                                     BEFEmitter* attribute_names) const {
@@ -1502,9 +1866,25 @@ void BEFFunctionEmitter::EmitKernel(mlir::Operation* op,
     } else {
       attribute_names->EmitInt(
           entity_index_.GetOptionalStringOffset(attr_name_pair.first));
+      uint32_t inline_value;
+      if (num_input_attributes < kNumInlineAttributeBits &&
+          GetInlineAttributeWord(attr_name_pair.second, &inline_value)) {
+        // Small scalar attributes are stored inline in the kernel entry word
+        // itself, flagged in special_metadata, so the executor reads the
+        // value without an indirection into the attributes section. The
+        // attribute is still emitted into that section for the BEF-to-MLIR
+        // converter, which finds its offset after the attribute name in the
+        // attribute names section (ignored by the executor).
+        special_attribute |= 1u
+                             << (kInlineAttributeShift + num_input_attributes);
+        input_attribute_emitter.EmitInt4(inline_value);
+        attribute_names->EmitInt(
+            entity_index_.GetAttributeOffset(attr_name_pair.second));
+      } else {
+        input_attribute_emitter.EmitInt4(
+            entity_index_.GetAttributeOffset(attr_name_pair.second));
+      }
       num_input_attributes++;
-      input_attribute_emitter.EmitInt4(
-          entity_index_.GetAttributeOffset(attr_name_pair.second));
     }
   }
 
@@ -1538,18 +1918,103 @@ void BEFFunctionEmitter::EmitKernel(mlir::Operation* op,
 }
 
 void BEFModuleEmitter::EmitFunctions(BEFEmitter* attribute_names,
-                                     BEFEmitter* register_types) {
-  BEFFunctionEmitter functions_section(entities_, entity_index_);
+                                     BEFEmitter* register_types,
+                                     int num_threads,
+                                     bool compact_function_bodies) {
+  BEFFunctionEmitter functions_section(entities_, entity_index_,
+                                       compact_function_bodies);
 
   attribute_names->EmitInt(entities_.functions.size());
   register_types->EmitInt(entities_.functions.size());
-  for (auto function_entry : entities_.functions) {
-    // Remember that we emitted this region to this offset.
-    entity_index_.AddFunction(function_entry.name, functions_section.size(),
-                              function_entry.type, function_entry.kind);
-    if (!function_entry.IsNative()) {
-      functions_section.EmitFunction(function_entry.region, attribute_names,
-                                     register_types);
+
+  if (num_threads > 1 && entities_.functions.size() > 1) {
+    // Parallel mode: translate each function body into its own emitter and
+    // merge the byte buffers in index order below.  Function translation only
+    // reads the shared entity tables, which are fully built by this point, so
+    // bodies can be emitted concurrently.
+    struct FunctionChunk {
+      FunctionChunk(const EntityTable& entities,
+                    const EntityIndex& entity_index,
+                    bool compact_function_bodies)
+          : function(entities, entity_index, compact_function_bodies) {}
+      BEFFunctionEmitter function;
+      BEFEmitter attribute_names;
+      BEFEmitter register_types;
+    };
+
+    std::vector<std::unique_ptr<FunctionChunk>> chunks;
+    chunks.reserve(entities_.functions.size());
+    for (size_t i = 0, e = entities_.functions.size(); i != e; ++i)
+      chunks.push_back(std::make_unique<FunctionChunk>(
+          entities_, entity_index_, compact_function_bodies));
+
+    // Hand out function indices through a shared counter so fast workers pick
+    // up the slack of slow ones.
+    std::atomic<size_t> next_function{0};
+    auto work = [&]() {
+      while (true) {
+        size_t index = next_function.fetch_add(1, std::memory_order_relaxed);
+        if (index >= entities_.functions.size()) break;
+        const auto& function_entry = entities_.functions[index];
+        if (function_entry.IsNative()) continue;
+        auto& chunk = *chunks[index];
+        chunk.function.EmitFunction(function_entry.region,
+                                    &chunk.attribute_names,
+                                    &chunk.register_types);
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (int i = 1; i < num_threads; ++i) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    // The chunk sizes are now exact, so size the merged buffers in one
+    // reservation each instead of reallocating while concatenating 12k
+    // function bodies.
+    size_t function_bytes = 0;
+    size_t attribute_name_bytes = 0;
+    size_t register_type_bytes = 0;
+    for (auto& chunk : chunks) {
+      function_bytes +=
+          chunk->function.size() + chunk->function.GetRequiredAlignment();
+      attribute_name_bytes += chunk->attribute_names.size();
+      register_type_bytes += chunk->register_types.size();
+    }
+    functions_section.ReserveHint(function_bytes);
+    attribute_names->ReserveHint(attribute_name_bytes);
+    register_types->ReserveHint(register_type_bytes);
+
+    for (size_t i = 0, e = entities_.functions.size(); i != e; ++i) {
+      const auto& function_entry = entities_.functions[i];
+      auto& chunk = *chunks[i];
+
+      // A chunk's internal alignment padding was computed relative to its own
+      // start, so place it at an offset aligned to its requirement to keep
+      // that padding valid section-absolute.
+      functions_section.EmitAlignment(chunk.function.GetRequiredAlignment());
+
+      // Remember that we emitted this region to this offset.
+      entity_index_.AddFunction(function_entry.name, functions_section.size(),
+                                function_entry.type, function_entry.kind);
+      if (!function_entry.IsNative()) {
+        functions_section.EmitEmitter(chunk.function);
+        // The per-function attribute name and register type chunks are pure
+        // VBR streams with no alignment, so this is plain concatenation.
+        attribute_names->EmitEmitter(chunk.attribute_names);
+        register_types->EmitEmitter(chunk.register_types);
+      }
+    }
+  } else {
+    for (auto function_entry : entities_.functions) {
+      // Remember that we emitted this region to this offset.
+      entity_index_.AddFunction(function_entry.name, functions_section.size(),
+                                function_entry.type, function_entry.kind);
+      if (!function_entry.IsNative()) {
+        functions_section.EmitFunction(function_entry.region, attribute_names,
+                                       register_types);
+      }
     }
   }
 
@@ -1595,21 +2060,18 @@ void BEFModuleEmitter::EmitRegisterTypes(const BEFEmitter& register_types) {
   EmitSection(BEFSectionID::kRegisterTypes, register_types);
 }
 
-// This function converts the specified MLIR module containing a host executor
-// compatible program to the BinaryExecutableFormat (BEF) format, which is the
-// low level format that the executor takes.
+// Emit each section of the file, flushing buffered output to the emitter's
+// sink (if any) after every section so that at most one section is buffered
+// at a time.  Returns false if a sink write failed.
 //
-// On error, this emits the error message through the MLIR error handler, and
-// returns an empty std:vector.
-std::vector<uint8_t> ConvertMLIRToBEF(mlir::ModuleOp module,
-                                      bool disable_optional_sections) {
-  BEFModuleEmitter emitter(module);
-
-  // Build the entities table.
-  if (emitter.CollectEntities(!disable_optional_sections) ==
-      LogicalResult::Failure)
-    return {};
-
+// Cross-section references in BEF (string, attribute and function offsets)
+// are all section-relative and known before the referencing section is
+// emitted, so sections can be written out as soon as they are complete and no
+// fixup pass over already-written output is needed.
+static bool EmitModuleSections(BEFModuleEmitter& emitter,
+                               bool disable_optional_sections,
+                               int num_function_threads,
+                               bool compact_function_bodies) {
   // Magic number at the start of the file.
   emitter.EmitBytes({kBEFMagic1, kBEFMagic2});
 
@@ -1618,23 +2080,78 @@ std::vector<uint8_t> ConvertMLIRToBEF(mlir::ModuleOp module,
   BEFEmitter register_types;
 
   // Emit each section of the file.
-  emitter.EmitFormatVersion();
+  emitter.EmitFormatVersion(compact_function_bodies ? kBEFVersion1
+                                                    : kBEFVersion0);
+  if (!emitter.Flush()) return false;
   emitter.EmitLocationInfo();
+  if (!emitter.Flush()) return false;
   emitter.EmitStrings();
+  if (!emitter.Flush()) return false;
   emitter.EmitAttributes(&attribute_types);
+  if (!emitter.Flush()) return false;
   emitter.EmitKernels();
+  if (!emitter.Flush()) return false;
   emitter.EmitTypes();
-  emitter.EmitFunctions(&attribute_names, &register_types);
+  if (!emitter.Flush()) return false;
+  emitter.EmitFunctions(&attribute_names, &register_types,
+                        num_function_threads, compact_function_bodies);
+  if (!emitter.Flush()) return false;
   emitter.EmitFunctionIndex();
+  if (!emitter.Flush()) return false;
 
   if (!disable_optional_sections) {
     emitter.EmitAttributeTypes(attribute_types);
+    if (!emitter.Flush()) return false;
     emitter.EmitAttributeNames(attribute_names);
+    if (!emitter.Flush()) return false;
     emitter.EmitRegisterTypes(register_types);
+    if (!emitter.Flush()) return false;
   }
 
+  return true;
+}
+
+// This function converts the specified MLIR module containing a host executor
+// compatible program to the BinaryExecutableFormat (BEF) format, which is the
+// low level format that the executor takes.
+//
+// On error, this emits the error message through the MLIR error handler, and
+// returns an empty std:vector.
+std::vector<uint8_t> ConvertMLIRToBEF(mlir::ModuleOp module,
+                                      bool disable_optional_sections,
+                                      int num_function_threads,
+                                      bool compact_function_bodies) {
+  BEFModuleEmitter emitter(module);
+
+  // Build the entities table.
+  if (emitter.CollectEntities(!disable_optional_sections) ==
+      LogicalResult::Failure)
+    return {};
+
+  // Without a sink the flushes are no-ops and the whole file accumulates in
+  // the emitter.
+  EmitModuleSections(emitter, disable_optional_sections, num_function_threads,
+                     compact_function_bodies);
+
   // Return the result.
   return emitter.TakeResult();
 }
 
+BEFBytesSink::~BEFBytesSink() {}
+
+bool ConvertMLIRToBEFStream(mlir::ModuleOp module,
+                            bool disable_optional_sections, BEFBytesSink* sink,
+                            int num_function_threads,
+                            bool compact_function_bodies) {
+  BEFModuleEmitter emitter(module, sink);
+
+  // Build the entities table.
+  if (emitter.CollectEntities(!disable_optional_sections) ==
+      LogicalResult::Failure)
+    return false;
+
+  return EmitModuleSections(emitter, disable_optional_sections,
+                            num_function_threads, compact_function_bodies);
+}
+
 }  // namespace tfrt
@@ -19,6 +19,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 
 #include "bef_file_impl.h"
@@ -26,6 +28,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "tfrt/host_context/async_value.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/host_allocator.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/location.h"
@@ -48,38 +51,99 @@ namespace tfrt {
 
 namespace {
 
+// Cheap timestamp for kernel cost accounting. On x86 this is a raw rdtsc so
+// the probe costs a few cycles; elsewhere it falls back to the steady clock
+// and the "cycle" totals are really nanoseconds, which ranks kernels just as
+// well.
+inline uint64_t KernelCostTimestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// A consumer that needs a register's value before the producer has set it
+// parks a waiter holding a private placeholder IndirectAsyncValue. The
+// producer resolves the parked placeholders directly when it sets the
+// register, so the register itself always ends up holding the concrete value
+// and readers arriving after the producer never pay a forwarding hop.
+struct RegisterWaiter {
+  IndirectAsyncValue* value;
+  RegisterWaiter* next;
+};
+
+// A register word is in one of three states: null (unset, no waiters), a
+// RegisterWaiter list tagged in the low bit (unset, parked consumers), or the
+// final AsyncValue installed by the producer. Waiters are heap allocated, so
+// their low bit is free to use as the tag.
+constexpr uintptr_t kRegisterWaiterTag = 1;
+
+inline bool IsRegisterWaiterList(AsyncValue* value) {
+  return (reinterpret_cast<uintptr_t>(value) & kRegisterWaiterTag) != 0;
+}
+
+inline AsyncValue* TagRegisterWaiterList(RegisterWaiter* waiter) {
+  return reinterpret_cast<AsyncValue*>(reinterpret_cast<uintptr_t>(waiter) |
+                                       kRegisterWaiterTag);
+}
+
+inline RegisterWaiter* UntagRegisterWaiterList(AsyncValue* value) {
+  return reinterpret_cast<RegisterWaiter*>(reinterpret_cast<uintptr_t>(value) &
+                                           ~kRegisterWaiterTag);
+}
+
+// Returns true if the producer has installed the register's final value.
+// Parked waiters do not count as a final value.
+inline bool RegisterValueIsSet(const BEFFileImpl::RegisterInfo& reg) {
+  AsyncValue* value = reg.value.load(std::memory_order_acquire);
+  return value != nullptr && !IsRegisterWaiterList(value);
+}
+
 AsyncValue* GetRegisterValue(const BEFFileImpl::RegisterInfo& reg) {
-  return reg.value.load(std::memory_order_acquire);
+  AsyncValue* value = reg.value.load(std::memory_order_acquire);
+  assert(!IsRegisterWaiterList(value) && "register has no final value yet");
+  return value;
 }
 
 AsyncValue* GetOrCreateRegisterValue(BEFFileImpl::RegisterInfo* reg,
                                      HostContext* host) {
   // In the normal case, just load the pointer and return it.
   AsyncValue* value = reg->value.load(std::memory_order_acquire);
-  if (value) return value;
-
-  // If it doesn't exist, we create an IndirectAsyncValue for this.  We have to
-  // be a bit careful though because a concurrent task could swap in the actual
-  // result while we're working on this.
+  if (value && !IsRegisterWaiterList(value)) return value;
+
+  // The producer has not set this register yet, so we have to hand out a
+  // placeholder. Rather than publishing a shared IndirectAsyncValue in the
+  // register - which would leave every later reader forwarding through it -
+  // we park a private placeholder on the register's waiter list and let the
+  // producer resolve it directly. This also keeps multi-user registers off a
+  // shared cache line: each consumer waits on its own placeholder, so
+  // concurrent waiters never contend on one value's state word while the
+  // producer's refcount traffic lands on the same line.
   auto* indirect_value = host->MakeIndirectAsyncValue().release();
-
-  AsyncValue* existing = nullptr;
-  // Speculatively set refcount in the expectation that compare_exchange
-  // succeeds (see b/142802684). Specifically:
-  // Add user_count refs to indirect_value. Corresponding DropRefs will occur
-  // as it's used. indirect_value starts with 1 reference, and setting this
-  // register will count as an additional use (+1), so add user_count refs,
-  // bringing its refcount to (user_count + 1).
-  indirect_value->AddRef(reg->user_count);
-  if (!reg->value.compare_exchange_strong(existing, indirect_value,
-                                          std::memory_order_release,
-                                          std::memory_order_acquire)) {
-    // If result_reg already got a result, then we don't need the
-    // IndirectAsyncValue after all. Decrease refcount back to 0.
-    indirect_value->DropRef(reg->user_count + 1);
-    return existing;
-  } else {
-    return indirect_value;
+  auto* waiter = host->Construct<RegisterWaiter>();
+  // indirect_value starts with 1 reference, which we hand to our caller. Add
+  // one more for the parked waiter; the producer drops it after forwarding.
+  indirect_value->AddRef();
+  waiter->value = indirect_value;
+
+  while (true) {
+    waiter->next = IsRegisterWaiterList(value) ? UntagRegisterWaiterList(value)
+                                               : nullptr;
+    if (reg->value.compare_exchange_weak(value, TagRegisterWaiterList(waiter),
+                                         std::memory_order_release,
+                                         std::memory_order_acquire))
+      return indirect_value;
+
+    // The producer beat us to the register, so the placeholder is not needed
+    // after all. Decrease its refcount back to 0 and use the final value.
+    if (value && !IsRegisterWaiterList(value)) {
+      host->Destruct(waiter);
+      indirect_value->DropRef(2);
+      return value;
+    }
   }
 }
 
@@ -107,10 +171,21 @@ void SetKernelsWithErrorInputReady(
 }
 
 AsyncValue* SetRegisterValue(BEFFileImpl::RegisterInfo* reg,
-                             AsyncValue* new_value,
-                             bool* register_already_set) {
+                             AsyncValue* new_value, HostContext* host) {
   assert(reg->user_count > 0 &&
          "No need to set register value if it is not being used by anyone.");
+  // The converter proved that this register's only consumer is a strict
+  // kernel: it becomes ready through this kernel's completion edge, after
+  // this store, so it can neither park a waiter nor race the publish. Skip
+  // the compare-exchange protocol and hand the value's existing +1 reference
+  // straight to the consumer.
+  if (reg->single_ordered_use) {
+    assert(reg->user_count == 1);
+    assert(reg->value.load(std::memory_order_relaxed) == nullptr &&
+           "single-ordered-use register was read before it was set");
+    reg->value.store(new_value, std::memory_order_release);
+    return new_value;
+  }
   // Atomically set reg->value to new_value.
   AsyncValue* existing = nullptr;
   // Speculatively set refcount in the expectation that compare_exchange
@@ -125,119 +200,239 @@ AsyncValue* SetRegisterValue(BEFFileImpl::RegisterInfo* reg,
   if (!reg->value.compare_exchange_strong(existing, new_value,
                                           std::memory_order_release,
                                           std::memory_order_acquire)) {
-    // If there was already a value in it, it must be a IndirectAsyncValue. We
-    // set the IndirectAsyncValue to point to the result.
-    auto indirect_value = cast<IndirectAsyncValue>(existing);
-
-    // Speculative AddRef above proved unneeded, so revert it.
-    new_value->DropRef(reg->user_count - 1);
-
-    // Give our +1 reference to 'new_value' to the indirect_value, since we are
-    // not storing it in our register file.
-    indirect_value->ForwardTo(TakeRef(new_value));
-
-    // Setting a register counts as an additional use. Signal caller to DropRef
-    // after the caller finished using the returned pointer.
-    *register_already_set = true;
+    // Consumers raced ahead of us and parked placeholders. Install the
+    // concrete value anyway - the exchange also picks up any waiter parked
+    // between the failed compare_exchange and now - and then resolve each
+    // parked placeholder directly.
+    existing = reg->value.exchange(new_value, std::memory_order_acq_rel);
+    assert(IsRegisterWaiterList(existing) &&
+           "only the producer stores a final value in a register");
+
+    RegisterWaiter* waiter = UntagRegisterWaiterList(existing);
+    unsigned num_waiters = 0;
+    while (waiter != nullptr) {
+      ++num_waiters;
+      waiter->value->ForwardTo(FormRef(new_value));
+      // Drop the parked ref. The consumer's own ref may already be gone, in
+      // which case this destroys the placeholder.
+      waiter->value->DropRef();
+      RegisterWaiter* next = waiter->next;
+      host->Destruct(waiter);
+      waiter = next;
+    }
 
-    return existing;
+    // Parked consumers were served through their placeholders and never load
+    // the register, so revert their share of the speculative AddRef above.
+    new_value->DropRef(num_waiters);
   }
 
-  *register_already_set = false;
   return new_value;
 }
 
 }  // namespace
 
-class BEFLocationHandler final : public LocationHandler,
-                                 public ReferenceCounted<BEFLocationHandler> {
- public:
-  BEFLocationHandler(HostContext* host, BEFFileImpl* bef_file)
-      : host_{host}, bef_file_(FormRef(bef_file)) {}
-
-  void Destroy() { host_->Destruct(this); }
-
-  DecodedLocation DecodeLocation(Location loc) const override {
-    return bef_file_->DecodeLocation(loc.data);
-  }
-
-  HostContext* GetHost() const { return host_; }
-
- private:
-  friend class ReferenceCounted<BEFLocationHandler>;
-
-  HostContext* const host_;
-  RCReference<BEFFileImpl> bef_file_;
-};
-
 /// A BEFExecutor runs a BEF function containing a stream of asynchronous
 /// kernels. Multiple executors can be active at one time, e.g. due to
 /// concurrent control flow constructs.
 class BEFExecutor final : public ReferenceCounted<BEFExecutor> {
  public:
-  static void Execute(const BEFFunction& fn, ArrayRef<AsyncValue*> arguments,
-                      MutableArrayRef<RCReference<AsyncValue>> results,
-                      HostContext* host);
+  static void Execute(const BEFFunction& fn, const ExecutionContext& exec_ctx,
+                      ArrayRef<AsyncValue*> arguments,
+                      MutableArrayRef<RCReference<AsyncValue>> results);
 
   /// When the last reference to the BEFExecutor is dropped, we deallocate
-  /// ourself.  The memory for this class is managed through the HostAllocator
-  /// managed by the HostContext.
+  /// ourself.  The executor lives at the front of the per-invocation arena
+  /// that also backs its register and kernel arrays, so take the state out of
+  /// the member before running the destructor and let its own destructor
+  /// release the arena - including this executor's storage - on scope exit.
   void Destroy() {
-    auto host = this->GetHost();
+    // Keep the BEF file alive until the invocation state has been released:
+    // the arena is recycled through a pool owned by the file's function
+    // template, and ~BEFExecutor may drop the last file reference.
+    RCReference<BEFFileImpl> bef_file = bef_file_.CopyRef();
+    BEFFileImpl::FunctionState function_state = std::move(function_state_);
+    assert(function_state.leading_storage() == this &&
+           "BEFExecutor must live at the front of the invocation arena");
     this->~BEFExecutor();
-    host->Deallocate<BEFExecutor>(this);
   }
 
  private:
-  BEFExecutor(BEFFileImpl* bef_file, HostContext* host,
+  BEFExecutor(BEFFileImpl* bef_file, const ExecutionContext& exec_ctx,
               ArrayRef<uint32_t> kernels,
-              HostArray<BEFFileImpl::KernelInfo> kernel_infos,
-              HostArray<BEFFileImpl::RegisterInfo> register_infos,
+              BEFFileImpl::FunctionState function_state,
               bool has_arguments_pseudo_kernel);
   ~BEFExecutor();
 
  private:
-  void DecrementArgumentsNotReadyCounts(SmallVectorImpl<unsigned>* kernel_ids);
-  void ProcessArgumentsPseudoKernel(SmallVectorImpl<unsigned>* kernel_ids);
+  void DecrementReadyCountAndEnqueue(
+      ArrayRef<uint32_t> users, SmallVectorImpl<unsigned>* ready_kernel_ids);
+  void ProcessReadyKernels(SmallVectorImpl<unsigned>* ready_kernel_ids);
+  void ProcessReadyKernelsBatch(SmallVector<unsigned, 8> ready_kernel_ids);
+  void ProcessArgumentsPseudoKernel(
+      SmallVectorImpl<unsigned>* ready_kernel_ids);
   void ProcessUsedBys(const BEFKernel& kernel, int result_number,
                       AsyncValue* result, int* entry_offset,
-                      SmallVectorImpl<unsigned>* kernel_ids);
+                      SmallVectorImpl<unsigned>* ready_kernel_ids);
   void MaybeAddRefForResult(AsyncValue* result);
-  HostContext* GetHost() const { return location_handler_->GetHost(); }
+  bool IsTinyKernel(unsigned kernel_id);
+  HostContext* GetHost() const { return exec_ctx_.host(); }
 
  private:
   friend class ReferenceCounted<BEFExecutor>;
 
   /// Make sure the BEF file doesn't get deallocated while we're asynchronously
-  /// running stuff.
+  /// running stuff. The file also serves as the LocationHandler for the
+  /// Locations handed to kernels, so it must stay alive as long as a kernel
+  /// may report an error.
   RCReference<BEFFileImpl> bef_file_;
 
   // This ArrayRef contains kernel entries of all kernels of this function.
   ArrayRef<uint32_t> kernels_;
 
-  /// This is an array of descriptors for all of the kernels in this function,
-  /// indexed by the kernel number.
-  HostArray<BEFFileImpl::KernelInfo> kernel_infos_;
-
-  /// This is an array of descriptors for all of our registers, indexed by their
-  /// register number.
-  HostArray<BEFFileImpl::RegisterInfo> register_infos_;
-
-  // Make sure location handler is alive as long as there is pending execution.
-  RCReference<BEFLocationHandler> location_handler_;
+  /// The per-invocation state: the descriptors for all of the kernels and
+  /// registers of this function, indexed by kernel/register number, backed by
+  /// the single arena allocation that also holds this executor object.
+  BEFFileImpl::FunctionState function_state_;
+
+  /// The per-request context this execution runs under. Holds the request's
+  /// cancellation state, which is checked before dispatching each ready
+  /// kernel.
+  ExecutionContext exec_ctx_;
+
+  /// Raised at every point where an error can enter this invocation's
+  /// dataflow: an error function argument, a kernel result observed in the
+  /// error state, or an async result resolving to an error. Until it is
+  /// raised, no kernel argument can be an error, so the dispatch loop skips
+  /// the per-argument error checks entirely and failures are handled by the
+  /// batched SetKernelsWithErrorInputReady sweep. Relaxed ordering is enough:
+  /// the flag is always set before the ready-count decrement that publishes
+  /// the erroneous value to its consumers.
+  std::atomic<bool> seen_error_{false};
 };
 
 //===----------------------------------------------------------------------===//
 // Core executor logic
 //===----------------------------------------------------------------------===//
 
+// Decrement the arguments_not_ready count of each kernel in `users` by one.
+// Kernels whose counts hit zero have all of their arguments available, so they
+// are appended to `ready_kernel_ids` to be executed inline on the current
+// stack by ProcessReadyKernels. Kernels that are still waiting on other
+// operands never touch the ready list at all - the thread that provides their
+// last operand picks them up.
+void BEFExecutor::DecrementReadyCountAndEnqueue(
+    ArrayRef<uint32_t> users, SmallVectorImpl<unsigned>* ready_kernel_ids) {
+  MutableArrayRef<BEFFileImpl::KernelInfo> kernel_infos =
+      function_state_.kernel_infos();
+  for (auto kernel_id : users) {
+    assert(kernel_id < kernel_infos.size() && "invalid kernel ID");
+    if (kernel_infos[kernel_id].arguments_not_ready.fetch_sub(1) == 1)
+      ready_kernel_ids->push_back(kernel_id);
+  }
+}
+
+// Process a batch of kernels that became ready when an asynchronous result
+// completed. Large batches - e.g. a high fan-out lookup whose result feeds
+// hundreds of kernels - are split, with the back half handed to the work
+// queue as a single work item, so other workers can help drain the fan-out
+// without paying one queue operation per ready kernel. The front half runs
+// inline on the completing thread to preserve latency for small fan-outs.
+// Returns true if this kernel was registered with KernelCostClass::kTiny.
+bool BEFExecutor::IsTinyKernel(unsigned kernel_id) {
+  auto offset = function_state_.kernel_infos()[kernel_id].offset;
+  BEFKernel kernel(kernels_.data() + offset / kKernelEntryAlignment);
+  return bef_file_->kernel_cost_classes_[kernel.kernel_code()] ==
+         KernelCostClass::kTiny;
+}
+
+void BEFExecutor::ProcessReadyKernelsBatch(
+    SmallVector<unsigned, 8> ready_kernel_ids) {
+  // Batches below this size are not worth sharing with other workers. Tiny
+  // kernels cost less to run than to enqueue and steal, so they do not count
+  // towards the threshold at all: a fan-out of mostly tiny kernels coalesces
+  // into this thread's inline run instead of being spread across workers.
+  constexpr size_t kMinBatchSpanSize = 32;
+  auto batch_weight = [&]() {
+    size_t weight = 0;
+    for (unsigned kernel_id : ready_kernel_ids)
+      if (!IsTinyKernel(kernel_id)) ++weight;
+    return weight;
+  };
+  if (ready_kernel_ids.size() >= 2 * kMinBatchSpanSize &&
+      batch_weight() >= 2 * kMinBatchSpanSize) {
+    size_t mid = ready_kernel_ids.size() / 2;
+    SmallVector<unsigned, 8> span(ready_kernel_ids.begin() + mid,
+                                  ready_kernel_ids.end());
+    ready_kernel_ids.resize(mid);
+
+    // Keep this executor alive until the span is processed. The enqueued task
+    // recursively splits its span, so a large fan-out spreads across workers.
+    // The span's first kernel id acts as a strand tag: it is stable across
+    // invocations of the same function, so the same group of kernels lands on
+    // the same worker each time and finds its data still cache-warm.
+    AddRef();
+    uint32_t strand_tag = span.front();
+    // Count the task into the request's completion group (if any), so the
+    // request owner can await its own spawned work without a full queue
+    // drain.
+    RequestCompletionGroup* group = exec_ctx_.completion_group();
+    if (group) group->TaskAdded();
+    // Timestamp the handoff for requests that carry a stats block, so the
+    // time this task spends parked in the queue is attributed to queueing
+    // rather than compute.
+    RequestContext* req = exec_ctx_.request_ctx();
+    bool trace_queue_wait = false;
+#ifndef NO_TFRT_TRACING
+    trace_queue_wait = internal::tracing::TracingApi::IsTracingOn();
+#endif
+    std::chrono::steady_clock::time_point enqueue_time;
+    if (req || trace_queue_wait)
+      enqueue_time = std::chrono::steady_clock::now();
+    llvm::unique_function<void()> work = [this, group, req, trace_queue_wait,
+                                          enqueue_time,
+                                          span = std::move(span)]() mutable {
+      if (req)
+        req->RecordQueueWait(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - enqueue_time)
+                .count());
+#ifndef NO_TFRT_TRACING
+      // Record the enqueue-to-start wait as a span on the worker that picks
+      // the task up, so scheduling bubbles show on the trace timeline right
+      // before the work they delayed.
+      if (trace_queue_wait) {
+        internal::tracing::TracingActivity activity{
+            "queue wait", enqueue_time,
+            internal::tracing::CurrentSteadyClockTime()};
+        internal::tracing::TracingApi::RecordActivity(activity);
+      }
+#endif
+      this->ProcessReadyKernelsBatch(std::move(span));
+      // Any tasks the batch spawned have already been added to the group, so
+      // the count cannot prematurely reach zero here. TaskDone must precede
+      // DropRef: the executor's context holds the reference keeping the
+      // group alive.
+      if (group) group->TaskDone();
+      this->DropRef();
+    };
+    // Work for a latency-critical request goes through the queue's
+    // high-priority lane instead of the affinity-steered per-worker queues.
+    if (exec_ctx_.is_critical()) {
+      GetHost()->EnqueueCriticalWork(std::move(work));
+    } else {
+      GetHost()->EnqueueWorkWithAffinity(std::move(work), strand_tag);
+    }
+  }
+  ProcessReadyKernels(&ready_kernel_ids);
+}
+
 // Enqueue the users of the result for later processing. If a result has no
 // users, it will be skipped. If the kernel immediately completed a result, then
 // we can mark all kernels using it as ready to go, otherwise we need to enqueue
 // them on their unavailable operands.
 void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
                                  AsyncValue* result, int* entry_offset,
-                                 SmallVectorImpl<unsigned>* kernel_ids) {
+                                 SmallVectorImpl<unsigned>* ready_kernel_ids) {
   // Find used_by entries for this result.
   auto num_used_bys = kernel.num_used_bys(result_number);
   // Skip current result if there is no user.
@@ -254,21 +449,45 @@ void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
 
   auto state = result->state();
 
+  // Fast path for straight-line runs of synchronous kernels: the result is
+  // already concrete, it has a single user, and that user has no other
+  // operands. The extra not-ready count added for the executor constructor's
+  // initial sweep is dropped before any kernel runs, so at this point the
+  // consumer's count can only be touched through this used_by entry - no
+  // other thread can race with us, and the atomic decrement can be replaced
+  // by a plain store. This makes back-to-back sync kernel chains (identified
+  // from the operand counts decoded at load time) run with one ready-list
+  // push per link and no register or counter contention.
+  if (state.IsConcrete() && used_bys.size() == 1) {
+    auto& kernel_info = function_state_.kernel_infos()[used_bys.front()];
+    if (kernel_info.num_operands == 1) {
+      assert(kernel_info.arguments_not_ready.load(std::memory_order_relaxed) ==
+                 1 &&
+             "straight-line consumer must be waiting only on this result");
+      kernel_info.arguments_not_ready.store(0, std::memory_order_relaxed);
+      ready_kernel_ids->push_back(used_bys.front());
+      return;
+    }
+  }
+
   // If this result has error, then we can accelerate error propagation by
   // making any using kernel ready.
   //
   // This check is done intentionally after checking for IsConcrete()
   // so that in the normal path we call AsyncValue::state() only once.
   if (state.IsError()) {
-    SetKernelsWithErrorInputReady(kernel_infos_.mutable_array(), used_bys);
+    seen_error_.store(true, std::memory_order_relaxed);
+    SetKernelsWithErrorInputReady(function_state_.kernel_infos(), used_bys);
   }
 
   // If this result is already available (because the kernel produced its
   // result synchronously, or because the worker thread beat our thread)
-  // then we can immediately process any using kernel as part of our visit
-  // here. Just add it to the worklist for processing, to avoid recursion.
+  // then we can immediately execute any using kernel that becomes ready as
+  // part of our visit here. Kernels still waiting for other operands are left
+  // alone. The ready list keeps this iterative to avoid unbounded recursion
+  // on long synchronous kernel chains.
   if (state.IsAvailable()) {
-    kernel_ids->append(used_bys.begin(), used_bys.end());
+    DecrementReadyCountAndEnqueue(used_bys, ready_kernel_ids);
     return;
   }
 
@@ -294,11 +513,14 @@ void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
 
     auto used_by = used_bys.front();
 
-    result->AndThen([this, used_by]() {
-      // When the result becomes available, we process the using kernel.
-      SmallVector<unsigned, 4> using_kernel_id;
-      using_kernel_id.push_back(used_by);
-      this->DecrementArgumentsNotReadyCounts(&using_kernel_id);
+    result->AndThen([this, used_by, result]() {
+      // When the result becomes available, we process the using kernel if it
+      // became ready.
+      if (result->IsError())
+        this->seen_error_.store(true, std::memory_order_relaxed);
+      SmallVector<unsigned, 4> ready_kernel_ids;
+      this->DecrementReadyCountAndEnqueue(used_by, &ready_kernel_ids);
+      this->ProcessReadyKernels(&ready_kernel_ids);
       this->DropRef();
     });
     return;
@@ -306,28 +528,29 @@ void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
 
   // Otherwise, build a list of values outside of the capture list and
   // process it in one go.
-  SmallVector<unsigned, 8> using_kernel_ids;
-  // As in BEFExecutor's constructor, we reserve some extra space to
-  // accommodate growth for users of results of these kernels.
-  using_kernel_ids.reserve(used_bys.size() + 4);
+  SmallVector<uint32_t, 8> using_kernel_ids;
   using_kernel_ids.append(used_bys.begin(), used_bys.end());
 
   // Process the whole batch when this result becomes available.
   result->AndThen(
-      [this, using_kernel_ids = std::move(using_kernel_ids)]() mutable {
-        this->DecrementArgumentsNotReadyCounts(&using_kernel_ids);
+      [this, result, using_kernel_ids = std::move(using_kernel_ids)]() mutable {
+        // As in BEFExecutor's constructor, we reserve some extra space to
+        // accommodate growth for users of results of the ready kernels.
+        if (result->IsError())
+          this->seen_error_.store(true, std::memory_order_relaxed);
+        SmallVector<unsigned, 8> ready_kernel_ids;
+        ready_kernel_ids.reserve(using_kernel_ids.size() + 4);
+        this->DecrementReadyCountAndEnqueue(using_kernel_ids,
+                                            &ready_kernel_ids);
+        this->ProcessReadyKernelsBatch(std::move(ready_kernel_ids));
         this->DropRef();
       });
 }
 
-// Process the arguments pseudo kernel and enqueue the users of these arguments.
+// Process the arguments pseudo kernel and enqueue the users of these arguments
+// that become ready.
 void BEFExecutor::ProcessArgumentsPseudoKernel(
-    SmallVectorImpl<unsigned>* kernel_ids) {
-  assert(!kernel_ids->empty());
-  assert(kernel_ids->back() == 0);
-  // Remove the first kernel that is argument pseudo kernel.
-  kernel_ids->pop_back();
-
+    SmallVectorImpl<unsigned>* ready_kernel_ids) {
   BEFKernel kernel(kernels_.data());
 
   assert(kernel.num_arguments() == 0);
@@ -341,7 +564,7 @@ void BEFExecutor::ProcessArgumentsPseudoKernel(
   // Move offset to the start of used_bys.
   int used_by_offset = results.size();
   for (int result_number = 0; result_number < results.size(); ++result_number) {
-    auto& result_register = register_infos_[results[result_number]];
+    auto& result_register = function_state_.register_infos()[results[result_number]];
     // TODO(chky): mlir_to_bef should not emit used args.
     if (result_register.user_count == 0) continue;
 
@@ -349,38 +572,42 @@ void BEFExecutor::ProcessArgumentsPseudoKernel(
     assert(result && "Argument AsyncValue is not set.");
 
     // Process users of this result.
-    ProcessUsedBys(kernel, result_number, result, &used_by_offset, kernel_ids);
+    ProcessUsedBys(kernel, result_number, result, &used_by_offset,
+                   ready_kernel_ids);
   }
 }
 
-// Extends the lifetime of location_handler_ as long as there are unavailable
-// results. This is to ensure location_handler_ remains valid in asynchronous
-// kernels. This approach works because reporting an error requires at least one
-// unavailable result.
+// Extends the lifetime of the BEF file as long as there are unavailable
+// results. This is to ensure the file - which decodes the Locations handed to
+// kernels - remains valid in asynchronous kernels. This approach works because
+// reporting an error requires at least one unavailable result.
 void BEFExecutor::MaybeAddRefForResult(AsyncValue* result) {
   if (!result->IsAvailable()) {
-    result->AndThen([handler = location_handler_.CopyRef()]() {});
+    result->AndThen([bef_file = bef_file_.CopyRef()]() {});
   }
 }
 
-/// Decrement arguments_not_ready counters for the specified kernels by one,
-/// executing them if they are now ready to run. This processes the kernels
-/// from the end of the vector to the start - worklist style.
-void BEFExecutor::DecrementArgumentsNotReadyCounts(
-    SmallVectorImpl<unsigned>* kernel_ids) {
-  KernelFrameBuilder kernel_frame(GetHost());
+/// Execute each kernel on the ready list inline on the current stack, adding
+/// any successor kernels that become ready as a consequence. This processes
+/// the kernels from the end of the vector to the start - worklist style. The
+/// worklist keeps inline execution of arbitrarily long synchronous kernel
+/// chains iterative, so no depth bound is needed to protect the stack.
+void BEFExecutor::ProcessReadyKernels(
+    SmallVectorImpl<unsigned>* ready_kernel_ids) {
+  // Build kernel frames from the executor's ExecutionContext so kernels see
+  // the request's cancellation state.
+  KernelFrameBuilder kernel_frame(exec_ctx_);
   kernel_frame.SetAttributeSection(bef_file_->attribute_section_);
 
   MutableArrayRef<BEFFileImpl::KernelInfo>& kernel_infos =
-      kernel_infos_.mutable_array();
+      function_state_.kernel_infos();
 
-  while (!kernel_ids->empty()) {
-    auto kernel_id = kernel_ids->pop_back_val();
+  while (!ready_kernel_ids->empty()) {
+    auto kernel_id = ready_kernel_ids->pop_back_val();
     assert(kernel_id < kernel_infos.size() && "invalid kernel ID");
-
-    // Decrement the count and see if we're ready to run.  If not, then we're
-    // done with the kernel.
-    if (kernel_infos[kernel_id].arguments_not_ready.fetch_sub(1) != 1) continue;
+    assert(kernel_infos[kernel_id].arguments_not_ready.load(
+               std::memory_order_relaxed) == 0 &&
+           "kernel on the ready list is not ready");
 
     assert(kernel_infos[kernel_id].offset % kKernelEntryAlignment == 0);
     BEFKernel kernel(kernels_.data() +
@@ -388,8 +615,17 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
 
     // Keep track of whether we saw any error arguments. If so, we propagate the
     // error to the results automatically. Initialize it with the cancel async
-    // value if the execution has been canceled.
-    AsyncValue* any_error_argument = GetHost()->GetCancelAsyncValue();
+    // value if this request or the whole host has been canceled, so a canceled
+    // execution forwards the cancel error instead of dispatching kernels.
+    AsyncValue* any_error_argument = exec_ctx_.GetCancelAsyncValue();
+    if (!any_error_argument)
+      any_error_argument = GetHost()->GetCancelAsyncValue();
+
+    // Until an error has entered the dataflow, no argument can be in the
+    // error state, so the per-argument checks below collapse into this one
+    // predictable branch.
+    const bool check_errors = any_error_argument != nullptr ||
+                              seen_error_.load(std::memory_order_relaxed);
 
     // Process the kernel record to get information about what argument
     // registers, result registers, and attributes should be passed.
@@ -413,7 +649,7 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
     auto arguments =
         kernel.GetKernelEntries(entry_offset, kernel.num_arguments());
     for (auto reg_idx : arguments) {
-      BEFFileImpl::RegisterInfo& reg = register_infos_[reg_idx];
+      BEFFileImpl::RegisterInfo& reg = function_state_.register_infos()[reg_idx];
 
       // The argument register may not be available if this is a non-strict
       // kernel that is starting before all operands are available. In that
@@ -421,7 +657,8 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
       AsyncValue* value = GetOrCreateRegisterValue(&reg, GetHost());
       // TODO(b/142757465): remove arguments_and_results_ vector in KernelFrame.
       kernel_frame.AddArg(value);
-      if (value->IsError()) any_error_argument = value;
+      if (LLVM_UNLIKELY(check_errors) && value->IsError())
+        any_error_argument = value;
     }
 
     // TODO(b/142757465): remove arguments_and_results_ vector in KernelFrame.
@@ -431,11 +668,20 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
     entry_offset += arguments.size();
     auto attributes =
         kernel.GetKernelEntries(entry_offset, kernel.num_attributes());
-    for (auto attribute_offset : attributes) {
+    for (int i = 0; i < attributes.size(); ++i) {
+      if (i < kNumInlineAttributeBits &&
+          (kernel.special_metadata() &
+           (1u << (kInlineAttributeShift + i)))) {
+        // Small scalar attributes are stored inline in the kernel entry
+        // word, so point the attribute at the already-resident word instead
+        // of chasing an offset into the attributes section.
+        kernel_frame.AddAttribute(&attributes[i]);
+        continue;
+      }
       // We pass the pointer here because this attribute could be an array of
       // size 0.
       kernel_frame.AddAttribute(bef_file_->attribute_section_.data() +
-                                attribute_offset);
+                                attributes[i]);
     }
 
     // Set up functions.
@@ -450,16 +696,25 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
     // If all arguments are good or if the kernel is non-strict, run the
     // function.
     if (any_error_argument == nullptr || is_nonstrict_kernel) {
-      // Get the location to pass down to the kernels so they can report an
-      // error.
+      // Give the kernel its location as the opaque BEF offset so it can
+      // report an error. Decoding the offset into a filename/line/column is
+      // deferred until an error actually fires.
       kernel_frame.SetLocation(
-          {location_handler_.get(), kernel.kernel_location()});
+          {bef_file_.get(), kernel.kernel_location()});
 
       // kernel_fn should populate results in kernel_frame with pointers to
       // AsyncValue before it returns.
+      if (RequestContext* req = exec_ctx_.request_ctx()) req->RecordKernelRun();
       {
         TFRT_TRACE_KERNEL_SCOPE(bef_file_->GetKernelName(kernel.kernel_code()));
-        kernel_fn(&kernel_frame);
+        if (auto* cycle_totals = bef_file_->kernel_cycle_totals()) {
+          const uint64_t start = KernelCostTimestamp();
+          kernel_fn(&kernel_frame);
+          cycle_totals[kernel.kernel_code()].fetch_add(
+              KernelCostTimestamp() - start, std::memory_order_relaxed);
+        } else {
+          kernel_fn(&kernel_frame);
+        }
       }
     } else {
       // Otherwise, automatically propagate errors to the result values.
@@ -485,12 +740,11 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
     entry_offset += results.size();
     for (int result_number = 0; result_number < results.size();
          ++result_number) {
-      auto& result_register = register_infos_[results[result_number]];
+      auto& result_register = function_state_.register_infos()[results[result_number]];
 
-      // This kernel is not a pesudo kernel, assert the result register is
-      // either unset or an IndirectAsyncValue.
-      assert(GetRegisterValue(result_register) == nullptr ||
-             GetRegisterValue(result_register)->IsUnresolvedIndirect());
+      // This kernel is not a pseudo kernel, assert the result register has no
+      // final value yet - at most parked consumers waiting for one.
+      assert(!RegisterValueIsSet(result_register));
 
       // Copy back the result AsyncValue to this result register.
       AsyncValue* result = kernel_frame.GetResultAt(result_number);
@@ -503,15 +757,11 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
         continue;
       }
 
-      bool register_already_set;
-      auto* register_value =
-          SetRegisterValue(&result_register, result, &register_already_set);
+      auto* register_value = SetRegisterValue(&result_register, result,
+                                              GetHost());
       // Process users of this result.
       ProcessUsedBys(kernel, result_number, register_value, &entry_offset,
-                     kernel_ids);
-
-      // DropRef since we no longer need the IndirectAsyncValue in the register.
-      if (register_already_set) register_value->DropRef();
+                     ready_kernel_ids);
     }
   }
 }
@@ -520,47 +770,52 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
 // Executor Setup
 //===----------------------------------------------------------------------===//
 
-BEFExecutor::BEFExecutor(BEFFileImpl* bef_file, HostContext* host,
+BEFExecutor::BEFExecutor(BEFFileImpl* bef_file,
+                         const ExecutionContext& exec_ctx,
                          ArrayRef<uint32_t> kernels,
-                         HostArray<BEFFileImpl::KernelInfo> kernel_infos,
-                         HostArray<BEFFileImpl::RegisterInfo> register_infos,
+                         BEFFileImpl::FunctionState function_state,
                          bool has_arguments_pseudo_kernel)
     : bef_file_(FormRef(bef_file)),
       kernels_(kernels),
-      kernel_infos_(std::move(kernel_infos)),
-      register_infos_(std::move(register_infos)),
-      location_handler_(
-          TakeRef(host->Construct<BEFLocationHandler>(host, bef_file))) {
+      function_state_(std::move(function_state)),
+      exec_ctx_(exec_ctx) {
   // Now that the executor object is all set up and ready to go, kick off the
   // instructions that are ready.
 
-  // InitializeKernels initialized each KernelInfo::arguments_not_ready to one
-  // plus the number of arguments. This means that as we walk the list to drop
-  // the argument count, if we hit zero then it is time for us to trigger the
-  // computation. This arrangement is nice because any sync or async kernel that
-  // immediately produces results will immediately unblock subsequent kernels to
-  // be run by the primary host thread, which results in zero thread hops, clean
-  // top-down execution semantics (very cache friendly), and results in all the
-  // atomics staying in that cores' cache.
-  SmallVector<unsigned, 16> kernel_ids_to_visit;
-  // If a kernel's result has multiple uses, DecrementArgumentsNotReadyCounts
-  // pops one kernel_id and pushes multiple user kernel_ids, increasing the size
-  // of kernel_ids_to_visit. We reserve some extra space to accommodate this
+  // ReadFunction initialized each KernelInfo::arguments_not_ready to one
+  // plus the number of arguments. This means that as we walk the kernel list
+  // to drop the extra count, any kernel that hits zero has no outstanding
+  // operands and goes on the ready list. This arrangement is nice because any
+  // sync or async kernel that immediately produces results will immediately
+  // unblock subsequent kernels to be run by the primary host thread, which
+  // results in zero thread hops, clean top-down execution semantics (very
+  // cache friendly), and results in all the atomics staying in that cores'
+  // cache.
+  SmallVector<unsigned, 16> ready_kernel_ids;
+  // If a kernel's result has multiple uses, ProcessReadyKernels pops one
+  // kernel_id and may push multiple ready user kernel_ids, increasing the size
+  // of ready_kernel_ids. We reserve some extra space to accommodate this
   // growth.
-  kernel_ids_to_visit.reserve(kernel_infos_.size() + 4);
-  // Reverse indices in kernel_ids_to_visit because
-  // DecrementArgumentsNotReadyCounts processes its argument from back to front.
-  for (unsigned i = 0, e = kernel_infos_.size(); i != e; ++i) {
-    kernel_ids_to_visit.push_back(e - i - 1);
+  ready_kernel_ids.reserve(function_state_.kernel_infos().size() + 4);
+
+  MutableArrayRef<BEFFileImpl::KernelInfo> kernel_infos_array =
+      function_state_.kernel_infos();
+  // The first kernel can be a pseudo kernel that provides the arguments, which
+  // gets special handling and never executes, so it stays off the ready list.
+  unsigned first_kernel_id = has_arguments_pseudo_kernel ? 1 : 0;
+  // Drop the extra count in reverse order so that ready kernels are executed
+  // in their original top-down order when popped from the back of the list.
+  for (unsigned i = kernel_infos_array.size(); i != first_kernel_id; --i) {
+    auto& arguments_not_ready = kernel_infos_array[i - 1].arguments_not_ready;
+    if (arguments_not_ready.fetch_sub(1) == 1)
+      ready_kernel_ids.push_back(i - 1);
   }
 
-  // The first kernel can be a pseudo kernel provides the arguments, which gets
-  // special handling.
   if (has_arguments_pseudo_kernel) {
-    ProcessArgumentsPseudoKernel(&kernel_ids_to_visit);
+    ProcessArgumentsPseudoKernel(&ready_kernel_ids);
   }
 
-  DecrementArgumentsNotReadyCounts(&kernel_ids_to_visit);
+  ProcessReadyKernels(&ready_kernel_ids);
 }
 
 BEFExecutor::~BEFExecutor() {}
@@ -581,9 +836,10 @@ static void InitializeArgumentRegisters(
 }
 
 void BEFExecutor::Execute(const BEFFunction& fn,
+                          const ExecutionContext& exec_ctx,
                           ArrayRef<AsyncValue*> arguments,
-                          MutableArrayRef<RCReference<AsyncValue>> results,
-                          HostContext* host) {
+                          MutableArrayRef<RCReference<AsyncValue>> results) {
+  HostContext* host = exec_ctx.host();
   DEBUG_PRINT("Execute function %s start\n",
               fn.name().empty() ? "(unknown)" : fn.name().str().c_str());
 
@@ -594,32 +850,42 @@ void BEFExecutor::Execute(const BEFFunction& fn,
          "incorrect number of results passed to function call");
 
   size_t location_offset;
-  HostArray<BEFFileImpl::RegisterInfo> register_infos;
-  HostArray<BEFFileImpl::KernelInfo> kernel_infos;
+  BEFFileImpl::FunctionState function_state;
   SmallVector<size_t, 4> result_regs;
 
+  // All per-invocation state, including the executor object itself, lives in
+  // a single arena allocation owned by function_state.
+  AllocationTagScope tag_scope("BEFExecutor");
   auto kernels = bef_file->ReadFunction(
-      fn.function_offset(), fn.result_types(), &location_offset,
-      &register_infos, &kernel_infos, &result_regs, host->allocator());
+      fn.function_offset(), fn.result_types(), sizeof(BEFExecutor),
+      alignof(BEFExecutor), &location_offset, &function_state, &result_regs,
+      host->allocator());
   if (kernels.empty()) return;
   assert(result_regs.size() == fn.result_types().size());
 
   MutableArrayRef<BEFFileImpl::RegisterInfo> register_array =
-      register_infos.mutable_array();
+      function_state.register_infos();
   InitializeArgumentRegisters(arguments, register_array);
-  auto* exec_ptr = host->Allocate<BEFExecutor>();
+  auto* exec_ptr = function_state.leading_storage();
   auto* exec = new (exec_ptr)
-      BEFExecutor(bef_file, host, kernels, std::move(kernel_infos),
-                  std::move(register_infos), !arguments.empty());
+      BEFExecutor(bef_file, exec_ctx, kernels, std::move(function_state),
+                  !arguments.empty());
+
+  // A function that starts with an error argument is already poisoned.
+  for (auto* argument : arguments)
+    if (argument->IsError()) {
+      exec->seen_error_.store(true, std::memory_order_relaxed);
+      break;
+    }
 
   // Populate the function result AsyncValues (results).
   //
   // Due to the presence of async kernels, the result registers may not contain
   // an AsyncValue yet at this point. If a result register contains an
-  // AsyncValue, we use it as the result. Otherwise, we make a
-  // IndirectAsyncValue as the function result and store the IndirectAsyncValue
-  // in the result register. When the actual AsyncValue is available, we set the
-  // IndirectAsyncValue to point to the actual value.
+  // AsyncValue, we use it as the result. Otherwise, we make an
+  // IndirectAsyncValue as the function result and park it on the register's
+  // waiter list. When the actual AsyncValue is available, the producing kernel
+  // resolves the IndirectAsyncValue directly.
   for (size_t i = 0, e = results.size(); i != e; ++i) {
     assert(!results[i] && "result AsyncValue is not nullptr");
     BEFFileImpl::RegisterInfo& result_reg = register_array[result_regs[i]];
@@ -641,10 +907,11 @@ void BEFExecutor::Execute(const BEFFunction& fn,
 //===----------------------------------------------------------------------===//
 
 /// Execute a function with the specified CPU context.
-void BEFFunction::Execute(ArrayRef<AsyncValue*> arguments,
-                          MutableArrayRef<RCReference<AsyncValue>> results,
-                          HostContext* host) const {
-  BEFExecutor::Execute(*this, arguments, results, host);
+void BEFFunction::Execute(const ExecutionContext& exec_ctx,
+                          ArrayRef<AsyncValue*> arguments,
+                          MutableArrayRef<RCReference<AsyncValue>> results)
+    const {
+  BEFExecutor::Execute(*this, exec_ctx, arguments, results);
 }
 
 // To keep this function alive, we have to keep the underlying BEF file alive.
@@ -21,13 +21,29 @@
 
 #include "tfrt/bef_executor/bef_file.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
 #include "bef_file_impl.h"
+#include "llvm/Support/MathExtras.h"
 #include "tfrt/host_context/async_value.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/native_function.h"
+#include "tfrt/metrics/metrics_api.h"
 #include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/bef_reader.h"
+#include "tfrt/support/string_util.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace tfrt {
 
@@ -35,6 +51,18 @@ namespace tfrt {
 
 namespace {
 
+// On-disk format of the kernel resolution cache (see
+// BEFFile::SaveKernelResolutionCache): this header followed by one uint32
+// registry ordinal per kernel table entry. The fingerprint ties the ordinals
+// to one exact kernel registration set; a mismatch makes the cache stale and
+// the reader falls back to name resolution.
+struct KernelCacheHeader {
+  uint32_t magic;
+  uint32_t num_kernels;
+  uint64_t fingerprint;
+};
+constexpr uint32_t kKernelCacheMagic = 0x434B4654;  // "TFKC", little endian.
+
 // This struct is a simple representation of an entry in FunctionIndex section.
 struct FunctionIndex {
   FunctionKind kind;
@@ -58,11 +86,17 @@ class BEFFileReader : public BEFReader {
       : BEFReader(file), registry_(registry), bef_file_(bef_file) {}
 
   bool ReadNextSection();
-  bool ReadKernelsSection(HostAllocator* host_allocator);
+  bool ReadKernelsSection(HostAllocator* host_allocator,
+                          string_view kernel_resolution_cache);
   bool ReadTypesSection();
   bool ReadFunctionIndexSection();
 
  private:
+  // Try to resolve the kernel table from a persisted resolution cache.
+  // Returns true if the cache is missing, stale or malformed; the caller
+  // falls back to name resolution.
+  bool ReadKernelsSectionFromCache(string_view kernel_resolution_cache);
+
   bool ReadFunctionIndexSectionInternal(
       SmallVectorImpl<FunctionIndex>* function_indices);
   bool ReadFormatVersionSection();
@@ -156,10 +190,14 @@ bool BEFFileReader::ReadFormatVersionSection() {
   // In the case of the FormatVersion section, we verify that we have a
   // supported version.
   uint8_t version;
-  if (ReadByte(&version) || version != kBEFVersion0)
+  if (ReadByte(&version) ||
+      (version != kBEFVersion0 && version != kBEFVersion1))
     return bef_file_->EmitFormatError("BEF file has unknown version number"),
            true;
 
+  // Remember the version; it selects the function body encoding.
+  bef_file_->format_version_ = version;
+
   // TODO: Should have per-file location info in the header.
   return false;
 }
@@ -194,19 +232,18 @@ bool BEFFileReader::DiagnoseUnknownKernel(size_t kernel_idx,
   for (const auto& function_index : function_indices) {
     if (function_index.kind != FunctionKind::kBEFFunction) continue;
 
-    HostArray<BEFFileImpl::RegisterInfo> register_infos;
-    HostArray<BEFFileImpl::KernelInfo> kernel_infos;
+    BEFFileImpl::FunctionState function_state;
     result_regs.clear();
     size_t location_offset;
     auto kernels = bef_file_->ReadFunction(
         function_index.function_offset, function_index.results,
-        &location_offset, &register_infos, &kernel_infos, &result_regs,
-        host_allocator);
+        /*leading_bytes=*/0, /*leading_alignment=*/1, &location_offset,
+        &function_state, &result_regs, host_allocator);
     if (kernels.empty()) continue;
 
     // Decode all of the kernels to see if any refers to our unknown kernel.
     MutableArrayRef<BEFFileImpl::KernelInfo>& kernel_infos_array =
-        kernel_infos.mutable_array();
+        function_state.kernel_infos();
     for (const auto& kernel_info : kernel_infos_array) {
       assert(kernel_info.offset % kKernelEntryAlignment == 0);
       BEFKernel kernel(kernels.data() +
@@ -229,20 +266,88 @@ bool BEFFileReader::DiagnoseUnknownKernel(size_t kernel_idx,
   return true;
 }
 
+bool BEFFileReader::ReadKernelsSectionFromCache(
+    string_view kernel_resolution_cache) {
+  std::FILE* file = std::fopen(kernel_resolution_cache.str().c_str(), "rb");
+  if (!file) return true;
+
+  KernelCacheHeader header;
+  bool usable = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                header.magic == kKernelCacheMagic &&
+                header.fingerprint == registry_->GetFingerprint();
+
+  // The cache must describe exactly this file's kernel table.
+  size_t num_kernels = 0;
+  BEFReader reader(bef_file_->kernels_section_);
+  usable = usable && !reader.ReadInt(&num_kernels) &&
+           header.num_kernels == num_kernels;
+
+  std::vector<uint32_t> ordinals;
+  if (usable) {
+    ordinals.resize(num_kernels);
+    usable = std::fread(ordinals.data(), sizeof(uint32_t), num_kernels,
+                        file) == num_kernels;
+  }
+  std::fclose(file);
+  if (!usable) return true;
+
+  const size_t num_registered = registry_->GetNumKernels();
+  bef_file_->kernels_.reserve(num_kernels);
+  bef_file_->kernel_cost_classes_.reserve(num_kernels);
+  for (uint32_t ordinal : ordinals) {
+    if (ordinal >= num_registered) {
+      bef_file_->kernels_.clear();
+      bef_file_->kernel_cost_classes_.clear();
+      return true;
+    }
+    bef_file_->kernels_.push_back(registry_->GetKernelByOrdinal(ordinal));
+    bef_file_->kernel_cost_classes_.push_back(
+        registry_->GetKernelCostClassByOrdinal(ordinal));
+  }
+  return false;
+}
+
 // Read the Kernels section from a BEF file, resolving the kernels and
 // returning false on success.  Emit an error and return true on failure.
-bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator) {
+bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator,
+                                       string_view kernel_resolution_cache) {
   auto format_error = [&]() -> bool {
     bef_file_->EmitFormatError("invalid Kernels section in BEF file");
     return true;
   };
 
+  // A usable resolution cache replaces per-kernel name lookups with ordinal
+  // indexing; this also short-circuits lazy-decode mode, since cached
+  // resolution is cheap enough to do eagerly.
+  if (!kernel_resolution_cache.empty() &&
+      !ReadKernelsSectionFromCache(kernel_resolution_cache))
+    return false;
+
   BEFReader reader(bef_file_->kernels_section_);
 
   size_t num_kernels;
   if (reader.ReadInt(&num_kernels)) return format_error();
 
+  // In lazy-decode mode only the name offsets are recorded here; each kernel
+  // is resolved against the registry when a function referencing it is first
+  // executed.
+  if (bef_file_->lazy_decode_) {
+    bef_file_->kernel_name_offsets_.reserve(num_kernels);
+    bef_file_->kernels_.assign(num_kernels, nullptr);
+    bef_file_->kernel_cost_classes_.assign(num_kernels,
+                                           KernelCostClass::kNormal);
+    while (num_kernels--) {
+      size_t kernel_name_offset;
+      if (reader.ReadInt(&kernel_name_offset) ||
+          kernel_name_offset >= bef_file_->string_section_.size())
+        return format_error();
+      bef_file_->kernel_name_offsets_.push_back(kernel_name_offset);
+    }
+    return false;
+  }
+
   bef_file_->kernels_.reserve(num_kernels);
+  bef_file_->kernel_cost_classes_.reserve(num_kernels);
   while (num_kernels--) {
     // Each kernel is encoded as an offset into the string table of the
     // kernel name.
@@ -263,8 +368,11 @@ bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator) {
                                    host_allocator);
     }
 
-    // Otherwise remember it.
+    // Otherwise remember it, along with its cost class so the executor can
+    // make dispatch decisions without going back to the registry.
     bef_file_->kernels_.push_back(kernel);
+    bef_file_->kernel_cost_classes_.push_back(
+        registry_->GetKernelCostClass(kernel_name));
   }
 
   return false;
@@ -393,6 +501,12 @@ bool BEFFileReader::ReadFunctionIndexSection() {
         auto bef_function = std::make_unique<BEFFunction>(
             name, function_index.arguments, function_index.results,
             function_index.function_offset, bef_file_);
+        // Record the function's scheduling state so that per-invocation
+        // setup is a copy of the template rather than a header decode. In
+        // lazy-decode mode the template is built on first Execute instead,
+        // so opening the file does not touch the function bodies.
+        if (!bef_file_->lazy_decode_)
+          bef_file_->CacheFunctionTemplate(*bef_function);
         bef_file_->functions_.push_back(std::move(bef_function));
         break;
       }
@@ -417,13 +531,13 @@ bool BEFFileReader::ReadFunctionIndexSection() {
 
 BEFFile::~BEFFile() {}
 
-RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
-                                   KernelRegistry* registry,
-                                   ErrorHandler error_handler,
-                                   tfrt::HostAllocator* host_allocator) {
-  auto* bef_impl = new BEFFileImpl(error_handler);
-  auto bef_rc = TakeRef(bef_impl);
-
+// Run the section readers over `file` into `bef_impl`, honoring its
+// lazy_decode_ mode. Returns true on failure after emitting an error.
+static bool ReadBEFSections(ArrayRef<uint8_t> file, KernelRegistry* registry,
+                            HostAllocator* host_allocator,
+                            BEFFileImpl* bef_impl,
+                            string_view kernel_resolution_cache) {
+  bef_impl->registry_ = registry;
   BEFFileReader reader(file, registry, bef_impl);
 
   uint8_t header[2];
@@ -432,98 +546,380 @@ RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
   if (reader.ReadByte(&header[0]) || reader.ReadByte(&header[1]) ||
       header[0] != kBEFMagic1 || header[1] != kBEFMagic2) {
     bef_impl->EmitFormatError("invalid BEF file header detected");
-    return {};
+    return true;
   }
 
   while (!reader.Empty()) {
-    if (reader.ReadNextSection()) return {};
+    if (reader.ReadNextSection()) return true;
   }
 
   // Now that we've figured out the contents of the sections, resolve some
   // things.
-  if (reader.ReadKernelsSection(host_allocator) || reader.ReadTypesSection() ||
-      reader.ReadFunctionIndexSection())
+  return reader.ReadKernelsSection(host_allocator, kernel_resolution_cache) ||
+         reader.ReadTypesSection() || reader.ReadFunctionIndexSection();
+}
+
+RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
+                                   KernelRegistry* registry,
+                                   ErrorHandler error_handler,
+                                   tfrt::HostAllocator* host_allocator,
+                                   string_view kernel_resolution_cache) {
+  auto* bef_impl = new BEFFileImpl(error_handler);
+  auto bef_rc = TakeRef(bef_impl);
+
+  if (ReadBEFSections(file, registry, host_allocator, bef_impl,
+                      kernel_resolution_cache))
     return {};
 
+  bef_impl->InitKernelCostAccounting();
+
   // Now that we decoded the whole thing, return the BEFFile to the caller.
   return bef_rc;
 }
 
+RCReference<BEFFile> BEFFile::OpenFile(string_view path,
+                                       KernelRegistry* registry,
+                                       ErrorHandler error_handler,
+                                       tfrt::HostAllocator* host_allocator,
+                                       string_view kernel_resolution_cache) {
+#if !defined(_WIN32)
+  auto* bef_impl = new BEFFileImpl(error_handler);
+  auto bef_rc = TakeRef(bef_impl);
+
+  std::string path_str = path.str();
+  int fd = open(path_str.c_str(), O_RDONLY);
+  if (fd < 0) {
+    bef_impl->EmitFormatError("could not open BEF file");
+    return {};
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    bef_impl->EmitFormatError("could not stat BEF file");
+    return {};
+  }
+
+  size_t size = file_stat.st_size;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping holds its own reference to the file.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    bef_impl->EmitFormatError("could not mmap BEF file");
+    return {};
+  }
+  bef_impl->mapped_region_ = mapping;
+  bef_impl->mapped_region_size_ = size;
+
+  // Defer function body decoding and kernel resolution to first Execute, so
+  // opening the file faults in only the section headers, the function index
+  // and the small metadata sections.
+  bef_impl->lazy_decode_ = true;
+  bef_impl->registry_ = registry;
+
+  ArrayRef<uint8_t> file(static_cast<const uint8_t*>(mapping), size);
+  if (ReadBEFSections(file, registry, host_allocator, bef_impl,
+                      kernel_resolution_cache))
+    return {};
+
+  bef_impl->InitKernelCostAccounting();
+
+  return bef_rc;
+#else
+  (void)path;
+  (void)registry;
+  (void)host_allocator;
+  (void)kernel_resolution_cache;
+  error_handler(
+      DecodedDiagnostic("memory-mapped BEF loading is not supported here"));
+  return {};
+#endif
+}
+
 BEFFileImpl::BEFFileImpl(std::function<void(DecodedDiagnostic)> error_handler)
     : error_handler_(error_handler) {}
 
-BEFFileImpl::~BEFFileImpl() {}
+BEFFileImpl::~BEFFileImpl() {
+  // Publish the final cost profile so short-lived processes still export a
+  // complete hot list through the metrics registry.
+  if (kernel_cycle_totals_) {
+    std::string profile = GetKernelCostProfile();
+    if (!profile.empty()) {
+      static auto* profile_metric = metrics::NewGauge<std::string>(
+          "/tfrt/bef_executor/kernel_cycles");
+      profile_metric->SetValue(std::move(profile));
+    }
+  }
+#if !defined(_WIN32)
+  if (mapped_region_) munmap(mapped_region_, mapped_region_size_);
+#endif
+}
+
+void BEFFileImpl::InitKernelCostAccounting() {
+  static const bool enabled = getenv("TFRT_BEF_KERNEL_COST_ACCOUNTING");
+  if (!enabled || kernels_.empty()) return;
+  // Value-initialization zeroes the accumulators.
+  kernel_cycle_totals_.reset(new std::atomic<uint64_t>[kernels_.size()]());
+}
+
+std::string BEFFileImpl::GetKernelCostProfile() {
+  if (!kernel_cycle_totals_) return "";
+
+  // Collect the kernels that actually ran, most cycles first. Ties are broken
+  // by kernel id so the output is stable across runs.
+  SmallVector<std::pair<uint64_t, size_t>, 16> totals;
+  for (size_t i = 0, e = kernels_.size(); i != e; ++i) {
+    uint64_t cycles = kernel_cycle_totals_[i].load(std::memory_order_relaxed);
+    if (cycles != 0) totals.push_back({cycles, i});
+  }
+  std::sort(totals.begin(), totals.end(),
+            [](const std::pair<uint64_t, size_t>& a,
+               const std::pair<uint64_t, size_t>& b) {
+              return a.first != b.first ? a.first > b.first
+                                        : a.second < b.second;
+            });
+
+  std::string profile;
+  for (const auto& entry : totals)
+    profile += StrCat(profile.empty() ? "" : " ", GetKernelName(entry.second),
+                      "=", entry.first);
+  return profile;
+}
 
 void BEFFileImpl::EmitFormatError(const char* message) {
   error_handler_(DecodedDiagnostic(message));
 }
 
-ArrayRef<uint32_t> BEFFileImpl::ReadFunction(
-    size_t function_offset, ArrayRef<TypeName> results, size_t* location_offset,
-    HostArray<RegisterInfo>* register_infos,
-    HostArray<KernelInfo>* kernel_infos, SmallVectorImpl<size_t>* result_regs,
-    HostAllocator* host_allocator) {
-  auto format_error = [&]() -> ArrayRef<uint32_t> {
-    EmitFormatError("invalid Function section in BEF file");
-    return {};
-  };
-
-  if (function_offset >= function_section_.size()) return format_error();
+bool BEFFileImpl::DecodeFunction(size_t function_offset,
+                                 ArrayRef<TypeName> results,
+                                 FunctionTemplate* function_template) {
+  if (function_offset >= function_section_.size()) return true;
 
   BEFReader reader(function_section_.drop_front(function_offset));
 
   // First we have the location info and register info table.
   size_t num_registers;
-  if (reader.ReadInt(location_offset) || reader.ReadInt(&num_registers))
-    return format_error();
+  if (reader.ReadInt(&function_template->location_offset) ||
+      reader.ReadInt(&num_registers))
+    return true;
 
-  *register_infos = HostArray<RegisterInfo>(num_registers, host_allocator);
-  auto* register_info_ptr = register_infos->mutable_array().data();
-  unsigned register_idx = 0;
-  while (num_registers--) {
-    size_t user_count;
-    if (reader.ReadInt(&user_count)) return format_error();
-    new (register_info_ptr + register_idx) RegisterInfo(user_count);
-    ++register_idx;
-  }
+  // Each VBR integer takes at least one byte, so a count larger than the
+  // remaining bytes is malformed; checking here keeps the resize below sane.
+  auto& register_words = function_template->register_words;
+  if (num_registers > reader.file().size()) return true;
+  register_words.resize(num_registers);
+  if (reader.ReadInts(num_registers, register_words.data())) return true;
+
+  // Version 0 register words are plain user counts; normalize them to the
+  // packed (user_count << 1 | single_ordered_use) form emitted by version 1.
+  if (format_version_ < kBEFVersion1)
+    for (auto& word : register_words) word <<= 1;
 
   // Next we have the kernel index table.
   size_t num_kernels;
-  if (reader.ReadInt(&num_kernels)) return format_error();
+  if (reader.ReadInt(&num_kernels)) return true;
+  if (num_kernels > reader.file().size() / 2) return true;
 
-  *kernel_infos = HostArray<KernelInfo>(num_kernels, host_allocator);
-  auto* kernel_info_ptr = kernel_infos->mutable_array().data();
-  unsigned kernel_idx = 0;
-  while (num_kernels--) {
-    size_t offset, num_operands;
-    if (reader.ReadInt(&offset) || reader.ReadInt(&num_operands))
-      return format_error();
-    new (kernel_info_ptr + kernel_idx)
-        KernelInfo(unsigned(offset), unsigned(num_operands));
-    ++kernel_idx;
-  }
+  auto& kernel_entries = function_template->kernel_entries;
+  SmallVector<unsigned, 32> entry_words;
+  entry_words.resize(num_kernels * 2);
+  if (reader.ReadInts(entry_words.size(), entry_words.data())) return true;
+  kernel_entries.reserve(num_kernels);
+  for (size_t i = 0; i != num_kernels; ++i)
+    kernel_entries.push_back({entry_words[i * 2], entry_words[i * 2 + 1]});
 
   // Read the result registers.
-  result_regs->reserve(results.size());
+  auto& result_regs = function_template->result_regs;
+  result_regs.reserve(results.size());
   for (unsigned i = 0, e = results.size(); i != e; ++i) {
     size_t result_reg;
-    if (reader.ReadInt(&result_reg) || result_reg >= register_infos->size())
-      return format_error();
-    result_regs->push_back(result_reg);
+    if (reader.ReadInt(&result_reg) || result_reg >= num_registers)
+      return true;
+    result_regs.push_back(result_reg);
+  }
+
+  if (format_version_ >= kBEFVersion1) {
+    // Compact function body: the kernel words are stored as a VBR stream
+    // prefixed with the word count. Decode them once into template-owned
+    // storage; the offsets in kernel_entries index the decoded words exactly
+    // as they index the mapped words in version 0.
+    size_t num_words;
+    if (reader.ReadInt(&num_words) ||
+        num_words > reader.file().size())
+      return true;
+    auto& storage = function_template->kernel_storage;
+    storage.resize(num_words);
+    if (reader.ReadInts(num_words, storage.data())) return true;
+    function_template->kernels = storage;
+    return false;
   }
 
   // Kernels are aligned to kKernelEntryAlignment.
-  if (reader.ReadAlignment(kKernelEntryAlignment)) return format_error();
+  if (reader.ReadAlignment(kKernelEntryAlignment)) return true;
 
   // We found the start of our kernel section.
-  return llvm::makeArrayRef(
+  function_template->kernels = llvm::makeArrayRef(
       reinterpret_cast<const uint32_t*>(reader.file().begin()),
       reader.file().size() / kKernelEntryAlignment);
+  return false;
+}
+
+bool BEFFileImpl::ResolveKernels(const FunctionTemplate& function_template) {
+  for (const auto& entry : function_template.kernel_entries) {
+    assert(entry.first % kKernelEntryAlignment == 0);
+    BEFKernel kernel(function_template.kernels.data() +
+                     entry.first / kKernelEntryAlignment);
+
+    uint32_t kernel_code = kernel.kernel_code();
+    if (kernel_code >= kernels_.size()) {
+      EmitFormatError("invalid kernel code in BEF function");
+      return true;
+    }
+    if (kernels_[kernel_code] != nullptr) continue;
+
+    const char* kernel_name = reinterpret_cast<const char*>(
+        &string_section_[kernel_name_offsets_[kernel_code]]);
+    auto* kernel_impl = registry_->GetKernel(kernel_name);
+    if (!kernel_impl) {
+      // Unlike eager loading there is no need to scan for the referencing
+      // kernel: we are looking at it, so its location is at hand.
+      error_handler_(DecodedDiagnostic(
+          DecodeLocation(kernel.kernel_location()),
+          "unknown kernel name '" + std::string(kernel_name) + "'"));
+      return true;
+    }
+    kernels_[kernel_code] = kernel_impl;
+    kernel_cost_classes_[kernel_code] =
+        registry_->GetKernelCostClass(kernel_name);
+  }
+  return false;
+}
+
+const BEFFileImpl::FunctionTemplate* BEFFileImpl::GetOrDecodeFunctionTemplate(
+    size_t function_offset, ArrayRef<TypeName> results) {
+  mutex_lock lock(decode_mu_);
+
+  auto it = lazy_function_templates_.find(function_offset);
+  if (it != lazy_function_templates_.end()) return it->second.get();
+
+  auto function_template = std::make_unique<FunctionTemplate>();
+  if (DecodeFunction(function_offset, results, function_template.get())) {
+    EmitFormatError("invalid Function section in BEF file");
+    return nullptr;
+  }
+
+  // Resolve the kernels this function references before publishing the
+  // template, so executors stamping a published template read fully
+  // resolved kernels_ entries. The lock's release ordering makes those
+  // entries visible to any thread that fetches the template afterwards.
+  if (ResolveKernels(*function_template)) return nullptr;
+
+  const FunctionTemplate* result = function_template.get();
+  lazy_function_templates_.try_emplace(function_offset,
+                                       std::move(function_template));
+  return result;
+}
+
+void BEFFileImpl::CacheFunctionTemplate(const BEFFunction& function) {
+  FunctionTemplate function_template;
+  if (DecodeFunction(function.function_offset(), function.result_types(),
+                     &function_template))
+    return;
+  function_templates_.try_emplace(function.function_offset(),
+                                  std::move(function_template));
+}
+
+ArrayRef<uint32_t> BEFFileImpl::ReadFunction(
+    size_t function_offset, ArrayRef<TypeName> results, size_t leading_bytes,
+    size_t leading_alignment, size_t* location_offset,
+    FunctionState* function_state, SmallVectorImpl<size_t>* result_regs,
+    HostAllocator* host_allocator) {
+  auto format_error = [&]() -> ArrayRef<uint32_t> {
+    EmitFormatError("invalid Function section in BEF file");
+    return {};
+  };
+
+  // In the common case the scheduling state of this function was decoded once
+  // at Open time, and we just stamp the template out below. Fall back to
+  // decoding it here for functions that are not in the cache (e.g. during
+  // load-time diagnostics, before the cache is built).
+  FunctionTemplate local_template;
+  const FunctionTemplate* function_template;
+  InvocationArenaPool* arena_pool = nullptr;
+  auto template_it = function_templates_.find(function_offset);
+  if (template_it != function_templates_.end()) {
+    function_template = &template_it->second;
+    arena_pool = template_it->second.arena_pool.get();
+  } else if (lazy_decode_) {
+    // Lazy-decode mode: build (or fetch) the template on first Execute of
+    // this function. GetOrDecodeFunctionTemplate emits its own errors.
+    const FunctionTemplate* lazy_template =
+        GetOrDecodeFunctionTemplate(function_offset, results);
+    if (!lazy_template) return {};
+    function_template = lazy_template;
+    arena_pool = lazy_template->arena_pool.get();
+  } else {
+    if (DecodeFunction(function_offset, results, &local_template))
+      return format_error();
+    // Note: the local template's arena pool dies with this call, so the
+    // invocation arena is not recycled on this fallback path.
+    function_template = &local_template;
+  }
+
+  *location_offset = function_template->location_offset;
+  size_t num_registers = function_template->register_words.size();
+  size_t num_kernels = function_template->kernel_entries.size();
+
+  // Lay out the arena: the caller's leading storage, then the register info
+  // array, then the kernel info array.
+  size_t register_infos_offset =
+      llvm::alignTo(leading_bytes, alignof(RegisterInfo));
+  size_t kernel_infos_offset = llvm::alignTo(
+      register_infos_offset + num_registers * sizeof(RegisterInfo),
+      alignof(KernelInfo));
+  size_t arena_size = kernel_infos_offset + num_kernels * sizeof(KernelInfo);
+  size_t arena_alignment =
+      std::max({leading_alignment, alignof(RegisterInfo), alignof(KernelInfo)});
+
+  function_state->Release();
+  void* arena =
+      arena_pool ? arena_pool->Acquire(arena_size, host_allocator) : nullptr;
+  if (!arena) arena = host_allocator->AllocateBytes(arena_size, arena_alignment);
+  function_state->arena_ = arena;
+  function_state->arena_size_ = arena_size;
+  function_state->host_allocator_ = host_allocator;
+  function_state->arena_pool_ = arena_pool;
+
+  char* arena_base = static_cast<char*>(function_state->arena_);
+  auto* register_info_ptr =
+      reinterpret_cast<RegisterInfo*>(arena_base + register_infos_offset);
+  for (size_t i = 0; i != num_registers; ++i) {
+    unsigned word = function_template->register_words[i];
+    new (register_info_ptr + i)
+        RegisterInfo(word >> 1, (word & 1) != 0);
+  }
+  function_state->register_infos_ =
+      MutableArrayRef<RegisterInfo>(register_info_ptr, num_registers);
+
+  auto* kernel_info_ptr =
+      reinterpret_cast<KernelInfo*>(arena_base + kernel_infos_offset);
+  for (size_t i = 0; i != num_kernels; ++i) {
+    const auto& entry = function_template->kernel_entries[i];
+    new (kernel_info_ptr + i) KernelInfo(entry.first, entry.second);
+  }
+  function_state->kernel_infos_ =
+      MutableArrayRef<KernelInfo>(kernel_info_ptr, num_kernels);
+
+  result_regs->assign(function_template->result_regs.begin(),
+                      function_template->result_regs.end());
+
+  return function_template->kernels;
 }
 
 // Given an offset into location_positions_section_, decode it and return
 // a DecodedDiagnostic.
-DecodedLocation BEFFileImpl::DecodeLocation(size_t location_position_offset) {
+DecodedLocation BEFFileImpl::DecodeLocation(
+    size_t location_position_offset) const {
   DecodedLocation result;
 
   // Read from location_positions_section_, from the specified offset.
@@ -591,6 +987,309 @@ const char* BEFFileImpl::GetKernelName(size_t kernel_id) {
   return kernel_names_[kernel_id];
 }
 
+bool BEFFile::SaveKernelResolutionCache(string_view path) const {
+  auto* impl = static_cast<const BEFFileImpl*>(this);
+
+  // Map every kernel table entry to its registry ordinal. Unknown kernels
+  // make the cache unwritable - such a file cannot fully load anyway.
+  BEFReader reader(impl->kernels_section_);
+  size_t num_kernels;
+  if (reader.ReadInt(&num_kernels)) return false;
+
+  std::vector<uint32_t> ordinals;
+  ordinals.reserve(num_kernels);
+  while (num_kernels--) {
+    size_t kernel_name_offset;
+    if (reader.ReadInt(&kernel_name_offset) ||
+        kernel_name_offset >= impl->string_section_.size())
+      return false;
+    const char* kernel_name = reinterpret_cast<const char*>(
+        &impl->string_section_[kernel_name_offset]);
+    size_t ordinal = impl->registry_->GetKernelOrdinal(kernel_name);
+    if (ordinal == KernelRegistry::kInvalidKernelOrdinal ||
+        ordinal > UINT32_MAX)
+      return false;
+    ordinals.push_back(ordinal);
+  }
+
+  std::FILE* file = std::fopen(path.str().c_str(), "wb");
+  if (!file) return false;
+
+  KernelCacheHeader header;
+  header.magic = kKernelCacheMagic;
+  header.num_kernels = ordinals.size();
+  header.fingerprint = impl->registry_->GetFingerprint();
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(ordinals.data(), sizeof(uint32_t), ordinals.size(),
+                        file) == ordinals.size();
+  // Treat a failed close as a failed write; the cache may be truncated.
+  ok = (std::fclose(file) == 0) && ok;
+  return ok;
+}
+
+// A function index entry in raw form: type lists are kept as indices into the
+// Types section, which ReloadFunctions requires to be unchanged, so index
+// equality is type equality.
+struct RawFunctionIndex {
+  uint8_t kind;
+  size_t function_offset;
+  size_t name_offset;
+  SmallVector<size_t, 4> argument_types;
+  SmallVector<size_t, 4> result_types;
+};
+
+// Parse a FunctionIndex section into raw entries. Returns true on malformed
+// input.
+static bool ParseRawFunctionIndex(ArrayRef<uint8_t> section,
+                                  SmallVectorImpl<RawFunctionIndex>* entries) {
+  BEFReader reader(section);
+  size_t num_functions;
+  if (reader.ReadInt(&num_functions)) return true;
+  entries->reserve(num_functions);
+  while (num_functions--) {
+    entries->emplace_back();
+    auto& entry = entries->back();
+    if (reader.ReadByte(&entry.kind) ||
+        reader.ReadInt(&entry.function_offset) ||
+        reader.ReadInt(&entry.name_offset))
+      return true;
+    size_t num_args;
+    if (reader.ReadInt(&num_args)) return true;
+    while (num_args--) {
+      size_t type;
+      if (reader.ReadInt(&type)) return true;
+      entry.argument_types.push_back(type);
+    }
+    size_t num_results;
+    if (reader.ReadInt(&num_results)) return true;
+    while (num_results--) {
+      size_t type;
+      if (reader.ReadInt(&type)) return true;
+      entry.result_types.push_back(type);
+    }
+  }
+  return false;
+}
+
+// Scan the section layout of `file` without modifying any file state.
+// Unknown section ids are skipped, like ReadNextSection does. Returns true on
+// malformed input.
+static bool ScanBEFSections(
+    ArrayRef<uint8_t> file, uint8_t* format_version,
+    ArrayRef<uint8_t> (&sections)[size_t(BEFSectionID::kNumSectionIDs)]) {
+  BEFReader reader(file);
+  uint8_t header[2];
+  if (reader.ReadByte(&header[0]) || reader.ReadByte(&header[1]) ||
+      header[0] != kBEFMagic1 || header[1] != kBEFMagic2)
+    return true;
+  while (!reader.Empty()) {
+    uint8_t section_id;
+    ArrayRef<uint8_t> section_data;
+    if (reader.ReadSection(&section_id, &section_data)) return true;
+    if (section_id == uint8_t(BEFSectionID::kFormatVersion)) {
+      BEFReader section_reader(section_data);
+      if (section_reader.ReadByte(format_version)) return true;
+    }
+    if (section_id < uint8_t(BEFSectionID::kNumSectionIDs))
+      sections[section_id] = section_data;
+    reader.SkipPast(section_data);
+  }
+  return false;
+}
+
+// Return the body bytes of the function starting at `offset`. The index does
+// not store sizes, so the body extends to the next function start (native
+// functions have zero-length bodies).
+static ArrayRef<uint8_t> GetFunctionBody(ArrayRef<uint8_t> function_section,
+                                         size_t offset,
+                                         ArrayRef<size_t> sorted_offsets) {
+  auto it =
+      std::upper_bound(sorted_offsets.begin(), sorted_offsets.end(), offset);
+  size_t end = it == sorted_offsets.end() ? function_section.size() : *it;
+  return function_section.slice(offset, end - offset);
+}
+
+bool BEFFile::ReloadFunctions(ArrayRef<uint8_t> file) {
+  auto* impl = static_cast<BEFFileImpl*>(this);
+
+  ArrayRef<uint8_t> sections[size_t(BEFSectionID::kNumSectionIDs)];
+  uint8_t format_version = kBEFVersion0;
+  if (ScanBEFSections(file, &format_version, sections)) return false;
+  auto section = [&](BEFSectionID id) { return sections[size_t(id)]; };
+
+  // Everything the retained decoded state points into must be unchanged.
+  if (format_version != impl->format_version_ ||
+      !section(BEFSectionID::kLocationFilenames)
+           .equals(impl->location_filenames_section_) ||
+      !section(BEFSectionID::kLocationPositions)
+           .equals(impl->location_positions_section_) ||
+      !section(BEFSectionID::kStrings).equals(impl->string_section_) ||
+      !section(BEFSectionID::kAttributes).equals(impl->attribute_section_) ||
+      !section(BEFSectionID::kKernels).equals(impl->kernels_section_) ||
+      !section(BEFSectionID::kTypes).equals(impl->types_section_))
+    return false;
+
+  SmallVector<RawFunctionIndex, 8> old_index, new_index;
+  if (ParseRawFunctionIndex(impl->function_index_section_, &old_index) ||
+      ParseRawFunctionIndex(section(BEFSectionID::kFunctionIndex), &new_index))
+    return false;
+  if (impl->functions_.size() != old_index.size()) return false;
+
+  // Kernels reference other functions by their index position, so existing
+  // functions must keep their positions and signatures; new functions may
+  // only be appended.
+  if (new_index.size() < old_index.size()) return false;
+  for (size_t i = 0, e = old_index.size(); i != e; ++i) {
+    if (old_index[i].kind != new_index[i].kind ||
+        old_index[i].name_offset != new_index[i].name_offset ||
+        old_index[i].argument_types != new_index[i].argument_types ||
+        old_index[i].result_types != new_index[i].result_types)
+      return false;
+  }
+
+  auto new_function_section = section(BEFSectionID::kFunctions);
+
+  // Validate appended functions before mutating anything.
+  for (size_t i = old_index.size(), e = new_index.size(); i != e; ++i) {
+    const auto& entry = new_index[i];
+    if (entry.name_offset >= impl->string_section_.size()) return false;
+    for (auto type : entry.argument_types)
+      if (type >= impl->type_names_.size()) return false;
+    for (auto type : entry.result_types)
+      if (type >= impl->type_names_.size()) return false;
+    const char* name = reinterpret_cast<const char*>(
+        &impl->string_section_[entry.name_offset]);
+    switch (static_cast<FunctionKind>(entry.kind)) {
+      case FunctionKind::kBEFFunction:
+        if (entry.function_offset >= new_function_section.size())
+          return false;
+        break;
+      case FunctionKind::kNativeFunction:
+        if (NativeFunctionRegistry::GetGlobalRegistry().Get(name) == nullptr)
+          return false;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  // Body extents end at the next function start in the respective section.
+  SmallVector<size_t, 8> old_offsets, new_offsets;
+  for (const auto& entry : old_index)
+    old_offsets.push_back(entry.function_offset);
+  for (const auto& entry : new_index)
+    new_offsets.push_back(entry.function_offset);
+  std::sort(old_offsets.begin(), old_offsets.end());
+  std::sort(new_offsets.begin(), new_offsets.end());
+
+  // Commit point: nothing below fails. Point all sections at the new buffer
+  // so future decodes read it; the byte-identical sections keep all recorded
+  // offsets valid.
+  auto old_function_section = impl->function_section_;
+  impl->location_filenames_section_ =
+      section(BEFSectionID::kLocationFilenames);
+  impl->location_positions_section_ =
+      section(BEFSectionID::kLocationPositions);
+  impl->string_section_ = section(BEFSectionID::kStrings);
+  impl->attribute_section_ = section(BEFSectionID::kAttributes);
+  impl->kernels_section_ = section(BEFSectionID::kKernels);
+  impl->types_section_ = section(BEFSectionID::kTypes);
+  impl->function_section_ = new_function_section;
+  impl->function_index_section_ = section(BEFSectionID::kFunctionIndex);
+
+  // Move retained templates to their new offsets, re-pointing mapped kernel
+  // words into the new buffer; templates of changed bodies are dropped and
+  // redecoded below. Compact-encoded templates own their kernel words, which
+  // survive the move unchanged.
+  auto repoint_kernels = [&](BEFFileImpl::FunctionTemplate& function_template,
+                             size_t old_offset, size_t new_offset) {
+    if (!function_template.kernel_storage.empty() ||
+        function_template.kernels.empty())
+      return;
+    size_t relative = reinterpret_cast<const uint8_t*>(
+                          function_template.kernels.data()) -
+                      (old_function_section.data() + old_offset);
+    function_template.kernels = llvm::makeArrayRef(
+        reinterpret_cast<const uint32_t*>(new_function_section.data() +
+                                          new_offset + relative),
+        function_template.kernels.size());
+  };
+
+  llvm::DenseMap<size_t, BEFFileImpl::FunctionTemplate> new_templates;
+  llvm::DenseMap<size_t, std::unique_ptr<BEFFileImpl::FunctionTemplate>>
+      new_lazy_templates;
+  SmallVector<BEFFunction*, 8> changed_functions;
+
+  {
+    mutex_lock lock(impl->decode_mu_);
+    for (size_t i = 0, e = old_index.size(); i != e; ++i) {
+      if (static_cast<FunctionKind>(old_index[i].kind) !=
+          FunctionKind::kBEFFunction)
+        continue;
+      auto* function = static_cast<BEFFunction*>(impl->functions_[i].get());
+      size_t old_offset = old_index[i].function_offset;
+      size_t new_offset = new_index[i].function_offset;
+      function->set_function_offset(new_offset);
+
+      auto old_body =
+          GetFunctionBody(old_function_section, old_offset, old_offsets);
+      auto new_body =
+          GetFunctionBody(new_function_section, new_offset, new_offsets);
+      if (!old_body.equals(new_body)) {
+        changed_functions.push_back(function);
+        continue;
+      }
+
+      auto it = impl->function_templates_.find(old_offset);
+      if (it != impl->function_templates_.end()) {
+        auto function_template = std::move(it->second);
+        repoint_kernels(function_template, old_offset, new_offset);
+        new_templates.try_emplace(new_offset, std::move(function_template));
+      }
+      auto lazy_it = impl->lazy_function_templates_.find(old_offset);
+      if (lazy_it != impl->lazy_function_templates_.end()) {
+        repoint_kernels(*lazy_it->second, old_offset, new_offset);
+        new_lazy_templates.try_emplace(new_offset,
+                                       std::move(lazy_it->second));
+      }
+    }
+    impl->function_templates_ = std::move(new_templates);
+    impl->lazy_function_templates_ = std::move(new_lazy_templates);
+  }
+
+  // Append the new functions, mirroring ReadFunctionIndexSection.
+  for (size_t i = old_index.size(), e = new_index.size(); i != e; ++i) {
+    const auto& entry = new_index[i];
+    const char* name = reinterpret_cast<const char*>(
+        &impl->string_section_[entry.name_offset]);
+    SmallVector<TypeName, 4> arguments, results;
+    for (auto type : entry.argument_types)
+      arguments.push_back(impl->type_names_[type]);
+    for (auto type : entry.result_types)
+      results.push_back(impl->type_names_[type]);
+    if (*name) impl->function_symbol_table_[name] = impl->functions_.size();
+    if (static_cast<FunctionKind>(entry.kind) == FunctionKind::kBEFFunction) {
+      auto bef_function = std::make_unique<BEFFunction>(
+          name, arguments, results, entry.function_offset, impl);
+      changed_functions.push_back(bef_function.get());
+      impl->functions_.push_back(std::move(bef_function));
+    } else {
+      auto callable = NativeFunctionRegistry::GetGlobalRegistry().Get(name);
+      impl->functions_.push_back(std::make_unique<NativeFunction>(
+          name, arguments, results, callable));
+    }
+  }
+
+  // Decode the changed and added functions. In lazy-decode mode they are
+  // simply decoded again on their next Execute.
+  if (!impl->lazy_decode_) {
+    for (auto* function : changed_functions)
+      impl->CacheFunctionTemplate(*function);
+  }
+
+  return true;
+}
+
 // Read a list of function names out of the BEF file function index.
 void BEFFile::GetFunctionList(SmallVectorImpl<const Function*>* results) const {
   auto* impl = static_cast<const BEFFileImpl*>(this);
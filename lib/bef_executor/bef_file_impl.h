@@ -23,20 +23,28 @@
 #ifndef TFRT_LIB_BEF_EXECUTOR_BEF_FILE_IMPL_H_
 #define TFRT_LIB_BEF_EXECUTOR_BEF_FILE_IMPL_H_
 
+#include <atomic>
+#include <memory>
+#include <string>
+
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "tfrt/bef_executor/bef_file.h"
 #include "tfrt/host_context/host_allocator.h"
 #include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/host_context/location.h"
 #include "tfrt/host_context/native_function.h"
+#include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
 class BEFFileImpl;
-class DecodedLocation;
 
 // This class implements Function for BEF files.
 class BEFFunction final : public Function {
@@ -56,9 +64,16 @@ class BEFFunction final : public Function {
   size_t function_offset() const { return function_offset_; }
   BEFFileImpl* bef_file() const { return bef_file_; }
 
-  void Execute(ArrayRef<AsyncValue*> arguments,
-               MutableArrayRef<RCReference<AsyncValue>> results,
-               HostContext* host) const override;
+  // Used by BEFFile::ReloadFunctions when a model update moves this function
+  // within the file.
+  void set_function_offset(size_t function_offset) {
+    function_offset_ = function_offset;
+  }
+
+  void Execute(const ExecutionContext& exec_ctx,
+               ArrayRef<AsyncValue*> arguments,
+               MutableArrayRef<RCReference<AsyncValue>> results) const override;
+  using Function::Execute;
   void AddRef() const override;
   void DropRef() const override;
 
@@ -70,7 +85,7 @@ class BEFFunction final : public Function {
 // This class is the implementation details behind the BEFFile::Open method,
 // which maintains all the state necessary for the BEFExecutor.  It is fully
 // public because it is a private implementation detail within this library.
-class BEFFileImpl : public BEFFile {
+class BEFFileImpl : public BEFFile, public LocationHandler {
  public:
   ~BEFFileImpl() override;
 
@@ -84,12 +99,19 @@ class BEFFileImpl : public BEFFile {
     // This is the number of uses of the register in the program.  The value
     // may be deallocated when this number of uses are complete.
     const unsigned user_count;
+    // True if the converter proved that this register has exactly one use
+    // and that use is a strict kernel, which therefore only runs after the
+    // producer's completion edge. The executor publishes such registers with
+    // a plain store instead of the compare-exchange/waiter protocol, since
+    // no consumer can observe the register before it is set.
+    const bool single_ordered_use;
     // 'value' is not used by BEFFileImpl. BEFExecutor takes ownership of
     // RegisterInfo, and uses 'value' to track the register's contents as it
     // executes a function.
     std::atomic<AsyncValue*> value{nullptr};
 
-    explicit RegisterInfo(unsigned user_count) : user_count(user_count) {}
+    explicit RegisterInfo(unsigned user_count, bool single_ordered_use = false)
+        : user_count(user_count), single_ordered_use(single_ordered_use) {}
   };
 
   // When decoding the kernel table for a function, we get the offset of
@@ -102,37 +124,243 @@ class BEFFileImpl : public BEFFile {
   // This struct is defined here, because ReadFunction() below will populate it.
   struct KernelInfo {
     unsigned offset;
+    // The total number of operands of this kernel, decoded at load time. The
+    // executor uses this to recognize straight-line links - a single-use
+    // result feeding a single-operand kernel - that can be executed without
+    // atomic bookkeeping.
+    unsigned num_operands;
     std::atomic<int> arguments_not_ready;
 
     // We initialize the ready list to "num_operands + 1" so we can drop the
     // last count in the executor constructor.
     KernelInfo(unsigned offset, unsigned num_operands)
-        : offset(offset), arguments_not_ready(num_operands + 1) {}
+        : offset(offset),
+          num_operands(num_operands),
+          arguments_not_ready(num_operands + 1) {}
+  };
+
+  // A capped pool of recycled invocation arenas for one function. A steady
+  // state serving workload invokes the same few functions millions of times;
+  // reusing the arena block between invocations of the same function removes
+  // the remaining allocator round trip per Function::Execute call.
+  class InvocationArenaPool {
+   public:
+    ~InvocationArenaPool() {
+      for (void* block : blocks_) allocator_->DeallocateBytes(block, size_);
+    }
+
+    // Take an idle arena out of the pool, or return nullptr if none is
+    // available (or if `size`/`allocator` do not match the pooled blocks,
+    // which can happen only if the file is used with multiple HostContexts).
+    void* Acquire(size_t size, HostAllocator* allocator) {
+      mutex_lock lock(mu_);
+      if (allocator_ == nullptr) {
+        allocator_ = allocator;
+        size_ = size;
+      }
+      if (allocator_ != allocator || size_ != size || blocks_.empty())
+        return nullptr;
+      return blocks_.pop_back_val();
+    }
+
+    // Return an arena to the pool. Returns false if the pool is full or the
+    // block does not belong here, in which case the caller still owns it.
+    bool Recycle(void* block, size_t size, HostAllocator* allocator) {
+      mutex_lock lock(mu_);
+      if (allocator_ != allocator || size_ != size ||
+          blocks_.size() >= kMaxIdleArenas)
+        return false;
+      blocks_.push_back(block);
+      return true;
+    }
+
+   private:
+    // Maximum number of idle arenas kept per function. This covers typical
+    // concurrent invocations of one function without holding onto unbounded
+    // memory for wide fan-out bursts.
+    static constexpr size_t kMaxIdleArenas = 8;
+
+    mutex mu_;
+    HostAllocator* allocator_ TFRT_GUARDED_BY(mu_) = nullptr;
+    size_t size_ TFRT_GUARDED_BY(mu_) = 0;
+    SmallVector<void*, 8> blocks_ TFRT_GUARDED_BY(mu_);
+  };
+
+  // All per-invocation executor state decoded from a function header: the
+  // register info array, the kernel info array, and a caller-requested chunk
+  // of leading storage (used by BEFExecutor for the executor object itself).
+  // Everything is carved out of a single bump-pointer arena backed by one
+  // HostAllocator allocation, so a Function::Execute call costs one
+  // allocation instead of one per piece of state. The arena dies with this
+  // object.
+  class FunctionState {
+   public:
+    FunctionState() = default;
+    ~FunctionState() { Release(); }
+
+    // FunctionState is move-only.
+    FunctionState(FunctionState&& other) { *this = std::move(other); }
+    FunctionState& operator=(FunctionState&& other) {
+      Release();
+      arena_ = other.arena_;
+      arena_size_ = other.arena_size_;
+      host_allocator_ = other.host_allocator_;
+      arena_pool_ = other.arena_pool_;
+      register_infos_ = other.register_infos_;
+      kernel_infos_ = other.kernel_infos_;
+      other.arena_ = nullptr;
+      other.arena_size_ = 0;
+      other.host_allocator_ = nullptr;
+      other.arena_pool_ = nullptr;
+      other.register_infos_ = {};
+      other.kernel_infos_ = {};
+      return *this;
+    }
+    FunctionState(const FunctionState&) = delete;
+    FunctionState& operator=(const FunctionState&) = delete;
+
+    // The leading storage requested by the caller of ReadFunction, at the
+    // start of the arena. It is left uninitialized by ReadFunction.
+    void* leading_storage() const { return arena_; }
+
+    MutableArrayRef<RegisterInfo>& register_infos() { return register_infos_; }
+    MutableArrayRef<KernelInfo>& kernel_infos() { return kernel_infos_; }
+
+   private:
+    friend class BEFFileImpl;
+
+    // Destroy the decoded state and return the arena to its function's pool,
+    // or to the allocator if the pool is full.
+    void Release() {
+      if (!arena_) return;
+      for (auto& register_info : register_infos_)
+        register_info.~RegisterInfo();
+      for (auto& kernel_info : kernel_infos_) kernel_info.~KernelInfo();
+      if (!arena_pool_ ||
+          !arena_pool_->Recycle(arena_, arena_size_, host_allocator_))
+        host_allocator_->DeallocateBytes(arena_, arena_size_);
+      arena_ = nullptr;
+    }
+
+    void* arena_ = nullptr;
+    size_t arena_size_ = 0;
+    HostAllocator* host_allocator_ = nullptr;
+    // The pool this arena is returned to on release; null for functions
+    // without a cached template. The pool lives on the FunctionTemplate,
+    // which the BEFFileImpl keeps alive for as long as any executor does.
+    InvocationArenaPool* arena_pool_ = nullptr;
+    MutableArrayRef<RegisterInfo> register_infos_;
+    MutableArrayRef<KernelInfo> kernel_infos_;
+  };
+
+  // The scheduling state of one function, decoded from its varint-encoded
+  // header once at BEFFile::Open time. Per invocation, ReadFunction stamps
+  // this template into the invocation arena instead of re-deriving the
+  // pending operand counts and register user counts from the kernel table.
+  struct FunctionTemplate {
+    // Offset of the function's location info in the LocationPositions
+    // section.
+    size_t location_offset;
+    // Kernel entries of all kernels in the function body. For format version
+    // 0 this points into the mapped Functions section; for the compact
+    // version 1 encoding it points at kernel_storage below.
+    ArrayRef<uint32_t> kernels;
+    // Owned backing store for kernels when the function body uses the
+    // compact encoding, where the kernel words are VBR decoded once here.
+    // With zero inline elements the heap block never moves when the template
+    // is moved into a map, so the kernels ArrayRef stays valid.
+    SmallVector<uint32_t, 0> kernel_storage;
+    // Per-register words in register number order, packed as
+    // (user_count << 1) | single_ordered_use. Format version 0 files carry
+    // plain user counts; DecodeFunction normalizes them to this form.
+    SmallVector<unsigned, 16> register_words;
+    // Per-kernel (offset, pending operand count) pairs, in kernel number
+    // order. These are the constructor arguments of KernelInfo.
+    SmallVector<std::pair<unsigned, unsigned>, 16> kernel_entries;
+    // Register numbers holding the function results.
+    SmallVector<size_t, 4> result_regs;
+    // Idle invocation arenas recycled between executions of this function.
+    std::unique_ptr<InvocationArenaPool> arena_pool =
+        std::make_unique<InvocationArenaPool>();
   };
 
+  // Decode the function header at `function_offset` into
+  // `function_template`. Returns true on malformed input; no error is
+  // emitted, that is left to the caller.
+  bool DecodeFunction(size_t function_offset, ArrayRef<TypeName> results,
+                      FunctionTemplate* function_template);
+
+  // Decode and cache the scheduling-state template of the given BEFFunction.
+  // Called once per function while BEFFile::Open reads the function index;
+  // the cache is immutable afterwards, so execution-time lookups are
+  // lock-free. Malformed functions are simply left out of the cache and
+  // diagnosed when they are first executed.
+  void CacheFunctionTemplate(const BEFFunction& function);
+
+  // In lazy-decode mode (see BEFFile::OpenFile), returns the template for
+  // the function at `function_offset`, decoding it and resolving the kernels
+  // it references on first use. Returns null after emitting an error if the
+  // function is malformed or references an unknown kernel.
+  const FunctionTemplate* GetOrDecodeFunctionTemplate(size_t function_offset,
+                                                      ArrayRef<TypeName> results);
+
+  // Resolve the kernels referenced by `function_template` against the
+  // registry, filling in kernels_ and kernel_cost_classes_. Entries already
+  // resolved for an earlier function are left alone, so concurrent executors
+  // stamping published templates never observe a write. Returns true after
+  // emitting an error if a referenced kernel is unknown.
+  bool ResolveKernels(const FunctionTemplate& function_template)
+      TFRT_REQUIRES(decode_mu_);
+
   // Decode the specified BEFFunction, returning an ArrayRef of kernel entries
   // for all kernels, decoded information about the registers used by the
   // function, and a table of offsets to each kernel within the function.
-  // `host_allocator` is used for the heap-allocated buffer that backs
-  // `kernel_infos`.
+  // `host_allocator` backs the single arena allocation held by
+  // `function_state`; `leading_bytes` of storage with `leading_alignment` are
+  // reserved at the front of the arena for the caller.
   //
   // On error, an error is emitted and a null pointer is returned.
   ArrayRef<uint32_t> ReadFunction(size_t function_offset,
                                   ArrayRef<TypeName> results,
+                                  size_t leading_bytes,
+                                  size_t leading_alignment,
                                   size_t* location_offset,
-                                  HostArray<RegisterInfo>* register_infos,
-                                  HostArray<KernelInfo>* kernel_infos,
+                                  FunctionState* function_state,
                                   SmallVectorImpl<size_t>* result_regs,
                                   HostAllocator* host_allocator);
 
   // Given an offset into the LocationPositions section, decode it and return
   // a DecodedDiagnostic.
-  DecodedLocation DecodeLocation(size_t location_position_offset);
+  DecodedLocation DecodeLocation(size_t location_position_offset) const;
+
+  // LocationHandler implementation. Location::data is an offset into the
+  // LocationPositions section, so kernel frames carry just the opaque offset
+  // and decoding only happens when an error is actually reported.
+  DecodedLocation DecodeLocation(Location loc) const override {
+    return DecodeLocation(static_cast<size_t>(loc.data));
+  }
 
   // Only used for debugging. Populates kernel_names_ on first call, which is
   // slow.
   const char* GetKernelName(size_t kernel_id);
 
+  // If the TFRT_BEF_KERNEL_COST_ACCOUNTING environment variable is set,
+  // allocate one cycle accumulator per kernel id. Called once at load time;
+  // when accounting is off this is a no-op and kernel_cycle_totals() stays
+  // null, so the executor's fast path pays only a pointer test.
+  void InitKernelCostAccounting();
+
+  // Per-kernel cumulative cycle counts, indexed by kernel id, or null when
+  // cost accounting is disabled.
+  std::atomic<uint64_t>* kernel_cycle_totals() const {
+    return kernel_cycle_totals_.get();
+  }
+
+  // Format the accumulated per-kernel cycle totals as a human readable hot
+  // list, most expensive kernel first. Returns an empty string when cost
+  // accounting is disabled or nothing has executed yet.
+  std::string GetKernelCostProfile();
+
   ErrorHandler error_handler_;
 
   ArrayRef<uint8_t> location_filenames_section_;
@@ -143,14 +371,51 @@ class BEFFileImpl : public BEFFile {
   ArrayRef<uint8_t> types_section_;
   ArrayRef<uint8_t> function_section_;
   ArrayRef<uint8_t> function_index_section_;
+  // The format version byte from the FormatVersion section; selects the
+  // function body encoding in DecodeFunction.
+  uint8_t format_version_ = kBEFVersion0;
   SmallVector<KernelImplementation, 8> kernels_;
+  // Cost class for each entry of kernels_, resolved from the registry at load
+  // time so the executor can check it without a name lookup.
+  SmallVector<KernelCostClass, 8> kernel_cost_classes_;
   SmallVector<TypeName, 8> type_names_;
   llvm::StringMap<size_t> function_symbol_table_;
   SmallVector<std::unique_ptr<Function>, 8> functions_;
 
+  // Scheduling-state templates for all BEF functions, keyed by function
+  // offset. Populated once by BuildFunctionTemplates and read-only
+  // afterwards.
+  llvm::DenseMap<size_t, FunctionTemplate> function_templates_;
+
   // Maps from kernel_id to the name of the kernel. Only nonempty when
   // debugging.
   std::vector<const char*> kernel_names_;
+
+  // Cycle totals per kernel id, parallel to kernels_. Only allocated when
+  // cost accounting is enabled; the executor updates the entries with relaxed
+  // increments, so concurrent executions on many threads stay cheap.
+  std::unique_ptr<std::atomic<uint64_t>[]> kernel_cycle_totals_;
+
+  // State for lazy-decode mode (BEFFile::OpenFile). In this mode
+  // function_templates_ stays empty; templates are decoded on first Execute
+  // of each function and published here. Templates are heap allocated so
+  // their addresses survive map growth, and a published template is
+  // immutable, so it can be stamped into invocation arenas without the lock.
+  bool lazy_decode_ = false;
+  // The registry the file was opened against, for lazy kernel resolution and
+  // for SaveKernelResolutionCache.
+  KernelRegistry* registry_ = nullptr;
+  // String table offsets of the kernel names, parallel to kernels_; only
+  // populated in lazy-decode mode, where kernels_ starts out all null.
+  SmallVector<size_t, 8> kernel_name_offsets_;
+  mutex decode_mu_;
+  llvm::DenseMap<size_t, std::unique_ptr<FunctionTemplate>>
+      lazy_function_templates_ TFRT_GUARDED_BY(decode_mu_);
+
+  // The mapping backing the file contents when opened with OpenFile; released
+  // in the destructor.
+  void* mapped_region_ = nullptr;
+  size_t mapped_region_size_ = 0;
 };
 
 }  // namespace tfrt
@@ -20,11 +20,14 @@
 //===----------------------------------------------------------------------===//
 #include "tfrt/bef_executor_driver/bef_executor_driver.h"
 
+#include <algorithm>
+#include <chrono>
 #include <limits>
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/SourceMgr.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/MLIRContext.h"
@@ -43,11 +46,70 @@
 #include "tfrt/support/mutex.h"
 #include "tfrt/support/ostream.h"
 #include "tfrt/support/string_util.h"
+#include "tfrt/tracing/chrome_tracing_sink/chrome_tracing_sink.h"
 #include "tfrt/tracing/tracing.h"
 
 namespace tfrt {
 
+// Benchmark `fn`: `warmup_runs` untimed repetitions to absorb load effects
+// (lazy decoding, kernel caches, allocator pools), then `num_runs` timed
+// ones. Each repetition is timed to full completion (including Quiesce) so
+// side-effecting kernels are accounted to the run that issued them. Reports
+// p50/p90/p99 wall time and, when the host allocator counts allocations
+// (e.g. the profiled allocator), allocations per run.
+static void BenchmarkFunction(const Function* fn, HostContext* host,
+                              int warmup_runs, int num_runs) {
+  auto run_once = [fn, host] {
+    llvm::SmallVector<RCReference<AsyncValue>, 4> results;
+    results.resize(fn->result_types().size());
+    fn->Execute(/*arguments=*/{}, results, host);
+    host->Await(results);
+    results.clear();
+    host->Quiesce();
+    // Clear any cancel state an erroring run may have left behind.
+    host->Restart();
+  };
+
+  for (int i = 0; i < warmup_runs; ++i) run_once();
+
+  std::vector<double> run_us;
+  run_us.reserve(num_runs);
+  int64_t allocs_before = host->allocator()->GetCumulativeAllocationCount();
+  for (int i = 0; i < num_runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    run_once();
+    auto end = std::chrono::steady_clock::now();
+    run_us.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  int64_t allocs_after = host->allocator()->GetCumulativeAllocationCount();
+
+  std::sort(run_us.begin(), run_us.end());
+  auto percentile = [&run_us](double p) {
+    return run_us[static_cast<size_t>(p * (run_us.size() - 1) + 0.5)];
+  };
+
+  tfrt::outs() << "'" << fn->name() << "' bench: runs=" << num_runs
+               << " p50=" << llvm::format("%.1f", percentile(0.5))
+               << "us p90=" << llvm::format("%.1f", percentile(0.9))
+               << "us p99=" << llvm::format("%.1f", percentile(0.99)) << "us";
+  if (allocs_before >= 0)
+    tfrt::outs() << " allocs/run="
+                 << (allocs_after - allocs_before) / num_runs;
+  tfrt::outs() << '\n';
+  tfrt::outs().flush();
+}
+
 int RunBefExecutor(const RunBefConfig& run_config) {
+#ifndef NO_TFRT_TRACING
+  // A requested chrome trace overrides whichever sink was statically
+  // registered and implies tracing is on for the whole run.
+  if (!run_config.chrome_trace_filename.empty()) {
+    internal::tracing::TracingApi::RegisterTracingSink(
+        "chrome", internal::tracing::ChromeTracingRecordActivity);
+    TFRT_TRACE_ON();
+  }
+#endif
   TFRT_TRACE_SCOPE("Bef Executor");
   static auto* version_metric =
       metrics::NewGauge<std::string>("/tensorflow/runtime/version");
@@ -210,6 +272,12 @@ int RunBefExecutor(const RunBefConfig& run_config) {
       continue;
     }
 
+    if (run_config.bench) {
+      BenchmarkFunction(fn, host, run_config.bench_warmup_runs,
+                        run_config.bench_num_runs);
+      continue;
+    }
+
     size_t before_num_values;
     if (AsyncValue::AsyncValueAllocationTrackingEnabled())
       before_num_values = AsyncValue::GetNumAsyncValueInstances();
@@ -284,6 +352,16 @@ int RunBefExecutor(const RunBefConfig& run_config) {
   }
 
   bef.reset();
+
+#ifndef NO_TFRT_TRACING
+  if (!run_config.chrome_trace_filename.empty() &&
+      internal::tracing::WriteChromeTrace(run_config.chrome_trace_filename)) {
+    tfrt::outs() << "Wrote chrome trace to " << run_config.chrome_trace_filename
+                 << '\n';
+    tfrt::outs().flush();
+  }
+#endif
+
   // Verify the diagnostic handler to make sure that each of the diagnostics
   // matched.
   return mlir::failed(source_mgr_handler.verify());
@@ -87,7 +87,13 @@ struct FunctionOpHandlerTraits {
                        MutableArrayRef<RCReference<AsyncValue>> results,
                        AsyncValueRef<Chain>* chain,
                        const ExecutionContext& exec_ctx) {
-    op_entry.dispatch_fn->Execute(inputs, results, exec_ctx.host());
+    op_entry.dispatch_fn->Execute(exec_ctx, inputs, results);
+  }
+
+  // Calling into the BEF executor just sets up the function's own kernel
+  // scheduling, so it is always fine to do inline.
+  static bool DispatchIsInexpensive(const FunctionOpEntry& op_entry) {
+    return true;
   }
 };
 
@@ -95,6 +101,65 @@ struct FunctionOpHandlerTraits {
 // Op Dispatch Implementation
 //===----------------------------------------------------------------------===//
 
+namespace {
+// Precomputed marshalling plan for one composite op. The argument and result
+// counts come from the function signature at MakeOp time, so each call can
+// preallocate its argument and result arrays without consulting the function
+// again.
+struct CompositeOpDispatchPlan {
+  size_t num_arguments;
+  size_t num_results;
+};
+}  // namespace
+
+// Fast path for composite ops without a metadata function. The function is a
+// BEF subgraph whose executor handles pending operands natively, so unlike
+// the generic dispatch path there is no need to wait for the argument
+// tensors: their AsyncValues are moved straight into the call and the inner
+// kernels start as their operands resolve. Result metadata is filled in from
+// each result tensor when it becomes available.
+static void ExecuteCompositeOp(const RCReference<Function>& fn,
+                               const CompositeOpDispatchPlan& plan,
+                               const OpInvocation& invocation) {
+  assert(invocation.arguments.size() == plan.num_arguments &&
+         invocation.results.size() == plan.num_results &&
+         "invocation does not match the composite op signature");
+  auto* host = invocation.exec_ctx.host();
+
+  SmallVector<RCReference<AsyncValue>, 4> arg_refs;
+  SmallVector<AsyncValue*, 4> args;
+  arg_refs.reserve(plan.num_arguments);
+  args.reserve(plan.num_arguments);
+  for (auto& argument : invocation.arguments) {
+    arg_refs.push_back(argument.ReleaseTensorRef());
+    args.push_back(arg_refs.back().get());
+  }
+
+  SmallVector<RCReference<AsyncValue>, 4> results;
+  results.resize(plan.num_results);
+  fn->Execute(invocation.exec_ctx, args, results);
+
+  for (size_t i = 0, e = plan.num_results; i != e; ++i) {
+    auto md_av = host->MakeUnconstructedAsyncValueRef<TensorMetadata>();
+    auto* result_av = results[i].get();
+    if (result_av->IsAvailable()) {
+      if (result_av->IsError())
+        md_av.SetError(result_av->GetError());
+      else
+        md_av.emplace(result_av->get<Tensor>().metadata());
+    } else {
+      result_av->AndThen([md_av = md_av.CopyRef(), result_av]() mutable {
+        if (result_av->IsError())
+          md_av.SetError(result_av->GetError());
+        else
+          md_av.emplace(result_av->get<Tensor>().metadata());
+      });
+    }
+    invocation.results[i] = TensorHandle(
+        std::move(md_av), AsyncValueRef<Tensor>(std::move(results[i])));
+  }
+}
+
 Expected<CoreRuntimeOp> CompositeOpHandler::MakeOp(string_view op_name) {
   auto composite_op_it = composite_op_mappings_.find(op_name);
 
@@ -105,10 +170,20 @@ Expected<CoreRuntimeOp> CompositeOpHandler::MakeOp(string_view op_name) {
 
   auto* host = GetRuntime()->GetHostContext();
 
+  const Function* fn = composite_op_it->second.dispatch_fn.get();
+  CompositeOpDispatchPlan plan{fn->argument_types().size(),
+                               fn->result_types().size()};
+
   return CoreRuntimeOp(
       [metadata_fn = composite_op_it->second.metadata_fn,
-       dispatch_fn = composite_op_it->second.dispatch_fn.CopyRef(),
+       dispatch_fn = composite_op_it->second.dispatch_fn.CopyRef(), plan,
        host](const OpInvocation& invocation) {
+        // Without a metadata function there is nothing for the generic
+        // machinery to compute: take the specialized function-call path.
+        if (!metadata_fn) {
+          ExecuteCompositeOp(dispatch_fn, plan, invocation);
+          return true;
+        }
         FunctionOpEntry op_entry{.metadata_fn = metadata_fn,
                                  .dispatch_fn = dispatch_fn.CopyRef()};
         return ExecuteOnOpHandler<FunctionOpHandlerTraits>(
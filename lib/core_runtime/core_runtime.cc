@@ -22,6 +22,8 @@
 
 #include <string>
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "tfrt/core_runtime/core_runtime_op.h"
 #include "tfrt/core_runtime/op_handler.h"
 #include "tfrt/core_runtime/op_handler_factory.h"
@@ -37,6 +39,7 @@
 #include "tfrt/host_context/shared_context.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 #include "tfrt/tracing/tracing.h"
 
 namespace tfrt {
@@ -94,6 +97,9 @@ class CoreRuntime::Impl {
                MutableArrayRef<TensorHandle> results,
                AsyncValueRef<Chain>* chain);
 
+  void ExecuteBatch(string_view op_name, OpHandler* op_handler, Location loc,
+                    MutableArrayRef<BatchedOpInvocation> invocations);
+
  private:
   friend class CoreRuntime;
 
@@ -101,12 +107,49 @@ class CoreRuntime::Impl {
     op_handler_registry_ = std::move(op_handler_registry);
   }
 
+  // Returns the resolved op handle for (op_handler, op_name), resolving and
+  // caching it on first use. Returns null if the op is unknown to the
+  // op_handler.
+  CoreRuntimeOp* GetOrCreateOp(string_view op_name, OpHandler* op_handler);
+
   // There is a 1-1 correspondence between HostContext and CoreRuntime.
   HostContext context_;
 
   OpHandlerRegistry op_handler_registry_;
+
+  mutex op_cache_mu_;
+  // Resolved op handles, keyed per op_handler by op name. The dispatch
+  // closures produced by MakeOp are stateless, so one cached handle may be
+  // invoked from multiple threads concurrently.
+  llvm::DenseMap<OpHandler*, llvm::StringMap<CoreRuntimeOp>> op_cache_
+      TFRT_GUARDED_BY(op_cache_mu_);
 };
 
+CoreRuntimeOp* CoreRuntime::Impl::GetOrCreateOp(string_view op_name,
+                                                OpHandler* op_handler) {
+  {
+    mutex_lock lock(op_cache_mu_);
+    auto& cached_ops = op_cache_[op_handler];
+    auto it = cached_ops.find(op_name);
+    if (it != cached_ops.end()) return &it->second;
+  }
+
+  // Resolve outside the lock: MakeOp may walk a chain of op_handlers.
+  auto op_handle = op_handler->MakeOp(op_name);
+  // Failures are not cached so a later registration is picked up.
+  if (!op_handle) {
+    llvm::consumeError(op_handle.takeError());
+    return nullptr;
+  }
+
+  mutex_lock lock(op_cache_mu_);
+  // StringMap entries are separately allocated, so the address of the cached
+  // op stays stable across rehashing and can be used outside the lock. If
+  // another thread raced us here, try_emplace keeps its copy.
+  auto r = op_cache_[op_handler].try_emplace(op_name, std::move(*op_handle));
+  return &r.first->second;
+}
+
 void CoreRuntime::Impl::Execute(string_view op_name, OpHandler* op_handler,
                                 Location loc,
                                 MutableArrayRef<TensorHandle> arguments,
@@ -119,22 +162,59 @@ void CoreRuntime::Impl::Execute(string_view op_name, OpHandler* op_handler,
   ExecutionContext exec_ctx{GetHostContext()};
   exec_ctx.set_location(loc);
 
-  // Ask the op_handler to execute the op.  If successful, we're done.
-  auto op_handle = op_handler->MakeOp(op_name);
-  if (op_handle) {
-    op_handle.get()(exec_ctx, arguments, attrs, results, chain);
+  // Ask the op_handler to execute the op.  If successful, we're done. The
+  // resolved handle is cached, so steady-state execution of an op skips the
+  // per-call resolution entirely.
+  if (CoreRuntimeOp* op_handle = GetOrCreateOp(op_name, op_handler)) {
+    (*op_handle)(exec_ctx, arguments, attrs, results, chain);
     return;
   }
 
   // Otherwise, we fail with an 'unknown op' error.
   auto err =
       EmitErrorAsync(exec_ctx, "op '" + op_name.str() + "' is not supported");
-  for (auto& result : results)
-    result = TensorHandle(err.CopyRef(), err.CopyRef());
+  for (size_t i = 0, e = results.size(); i != e; ++i) {
+    // The last consumer takes over our reference instead of re-counting it.
+    if (i + 1 == e && !chain)
+      results[i] = TensorHandle::CreateError(std::move(err));
+    else
+      results[i] = TensorHandle::CreateError(err.CopyRef());
+  }
 
   if (chain) *chain = std::move(err);
 }
 
+void CoreRuntime::Impl::ExecuteBatch(
+    string_view op_name, OpHandler* op_handler, Location loc,
+    MutableArrayRef<BatchedOpInvocation> invocations) {
+  TFRT_TRACE_KERNEL_SCOPE(StrCat(op_name, "#op_handler=",
+                                 op_handler->GetName(),
+                                 "#batch_size=", invocations.size()));
+
+  ExecutionContext exec_ctx{GetHostContext()};
+  exec_ctx.set_location(loc);
+
+  // Resolve the op once for the whole batch, then hand every invocation to
+  // the same dispatch closure.
+  if (CoreRuntimeOp* op_handle = GetOrCreateOp(op_name, op_handler)) {
+    for (auto& invocation : invocations) {
+      (*op_handle)(exec_ctx, invocation.arguments, *invocation.attrs,
+                   invocation.results, invocation.chain);
+    }
+    return;
+  }
+
+  // Otherwise, fail every invocation with the same 'unknown op' error.
+  auto err =
+      EmitErrorAsync(exec_ctx, "op '" + op_name.str() + "' is not supported");
+  for (auto& invocation : invocations) {
+    for (auto& result : invocation.results)
+      result = TensorHandle::CreateError(err.CopyRef());
+    if (invocation.chain)
+      *invocation.chain = AsyncValueRef<Chain>(err.CopyRef());
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Constructor / Destructor Logic
 //===----------------------------------------------------------------------===//
@@ -214,6 +294,9 @@ llvm::Expected<std::unique_ptr<CoreRuntime>> CoreRuntime::Create(
         const auto& create_fn = *error_or_create_fn;
         auto op_handler = create_fn(runtime.get(), fallback);
         if (!op_handler) return op_handler.takeError();
+        // A bypassed interposer removes itself from the chain: its callers
+        // link directly to its fallback and it is never dispatched through.
+        if ((*op_handler)->IsBypassed()) continue;
         fallback = op_handler->get();
         op_handler_registry.AddOpHandler(std::move(*op_handler));
       } else {
@@ -279,6 +362,12 @@ void CoreRuntime::Execute(string_view op_name, OpHandler* op_handler,
   impl_->Execute(op_name, op_handler, loc, arguments, attrs, results, chain);
 }
 
+void CoreRuntime::ExecuteBatch(string_view op_name, OpHandler* op_handler,
+                               Location loc,
+                               MutableArrayRef<BatchedOpInvocation> invocations) {
+  impl_->ExecuteBatch(op_name, op_handler, loc, invocations);
+}
+
 Expected<CoreRuntimeOp> CoreRuntime::MakeOp(string_view op_name,
                                             OpHandler* op_handler) {
   return op_handler->MakeOp(op_name);
@@ -21,16 +21,106 @@
 
 #include "tfrt/core_runtime/dispatch_utils.h"
 
+#include <algorithm>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 namespace internal {
+namespace {
+
+// Memoizes successful metadata function results. Eager execution typically
+// runs the same op with the same input shapes over and over, so after the
+// first call the result metadata of an attribute-less invocation comes out of
+// a hash probe instead of re-running shape inference. Invocations with
+// attributes are not cached because attributes can change result shapes
+// without changing input metadata.
+//
+// The cache is direct mapped: each fingerprint selects one slot and a
+// colliding insertion overwrites it, which bounds the size without an
+// eviction policy. Lookups verify the full key before trusting a slot.
+class MetadataFnCache {
+ public:
+  // If the result metadata for (metadata_fn, argument_mds) is cached, fills
+  // `result_mds` and returns true.
+  bool Lookup(OpMetadataFn metadata_fn, ArrayRef<TensorMetadata> argument_mds,
+              MutableArrayRef<TensorMetadata> result_mds) {
+    size_t slot = Fingerprint(metadata_fn, argument_mds) % kNumSlots;
+    mutex_lock lock(mu_);
+    auto it = entries_.find(slot);
+    if (it == entries_.end()) return false;
+    auto& entry = it->second;
+    if (entry.metadata_fn != metadata_fn ||
+        !std::equal(entry.argument_mds.begin(), entry.argument_mds.end(),
+                    argument_mds.begin(), argument_mds.end()))
+      return false;
+    assert(entry.result_mds.size() == result_mds.size());
+    std::copy(entry.result_mds.begin(), entry.result_mds.end(),
+              result_mds.begin());
+    return true;
+  }
+
+  // Caches a successful metadata function result.
+  void Insert(OpMetadataFn metadata_fn, ArrayRef<TensorMetadata> argument_mds,
+              ArrayRef<TensorMetadata> result_mds) {
+    size_t slot = Fingerprint(metadata_fn, argument_mds) % kNumSlots;
+    mutex_lock lock(mu_);
+    auto& entry = entries_[slot];
+    entry.metadata_fn = metadata_fn;
+    entry.argument_mds.assign(argument_mds.begin(), argument_mds.end());
+    entry.result_mds.assign(result_mds.begin(), result_mds.end());
+  }
+
+ private:
+  struct Entry {
+    OpMetadataFn metadata_fn = nullptr;
+    SmallVector<TensorMetadata, 4> argument_mds;
+    SmallVector<TensorMetadata, 4> result_mds;
+  };
+
+  static constexpr size_t kNumSlots = 4096;
+
+  // Hashes the metadata function pointer together with the dtype and shape of
+  // every input.
+  static size_t Fingerprint(OpMetadataFn metadata_fn,
+                            ArrayRef<TensorMetadata> argument_mds) {
+    llvm::hash_code hash =
+        llvm::hash_value(reinterpret_cast<uintptr_t>(metadata_fn));
+    for (const TensorMetadata& md : argument_mds) {
+      hash = llvm::hash_combine(hash, static_cast<int>(md.dtype.kind()));
+      SmallVector<ssize_t, 4> dims;
+      md.shape.GetDimensions(&dims);
+      for (ssize_t dim : dims) hash = llvm::hash_combine(hash, dim);
+    }
+    return static_cast<size_t>(hash);
+  }
+
+  mutex mu_;
+  llvm::DenseMap<size_t, Entry> entries_ TFRT_GUARDED_BY(mu_);
+};
+
+MetadataFnCache* GetMetadataFnCache() {
+  static auto* const cache = new MetadataFnCache();
+  return cache;
+}
+
+}  // namespace
 MDFunctionExecResult ExecuteMetadataFunction(
     const OpMetadataFn& metadata_fn, const OpInvocation& invocation,
     SmallVectorImpl<TensorMetadata>& result_mds) {
   auto propagate_error = [&](RCReference<AsyncValue> error) {
-    for (auto& result : invocation.results)
-      result = TensorHandle::CreateError(error.CopyRef());
+    auto results = invocation.results;
+    for (size_t i = 0, e = results.size(); i != e; ++i) {
+      // The last consumer takes over our reference instead of re-counting it.
+      if (i + 1 == e && !invocation.chain)
+        results[i] = TensorHandle::CreateError(std::move(error));
+      else
+        results[i] = TensorHandle::CreateError(error.CopyRef());
+    }
     if (invocation.chain)
       *invocation.chain = AsyncValueRef<Chain>(std::move(error));
   };
@@ -71,16 +161,26 @@ MDFunctionExecResult ExecuteMetadataFunction(
   // Okay, the shapes are available as we expect, get the result metadata.
   result_mds.resize(invocation.results.size());
 
-  // TODO(tf-runtime-team): Remove this tracing tag when finished debugging
-  // dispatch performance.
-  TFRT_TRACE_SCOPE("RunMetadataFunction");
-  if (auto error = metadata_fn(argument_mds, invocation.attrs, result_mds,
-                               invocation.exec_ctx)) {
-    // If the metadata function produced an error, propagate it.
-    propagate_error(std::move(error));
-    return MDFunctionExecResult::kError;
+  // Attribute-less invocations are memoized: a repeat execution with the same
+  // input metadata skips the metadata function entirely.
+  auto* cache = GetMetadataFnCache();
+  const bool cacheable = invocation.attrs.GetNumEntries() == 0;
+  if (cacheable && cache->Lookup(metadata_fn, argument_mds, result_mds))
+    return MDFunctionExecResult::kSuccess;
+
+  {
+    // TODO(tf-runtime-team): Remove this tracing tag when finished debugging
+    // dispatch performance.
+    TFRT_TRACE_SCOPE("RunMetadataFunction");
+    if (auto error = metadata_fn(argument_mds, invocation.attrs, result_mds,
+                                 invocation.exec_ctx)) {
+      // If the metadata function produced an error, propagate it.
+      propagate_error(std::move(error));
+      return MDFunctionExecResult::kError;
+    }
   }
 
+  if (cacheable) cache->Insert(metadata_fn, argument_mds, result_mds);
   return MDFunctionExecResult::kSuccess;
 }
 
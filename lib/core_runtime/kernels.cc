@@ -21,6 +21,10 @@
 
 #include "tfrt/core_runtime/kernels.h"
 
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "tfrt/core_runtime/core_runtime.h"
@@ -32,6 +36,7 @@
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/support/error_util.h"
+#include "tfrt/support/mutex.h"
 #include "tfrt/support/ref_count.h"
 #include "tfrt/tensor/host_tensor.h"
 #include "tfrt/tensor/string_host_tensor.h"
@@ -131,43 +136,27 @@ static llvm::Expected<TensorHandle> ConstStringTensor(
     ArrayAttribute<ssize_t> shape, AggregateAttribute value,
     HostContext *host) {
   TensorMetadata metadata(DType(DType::String), shape.data());
+  assert(metadata.shape.GetNumElements() == value.size());
+
+  SmallVector<string_view, 8> strings;
+  strings.reserve(value.size());
+  for (int i = 0, e = value.size(); i != e; ++i) {
+    strings.push_back(value.GetStringAttribute(i).get());
+  }
 
   auto tensor_ref =
-      StringHostTensor::MakeConstructedAsyncValueRef(metadata, host);
+      StringHostTensor::MakeConstructedAsyncValueRef(metadata, strings, host);
   if (!tensor_ref)
     return MakeStringError("failed to allocate string host tensor");
 
-  auto strings = tensor_ref.get().strings();
-  assert(strings.size() == value.size());
-
-  for (int i = 0, e = strings.size(); i != e; ++i) {
-    strings[i] = value.GetStringAttribute(i).str();
-  }
-
   tensor_ref.SetStateConcrete();
 
   return TensorHandle(metadata, std::move(tensor_ref));
 }
 
-static void ExecuteOpImpl(CoreRuntime *core_rt, OpHandler *op_handler,
-                          ArrayRef<AsyncValue *> args,
-                          AsyncValueRef<Chain> *op_chain,
-                          MutableArrayRef<RCReference<AsyncValue>> results,
-                          AggregateAttribute op_attr_array,
-                          StringAttribute op_name, Location loc) {
-  SmallVector<TensorHandle, 8> th_args;
-  th_args.reserve(args.size());
-
-  // TODO(clattner): This copies the input TensorHandle's.  While this is
-  // correct, it would be better to *move* out of the input async value when
-  // we know that we're the last user of the async value.
-  for (auto *arg : args) th_args.push_back(arg->get<TensorHandle>().CopyRef());
-
-  SmallVector<TensorHandle, 8> result_ths;
-  result_ths.resize(results.size());
-
-  // Set up OpAttrs.
-  OpAttrs op_attrs;
+// Decode `op_attr_array` into a mutable attribute set.
+static void DecodeOpAttrs(const AggregateAttribute &op_attr_array,
+                          OpAttrs *op_attrs) {
   for (size_t i = 0, e = op_attr_array.size(); i != e; ++i) {
     auto pair = op_attr_array.GetAggregateAttribute(i);
     assert(pair.size() == 2);
@@ -183,29 +172,124 @@ static void ExecuteOpImpl(CoreRuntime *core_rt, OpHandler *op_handler,
       auto type = GetOpAttrTypeFromBEFAttributeType(
           GetArrayAttributeElementType(attribute_type));
 
-      op_attrs.SetRaw(key, value, DecodeArraySizeFromBEFAttributes(value),
-                      type);
+      op_attrs->SetRaw(key, value, DecodeArraySizeFromBEFAttributes(value),
+                       type);
     } else if (attribute_type == BEFAttributeType::kString) {
-      op_attrs.SetRaw(key, value, DecodeArraySizeFromBEFAttributes(value),
-                      OpAttrType::CHAR);
+      op_attrs->SetRaw(key, value, DecodeArraySizeFromBEFAttributes(value),
+                       OpAttrType::CHAR);
     } else if (attribute_type == BEFAttributeType::kType) {
       BEFAttributeType type = *static_cast<const BEFAttributeType *>(value);
       assert(IsFixedAttribute(type));
-      op_attrs.Set(key, GetOpAttrTypeFromBEFAttributeType(type));
+      op_attrs->Set(key, GetOpAttrTypeFromBEFAttributeType(type));
     } else if (attribute_type == BEFAttributeType::kDenseElements) {
       DenseAttr dense_attr(value);
-      auto r = op_attrs.Set(key, dense_attr);
+      auto r = op_attrs->Set(key, dense_attr);
       assert(r);
       (void)r;
     } else {
       assert(IsScalarAttribute(attribute_type));
       auto type = GetOpAttrTypeFromBEFAttributeType(attribute_type);
-      op_attrs.SetRaw(key, value, OpAttrsRawEntry::kScalarSentinel, type);
+      op_attrs->SetRaw(key, value, OpAttrsRawEntry::kScalarSentinel, type);
     }
   }
+}
+
+// Return a frozen attribute set for `op_attr_array`, memoized on the address
+// of the aggregate's descriptors in the BEF file. The attributes of a
+// corert.executeop are constants in the file, so every invocation of one
+// kernel presents the same aggregate and the decode runs once instead of per
+// invocation.
+//
+// Cached sets are retained for the lifetime of the process; this assumes BEF
+// files stay loaded once opened. The attribute values are copied at freeze
+// time, so a cached set does not point back into the file.
+static OpAttrsRef GetOrDecodeFrozenAttrs(
+    const AggregateAttribute &op_attr_array) {
+  static mutex *cache_mu = new mutex;
+  static auto *cache = new llvm::DenseMap<const void *, OpAttrsRef>;
+
+  const void *key = op_attr_array.data();
+  {
+    mutex_lock lock(*cache_mu);
+    auto it = cache->find(key);
+    if (it != cache->end()) return it->second.freeze();
+  }
+
+  OpAttrs op_attrs;
+  DecodeOpAttrs(op_attr_array, &op_attrs);
+  auto frozen = op_attrs.freeze();
+
+  // If another thread decoded the same aggregate first, the sets are
+  // equivalent and either may be kept.
+  mutex_lock lock(*cache_mu);
+  cache->try_emplace(key, frozen.freeze());
+  return frozen;
+}
+
+namespace {
+// A TensorHandle array checked out of a per-thread pool. Op dispatch runs
+// synchronously on the calling thread, so the arrays live at any moment nest
+// like a stack and a small pool per thread suffices. An op taking more
+// arguments than the inline capacity (detection models pass 20+ tensors to
+// some ops) then reuses one grown allocation per thread instead of spilling
+// to the heap on every invocation.
+class ScratchTensorHandles {
+ public:
+  ScratchTensorHandles() {
+    auto &pool = GetPool();
+    if (pool.empty()) {
+      storage_ = std::make_unique<SmallVector<TensorHandle, 8>>();
+    } else {
+      storage_ = std::move(pool.back());
+      pool.pop_back();
+    }
+  }
+
+  ~ScratchTensorHandles() {
+    storage_->clear();
+    auto &pool = GetPool();
+    if (pool.size() < kMaxPooledArrays) pool.push_back(std::move(storage_));
+  }
+
+  SmallVectorImpl<TensorHandle> &get() { return *storage_; }
+
+ private:
+  // Each invocation checks out two arrays (arguments and results), so this
+  // covers four levels of nested op execution (e.g. through composite ops)
+  // before extra arrays are simply allocated and discarded.
+  static constexpr size_t kMaxPooledArrays = 8;
+
+  static std::vector<std::unique_ptr<SmallVector<TensorHandle, 8>>> &GetPool() {
+    thread_local std::vector<std::unique_ptr<SmallVector<TensorHandle, 8>>>
+        pool;
+    return pool;
+  }
+
+  std::unique_ptr<SmallVector<TensorHandle, 8>> storage_;
+};
+}  // namespace
+
+static void ExecuteOpImpl(CoreRuntime *core_rt, OpHandler *op_handler,
+                          ArrayRef<AsyncValue *> args,
+                          AsyncValueRef<Chain> *op_chain,
+                          MutableArrayRef<RCReference<AsyncValue>> results,
+                          AggregateAttribute op_attr_array,
+                          StringAttribute op_name, Location loc) {
+  ScratchTensorHandles scratch_args;
+  auto &th_args = scratch_args.get();
+  th_args.reserve(args.size());
+
+  // TODO(clattner): This copies the input TensorHandle's.  While this is
+  // correct, it would be better to *move* out of the input async value when
+  // we know that we're the last user of the async value.
+  for (auto *arg : args) th_args.push_back(arg->get<TensorHandle>().CopyRef());
+
+  ScratchTensorHandles scratch_results;
+  auto &result_ths = scratch_results.get();
+  result_ths.resize(results.size());
 
-  core_rt->Execute(op_name, op_handler, loc, th_args, OpAttrsRef(op_attrs),
-                   result_ths, op_chain);
+  core_rt->Execute(op_name, op_handler, loc, th_args,
+                   GetOrDecodeFrozenAttrs(op_attr_array), result_ths, op_chain);
 
   // Return all of the TensorHandles in AsyncValue's.
   for (size_t i = 0, e = result_ths.size(); i != e; ++i) {
@@ -44,6 +44,20 @@ namespace tfrt {
 
 namespace {
 
+// Return true if op logging is turned off for this process. Production builds
+// can define TFRT_DISABLE_LOGGING_OP_HANDLER to compile the bypass in
+// unconditionally; otherwise the TFRT_DISABLE_OP_LOGGING environment variable
+// disables logging at startup. A bypassed LoggingOpHandler is dropped from
+// the op handler chain entirely (see OpHandler::IsBypassed), restoring direct
+// dispatch to the op_handler it would have wrapped.
+static bool IsOpLoggingDisabled() {
+#ifdef TFRT_DISABLE_LOGGING_OP_HANDLER
+  return true;
+#else
+  return std::getenv("TFRT_DISABLE_OP_LOGGING") != nullptr;
+#endif
+}
+
 // TODO(tf-runtime-team): Rename it.
 class LoggingOpHandler : public OpHandler {
  public:
@@ -92,6 +106,8 @@ class LoggingOpHandler : public OpHandler {
 
   Expected<CoreRuntimeOp> MakeOp(string_view op_name) override;
 
+  bool IsBypassed() const override { return IsOpLoggingDisabled(); }
+
   AsyncValueRef<DenseHostTensor> CopyDeviceTensorToHost(
       const Tensor &tensor) override {
     return GetFallback()->CopyDeviceTensorToHost(tensor);
@@ -20,17 +20,29 @@
 
 #include "tfrt/core_runtime/op_attrs.h"
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/support/bef_encoding.h"
+#include "tfrt/support/mutex.h"
 #include "tfrt/tensor/tensor_serialize_utils.h"
 
 namespace tfrt {
 
+const char *GetInternedAttrName(string_view name) {
+  static mutex *mu = new mutex();
+  static llvm::StringSet<> *interned_names = new llvm::StringSet<>();
+  mutex_lock lock(*mu);
+  // StringSet entries are separately allocated and never move, so the key data
+  // pointer stays valid for the lifetime of the process.
+  return interned_names->insert(name).first->getKeyData();
+}
+
 // Return the OpAttrType converted from BEFAttributeType in BEF.
 OpAttrType GetOpAttrTypeFromBEFAttributeType(BEFAttributeType kind) {
   switch (kind) {
@@ -68,6 +80,7 @@ class ImmutableOpAttrs : public ReferenceCounted<ImmutableOpAttrs> {
   // generally use OpAttrsRef instead.
   const OpAttrsRawEntry *GetRaw(string_view attr_name) const;
   size_t GetNumEntries() const { return num_entries_; }
+  size_t GetHash() const { return hash_; }
   void IterateEntries(
       const std::function<void(const OpAttrsRawEntry &entry)> &fn) const;
 
@@ -83,6 +96,10 @@ class ImmutableOpAttrs : public ReferenceCounted<ImmutableOpAttrs> {
   // This is the number of entries in this set.
   size_t num_entries_;
 
+  // Order-independent hash of the full contents, precomputed in create() so
+  // dispatch caches can key on a frozen attribute set without rehashing it.
+  size_t hash_ = 0;
+
   // The entries_ array is tail allocated here, and followed by the payload
   // data for the attributes.
   OpAttrsRawEntry entries_[];
@@ -123,6 +140,20 @@ const char *GetNameString(OpAttrType type) {
   }
 }
 
+// Return a hash of a single attribute entry: its name, type, shape and
+// payload bytes. Entry hashes are combined with addition, which is
+// commutative, so the hash of a whole set does not depend on the
+// non-deterministic iteration order of the mutable representation.
+static size_t GetEntryHash(const OpAttrsRawEntry &entry) {
+  auto type_size = GetHostSizeAndAlignment(entry.GetData(), entry.type).first;
+  const char *data = static_cast<const char *>(entry.GetData());
+  size_t data_size = std::abs(entry.array_size) * type_size;
+  return static_cast<size_t>(llvm::hash_combine(
+      llvm::hash_value(string_view(entry.name)), entry.array_size,
+      static_cast<int>(entry.type),
+      llvm::hash_combine_range(data, data + data_size)));
+}
+
 static void GetSortedAttrs(const OpAttrsRef &attrs,
                            SmallVectorImpl<const OpAttrsRawEntry *> *result) {
   // Collect the attributes in non-determinstic order.
@@ -425,12 +456,10 @@ RCReference<ImmutableOpAttrs> ImmutableOpAttrs::create(const OpAttrs &attrs) {
   // common case, we should be able to memcpy over one big block of memory and
   // update pointers, instead of doing several small memcpy's.
 
-  // Figure out how much space we need for each entry, which is the space for
-  // the name and the payload together:
+  // Figure out how much space we need for each entry's payload.  Names are
+  // interned in the global attribute-name table rather than copied, so frozen
+  // sets share name storage and equal names compare pointer-equal.
   for (auto *entry : sorted_attrs) {
-    // Space for the name and null terminator.
-    alloc_size += strlen(entry->name) + 1;
-
     // If this is an array attribute, then we need to emit the BEF array size.
     // It will have the same size as the array size in the source.
     if (entry->IsArray()) alloc_size += GetBEFArraySizeSize(entry->data);
@@ -461,11 +490,8 @@ RCReference<ImmutableOpAttrs> ImmutableOpAttrs::create(const OpAttrs &attrs) {
     result_entry.array_size = src_entry.array_size;
     result_entry.type = src_entry.type;
 
-    // Copy the name over.
-    result_entry.name = data_ptr;
-    auto name_len = strlen(src_entry.name);
-    memcpy(data_ptr, src_entry.name, name_len + 1);
-    data_ptr += name_len + 1;
+    // Intern the name instead of copying it.
+    result_entry.name = GetInternedAttrName(src_entry.name);
 
     auto size_and_alignment =
         GetHostSizeAndAlignment(src_entry.data, src_entry.type);
@@ -496,6 +522,8 @@ RCReference<ImmutableOpAttrs> ImmutableOpAttrs::create(const OpAttrs &attrs) {
     } else {
       memcpy(result_entry.buffer, src_entry.buffer, sizeof(void *));
     }
+
+    result->hash_ += GetEntryHash(result_entry);
   }
 
   return TakeRef(result);
@@ -515,10 +543,18 @@ void ImmutableOpAttrs::Destroy() {
 // Look up an attribute by name, regardless of its underlying type.
 // On lookup failure, the result is null.
 const OpAttrsRawEntry *ImmutableOpAttrs::GetRaw(string_view attr_name) const {
-  // If we only have a few entries, do a linear search for the name.
-  // TODO(tf_runtime_team): implement a binary search for more elements.
-  for (size_t i = 0, e = num_entries_; i != e; ++i) {
-    if (!strcmp(entries_[i].name, attr_name.data())) return &entries_[i];
+  // The entries are sorted by name, so we can binary search.  An interned
+  // query name hits the pointer-equality check without any string compare.
+  size_t lo = 0, hi = num_entries_;
+  while (lo != hi) {
+    size_t mid = (lo + hi) / 2;
+    if (entries_[mid].name == attr_name.data()) return &entries_[mid];
+    int cmp = strcmp(entries_[mid].name, attr_name.data());
+    if (cmp == 0) return &entries_[mid];
+    if (cmp < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
   return nullptr;
 }
@@ -608,6 +644,16 @@ static void PrintElement(const void *ptr, OpAttrType type, raw_ostream &os) {
   }
 }
 
+size_t OpAttrsRef::GetHash() const {
+  // Frozen sets carry a precomputed hash; mutable sets are hashed on demand.
+  if (auto *ptr = attrs_.dyn_cast<ImmutableOpAttrs *>()) return ptr->GetHash();
+  size_t hash = 0;
+  if (auto *ptr = attrs_.dyn_cast<const OpAttrs *>())
+    ptr->IterateEntries(
+        [&](const OpAttrsRawEntry &entry) { hash += GetEntryHash(entry); });
+  return hash;
+}
+
 OpAttrsRef OpAttrsRef::freeze() const {
   if (auto *ptr = attrs_.dyn_cast<const OpAttrs *>()) return ptr->freeze();
   if (auto *ptr = attrs_.dyn_cast<ImmutableOpAttrs *>())
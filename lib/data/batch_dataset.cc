@@ -26,7 +26,8 @@ namespace data {
 
 template <>
 llvm::Expected<DenseHostTensor> BatchValues<DenseHostTensor>(
-    ArrayRef<DenseHostTensor> values, HostAllocator* allocator) {
+    MutableArrayRef<DenseHostTensor> values, TensorPool* pool,
+    HostAllocator* allocator) {
   // Verify that all batched tensors have the same dtype and tensor shape.
   for (int i = 1, e = values.size(); i < e; i++) {
     assert((values[0].metadata() == values[i].metadata()) &&
@@ -44,18 +45,19 @@ llvm::Expected<DenseHostTensor> BatchValues<DenseHostTensor>(
   output_dims[0] = values.size();
   TensorMetadata output_metadata(values[0].metadata().dtype, output_dims);
 
-  auto output_dht =
-      DenseHostTensor::CreateUninitialized(output_metadata, allocator);
+  auto output_dht = pool->Allocate(output_metadata, allocator);
   if (!output_dht) {
     return MakeStringError("failed to create uninitialized tensor");
   }
   // IDEA(donglin): We can optimize performance by returning a tensor backed by
   // the data of the batched tensors without copying data.
-  // Copy data from the batched tensors to the output tensor
+  // Copy data from the batched tensors to the output tensor, returning each
+  // consumed element tensor to the pool as soon as it is copied.
   size_t data_size = values[0].DataSizeInBytes();
   for (int i = 0; i < values.size(); i++) {
     char* ptr = static_cast<char*>(output_dht->data()) + i * data_size;
     std::memcpy(ptr, values[i].data(), data_size);
+    pool->Recycle(std::move(values[i]));
   }
 
   return std::move(*output_dht);
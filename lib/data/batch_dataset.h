@@ -31,6 +31,7 @@
 
 #include "dataset.h"
 #include "llvm/ADT/SmallVector.h"
+#include "tensor_pool.h"
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/support/forward_decls.h"
@@ -63,15 +64,15 @@ using DHTTuple = RepeatTypeHelperT<std::tuple, N, DenseHostTensor>;
 // Template for BatchDatasetHelper<T> where T is a scalar type. GetNext()
 // should return a 1-D DenseHostTensor of the batched scalar values.
 template <typename T>
-llvm::Expected<DenseHostTensor> BatchValues(ArrayRef<T> values,
+llvm::Expected<DenseHostTensor> BatchValues(MutableArrayRef<T> values,
+                                            TensorPool* pool,
                                             HostAllocator* allocator) {
   static_assert(std::is_scalar<T>::value, "T needs to be a scalar type");
   // Construct a 1-D tensor as output.
   ssize_t size = values.size();
   TensorMetadata output_metadata(GetDType<T>(), {size});
 
-  auto output_dht =
-      DenseHostTensor::CreateUninitialized(output_metadata, allocator);
+  auto output_dht = pool->Allocate(output_metadata, allocator);
   if (!output_dht) {
     return MakeStringError("failed to create uninitialized tensor");
   }
@@ -84,10 +85,12 @@ llvm::Expected<DenseHostTensor> BatchValues(ArrayRef<T> values,
 
 // Template specialization for BatchDataset<DenseHostTensor>. GetNext() returns
 // a DenseHostTensor with +1 dimension. The current implementation copies data
-// of the batched tensors to construct a new tensor.
+// of the batched tensors to construct a new tensor, and recycles the consumed
+// element tensors into the pool.
 template <>
 llvm::Expected<DenseHostTensor> BatchValues<DenseHostTensor>(
-    ArrayRef<DenseHostTensor> values, HostAllocator* allocator);
+    MutableArrayRef<DenseHostTensor> values, TensorPool* pool,
+    HostAllocator* allocator);
 
 template <std::size_t N, std::size_t Index, typename... T>
 struct TuplesToDHTsHelper {
@@ -96,7 +99,8 @@ struct TuplesToDHTsHelper {
   // DenseHostTensor presenting batched value of i'th values of every input
   // tuple.
   static llvm::Expected<DHTTuple<N - Index>> Convert(
-      std::vector<std::tuple<T...>>& tuples, HostAllocator* allocator) {
+      std::vector<std::tuple<T...>>& tuples, TensorPool* pool,
+      HostAllocator* allocator) {
     using ElementT = typename std::tuple_element<Index, std::tuple<T...>>::type;
     // Move 'Index'th value of every tuple into a vector.
     std::vector<ElementT> values;
@@ -104,15 +108,16 @@ struct TuplesToDHTsHelper {
       values.push_back(std::move(std::get<Index>(tuples[i])));
     }
     // Batch the vector of values into std::tuple<DenseHostTensor>.
-    auto dht = BatchValues<ElementT>(ArrayRef<ElementT>(values), allocator);
+    auto dht = BatchValues<ElementT>(MutableArrayRef<ElementT>(values), pool,
+                                     allocator);
     if (!dht) {
       return dht.takeError();
     }
     auto head_tuple = std::make_tuple(std::move(*dht));
     // Recursively convert the remaining values of tuples into
     // std::tuple<DenseHostTensor...>.
-    auto tail_tuple =
-        TuplesToDHTsHelper<N, Index + 1U, T...>::Convert(tuples, allocator);
+    auto tail_tuple = TuplesToDHTsHelper<N, Index + 1U, T...>::Convert(
+        tuples, pool, allocator);
     if (!tail_tuple) {
       return tail_tuple.takeError();
     }
@@ -125,7 +130,8 @@ struct TuplesToDHTsHelper {
 template <std::size_t N, typename... T>
 struct TuplesToDHTsHelper<N, N, T...> {
   static llvm::Expected<std::tuple<>> Convert(
-      std::vector<std::tuple<T...>>& tuples, HostAllocator* allocator) {
+      std::vector<std::tuple<T...>>& tuples, TensorPool* pool,
+      HostAllocator* allocator) {
     return std::make_tuple();
   }
 };
@@ -133,8 +139,10 @@ struct TuplesToDHTsHelper<N, N, T...> {
 // Convert std::vector<std::tuple<T...>> to std::tuple<DenseHostTensor...>
 template <typename... T>
 static llvm::Expected<DHTTuple<sizeof...(T)>> TuplesToDHTs(
-    std::vector<std::tuple<T...>>& tuples, HostAllocator* allocator) {
-  return TuplesToDHTsHelper<sizeof...(T), 0, T...>::Convert(tuples, allocator);
+    std::vector<std::tuple<T...>>& tuples, TensorPool* pool,
+    HostAllocator* allocator) {
+  return TuplesToDHTsHelper<sizeof...(T), 0, T...>::Convert(tuples, pool,
+                                                            allocator);
 }
 
 template <typename... T>
@@ -165,6 +173,9 @@ class BatchDataset : public DHTDataset<sizeof...(T)> {
   int32_t batch_size_;
   HostContext* host_;
   HostAllocator* allocator_;
+  // Recycles the batch buffers and consumed element buffers across
+  // iterations; shared by all iterators of this dataset.
+  TensorPool pool_;
 };
 
 template <typename... T>
@@ -238,7 +249,8 @@ AsyncValueRef<DHTTuple<sizeof...(T)>> BatchDatasetIterator<T...>::GetNext(
           auto& value = async_value->get<std::tuple<T...>>();
           values.push_back(std::move(value));
         }
-        auto result = TuplesToDHTs<T...>(values, parent_dataset->allocator_);
+        auto result = TuplesToDHTs<T...>(values, &parent_dataset->pool_,
+                                         parent_dataset->allocator_);
         if (!result) {
           async_result.SetError(EmitError(exec_ctx, result.takeError()));
           return;
@@ -0,0 +1,240 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- cache_dataset.cc ---------------------------------------------------===//
+//
+// This file implements CacheDataset class which materializes the output of
+// its input dataset to disk on the first pass and replays it zero-copy from a
+// memory mapping on later passes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "cache_dataset.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/tensor/tensor_serialize_utils.h"
+
+namespace tfrt {
+namespace data {
+
+namespace {
+// First word of a finished cache file. A file without it (including one
+// caught mid-write before the atomic rename) is ignored and rebuilt.
+constexpr uint64_t kCacheFileMagic = 0x30656863'61637452ull;
+
+// Maps a finished cache file, or returns nullptr if it does not exist or is
+// not a valid cache file.
+std::shared_ptr<CacheFileMapping> TryMapCacheFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  size_t size = file_stat.st_size;
+  if (size < sizeof(uint64_t) || size % sizeof(uint64_t) != 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file alive; the descriptor is no longer needed.
+  close(fd);
+  if (base == MAP_FAILED) return nullptr;
+
+  auto mapping = std::make_shared<CacheFileMapping>();
+  mapping->base = base;
+  mapping->size_bytes = size;
+  mapping->words = static_cast<const uint64_t*>(base);
+  mapping->num_words = size / sizeof(uint64_t);
+  if (mapping->words[0] != kCacheFileMagic) return nullptr;
+  return mapping;
+}
+}  // namespace
+
+CacheFileMapping::~CacheFileMapping() {
+  if (base != nullptr) munmap(base, size_bytes);
+}
+
+//===----------------------------------------------------------------------===//
+// Implementation for CacheDataset member functions
+//===----------------------------------------------------------------------===//
+
+RCReference<Iterator<DenseHostTensor>> CacheDataset::MakeIterator() {
+  if (auto mapping = TryMapCacheFile(path_)) {
+    return TakeRef(host_->Construct<CacheReaderDatasetIterator>(
+        FormRef(this), std::move(mapping)));
+  }
+  return TakeRef(host_->Construct<CacheWriterDatasetIterator>(FormRef(this)));
+}
+
+//===----------------------------------------------------------------------===//
+// Implementation for CacheWriterDatasetIterator member functions
+//===----------------------------------------------------------------------===//
+
+CacheWriterDatasetIterator::WriterState::WriterState(std::string tmp_path,
+                                                     std::string final_path)
+    : tmp_path(std::move(tmp_path)), final_path(std::move(final_path)) {
+  stream.open(this->tmp_path,
+              std::ios_base::binary | std::ios_base::trunc);
+  if (!stream) {
+    failed = true;
+    return;
+  }
+  stream.write(reinterpret_cast<const char*>(&kCacheFileMagic),
+               sizeof(kCacheFileMagic));
+}
+
+CacheWriterDatasetIterator::WriterState::~WriterState() {
+  if (!finalized) {
+    if (stream.is_open()) stream.close();
+    std::remove(tmp_path.c_str());
+  }
+}
+
+CacheWriterDatasetIterator::CacheWriterDatasetIterator(
+    RCReference<CacheDataset> parent_dataset)
+    : Iterator<DenseHostTensor>(),
+      parent_dataset_(std::move(parent_dataset)),
+      input_iterator_(parent_dataset_->input_dataset_->MakeIterator()),
+      state_(std::make_shared<WriterState>(parent_dataset_->path_ + ".tmp",
+                                           parent_dataset_->path_)) {}
+
+void CacheWriterDatasetIterator::MaybeFinalizeLocked(WriterState* state) {
+  if (!state->input_done || state->failed || state->finalized ||
+      !state->slots.empty())
+    return;
+  state->stream.close();
+  if (state->stream.fail()) {
+    state->failed = true;
+    return;
+  }
+  if (std::rename(state->tmp_path.c_str(), state->final_path.c_str()) != 0) {
+    state->failed = true;
+    return;
+  }
+  state->finalized = true;
+}
+
+void CacheWriterDatasetIterator::Fail(
+    const std::shared_ptr<WriterState>& state) {
+  mutex_lock lock(state->mu);
+  state->failed = true;
+}
+
+void CacheWriterDatasetIterator::CommitSlot(
+    const std::shared_ptr<WriterState>& state, size_t index,
+    std::vector<uint64_t> words) {
+  mutex_lock lock(state->mu);
+  if (state->failed) return;
+  state->slots[index - state->base_index] = std::move(words);
+  // Flush the ordered prefix of resolved records.
+  while (!state->slots.empty() && state->slots.front().hasValue()) {
+    auto& record = *state->slots.front();
+    uint64_t count = record.size();
+    state->stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    state->stream.write(reinterpret_cast<const char*>(record.data()),
+                        count * sizeof(uint64_t));
+    state->slots.pop_front();
+    ++state->base_index;
+  }
+  if (state->stream.fail()) {
+    state->failed = true;
+    return;
+  }
+  MaybeFinalizeLocked(state.get());
+}
+
+AsyncValueRef<std::tuple<DenseHostTensor>> CacheWriterDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  auto value = input_iterator_->GetNext(exec_ctx);
+  if (!value) {
+    mutex_lock lock(state_->mu);
+    state_->input_done = true;
+    MaybeFinalizeLocked(state_.get());
+    return value;
+  }
+
+  bool record = false;
+  size_t index = 0;
+  {
+    mutex_lock lock(state_->mu);
+    if (!state_->failed) {
+      record = true;
+      index = next_index_++;
+      state_->slots.emplace_back(llvm::None);
+    }
+  }
+  if (record) {
+    value.AndThen([state = state_, index, value = value.CopyRef()]() {
+      if (value.IsError()) {
+        Fail(state);
+        return;
+      }
+      CommitSlot(state, index,
+                 SerializeDenseHostTensorToDenseAttr(std::get<0>(value.get())));
+    });
+  }
+  return value;
+}
+
+//===----------------------------------------------------------------------===//
+// Implementation for CacheReaderDatasetIterator member functions
+//===----------------------------------------------------------------------===//
+
+CacheReaderDatasetIterator::CacheReaderDatasetIterator(
+    RCReference<CacheDataset> parent_dataset,
+    std::shared_ptr<CacheFileMapping> mapping)
+    : Iterator<DenseHostTensor>(),
+      parent_dataset_(std::move(parent_dataset)),
+      mapping_(std::move(mapping)),
+      offset_(1) {}  // Skip the magic word.
+
+AsyncValueRef<std::tuple<DenseHostTensor>> CacheReaderDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  if (offset_ >= mapping_->num_words) {
+    // End of iteration.
+    return AsyncValueRef<std::tuple<DenseHostTensor>>();
+  }
+  uint64_t count = mapping_->words[offset_];
+  if (count == 0 || offset_ + 1 + count > mapping_->num_words) {
+    return EmitErrorAsync(
+        exec_ctx,
+        MakeStringError("corrupted cache file: ", parent_dataset_->path_));
+  }
+  DenseAttr attr(mapping_->words + offset_ + 1);
+  offset_ += 1 + count;
+
+  // Alias the mapped bytes; the deallocator pins the mapping for the lifetime
+  // of the buffer instead of freeing anything.
+  TensorMetadata metadata = CreateTensorMetadata(attr);
+  auto buffer = HostBuffer::CreateFromExternal(
+      const_cast<void*>(attr.elements()), attr.DataSizeInBytes(),
+      [mapping = mapping_](void*, size_t) {});
+  return exec_ctx.host()->MakeConcreteAsyncValueRef<std::tuple<DenseHostTensor>>(
+      DenseHostTensor(metadata, std::move(buffer)));
+}
+
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- cache_dataset.h ------------------------------------------*- C++ -*-===//
+//
+// This file declares CacheDataset class which materializes the output of its
+// input dataset into an on-disk file of serialized dense attribute records on
+// the first pass, and serves later passes zero-copy out of a memory mapping
+// of that file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_CACHE_DATASET_H_
+#define TFRT_LIB_DATA_CACHE_DATASET_H_
+
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+// CacheDataset caches the elements of its input dataset in a file at `path`.
+// The first iterator streams elements through unchanged while appending each
+// one, serialized with the dense attribute format from
+// tensor_serialize_utils, to a temporary file that is atomically renamed to
+// `path` once the input is exhausted; an abandoned pass leaves no cache.
+// Iterators made after the file exists never touch the input dataset: they
+// mmap the file and yield tensors whose buffers alias the mapping, so a
+// cached epoch costs page faults instead of decode CPU.
+//
+// The input dataset must produce single DenseHostTensor elements, and the
+// cached pipeline prefix must be deterministic for the cache to be a faithful
+// replay.
+class CacheDataset : public Dataset<DenseHostTensor> {
+ public:
+  explicit CacheDataset(RCReference<Dataset<DenseHostTensor>> input_dataset,
+                        std::string path, HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        path_(std::move(path)),
+        host_(host),
+        allocator_(host->allocator()) {}
+
+  // This class is not copyable or movable.
+  CacheDataset(const CacheDataset&) = delete;
+  CacheDataset& operator=(const CacheDataset&) = delete;
+
+  RCReference<Iterator<DenseHostTensor>> MakeIterator() override;
+
+ private:
+  friend class CacheWriterDatasetIterator;
+  friend class CacheReaderDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<CacheDataset>(this, allocator_);
+  }
+
+  RCReference<Dataset<DenseHostTensor>> input_dataset_;
+  const std::string path_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+// One finished cache file mapped into memory. Every tensor served from the
+// file shares ownership of the mapping, so it stays valid for as long as any
+// consumer still holds a tensor.
+struct CacheFileMapping {
+  ~CacheFileMapping();
+
+  void* base = nullptr;
+  size_t size_bytes = 0;
+  const uint64_t* words = nullptr;
+  size_t num_words = 0;
+};
+
+// CacheWriterDatasetIterator streams the input through unchanged and appends
+// each element to the cache file as its async value resolves. Elements are
+// written in iteration order; out-of-order completions are parked until the
+// preceding records are on disk.
+class CacheWriterDatasetIterator : public Iterator<DenseHostTensor> {
+ public:
+  explicit CacheWriterDatasetIterator(RCReference<CacheDataset> parent_dataset);
+
+  // This class is not copyable or movable.
+  CacheWriterDatasetIterator(const CacheWriterDatasetIterator&) = delete;
+  CacheWriterDatasetIterator& operator=(const CacheWriterDatasetIterator&) =
+      delete;
+
+  AsyncValueRef<std::tuple<DenseHostTensor>> GetNext(
+      const ExecutionContext& exec_ctx) override;
+
+ private:
+  // State shared with the completion callbacks of outstanding elements. The
+  // callbacks hold a shared_ptr so a cache pass abandoned mid-epoch can still
+  // clean up its temporary file after the last element resolves.
+  struct WriterState {
+    WriterState(std::string tmp_path, std::string final_path);
+    ~WriterState();
+
+    const std::string tmp_path;
+    const std::string final_path;
+    mutex mu;
+    std::ofstream stream TFRT_GUARDED_BY(mu);
+    // Serialized records not yet flushed, indexed from base_index.
+    std::deque<llvm::Optional<std::vector<uint64_t>>> slots TFRT_GUARDED_BY(mu);
+    size_t base_index TFRT_GUARDED_BY(mu) = 0;
+    bool input_done TFRT_GUARDED_BY(mu) = false;
+    bool failed TFRT_GUARDED_BY(mu) = false;
+    bool finalized TFRT_GUARDED_BY(mu) = false;
+  };
+
+  // Stores the serialized record for `index` and flushes the ordered prefix
+  // of resolved records to the file.
+  static void CommitSlot(const std::shared_ptr<WriterState>& state,
+                         size_t index, std::vector<uint64_t> words);
+
+  // Abandons the cache file; elements keep streaming through to the consumer.
+  static void Fail(const std::shared_ptr<WriterState>& state);
+
+  // Closes and renames the temporary file if the input is exhausted and every
+  // record is on disk.
+  static void MaybeFinalizeLocked(WriterState* state)
+      TFRT_REQUIRES(state->mu);
+
+  void Destroy() override {
+    internal::DestroyImpl<CacheWriterDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  RCReference<CacheDataset> parent_dataset_;
+  RCReference<Iterator<DenseHostTensor>> input_iterator_;
+  std::shared_ptr<WriterState> state_;
+  size_t next_index_ = 0;
+};
+
+// CacheReaderDatasetIterator replays a finished cache file. Each GetNext
+// decodes one record header out of the mapping and yields a tensor whose
+// buffer aliases the mapped bytes.
+class CacheReaderDatasetIterator : public Iterator<DenseHostTensor> {
+ public:
+  CacheReaderDatasetIterator(RCReference<CacheDataset> parent_dataset,
+                             std::shared_ptr<CacheFileMapping> mapping);
+
+  // This class is not copyable or movable.
+  CacheReaderDatasetIterator(const CacheReaderDatasetIterator&) = delete;
+  CacheReaderDatasetIterator& operator=(const CacheReaderDatasetIterator&) =
+      delete;
+
+  AsyncValueRef<std::tuple<DenseHostTensor>> GetNext(
+      const ExecutionContext& exec_ctx) override;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<CacheReaderDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  RCReference<CacheDataset> parent_dataset_;
+  std::shared_ptr<CacheFileMapping> mapping_;
+  // Next unread position in the mapping, in words.
+  size_t offset_ = 0;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_CACHE_DATASET_H_
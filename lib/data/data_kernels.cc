@@ -19,11 +19,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "batch_dataset.h"
+#include "cache_dataset.h"
 #include "interleave_dataset.h"
+#include "map_and_batch_dataset.h"
 #include "map_dataset.h"
 #include "prefetch_dataset.h"
 #include "range_dataset.h"
 #include "repeat_dataset.h"
+#include "shuffle_dataset.h"
 #include "slice_dataset.h"
 #include "tf_record_dataset.h"
 #include "tfrt/host_context/function.h"
@@ -98,6 +101,44 @@ RCReference<MapDataset<std::tuple<T>, std::tuple<U...>>> MakeMapDataset(
 
   return TakeRef(host->Construct<MapDataset<std::tuple<T>, std::tuple<U...>>>(
       (*dataset).CopyRef(), RCArray<AsyncValue>(args.values()),
+      FormRef(&fn.get()), /*num_parallel_calls=*/1, host));
+}
+
+// IDEA(donglin): Specify num_parallel_calls as Int32Attribute when TFRT infra
+// supports it.
+template <typename T, typename... U>
+RCReference<MapDataset<std::tuple<T>, std::tuple<U...>>> MakeParallelMapDataset(
+    RCReference<Dataset<T>>* dataset, RemainingArguments args,
+    ArrayAttribute<int32_t> num_parallel_calls, Attribute<Function> fn,
+    HostContext* host) {
+  assert((args.size() + 1 == fn->argument_types().size()) &&
+         "MapDataset only supports input dataset with unary output.");
+  assert(fn->result_types().size() == sizeof...(U) &&
+         "Map function output size does not match expexcted.");
+  assert(num_parallel_calls.size() == 1);
+
+  return TakeRef(host->Construct<MapDataset<std::tuple<T>, std::tuple<U...>>>(
+      (*dataset).CopyRef(), RCArray<AsyncValue>(args.values()),
+      FormRef(&fn.get()), num_parallel_calls[0], host));
+}
+
+//===----------------------------------------------------------------------===//
+// MapAndBatchDataset
+//===----------------------------------------------------------------------===//
+
+// IDEA(donglin): Specify batch_size as Int32Attribute when TFRT infra supports
+// it.
+template <typename T>
+RCReference<MapAndBatchDataset<std::tuple<T>>> MakeMapAndBatchDataset(
+    RCReference<Dataset<T>>* dataset, RemainingArguments args,
+    ArrayAttribute<int32_t> batch_size, Attribute<Function> fn,
+    HostContext* host) {
+  assert((args.size() + 1 == fn->argument_types().size()) &&
+         "MapAndBatchDataset only supports input dataset with unary output.");
+  assert(batch_size.size() == 1);
+
+  return TakeRef(host->Construct<MapAndBatchDataset<std::tuple<T>>>(
+      (*dataset).CopyRef(), batch_size[0], RCArray<AsyncValue>(args.values()),
       FormRef(&fn.get()), host));
 }
 
@@ -119,8 +160,28 @@ MakeInterleaveDataset(RCReference<Dataset<T>>* dataset, int64_t cycle_length,
 
   return TakeRef(
       host->Construct<InterleaveDataset<std::tuple<T>, std::tuple<U...>>>(
-          (*dataset).CopyRef(), cycle_length, block_length, FormRef(&fn.get()),
-          host));
+          (*dataset).CopyRef(), cycle_length, block_length, /*parallel=*/false,
+          /*sloppy=*/false, FormRef(&fn.get()), host));
+}
+
+// IDEA(donglin): Specify sloppy as BoolAttribute when TFRT infra supports it.
+template <typename T, typename... U>
+RCReference<InterleaveDataset<std::tuple<T>, std::tuple<U...>>>
+MakeParallelInterleaveDataset(RCReference<Dataset<T>>* dataset,
+                              int64_t cycle_length, int64_t block_length,
+                              ArrayAttribute<int32_t> sloppy,
+                              Attribute<Function> fn, HostContext* host) {
+  assert(fn->argument_types().size() == 1 &&
+         "Interleave only supports functions with unary inputs.");
+  assert(
+      fn->result_types().size() == 1 &&
+      "Interleave expects only one function output, which must be a dataset.");
+  assert(sloppy.size() == 1);
+
+  return TakeRef(
+      host->Construct<InterleaveDataset<std::tuple<T>, std::tuple<U...>>>(
+          (*dataset).CopyRef(), cycle_length, block_length, /*parallel=*/true,
+          sloppy[0] != 0, FormRef(&fn.get()), host));
 }
 
 //===----------------------------------------------------------------------===//
@@ -129,7 +190,32 @@ MakeInterleaveDataset(RCReference<Dataset<T>>* dataset, int64_t cycle_length,
 
 RCReference<TFRecordDataset> MakeTFRecordDataset(std::string path,
                                                  HostContext* host) {
-  return TakeRef(host->Construct<TFRecordDataset>(std::move(path), host));
+  return TakeRef(host->Construct<TFRecordDataset>(
+      std::move(path), /*num_parallel_reads=*/1, /*buffer_size=*/0,
+      /*use_direct_io=*/false, host));
+}
+
+// IDEA(donglin): Specify num_parallel_reads as Int32Attribute when TFRT infra
+// supports it.
+RCReference<TFRecordDataset> MakeParallelTFRecordDataset(
+    std::string path, ArrayAttribute<int32_t> num_parallel_reads,
+    HostContext* host) {
+  assert(num_parallel_reads.size() == 1);
+  return TakeRef(host->Construct<TFRecordDataset>(
+      std::move(path), num_parallel_reads[0], /*buffer_size=*/0,
+      /*use_direct_io=*/false, host));
+}
+
+// IDEA(donglin): Specify buffer_size as Int64Attribute and use_direct_io as
+// BoolAttribute when TFRT infra supports them.
+RCReference<TFRecordDataset> MakeBufferedTFRecordDataset(
+    std::string path, ArrayAttribute<int64_t> buffer_size,
+    ArrayAttribute<int32_t> use_direct_io, HostContext* host) {
+  assert(buffer_size.size() == 1);
+  assert(use_direct_io.size() == 1);
+  return TakeRef(host->Construct<TFRecordDataset>(
+      std::move(path), /*num_parallel_reads=*/1,
+      static_cast<size_t>(buffer_size[0]), use_direct_io[0] != 0, host));
 }
 
 //===----------------------------------------------------------------------===//
@@ -160,6 +246,33 @@ RCReference<BatchDataset<T...>> MakeBatchDataset(
                                                      batch_size[0], host));
 }
 
+//===----------------------------------------------------------------------===//
+// CacheDataset
+//===----------------------------------------------------------------------===//
+
+RCReference<CacheDataset> MakeCacheDataset(
+    RCReference<Dataset<DenseHostTensor>>* dataset, std::string path,
+    HostContext* host) {
+  return TakeRef(host->Construct<CacheDataset>((*dataset).CopyRef(),
+                                               std::move(path), host));
+}
+
+//===----------------------------------------------------------------------===//
+// ShuffleDataset
+//===----------------------------------------------------------------------===//
+
+// IDEA(donglin): Specify buffer_size_bytes and seed as Int64Attribute when
+// TFRT infra supports it.
+template <typename... T>
+RCReference<ShuffleDataset<T...>> MakeShuffleDataset(
+    RCReference<Dataset<T...>>* dataset, ArrayAttribute<int64_t> buffer_size_bytes,
+    ArrayAttribute<int64_t> seed, HostContext* host) {
+  assert(buffer_size_bytes.size() == 1);
+  assert(seed.size() == 1);
+  return TakeRef(host->Construct<ShuffleDataset<T...>>(
+      (*dataset).CopyRef(), buffer_size_bytes[0], seed[0], host));
+}
+
 //===----------------------------------------------------------------------===//
 // PrefetchDataset
 //===----------------------------------------------------------------------===//
@@ -168,7 +281,20 @@ template <typename... T>
 RCReference<PrefetchDataset<T...>> MakePrefetchDataset(
     RCReference<Dataset<T...>>* dataset, HostContext* host) {
   return TakeRef(host->Construct<PrefetchDataset<T...>>(
-      (*dataset).CopyRef(), host->GetNumWorkerThreads(), host));
+      (*dataset).CopyRef(), host->GetNumWorkerThreads(),
+      host->GetNumWorkerThreads(), host));
+}
+
+// IDEA(donglin): Specify min/max_prefetch_num as Int32Attribute when TFRT
+// infra supports it.
+template <typename... T>
+RCReference<PrefetchDataset<T...>> MakeAutotunePrefetchDataset(
+    RCReference<Dataset<T...>>* dataset, ArrayAttribute<int32_t> min_prefetch_num,
+    ArrayAttribute<int32_t> max_prefetch_num, HostContext* host) {
+  assert(min_prefetch_num.size() == 1);
+  assert(max_prefetch_num.size() == 1);
+  return TakeRef(host->Construct<PrefetchDataset<T...>>(
+      (*dataset).CopyRef(), min_prefetch_num[0], max_prefetch_num[0], host));
 }
 
 //===----------------------------------------------------------------------===//
@@ -253,12 +379,14 @@ static void EnumerateIterator(RemainingArguments args, RemainingResults results,
       fn_args[values_and_bool.size() - 1 + i] = fn_results[i].release();
     }
 
-    body_fn_ptr->Execute(fn_args, fn_results, exec_ctx.host());
+    body_fn_ptr->Execute(exec_ctx, fn_args, fn_results);
     for (int i = 0; i < fn_args.size(); i++) {
       fn_args[i]->DropRef();
     }
 
-    if (auto cancel_av = exec_ctx.host()->GetCancelAsyncValue()) {
+    AsyncValue* cancel_av = exec_ctx.GetCancelAsyncValue();
+    if (!cancel_av) cancel_av = exec_ctx.host()->GetCancelAsyncValue();
+    if (cancel_av) {
       // Cancellation detected. Set results to the cancel async value and
       // return.
       for (int i = 0; i < num_results; i++) {
@@ -327,6 +455,10 @@ void RegisterDataKernels(KernelRegistry* registry) {
 
   registry->AddKernel("data.tf_record_dataset",
                       TFRT_KERNEL(MakeTFRecordDataset));
+  registry->AddKernel("data.tf_record_dataset.parallel",
+                      TFRT_KERNEL(MakeParallelTFRecordDataset));
+  registry->AddKernel("data.tf_record_dataset.buffered",
+                      TFRT_KERNEL(MakeBufferedTFRecordDataset));
 
   registry->AddKernel("data.map_dataset.i32.i32",
                       TFRT_KERNEL(MakeMapDataset<int32_t, int32_t>));
@@ -346,8 +478,27 @@ void RegisterDataKernels(KernelRegistry* registry) {
   registry->AddKernel("data.map_dataset.i32.f32_and_i32",
                       TFRT_KERNEL(MakeMapDataset<int32_t, float, int32_t>));
 
+  registry->AddKernel("data.map_dataset.parallel.i32.i32",
+                      TFRT_KERNEL(MakeParallelMapDataset<int32_t, int32_t>));
+  registry->AddKernel("data.map_dataset.parallel.i64.i64",
+                      TFRT_KERNEL(MakeParallelMapDataset<int64_t, int64_t>));
+  registry->AddKernel(
+      "data.map_dataset.parallel.str.tensor",
+      TFRT_KERNEL(MakeParallelMapDataset<std::string, DenseHostTensor>));
+
+  registry->AddKernel("data.map_and_batch_dataset.i32.tensor",
+                      TFRT_KERNEL(MakeMapAndBatchDataset<int32_t>));
+  registry->AddKernel("data.map_and_batch_dataset.str.tensor",
+                      TFRT_KERNEL(MakeMapAndBatchDataset<std::string>));
+
   registry->AddKernel("data.interleave_dataset.i32.i32",
                       TFRT_KERNEL(MakeInterleaveDataset<int32_t, int32_t>));
+  registry->AddKernel(
+      "data.interleave_dataset.parallel.i32.i32",
+      TFRT_KERNEL(MakeParallelInterleaveDataset<int32_t, int32_t>));
+  registry->AddKernel(
+      "data.interleave_dataset.parallel.str.str",
+      TFRT_KERNEL(MakeParallelInterleaveDataset<std::string, std::string>));
 
   registry->AddKernel("data.batch_dataset.tensor",
                       TFRT_KERNEL(MakeBatchDataset<DenseHostTensor>));
@@ -358,6 +509,18 @@ void RegisterDataKernels(KernelRegistry* registry) {
   registry->AddKernel("data.batch_dataset.tensor_and_i64",
                       TFRT_KERNEL(MakeBatchDataset<DenseHostTensor, int64_t>));
 
+  registry->AddKernel("data.cache_dataset.tensor",
+                      TFRT_KERNEL(MakeCacheDataset));
+
+  registry->AddKernel("data.shuffle_dataset.i32",
+                      TFRT_KERNEL(MakeShuffleDataset<int32_t>));
+  registry->AddKernel("data.shuffle_dataset.i64",
+                      TFRT_KERNEL(MakeShuffleDataset<int64_t>));
+  registry->AddKernel("data.shuffle_dataset.str",
+                      TFRT_KERNEL(MakeShuffleDataset<std::string>));
+  registry->AddKernel("data.shuffle_dataset.tensor",
+                      TFRT_KERNEL(MakeShuffleDataset<DenseHostTensor>));
+
   registry->AddKernel("data.repeat_dataset.i32",
                       TFRT_KERNEL(MakeRepeatDataset<int32_t>));
   registry->AddKernel("data.repeat_dataset.i64",
@@ -371,6 +534,13 @@ void RegisterDataKernels(KernelRegistry* registry) {
   registry->AddKernel(
       "data.prefetch_dataset.tensor_and_i64",
       TFRT_KERNEL(MakePrefetchDataset<DenseHostTensor, int64_t>));
+  registry->AddKernel(
+      "data.prefetch_dataset.autotune.tensor_and_tensor",
+      TFRT_KERNEL(
+          MakeAutotunePrefetchDataset<DenseHostTensor, DenseHostTensor>));
+  registry->AddKernel(
+      "data.prefetch_dataset.autotune.tensor_and_i64",
+      TFRT_KERNEL(MakeAutotunePrefetchDataset<DenseHostTensor, int64_t>));
 }
 
 }  // namespace data
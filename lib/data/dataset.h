@@ -24,13 +24,16 @@
 #define TFRT_LIB_DATA_DATASET_H_
 
 #include <memory>
+#include <string>
 
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/host_allocator.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/metrics/metrics_api.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/rc_array.h"
 #include "tfrt/support/ref_count.h"
+#include "tfrt/support/string_util.h"
 
 namespace tfrt {
 namespace data {
@@ -70,6 +73,44 @@ static void EmplaceTupleResult(ArrayRef<AsyncValue*> results,
 
 }  // namespace internal
 
+// IteratorMetrics exports the counters of one iterator instance through the
+// metrics API, so input-bound steps can be diagnosed in production without
+// attaching a profiler. Gauges are registered under
+// "/tfrt/data/<dataset_name>/<counter>", where dataset_name matches the
+// kernel names in data_kernels.cc. The counters are only updated from the
+// thread driving GetNext, so they need no synchronization.
+class IteratorMetrics {
+ public:
+  explicit IteratorMetrics(const std::string& dataset_name)
+      : num_get_next_calls_(metrics::NewGauge<int64_t>(
+            StrCat("/tfrt/data/", dataset_name, "/get_next_calls"))),
+        time_blocked_upstream_us_(metrics::NewGauge<int64_t>(
+            StrCat("/tfrt/data/", dataset_name, "/time_blocked_upstream_us"))),
+        buffer_occupancy_(metrics::NewGauge<int64_t>(
+            StrCat("/tfrt/data/", dataset_name, "/buffer_occupancy"))) {}
+
+  // Records one GetNext call that spent `blocked_us` microseconds in
+  // synchronous upstream work before it could hand an element back.
+  void RecordGetNext(int64_t blocked_us) {
+    num_get_next_calls_->SetValue(++total_get_next_calls_);
+    total_blocked_us_ += blocked_us;
+    time_blocked_upstream_us_->SetValue(total_blocked_us_);
+  }
+
+  // Records how many buffered elements were ready when the consumer arrived.
+  // Only meaningful for iterators that keep an internal buffer.
+  void RecordBufferOccupancy(int64_t occupancy) {
+    buffer_occupancy_->SetValue(occupancy);
+  }
+
+ private:
+  metrics::Gauge<int64_t>* num_get_next_calls_;
+  metrics::Gauge<int64_t>* time_blocked_upstream_us_;
+  metrics::Gauge<int64_t>* buffer_occupancy_;
+  int64_t total_get_next_calls_ = 0;
+  int64_t total_blocked_us_ = 0;
+};
+
 // We separate the IteratorBase from the templatized Iterator so that
 // kernels can use IteratorBase::GetNextUntyped without being specialized for
 // the output type.
@@ -25,6 +25,10 @@
 #ifndef TFRT_LIB_DATA_INTERLEAVE_DATASET_H_
 #define TFRT_LIB_DATA_INTERLEAVE_DATASET_H_
 
+#include <algorithm>
+#include <queue>
+#include <vector>
+
 #include "dataset.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/support/forward_decls.h"
@@ -38,6 +42,9 @@ class InterleaveDataset;
 template <typename... T>
 class InterleaveDatasetIterator;
 
+template <typename... T>
+class ParallelInterleaveDatasetIterator;
+
 // Partial specialization of InterleaveDataset to support multiple parameter
 // packs. InterleaveDataset maps a user-defined function over the
 // elements in its input dataset and interleaves the results. The user-
@@ -53,17 +60,28 @@ class InterleaveDatasetIterator;
 // returned Dataset objects, and cycle through them, producing `block_length`
 // consecutive elements from each iterator, and consuming the next input
 // element each time it reaches the end of an iterator.
+//
+// If `parallel` is true, the iterator opens all cycle_length child iterators
+// eagerly and keeps block_length GetNext calls outstanding on each of them,
+// so asynchronous children make progress concurrently instead of being
+// advanced one at a time from the consumer. If `sloppy` is also true, the
+// iterator yields from whichever child has an element ready first instead of
+// strictly cycling, so one slow child does not stall the whole cycle; the
+// element order then depends on timing.
 template <typename... InputTypes, typename... OutputTypes>
 class InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
     : public Dataset<OutputTypes...> {
  public:
   explicit InterleaveDataset(RCReference<Dataset<InputTypes...>> input_dataset,
                              int64_t cycle_length, int64_t block_length,
+                             bool parallel, bool sloppy,
                              RCReference<const Function> map_fn,
                              HostContext* host)
       : input_dataset_(std::move(input_dataset)),
         cycle_length_(cycle_length),
         block_length_(block_length),
+        parallel_(parallel),
+        sloppy_(sloppy),
         host_(host),
         allocator_(host->allocator()),
         map_fn_(std::move(map_fn)) {}
@@ -75,9 +93,11 @@ class InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   RCReference<Iterator<OutputTypes...>> MakeIterator() override;
 
  private:
-  // Allow iterator to rely on private data members of this dataset.
+  // Allow iterators to rely on private data members of this dataset.
   friend class InterleaveDatasetIterator<std::tuple<InputTypes...>,
                                          std::tuple<OutputTypes...>>;
+  friend class ParallelInterleaveDatasetIterator<std::tuple<InputTypes...>,
+                                                 std::tuple<OutputTypes...>>;
 
   void Destroy() override {
     internal::DestroyImpl<InterleaveDataset<std::tuple<InputTypes...>,
@@ -88,6 +108,8 @@ class InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   RCReference<Dataset<InputTypes...>> input_dataset_;
   int64_t cycle_length_;
   int64_t block_length_;
+  bool parallel_;
+  bool sloppy_;
   HostContext* host_;
   HostAllocator* allocator_;
   RCReference<const Function> map_fn_;
@@ -153,9 +175,87 @@ class InterleaveDatasetIterator<std::tuple<InputTypes...>,
       const ExecutionContext& exec_ctx);
 };
 
+// ParallelInterleaveDatasetIterator opens all cycle_length child iterators
+// eagerly and keeps up to block_length GetNext calls buffered per child, so
+// asynchronous children produce elements concurrently. In sloppy mode it
+// yields from whichever child has an available element first.
+template <typename... InputTypes, typename... OutputTypes>
+class ParallelInterleaveDatasetIterator<std::tuple<InputTypes...>,
+                                        std::tuple<OutputTypes...>>
+    : public Iterator<OutputTypes...> {
+ public:
+  explicit ParallelInterleaveDatasetIterator(
+      RCReference<InterleaveDataset<std::tuple<InputTypes...>,
+                                    std::tuple<OutputTypes...>>>
+          parent_dataset)
+      : Iterator<OutputTypes...>(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()),
+        slots_(parent_dataset_->cycle_length_) {}
+
+  // This class is not copyable or movable.
+  ParallelInterleaveDatasetIterator(const ParallelInterleaveDatasetIterator&) =
+      delete;
+  ParallelInterleaveDatasetIterator& operator=(
+      const ParallelInterleaveDatasetIterator&) = delete;
+
+  AsyncValueRef<std::tuple<OutputTypes...>> GetNext(
+      const ExecutionContext& exec_ctx) override;
+
+ private:
+  // One child of the cycle: its iterator and the elements buffered from it.
+  // An empty AsyncValueRef in the buffer marks the end of this child.
+  struct CycleSlot {
+    RCReference<Iterator<OutputTypes...>> iterator;
+    std::queue<AsyncValueRef<std::tuple<OutputTypes...>>> buffer;
+  };
+
+  void Destroy() override {
+    internal::DestroyImpl<ParallelInterleaveDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  // Opens child iterators for vacant slots while input remains and tops every
+  // open child's buffer up to block_length outstanding GetNext calls. Returns
+  // a non-null error value if the input iterator fails.
+  AsyncValueRef<std::tuple<OutputTypes...>> FillSlots(
+      const ExecutionContext& exec_ctx);
+
+  // Closes the slot at `index` and resets the block position to the next
+  // slot.
+  void CloseSlot(size_t index) {
+    slots_[index].iterator.reset();
+    slots_[index].buffer = {};
+    --num_open_;
+    block_index_ = 0;
+    cycle_index_ = (index + 1) % slots_.size();
+  }
+
+  RCReference<Iterator<OutputTypes...>> MakeIteratorFromInputElement(
+      AsyncValueRef<std::tuple<InputTypes...>> input_element,
+      const ExecutionContext& exec_ctx);
+
+  RCReference<
+      InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>>
+      parent_dataset_;
+  RCReference<Iterator<InputTypes...>> input_iterator_;
+
+  std::vector<CycleSlot> slots_;
+  size_t cycle_index_ = 0;
+  size_t block_index_ = 0;
+  bool end_of_input_ = false;
+  size_t num_open_ = 0;  // Number of open child iterators
+};
+
 template <typename... InputTypes, typename... OutputTypes>
 RCReference<Iterator<OutputTypes...>> InterleaveDataset<
     std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::MakeIterator() {
+  if (parallel_) {
+    return TakeRef(
+        host_->Construct<ParallelInterleaveDatasetIterator<
+            std::tuple<InputTypes...>, std::tuple<OutputTypes...>>>(
+            FormRef(this)));
+  }
   return TakeRef(
       host_->Construct<InterleaveDatasetIterator<std::tuple<InputTypes...>,
                                                  std::tuple<OutputTypes...>>>(
@@ -245,7 +345,125 @@ RCReference<Iterator<OutputTypes...>> InterleaveDatasetIterator<
   fn_args.push_back(arg.GetAsyncValue());
   SmallVector<RCReference<AsyncValue>, 1> fn_results;
   fn_results.resize(1);
-  parent_dataset_->map_fn_->Execute(fn_args, fn_results, exec_ctx.host());
+  parent_dataset_->map_fn_->Execute(exec_ctx, fn_args, fn_results);
+
+  // NOTE: If the inputs to this function are async, or the function is
+  // executed asynchronously, this will fail.
+  // TODO(rachelim): Try to support asynchronously created iterators.
+  assert(fn_results[0]->IsAvailable());
+
+  const auto& dataset =
+      fn_results[0]->template get<RCReference<Dataset<OutputTypes...>>>();
+  return dataset->MakeIterator();
+}
+
+template <typename... InputTypes, typename... OutputTypes>
+AsyncValueRef<std::tuple<OutputTypes...>>
+ParallelInterleaveDatasetIterator<std::tuple<InputTypes...>,
+                                  std::tuple<OutputTypes...>>::
+    FillSlots(const ExecutionContext& exec_ctx) {
+  const size_t buffer_depth =
+      std::max<int64_t>(1, parent_dataset_->block_length_);
+  for (auto& slot : slots_) {
+    // Open a child iterator for a vacant slot while input remains.
+    if (!slot.iterator && !end_of_input_) {
+      auto input_element = input_iterator_->GetNext(exec_ctx);
+      if (!input_element) {
+        end_of_input_ = true;
+      } else if (!input_element.IsAvailable()) {
+        // Same limitation as the sequential iterator: opening a child
+        // requires the input element synchronously.
+        return EmitErrorAsync(
+            exec_ctx,
+            "interleave expects its inputs to be available synchronously");
+      } else if (input_element.IsError()) {
+        return AsyncValueRef<std::tuple<OutputTypes...>>(
+            input_element.ReleaseRCRef());
+      } else {
+        slot.iterator =
+            MakeIteratorFromInputElement(std::move(input_element), exec_ctx);
+        ++num_open_;
+      }
+    }
+    // Keep block_length GetNext calls outstanding on every open child so they
+    // all make progress concurrently.
+    while (slot.iterator && slot.buffer.size() < buffer_depth) {
+      slot.buffer.push(slot.iterator->GetNext(exec_ctx));
+    }
+  }
+  return AsyncValueRef<std::tuple<OutputTypes...>>();
+}
+
+template <typename... InputTypes, typename... OutputTypes>
+AsyncValueRef<std::tuple<OutputTypes...>>
+ParallelInterleaveDatasetIterator<std::tuple<InputTypes...>,
+                                  std::tuple<OutputTypes...>>::
+    GetNext(const ExecutionContext& exec_ctx) {
+  while (true) {
+    auto error = FillSlots(exec_ctx);
+    if (error) return error;
+    if (num_open_ == 0) {
+      // End of iteration.
+      return AsyncValueRef<std::tuple<OutputTypes...>>();
+    }
+
+    // Pick the slot to yield from. By default this is the next open slot of
+    // the cycle; in sloppy mode, prefer the first slot whose front element is
+    // already available so one slow child does not stall the others.
+    size_t chosen = slots_.size();
+    for (size_t j = 0; j != slots_.size(); ++j) {
+      size_t index = (cycle_index_ + j) % slots_.size();
+      if (!slots_[index].iterator) continue;
+      if (chosen == slots_.size()) chosen = index;
+      if (!parent_dataset_->sloppy_) break;
+      auto& front = slots_[index].buffer.front();
+      if (!front || front.IsAvailable()) {
+        chosen = index;
+        break;
+      }
+    }
+
+    auto& slot = slots_[chosen];
+    auto value = std::move(slot.buffer.front());
+    slot.buffer.pop();
+
+    // An empty value means this child is exhausted; close its slot and open a
+    // replacement on the next pass.
+    if (!value) {
+      CloseSlot(chosen);
+      continue;
+    }
+    if (chosen != cycle_index_) {
+      // Sloppy mode jumped ahead; resume the cycle at the chosen slot.
+      cycle_index_ = chosen;
+      block_index_ = 0;
+    }
+    // Advance the block position, moving to the next slot of the cycle after
+    // block_length consecutive elements.
+    ++block_index_;
+    if (block_index_ >= static_cast<size_t>(parent_dataset_->block_length_)) {
+      block_index_ = 0;
+      cycle_index_ = (chosen + 1) % slots_.size();
+    }
+    return value;
+  }
+}
+
+template <typename... InputTypes, typename... OutputTypes>
+RCReference<Iterator<OutputTypes...>>
+ParallelInterleaveDatasetIterator<std::tuple<InputTypes...>,
+                                  std::tuple<OutputTypes...>>::
+    MakeIteratorFromInputElement(
+        AsyncValueRef<std::tuple<InputTypes...>> input_element,
+        const ExecutionContext& exec_ctx) {
+  // TODO(rachelim): Support inputs of arbitrary arity.
+  SmallVector<AsyncValue*, 4> fn_args;
+  auto arg = exec_ctx.host()->template MakeConcreteAsyncValueRef<InputTypes...>(
+      std::move(std::get<0>(input_element.get())));
+  fn_args.push_back(arg.GetAsyncValue());
+  SmallVector<RCReference<AsyncValue>, 1> fn_results;
+  fn_results.resize(1);
+  parent_dataset_->map_fn_->Execute(exec_ctx, fn_args, fn_results);
 
   // NOTE: If the inputs to this function are async, or the function is
   // executed asynchronously, this will fail.
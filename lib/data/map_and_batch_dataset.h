@@ -0,0 +1,307 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- map_and_batch_dataset.h ----------------------------------*- C++ -*-===//
+//
+// This file declares MapAndBatchDataset class which fuses MapDataset and
+// BatchDataset: the map invocations of one batch run in parallel over the
+// work queue and each result is copied into its slice of a single
+// preallocated batch tensor as soon as it resolves, instead of materializing
+// a vector of per-element tensors that a later serial gather copies.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_MAP_AND_BATCH_DATASET_H_
+#define TFRT_LIB_DATA_MAP_AND_BATCH_DATASET_H_
+
+#include <cstring>
+#include <memory>
+
+#include "dataset.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/function.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+template <typename... T>
+class MapAndBatchDataset;
+
+template <typename... T>
+class MapAndBatchDatasetIterator;
+
+// Partial specialization of MapAndBatchDataset to support multiple parameter
+// packs. MapAndBatchDataset maps a user-defined function over the elements in
+// its input dataset and batches the resulting tensors. The map function must
+// return a single DenseHostTensor, and must return the same metadata for
+// every element of a batch.
+template <typename... InputTypes>
+class MapAndBatchDataset<std::tuple<InputTypes...>>
+    : public Dataset<DenseHostTensor> {
+ public:
+  explicit MapAndBatchDataset(RCReference<Dataset<InputTypes...>> input_dataset,
+                              int32_t batch_size,
+                              RCArray<AsyncValue> additional_fn_args,
+                              RCReference<const Function> map_fn,
+                              HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        batch_size_(batch_size),
+        host_(host),
+        allocator_(host->allocator()),
+        additional_fn_args_(std::move(additional_fn_args)),
+        map_fn_(std::move(map_fn)) {
+    assert(map_fn_->result_types().size() == 1 &&
+           "MapAndBatchDataset requires a map function with a single output.");
+  }
+
+  // This class is not copyable or movable.
+  MapAndBatchDataset(const MapAndBatchDataset&) = delete;
+  MapAndBatchDataset& operator=(const MapAndBatchDataset&) = delete;
+
+  RCReference<Iterator<DenseHostTensor>> MakeIterator() override;
+
+ private:
+  // Allow iterator to rely on private data members of this dataset.
+  friend class MapAndBatchDatasetIterator<std::tuple<InputTypes...>>;
+
+  void Destroy() override {
+    internal::DestroyImpl<MapAndBatchDataset<std::tuple<InputTypes...>>>(
+        this, allocator_);
+  }
+
+  RCReference<Dataset<InputTypes...>> input_dataset_;
+  const int32_t batch_size_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+  RCArray<AsyncValue> additional_fn_args_;
+  RCReference<const Function> map_fn_;
+};
+
+template <typename... InputTypes>
+class MapAndBatchDatasetIterator<std::tuple<InputTypes...>>
+    : public Iterator<DenseHostTensor> {
+ public:
+  explicit MapAndBatchDatasetIterator(
+      RCReference<MapAndBatchDataset<std::tuple<InputTypes...>>> parent_dataset)
+      : Iterator<DenseHostTensor>(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()) {}
+
+  AsyncValueRef<std::tuple<DenseHostTensor>> GetNext(
+      const ExecutionContext& exec_ctx) override {
+    // Get up to batch_size values from the underlying iterator.
+    SmallVector<AsyncValueRef<std::tuple<InputTypes...>>, 4> inputs;
+    for (int i = 0; i < parent_dataset_->batch_size_; i++) {
+      auto input = input_iterator_->GetNext(exec_ctx);
+      if (!input) {
+        break;
+      }
+      if (input.IsError()) {
+        return AsyncValueRef<std::tuple<DenseHostTensor>>(input.ReleaseRCRef());
+      }
+      inputs.push_back(std::move(input));
+    }
+    if (inputs.empty()) {
+      return AsyncValueRef<std::tuple<DenseHostTensor>>();
+    }
+
+    auto async_result =
+        exec_ctx.host()
+            ->template MakeUnconstructedAsyncValueRef<
+                std::tuple<DenseHostTensor>>();
+    auto state = std::make_shared<BatchState>();
+    state->num_pending = inputs.size();
+    for (size_t i = 0, e = inputs.size(); i != e; ++i) {
+      StartMapIntoSlice(exec_ctx, std::move(inputs[i]), i, e, state,
+                        async_result.CopyRef());
+    }
+    return async_result;
+  }
+
+ private:
+  // State shared between the map invocations of one batch. The batch tensor
+  // is allocated by whichever invocation resolves first, once the element
+  // metadata is known.
+  struct BatchState {
+    mutex mu;
+    llvm::Optional<DenseHostTensor> batch TFRT_GUARDED_BY(mu);
+    TensorMetadata element_metadata TFRT_GUARDED_BY(mu);
+    size_t num_pending TFRT_GUARDED_BY(mu) = 0;
+    bool failed TFRT_GUARDED_BY(mu) = false;
+  };
+
+  // Records the failure of one slice. Only the first error is forwarded to
+  // async_result.
+  static void FailSlice(
+      const std::shared_ptr<BatchState>& state,
+      const AsyncValueRef<std::tuple<DenseHostTensor>>& async_result,
+      const DecodedDiagnostic& error) {
+    bool first_error;
+    {
+      mutex_lock lock(state->mu);
+      first_error = !state->failed;
+      state->failed = true;
+      --state->num_pending;
+    }
+    if (first_error) {
+      async_result.SetError(error);
+    }
+  }
+
+  // Launches one asynchronous invocation of the map function on `input` and
+  // copies the resulting tensor into slice `index` of the batch tensor on the
+  // worker thread that resolves it. The invocation that completes the batch
+  // makes async_result available.
+  void StartMapIntoSlice(
+      const ExecutionContext& exec_ctx,
+      AsyncValueRef<std::tuple<InputTypes...>> input, size_t index,
+      size_t num_elements, std::shared_ptr<BatchState> state,
+      AsyncValueRef<std::tuple<DenseHostTensor>> async_result) {
+    const Function* map_fn = parent_dataset_->map_fn_.get();
+    auto additional_fn_args = parent_dataset_->additional_fn_args_.CopyRef();
+    HostContext* host = exec_ctx.host();
+    host->EnqueueWork([exec_ctx, host, map_fn = FormRef(map_fn),
+                       additional_fn_args = std::move(additional_fn_args),
+                       input = std::move(input), index, num_elements,
+                       state = std::move(state),
+                       async_result = std::move(async_result)]() mutable {
+      input.AndThen([exec_ctx, host, map_fn = map_fn.CopyRef(),
+                     additional_fn_args = std::move(additional_fn_args),
+                     input = input.CopyRef(), index, num_elements,
+                     state = std::move(state),
+                     async_result = std::move(async_result)]() mutable {
+        if (input.IsError()) {
+          FailSlice(state, async_result, input.GetError());
+          return;
+        }
+        // Construct arguments for function execution. The arguments consist
+        // of the 'additional_fn_args' from the MapAndBatchDataset constructor,
+        // followed by the value from the underlying iterator.
+        SmallVector<AsyncValue*, 4> arguments;
+        for (auto* additional_arg : additional_fn_args.values()) {
+          arguments.push_back(additional_arg);
+        }
+        auto arg = host->template MakeConcreteAsyncValueRef<InputTypes...>(
+            std::move(std::get<0>(input.get())));
+        arguments.push_back(arg.GetAsyncValue());
+
+        SmallVector<RCReference<AsyncValue>, 1> results;
+        results.resize(1);
+        map_fn->Execute(arguments, results, host);
+        auto result = std::move(results[0]);
+        auto* result_ptr = result.get();
+        result_ptr->AndThen([exec_ctx, result = std::move(result), index,
+                             num_elements, state = std::move(state),
+                             async_result = std::move(async_result)]() mutable {
+          if (result->IsError()) {
+            FailSlice(state, async_result, result->GetError());
+            return;
+          }
+          auto& element = result->template get<DenseHostTensor>();
+          ScatterSlice(exec_ctx, element, index, num_elements, state,
+                       async_result);
+        });
+      });
+    });
+  }
+
+  // Copies `element` into slice `index` of the batch tensor, allocating the
+  // batch tensor first if this is the first slice to resolve. The slice of a
+  // row-major dense tensor is contiguous, so the write is a single memcpy at
+  // the slice offset.
+  static void ScatterSlice(
+      const ExecutionContext& exec_ctx, const DenseHostTensor& element,
+      size_t index, size_t num_elements,
+      const std::shared_ptr<BatchState>& state,
+      const AsyncValueRef<std::tuple<DenseHostTensor>>& async_result) {
+    char* slice = nullptr;
+    {
+      mutex_lock lock(state->mu);
+      if (state->failed) {
+        --state->num_pending;
+        return;
+      }
+      if (!state->batch.hasValue()) {
+        // Construct the batch tensor with the +1 dimension and the same dtype
+        // as the element tensors.
+        state->element_metadata = element.metadata();
+        SmallVector<ssize_t, 4> batch_dims;
+        element.shape().GetDimensions(&batch_dims);
+        const int rank = batch_dims.size();
+        batch_dims.resize(rank + 1);
+        for (int i = rank; i > 0; i--) {
+          batch_dims[i] = batch_dims[i - 1];
+        }
+        batch_dims[0] = num_elements;
+        TensorMetadata batch_metadata(element.dtype(), batch_dims);
+        state->batch = DenseHostTensor::CreateUninitialized(
+            batch_metadata, exec_ctx.host()->allocator());
+        if (!state->batch.hasValue()) {
+          state->failed = true;
+          --state->num_pending;
+          async_result.SetError(
+              EmitError(exec_ctx, "failed to create uninitialized tensor"));
+          return;
+        }
+      } else if (!(element.metadata() == state->element_metadata)) {
+        state->failed = true;
+        --state->num_pending;
+        async_result.SetError(EmitError(
+            exec_ctx, "tensors to be batched must have the same metadata"));
+        return;
+      }
+      slice = static_cast<char*>(state->batch->data()) +
+              index * element.DataSizeInBytes();
+    }
+    // Copy outside the lock; slices of distinct elements are disjoint.
+    std::memcpy(slice, element.data(), element.DataSizeInBytes());
+    bool done;
+    {
+      mutex_lock lock(state->mu);
+      done = --state->num_pending == 0 && !state->failed;
+    }
+    if (done) {
+      async_result.emplace(std::move(*state->batch));
+    }
+  }
+
+  void Destroy() override {
+    internal::DestroyImpl<MapAndBatchDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  RCReference<MapAndBatchDataset<std::tuple<InputTypes...>>> parent_dataset_;
+  RCReference<Iterator<InputTypes...>> input_iterator_;
+};
+
+template <typename... InputTypes>
+RCReference<Iterator<DenseHostTensor>>
+MapAndBatchDataset<std::tuple<InputTypes...>>::MakeIterator() {
+  return TakeRef(
+      host_->Construct<MapAndBatchDatasetIterator<std::tuple<InputTypes...>>>(
+          FormRef(this)));
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_MAP_AND_BATCH_DATASET_H_
@@ -24,6 +24,9 @@
 #ifndef TFRT_LIB_DATA_MAP_DATASET_H_
 #define TFRT_LIB_DATA_MAP_DATASET_H_
 
+#include <chrono>
+#include <queue>
+
 #include "dataset.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/support/forward_decls.h"
@@ -65,18 +68,27 @@ static std::tuple<T...> ArrayToTuple(
 // Partial specialization of MapDataset to support multiple parameter packs.
 // MapDataset maps a user-defined function over the elements in its input
 // dataset.
+//
+// If num_parallel_calls is larger than one, the iterator keeps up to that many
+// map invocations in flight over the work queue and returns their results in
+// input order, similar to what PrefetchDataset does for single elements but
+// for the map computation itself.
 template <typename... InputTypes, typename... OutputTypes>
 class MapDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
     : public Dataset<OutputTypes...> {
  public:
   explicit MapDataset(RCReference<Dataset<InputTypes...>> input_dataset,
                       RCArray<AsyncValue> additional_fn_args,
-                      RCReference<const Function> map_fn, HostContext* host)
+                      RCReference<const Function> map_fn,
+                      int32_t num_parallel_calls, HostContext* host)
       : input_dataset_(std::move(input_dataset)),
         host_(host),
         allocator_(host->allocator()),
         additional_fn_args_(std::move(additional_fn_args)),
-        map_fn_(std::move(map_fn)) {}
+        map_fn_(std::move(map_fn)),
+        num_parallel_calls_(num_parallel_calls) {
+    assert(num_parallel_calls >= 1);
+  }
 
   // This class is not copyable or movable.
   MapDataset(const MapDataset&) = delete;
@@ -100,6 +112,7 @@ class MapDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   HostAllocator* allocator_;
   RCArray<AsyncValue> additional_fn_args_;
   RCReference<const Function> map_fn_;
+  const int32_t num_parallel_calls_;
 };
 
 template <typename... InputTypes, typename... OutputTypes>
@@ -116,6 +129,28 @@ class MapDatasetIterator<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
 
   AsyncValueRef<std::tuple<OutputTypes...>> GetNext(
       const ExecutionContext& exec_ctx) override {
+    // Keep up to num_parallel_calls map invocations in flight and hand their
+    // results out in input order. With num_parallel_calls == 1 this degenerates
+    // to starting one invocation and returning it.
+    auto start = std::chrono::steady_clock::now();
+    while (buffer_.size() <
+           static_cast<size_t>(parent_dataset_->num_parallel_calls_)) {
+      buffer_.push(StartMap(exec_ctx));
+    }
+    metrics_.RecordGetNext(std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    auto result = std::move(buffer_.front());
+    buffer_.pop();
+    return result;
+  }
+
+ private:
+  // Fetches the next element from the input iterator and launches one
+  // asynchronous invocation of the map function on it, returning the
+  // unconstructed result. Returns an empty AsyncValueRef at end of input.
+  AsyncValueRef<std::tuple<OutputTypes...>> StartMap(
+      const ExecutionContext& exec_ctx) {
     const Function* map_fn = parent_dataset_->map_fn_.get();
     // IDEA(donglin): consider extending RCArray to support CopyRef() without
     // doing shallow copy.
@@ -197,7 +232,6 @@ class MapDatasetIterator<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
     return async_result;
   }
 
- private:
   // This class is not copyable or movable.
   MapDatasetIterator(const MapDatasetIterator&) = delete;
   MapDatasetIterator& operator=(const MapDatasetIterator&) = delete;
@@ -210,6 +244,9 @@ class MapDatasetIterator<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   RCReference<MapDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>>
       parent_dataset_;
   RCReference<Iterator<InputTypes...>> input_iterator_;
+  // In-flight map invocations in input order.
+  std::queue<AsyncValueRef<std::tuple<OutputTypes...>>> buffer_;
+  IteratorMetrics metrics_{"map_dataset"};
 };
 
 template <typename... InputTypes, typename... OutputTypes>
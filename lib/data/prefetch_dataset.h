@@ -25,7 +25,9 @@
 #ifndef TFRT_LIB_DATA_PREFETCH_DATASET_H_
 #define TFRT_LIB_DATA_PREFETCH_DATASET_H_
 
-#include <queue>
+#include <algorithm>
+#include <chrono>
+#include <deque>
 
 #include "dataset.h"
 #include "tfrt/support/forward_decls.h"
@@ -36,14 +38,27 @@ namespace data {
 template <typename... T>
 class PrefetchDatasetIterator;
 
+// PrefetchDataset keeps up to a configurable number of GetNext calls to the
+// input iterator outstanding ahead of the consumer.
+//
+// If min_prefetch_num < max_prefetch_num, the iterator autotunes its buffer
+// size within that range: the buffer doubles when the consumer stalls on an
+// element that is not yet available, and shrinks by one when a whole
+// observation window passes without a stall, so pipelines converge to the
+// smallest buffer that hides producer latency without manual tuning.
 template <typename... T>
 class PrefetchDataset : public Dataset<T...> {
  public:
   explicit PrefetchDataset(RCReference<Dataset<T...>> input_dataset,
-                           int32_t prefetch_num, HostContext* host)
+                           int32_t min_prefetch_num, int32_t max_prefetch_num,
+                           HostContext* host)
       : input_dataset_(std::move(input_dataset)),
-        prefetch_num_(prefetch_num),
-        host_(host) {}
+        min_prefetch_num_(min_prefetch_num),
+        max_prefetch_num_(max_prefetch_num),
+        host_(host) {
+    assert(min_prefetch_num >= 1);
+    assert(max_prefetch_num >= min_prefetch_num);
+  }
 
   // This class is not copyable or movable.
   PrefetchDataset(const PrefetchDataset&) = delete;
@@ -60,7 +75,8 @@ class PrefetchDataset : public Dataset<T...> {
   }
 
   RCReference<Dataset<T...>> input_dataset_;
-  int32_t prefetch_num_;
+  int32_t min_prefetch_num_;
+  int32_t max_prefetch_num_;
   HostContext* host_;
 };
 
@@ -72,7 +88,8 @@ class PrefetchDatasetIterator : public Iterator<T...> {
       RCReference<Iterator<T...>> input_iterator)
       : Iterator<T...>(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(std::move(input_iterator)) {}
+        input_iterator_(std::move(input_iterator)),
+        prefetch_num_(parent_dataset_->min_prefetch_num_) {}
 
   // This class is not copyable or movable.
   PrefetchDatasetIterator(const PrefetchDatasetIterator&) = delete;
@@ -80,15 +97,52 @@ class PrefetchDatasetIterator : public Iterator<T...> {
 
   AsyncValueRef<std::tuple<T...>> GetNext(
       const ExecutionContext& exec_ctx) override {
-    while (buffer_.size() < parent_dataset_->prefetch_num_) {
-      buffer_.push(input_iterator_->GetNext(exec_ctx));
+    // If the buffer was shrunk below its current size, let it drain instead of
+    // refilling. A synchronous input iterator does its work inside this loop,
+    // which is what the blocked-upstream counter measures.
+    auto start = std::chrono::steady_clock::now();
+    while (buffer_.size() < static_cast<size_t>(prefetch_num_)) {
+      buffer_.push_back(input_iterator_->GetNext(exec_ctx));
     }
+    metrics_.RecordGetNext(std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    metrics_.RecordBufferOccupancy(std::count_if(
+        buffer_.begin(), buffer_.end(),
+        [](const AsyncValueRef<std::tuple<T...>>& value) {
+          return !value || value.IsAvailable();
+        }));
     auto result = std::move(buffer_.front());
-    buffer_.pop();
+    buffer_.pop_front();
+    if (parent_dataset_->min_prefetch_num_ <
+        parent_dataset_->max_prefetch_num_) {
+      UpdatePrefetchNum(result);
+    }
     return result;
   }
 
  private:
+  // Observation window after which an uncontended buffer shrinks by one.
+  static constexpr int32_t kAdjustmentInterval = 32;
+
+  // Adjusts the buffer size based on whether the consumer would have stalled
+  // on `result`: an element that is not yet available means the producer is
+  // behind, so the buffer doubles immediately; a full window of available
+  // elements means there is slack, so the buffer gives one slot back.
+  void UpdatePrefetchNum(const AsyncValueRef<std::tuple<T...>>& result) {
+    if (result && !result.IsAvailable()) {
+      prefetch_num_ =
+          std::min(prefetch_num_ * 2, parent_dataset_->max_prefetch_num_);
+      num_ready_ = 0;
+      return;
+    }
+    if (++num_ready_ >= kAdjustmentInterval) {
+      prefetch_num_ =
+          std::max(prefetch_num_ - 1, parent_dataset_->min_prefetch_num_);
+      num_ready_ = 0;
+    }
+  }
+
   void Destroy() override {
     internal::DestroyImpl<PrefetchDatasetIterator>(
         this, parent_dataset_->host_->allocator());
@@ -96,7 +150,12 @@ class PrefetchDatasetIterator : public Iterator<T...> {
 
   RCReference<PrefetchDataset<T...>> parent_dataset_;
   RCReference<Iterator<T...>> input_iterator_;
-  std::queue<AsyncValueRef<std::tuple<T...>>> buffer_;
+  std::deque<AsyncValueRef<std::tuple<T...>>> buffer_;
+  IteratorMetrics metrics_{"prefetch_dataset"};
+  // Current buffer size target, within [min_prefetch_num, max_prefetch_num].
+  int32_t prefetch_num_;
+  // Consecutive GetNext calls whose element was already available.
+  int32_t num_ready_ = 0;
 };
 
 template <typename... T>
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- shuffle_dataset.h ----------------------------------------*- C++ -*-===//
+//
+// This file declares ShuffleDataset class which wraps around another Dataset
+// instance and yields its elements in random order from a buffer bounded by a
+// byte budget. The buffer holds AsyncValue handles, so shuffling a large
+// window moves references, never tensor payloads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_SHUFFLE_DATASET_H_
+#define TFRT_LIB_DATA_SHUFFLE_DATASET_H_
+
+#include <random>
+#include <vector>
+
+#include "dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+template <typename... T>
+class ShuffleDatasetIterator;
+
+// Returns the payload size of one element component, used to charge the
+// shuffle buffer against its byte budget.
+inline size_t ElementSizeInBytes(const DenseHostTensor& tensor) {
+  return tensor.DataSizeInBytes();
+}
+
+inline size_t ElementSizeInBytes(const std::string& value) {
+  return value.size();
+}
+
+template <typename T>
+size_t ElementSizeInBytes(const T& value) {
+  static_assert(std::is_scalar<T>::value, "T needs to be a scalar type");
+  return sizeof(T);
+}
+
+template <typename... T, size_t... Indices>
+size_t TupleSizeInBytesHelper(const std::tuple<T...>& element,
+                              std::index_sequence<Indices...>) {
+  size_t total = 0;
+  (void)std::initializer_list<int>{
+      (total += ElementSizeInBytes(std::get<Indices>(element)), 0)...};
+  return total;
+}
+
+template <typename... T>
+size_t TupleSizeInBytes(const std::tuple<T...>& element) {
+  return TupleSizeInBytesHelper(element,
+                                std::make_index_sequence<sizeof...(T)>());
+}
+
+// ShuffleDataset yields the elements of its input dataset in random order.
+// The shuffle window is bounded by buffer_size_bytes of element payload
+// rather than an element count, so one budget works across pipelines with
+// very different element sizes. The same seed over the same input produces
+// the same order.
+template <typename... T>
+class ShuffleDataset : public Dataset<T...> {
+ public:
+  explicit ShuffleDataset(RCReference<Dataset<T...>> input_dataset,
+                          int64_t buffer_size_bytes, int64_t seed,
+                          HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        buffer_size_bytes_(buffer_size_bytes),
+        seed_(seed),
+        host_(host) {
+    assert(buffer_size_bytes >= 1);
+  }
+
+  // This class is not copyable or movable.
+  ShuffleDataset(const ShuffleDataset&) = delete;
+  ShuffleDataset& operator=(const ShuffleDataset&) = delete;
+
+  RCReference<Iterator<T...>> MakeIterator() override;
+
+ private:
+  // Allow iterator to rely on private data members of this dataset.
+  friend class ShuffleDatasetIterator<T...>;
+
+  void Destroy() override {
+    internal::DestroyImpl<ShuffleDataset<T...>>(this, host_->allocator());
+  }
+
+  RCReference<Dataset<T...>> input_dataset_;
+  const int64_t buffer_size_bytes_;
+  const int64_t seed_;
+  HostContext* host_;
+};
+
+template <typename... T>
+class ShuffleDatasetIterator : public Iterator<T...> {
+ public:
+  explicit ShuffleDatasetIterator(
+      RCReference<ShuffleDataset<T...>> parent_dataset)
+      : Iterator<T...>(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()),
+        rng_(parent_dataset_->seed_) {}
+
+  // This class is not copyable or movable.
+  ShuffleDatasetIterator(const ShuffleDatasetIterator&) = delete;
+  ShuffleDatasetIterator& operator=(const ShuffleDatasetIterator&) = delete;
+
+  AsyncValueRef<std::tuple<T...>> GetNext(
+      const ExecutionContext& exec_ctx) override {
+    Fill(exec_ctx);
+    if (buffer_.empty()) {
+      // End of iteration.
+      return AsyncValueRef<std::tuple<T...>>();
+    }
+    // Draw a uniformly random buffered element and replace it with the last
+    // entry, so removal is O(1) and only handles move.
+    std::uniform_int_distribution<size_t> dist(0, buffer_.size() - 1);
+    size_t index = dist(rng_);
+    std::swap(buffer_[index], buffer_.back());
+    auto entry = std::move(buffer_.back());
+    buffer_.pop_back();
+    if (entry.accounted) {
+      buffered_bytes_ -= entry.bytes;
+    } else {
+      --num_unaccounted_;
+    }
+    return std::move(entry.value);
+  }
+
+ private:
+  // One buffered element. Its size is charged against the byte budget once
+  // the underlying AsyncValue becomes available; until then it counts toward
+  // the unaccounted cap.
+  struct Entry {
+    AsyncValueRef<std::tuple<T...>> value;
+    size_t bytes = 0;
+    bool accounted = false;
+  };
+
+  // Bounds the elements whose size is not yet known, so an all-pending
+  // pipeline cannot fill the buffer without limit before any sizes resolve.
+  static constexpr size_t kMaxUnaccountedElements = 256;
+
+  // Charges the sizes of elements that have become available since the last
+  // call, then pulls from the input until the byte budget or the unaccounted
+  // cap is reached.
+  void Fill(const ExecutionContext& exec_ctx) {
+    while (!end_of_input_) {
+      for (auto& entry : buffer_) {
+        if (entry.accounted || !entry.value.IsAvailable()) continue;
+        if (!entry.value.IsError()) {
+          entry.bytes = TupleSizeInBytes(entry.value.get());
+        }
+        entry.accounted = true;
+        buffered_bytes_ += entry.bytes;
+        --num_unaccounted_;
+      }
+      if (buffered_bytes_ >=
+          static_cast<size_t>(parent_dataset_->buffer_size_bytes_))
+        break;
+      if (num_unaccounted_ >= kMaxUnaccountedElements) break;
+      auto value = input_iterator_->GetNext(exec_ctx);
+      if (!value) {
+        end_of_input_ = true;
+        break;
+      }
+      buffer_.push_back(Entry{std::move(value)});
+      ++num_unaccounted_;
+    }
+  }
+
+  void Destroy() override {
+    internal::DestroyImpl<ShuffleDatasetIterator>(
+        this, parent_dataset_->host_->allocator());
+  }
+
+  RCReference<ShuffleDataset<T...>> parent_dataset_;
+  RCReference<Iterator<T...>> input_iterator_;
+  std::mt19937_64 rng_;
+  std::vector<Entry> buffer_;
+  size_t buffered_bytes_ = 0;
+  size_t num_unaccounted_ = 0;
+  bool end_of_input_ = false;
+};
+
+template <typename... T>
+RCReference<Iterator<T...>> ShuffleDataset<T...>::MakeIterator() {
+  return TakeRef(
+      host_->Construct<ShuffleDatasetIterator<T...>>(FormRef(this)));
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_SHUFFLE_DATASET_H_
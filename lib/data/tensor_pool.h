@@ -0,0 +1,107 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- tensor_pool.h --------------------------------------------*- C++ -*-===//
+//
+// This file declares TensorPool class which recycles the HostBuffers of
+// DenseHostTensors whose metadata recurs every pipeline iteration, so
+// steady-state input pipelines stop going to the allocator for buffers that
+// die one step after they are created.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_TENSOR_POOL_H_
+#define TFRT_LIB_DATA_TENSOR_POOL_H_
+
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+// TensorPool hands out DenseHostTensors backed by recycled buffers when one
+// with matching metadata is available, and accepts consumed tensors back via
+// Recycle. A dataset owns its pool and shares it with its iterators; all
+// methods are thread-safe. The pool is bounded per metadata key; beyond the
+// bound Recycle simply drops the buffer.
+//
+// A pipeline typically sees only a handful of distinct metadata keys, so
+// lookup is a linear scan.
+class TensorPool {
+ public:
+  TensorPool() = default;
+
+  // This class is not copyable or movable.
+  TensorPool(const TensorPool&) = delete;
+  TensorPool& operator=(const TensorPool&) = delete;
+
+  // Returns a tensor with the given metadata, backed by a pooled buffer if
+  // one is available and freshly allocated otherwise. Returns None on
+  // allocation failure.
+  llvm::Optional<DenseHostTensor> Allocate(const TensorMetadata& metadata,
+                                           HostAllocator* allocator) {
+    {
+      mutex_lock lock(mu_);
+      for (auto& entry : entries_) {
+        if (entry.metadata == metadata && !entry.buffers.empty()) {
+          auto buffer = std::move(entry.buffers.back());
+          entry.buffers.pop_back();
+          return DenseHostTensor(metadata, std::move(buffer));
+        }
+      }
+    }
+    return DenseHostTensor::CreateUninitialized(metadata, allocator);
+  }
+
+  // Returns a consumed tensor to the pool. The buffer is pooled only if
+  // `tensor` holds the last reference to it; otherwise some other holder is
+  // still reading it and it is simply released.
+  void Recycle(DenseHostTensor tensor) {
+    auto buffer = tensor.ReleaseBuffer();
+    if (!buffer || !buffer->IsUnique()) return;
+    mutex_lock lock(mu_);
+    for (auto& entry : entries_) {
+      if (entry.metadata == tensor.metadata()) {
+        if (entry.buffers.size() < kMaxBuffersPerKey)
+          entry.buffers.push_back(std::move(buffer));
+        return;
+      }
+    }
+    entries_.push_back(Entry{tensor.metadata()});
+    entries_.back().buffers.push_back(std::move(buffer));
+  }
+
+ private:
+  // Bounds the buffers retained per metadata key so a transient burst does
+  // not pin memory forever.
+  static constexpr size_t kMaxBuffersPerKey = 16;
+
+  struct Entry {
+    TensorMetadata metadata;
+    SmallVector<RCReference<HostBuffer>, 4> buffers;
+  };
+
+  mutex mu_;
+  SmallVector<Entry, 4> entries_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_TENSOR_POOL_H_
@@ -21,6 +21,14 @@
 
 #include "tf_record_dataset.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <vector>
+
 #include "tfrt/support/error_util.h"
 
 namespace tfrt {
@@ -58,13 +66,227 @@ inline uint64_t DecodeFixed64(const char* ptr) {
     return (hi << 32) | lo;
   }
 }
+
+// Record framing, from tensorflow/core/io/record_writer.h: a record is a
+// uint64 length, the masked crc32 of the length, the payload, and the masked
+// crc32 of the payload.
+constexpr size_t kHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+constexpr size_t kFooterSize = sizeof(uint32_t);
+
+// Sanity bound on the length field when scanning for a record boundary. A
+// candidate header whose length exceeds this is rejected without consulting
+// its checksum.
+constexpr uint64_t kMaxRecordSize = 1ull << 31;
+
+// Bounds the merge queue of the parallel reader so reader tasks stay ahead of
+// the consumer without unbounded memory.
+constexpr size_t kMaxBufferedRecords = 512;
+
+// Computes crc32c (Castagnoli polynomial), bitwise reflected.
+uint32_t Crc32c(const char* data, size_t n) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t;
+    for (uint32_t i = 0; i != 256; ++i) {
+      uint32_t crc = i;
+      for (int k = 0; k != 8; ++k)
+        crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78u : 0);
+      t[i] = crc;
+    }
+    return t;
+  }();
+  uint32_t crc = 0xffffffffu;
+  for (size_t i = 0; i != n; ++i)
+    crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^
+          (crc >> 8);
+  return crc ^ 0xffffffffu;
+}
+
+// TFRecord stores crcs rotated and offset so that a crc of a crc looks
+// different from the original value.
+uint32_t MaskedCrc32c(const char* data, size_t n) {
+  constexpr uint32_t kMaskDelta = 0xa282ead8u;
+  uint32_t crc = Crc32c(data, n);
+  return ((crc >> 15) | (crc << 17)) + kMaskDelta;
+}
+
+// Returns true if `header` points at kHeaderSize bytes that parse as a record
+// header: a plausible length followed by the masked crc32 of the length.
+bool IsValidRecordHeader(const char* header) {
+  uint64_t length = DecodeFixed64(header);
+  return length < kMaxRecordSize &&
+         MaskedCrc32c(header, sizeof(uint64_t)) ==
+             DecodeFixed32(header + sizeof(uint64_t));
+}
+
+// Scans forward from `begin` for the first offset that parses as a record
+// header. Returns an offset in [begin, end), or `end` if no record starts in
+// the shard. Offset zero is always a record boundary and is returned without
+// scanning.
+uint64_t FindFirstRecord(std::ifstream& stream, uint64_t begin, uint64_t end) {
+  if (begin == 0) return 0;
+
+  constexpr size_t kScanBlock = 1 << 16;
+  std::vector<char> buffer(kScanBlock + kHeaderSize - 1);
+  uint64_t offset = begin;
+  while (offset < end) {
+    stream.clear();
+    stream.seekg(offset);
+    stream.read(buffer.data(), buffer.size());
+    size_t got = stream.gcount();
+    if (got < kHeaderSize) break;
+    size_t candidates = std::min<uint64_t>(got - kHeaderSize + 1, end - offset);
+    for (size_t i = 0; i != candidates; ++i) {
+      if (IsValidRecordHeader(buffer.data() + i)) return offset + i;
+    }
+    // A short read means we scanned up to the end of the file.
+    if (got < buffer.size()) break;
+    offset += candidates;
+  }
+  return end;
+}
 }  // namespace
 
+//===----------------------------------------------------------------------===//
+// Implementation for ReadaheadInputStream member functions
+//===----------------------------------------------------------------------===//
+
+ReadaheadInputStream::ReadaheadInputStream(const std::string& path,
+                                           size_t buffer_size,
+                                           bool use_direct_io,
+                                           HostContext* host)
+    : host_(host) {
+  // O_DIRECT requires the buffer and the read size to be aligned to the
+  // logical block size of the device; align to a page to cover any of them.
+  constexpr size_t kAlignment = 4096;
+  capacity_ = std::max(kAlignment,
+                       (buffer_size + kAlignment - 1) & ~(kAlignment - 1));
+
+  int flags = O_RDONLY;
+#ifdef O_DIRECT
+  if (use_direct_io) flags |= O_DIRECT;
+#endif
+  fd_ = open(path.c_str(), flags);
+#ifdef O_DIRECT
+  if (fd_ < 0 && use_direct_io) {
+    // Some file systems do not support O_DIRECT; fall back to a cached open
+    // rather than failing the read.
+    fd_ = open(path.c_str(), O_RDONLY);
+  }
+#endif
+  if (fd_ < 0) {
+    failed_ = true;
+    return;
+  }
+
+  HostAllocator* allocator = host_->allocator();
+  buffers_[0] =
+      static_cast<char*>(allocator->AllocateBytes(capacity_, kAlignment));
+  buffers_[1] =
+      static_cast<char*>(allocator->AllocateBytes(capacity_, kAlignment));
+
+  // The front buffer starts out drained; the first Read advances to the
+  // buffer this fill produces.
+  StartFill(1 - front_);
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  {
+    mutex_lock lock(mu_);
+    while (fill_in_flight_) fill_cv_.wait(lock);
+  }
+  if (fd_ >= 0) close(fd_);
+  HostAllocator* allocator = host_->allocator();
+  for (char* buffer : buffers_) {
+    if (buffer) allocator->DeallocateBytes(buffer, capacity_);
+  }
+}
+
+void ReadaheadInputStream::StartFill(int buffer_index) {
+  {
+    mutex_lock lock(mu_);
+    fill_in_flight_ = true;
+  }
+  bool enqueued = host_->EnqueueBlockingWork(
+      [this, buffer_index] { FillBuffer(buffer_index); });
+  // If the blocking work queue is at capacity, fill inline; the consumer then
+  // loses the overlap for this buffer but not the stream.
+  if (!enqueued) FillBuffer(buffer_index);
+}
+
+void ReadaheadInputStream::FillBuffer(int buffer_index) {
+  size_t total = 0;
+  bool error = false;
+  while (total < capacity_) {
+    ssize_t r = read(fd_, buffers_[buffer_index] + total, capacity_ - total);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      error = true;
+      break;
+    }
+    if (r == 0) break;
+    total += r;
+  }
+  {
+    mutex_lock lock(mu_);
+    fill_size_ = total;
+    fill_error_ = error;
+    fill_in_flight_ = false;
+  }
+  fill_cv_.notify_all();
+}
+
+bool ReadaheadInputStream::AdvanceBuffer() {
+  size_t got;
+  bool error;
+  {
+    mutex_lock lock(mu_);
+    while (fill_in_flight_) fill_cv_.wait(lock);
+    got = fill_size_;
+    error = fill_error_;
+  }
+  if (error) {
+    failed_ = true;
+    return false;
+  }
+  front_ = 1 - front_;
+  front_size_ = got;
+  pos_ = 0;
+  if (got < capacity_) {
+    // A short fill means the file is exhausted; there is nothing left to
+    // prefetch.
+    eof_ = true;
+  } else {
+    StartFill(1 - front_);
+  }
+  return got > 0;
+}
+
+size_t ReadaheadInputStream::Read(char* dst, size_t n) {
+  if (failed_) return 0;
+  size_t total = 0;
+  while (total < n) {
+    size_t available = front_size_ - pos_;
+    if (available == 0) {
+      if (eof_ || !AdvanceBuffer()) break;
+      continue;
+    }
+    size_t take = std::min(n - total, available);
+    memcpy(dst + total, buffers_[front_] + pos_, take);
+    pos_ += take;
+    total += take;
+  }
+  return total;
+}
+
 //===----------------------------------------------------------------------===//
 // Implementation for TFRecordDataset member functions
 //===----------------------------------------------------------------------===//
 
 RCReference<Iterator<std::string>> TFRecordDataset::MakeIterator() {
+  if (num_parallel_reads_ > 1) {
+    return TakeRef(
+        host_->Construct<ParallelTFRecordDatasetIterator>(FormRef(this)));
+  }
   return TakeRef(host_->Construct<TFRecordDatasetIterator>(FormRef(this)));
 }
 
@@ -87,7 +309,7 @@ AsyncValueRef<std::tuple<std::string>> TFRecordDatasetIterator::GetNext(
 
 // Logic based on tensorflow/core/io/record_reader.*
 // Note: RecordReader maintains the offset. For now, we're relying on
-// ifstream reading sequentially.
+// the input stream reading sequentially.
 llvm::Expected<std::string> TFRecordDatasetIterator::ReadChecksummed(
     size_t n, bool* eof) {
   // The crc has size uint32.
@@ -97,20 +319,17 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadChecksummed(
   result.clear();
   result.resize(to_read);
 
-  char* buffer = &result[0];
-  stream_.read(buffer, to_read);
+  size_t got = input_->Read(&result[0], to_read);
 
-  if (stream_.eof()) {
-    if (stream_.gcount() == 0) {
-      // The previous record read was the final one. We're trying to read past
-      // the end of the file, but there's nothing left.
-      *eof = true;
-      return MakeStringError("end of file");
-    }
-    // Unable to read the full to_read number of bytes; this is
-    // a partial record.
+  if (got == 0 && !input_->failed()) {
+    // The previous record read was the final one. We're trying to read past
+    // the end of the file, but there's nothing left.
+    *eof = true;
+    return MakeStringError("end of file");
   }
-  if (stream_.fail()) {
+  if (got < to_read) {
+    // Unable to read the full to_read number of bytes; this is a partial
+    // record or an I/O error.
     return MakeStringError("failed to read data from stream");
   }
 
@@ -123,12 +342,7 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadChecksummed(
 // TODO(rachelim): Instead of having a bool* eof, consider subclassing
 // ErrorInfo and returning a special error type for eof.
 llvm::Expected<std::string> TFRecordDatasetIterator::ReadRecord(bool* eof) {
-  if (stream_.eof() && stream_.gcount() == 0) {
-    *eof = true;
-    return MakeStringError("end of file");
-  }
-
-  if (stream_.fail()) {
+  if (input_->failed()) {
     return MakeStringError("failed to read file: ", parent_dataset_->path_);
   }
 
@@ -154,5 +368,127 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadRecord(bool* eof) {
   return body;
 }
 
+//===----------------------------------------------------------------------===//
+// Implementation for ParallelTFRecordDatasetIterator member functions
+//===----------------------------------------------------------------------===//
+
+ParallelTFRecordDatasetIterator::ParallelTFRecordDatasetIterator(
+    RCReference<TFRecordDataset> parent_dataset)
+    : Iterator<std::string>(),
+      parent_dataset_(std::move(parent_dataset)),
+      state_(std::make_shared<ReaderState>(parent_dataset_->path_)) {
+  HostContext* host = parent_dataset_->host_;
+
+  uint64_t file_size = 0;
+  {
+    std::ifstream stream(state_->path,
+                         std::ios_base::binary | std::ios_base::ate);
+    if (stream) file_size = stream.tellg();
+  }
+
+  // Do not create shards smaller than this; below it the per-shard
+  // resynchronization scan costs more than the parallelism buys.
+  constexpr uint64_t kMinShardSize = 1 << 20;
+  uint64_t num_shards = std::max<uint64_t>(
+      1, std::min<uint64_t>(parent_dataset_->num_parallel_reads_,
+                            std::max<uint64_t>(1, file_size / kMinShardSize)));
+
+  state_->num_active_readers = num_shards;
+  for (uint64_t i = 0; i != num_shards; ++i) {
+    uint64_t begin = file_size * i / num_shards;
+    uint64_t end = file_size * (i + 1) / num_shards;
+    bool enqueued = host->EnqueueBlockingWork(
+        [state = state_, begin, end]() mutable {
+          ReadShard(std::move(state), begin, end);
+        });
+    if (!enqueued) {
+      mutex_lock lock(state_->mu);
+      --state_->num_active_readers;
+      state_->records.push(
+          MakeStringError("failed to enqueue TFRecord reader task"));
+    }
+  }
+}
+
+AsyncValueRef<std::tuple<std::string>> ParallelTFRecordDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  auto record = [&]() -> llvm::Optional<llvm::Expected<std::string>> {
+    mutex_lock lock(state_->mu);
+    while (state_->records.empty() && state_->num_active_readers > 0)
+      state_->consumer_cv.wait(lock);
+    if (state_->records.empty()) return llvm::None;
+    auto result = std::move(state_->records.front());
+    state_->records.pop();
+    return std::move(result);
+  }();
+  if (!record.hasValue()) {
+    // All readers finished and the merge queue is drained.
+    return AsyncValueRef<std::tuple<std::string>>();
+  }
+  state_->reader_cv.notify_one();
+  if (!*record) {
+    return EmitErrorAsync(exec_ctx, record->takeError());
+  }
+  return exec_ctx.host()->MakeConcreteAsyncValueRef<std::tuple<std::string>>(
+      std::move(**record));
+}
+
+void ParallelTFRecordDatasetIterator::ReadShard(
+    std::shared_ptr<ReaderState> state, uint64_t begin, uint64_t end) {
+  // Pushes one record (or error) into the merge queue, blocking while the
+  // queue is full. Returns false if the iterator went away.
+  auto push = [&state](llvm::Expected<std::string> value) -> bool {
+    mutex_lock lock(state->mu);
+    while (state->records.size() >= kMaxBufferedRecords && !state->cancelled)
+      state->reader_cv.wait(lock);
+    if (state->cancelled) return false;
+    state->records.push(std::move(value));
+    state->consumer_cv.notify_one();
+    return true;
+  };
+
+  std::ifstream stream(state->path, std::ios_base::binary);
+  if (!stream) {
+    push(MakeStringError("failed to read file: ", state->path));
+  } else {
+    uint64_t offset = FindFirstRecord(stream, begin, end);
+    stream.clear();
+    stream.seekg(offset);
+    while (offset < end) {
+      char header[kHeaderSize];
+      stream.read(header, kHeaderSize);
+      if (stream.gcount() == 0 && stream.eof()) break;
+      if (stream.gcount() < static_cast<std::streamsize>(kHeaderSize) ||
+          stream.fail()) {
+        push(MakeStringError("failed to read TFRecord header at offset ",
+                             offset, " in file: ", state->path));
+        break;
+      }
+      if (!IsValidRecordHeader(header)) {
+        push(MakeStringError("corrupted TFRecord header at offset ", offset,
+                             " in file: ", state->path));
+        break;
+      }
+      const uint64_t length = DecodeFixed64(header);
+
+      std::string body(length, '\0');
+      char footer[kFooterSize];
+      stream.read(&body[0], length);
+      if (stream.gcount() == static_cast<std::streamsize>(length))
+        stream.read(footer, kFooterSize);
+      if (stream.fail()) {
+        push(MakeStringError("failed to read body of TFRecord at offset ",
+                             offset, " in file: ", state->path));
+        break;
+      }
+      if (!push(std::move(body))) break;
+      offset += kHeaderSize + length + kFooterSize;
+    }
+  }
+
+  mutex_lock lock(state->mu);
+  if (--state->num_active_readers == 0) state->consumer_cv.notify_all();
+}
+
 }  // namespace data
 }  // namespace tfrt
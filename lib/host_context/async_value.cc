@@ -76,12 +76,13 @@ void AsyncValue::Destroy() {
     // explicit check and instead make ~IndirectAsyncValue go through the
     // GetTypeInfo().destructor case below.
     static_cast<IndirectAsyncValue*>(this)->~IndirectAsyncValue();
-    GetHostContext()->DeallocateBytes(this, sizeof(IndirectAsyncValue));
+    GetHostContext()->DeallocateAsyncValueBytes(this,
+                                                sizeof(IndirectAsyncValue));
     return;
   }
 
   auto size = GetTypeInfo().destructor(this);
-  GetHostContext()->DeallocateBytes(this, size);
+  GetHostContext()->DeallocateAsyncValueBytes(this, size);
 }
 
 // This is called when the value is set into the ConcreteAsyncValue buffer, or
@@ -113,7 +114,8 @@ void AsyncValue::RunWaiters(NotifierListNode* list) {
     // check atomic state again.
     node->notification_();
     list = node->next_;
-    host->Destruct(node);
+    node->~NotifierListNode();
+    host->DeallocateAsyncValueBytes(node, sizeof(NotifierListNode));
   }
 }
 
@@ -122,8 +124,13 @@ void AsyncValue::RunWaiters(NotifierListNode* list) {
 // called when the value becomes available.
 void AsyncValue::EnqueueWaiter(llvm::unique_function<void()>&& waiter,
                                WaitersAndState old_value) {
-  // Create the node for our waiter.
-  auto* node = GetHostContext()->Construct<NotifierListNode>(std::move(waiter));
+  // Create the node for our waiter. Waiter nodes have the same allocation
+  // profile as small AsyncValues - small, hot, and short-lived - so they
+  // recycle through the same size-class free lists rather than hitting the
+  // general-purpose allocator on every AndThen.
+  void* node_storage = GetHostContext()->AllocateAsyncValueBytes(
+      sizeof(NotifierListNode), alignof(NotifierListNode));
+  auto* node = new (node_storage) NotifierListNode(std::move(waiter));
   auto old_state = old_value.getInt();
 
   // Swap the next link in. old_value.getInt() must be unavailable when
@@ -0,0 +1,113 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- budgeted_allocator.cc ----------------------------------------------===//
+//
+// This file implements an allocator decorator that tracks the bytes live
+// through it, remembers the high watermark, and enforces a hard byte budget.
+// In a multi-tenant process each HostContext wraps its allocator with one of
+// these: a tenant that exceeds its budget gets failed allocations - which the
+// runtime surfaces as error AsyncValues - instead of growing until the OS
+// kills the whole process. The watermark is exported through the metrics
+// registry so per-tenant footprints can be charted without a debugger.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/metrics/metrics_api.h"
+#include "tfrt/support/string_util.h"
+
+namespace tfrt {
+namespace {
+
+class BudgetedAllocator : public HostAllocator {
+ public:
+  BudgetedAllocator(std::unique_ptr<HostAllocator> allocator,
+                    size_t budget_bytes)
+      : allocator_(std::move(allocator)), budget_bytes_(budget_bytes) {}
+
+  ~BudgetedAllocator() override { ExportWatermark(); }
+
+  void* AllocateBytes(size_t size, size_t alignment) override {
+    // Optimistically charge the allocation, then back it out on rejection.
+    // This can transiently over-count by the sizes of in-flight rejected
+    // allocations, but never admits an allocation past the budget.
+    const int64_t now_live =
+        live_bytes_.fetch_add(size, std::memory_order_relaxed) +
+        static_cast<int64_t>(size);
+    if (static_cast<uint64_t>(now_live) > budget_bytes_) {
+      live_bytes_.fetch_sub(size, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    // Advance the watermark. Contending updates both try to install their own
+    // value; the loop keeps the maximum.
+    int64_t watermark = watermark_bytes_.load(std::memory_order_relaxed);
+    while (now_live > watermark &&
+           !watermark_bytes_.compare_exchange_weak(watermark, now_live,
+                                                   std::memory_order_relaxed))
+      ;
+
+    // Refresh the exported watermark periodically, so it can be read live
+    // from the metrics registry without waiting for destruction.
+    if (allocations_.fetch_add(1, std::memory_order_relaxed) %
+            kExportInterval ==
+        0)
+      ExportWatermark();
+
+    void* ptr = allocator_->AllocateBytes(size, alignment);
+    if (!ptr) live_bytes_.fetch_sub(size, std::memory_order_relaxed);
+    return ptr;
+  }
+
+  void DeallocateBytes(void* ptr, size_t size) override {
+    live_bytes_.fetch_sub(size, std::memory_order_relaxed);
+    allocator_->DeallocateBytes(ptr, size);
+  }
+
+  int64_t GetCumulativeAllocationCount() const override {
+    return allocator_->GetCumulativeAllocationCount();
+  }
+
+ private:
+  static constexpr int64_t kExportInterval = 1024;
+
+  void ExportWatermark() const {
+    static auto* watermark_metric =
+        metrics::NewGauge<int64_t>("/tfrt/host_allocator/watermark_bytes");
+    watermark_metric->SetValue(
+        watermark_bytes_.load(std::memory_order_relaxed));
+  }
+
+  std::unique_ptr<HostAllocator> allocator_;
+  const size_t budget_bytes_;
+  std::atomic<int64_t> live_bytes_{0};
+  std::atomic<int64_t> watermark_bytes_{0};
+  std::atomic<int64_t> allocations_{0};
+};
+
+}  // namespace
+
+std::unique_ptr<HostAllocator> CreateBudgetedAllocator(
+    std::unique_ptr<HostAllocator> allocator, size_t budget_bytes) {
+  return std::make_unique<BudgetedAllocator>(std::move(allocator),
+                                             budget_bytes);
+}
+
+}  // namespace tfrt
@@ -0,0 +1,244 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- calibrated_work_queue.cc ---------------------------------*- C++ -*-===//
+//
+// This file implements CreateCalibratedWorkQueue, which picks the
+// multi-threaded work queue's worker count by measurement instead of by
+// hand-tuned config strings. At startup it runs a short synthetic task mix
+// (compute, fan-out, blocking) across candidate worker counts and keeps the
+// count that maximizes throughput among the candidates whose handoff latency
+// stays within a bound of the best observed. The result can be persisted per
+// machine profile so calibration runs once per instance type.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "llvm/ADT/Optional.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/latch.h"
+#include "tfrt/support/logging.h"
+
+namespace tfrt {
+namespace {
+
+// One calibrated configuration for CreateMultiThreadedWorkQueue.
+struct WorkQueueCalibration {
+  int num_threads;
+  int num_blocking_threads;
+};
+
+// Number of compute tasks and fan-out leaves in one measurement round. Small
+// enough that calibration finishes in tens of milliseconds per candidate,
+// large enough to keep every candidate's workers busy.
+constexpr int kNumComputeTasks = 512;
+constexpr int kNumFanOutLeaves = 256;
+constexpr int kNumBlockingTasks = 8;
+constexpr int kNumRounds = 3;
+
+// A candidate is only eligible if its enqueue-to-run latency is within this
+// factor of the best latency measured across all candidates. This rejects
+// worker counts that win throughput by oversubscribing the machine.
+constexpr int64_t kLatencyBoundFactor = 2;
+
+// Returns the file used to persist calibration results, or empty when
+// persistence is disabled.
+std::string CalibrationFilePath() {
+  const char* path = getenv("TFRT_WORK_QUEUE_CALIBRATION_FILE");
+  return path ? path : "";
+}
+
+// The machine profile key. Calibration results only transfer between
+// machines with the same CPU count, so that is the key; heterogeneous fleets
+// sharing one file get one entry per instance type.
+int MachineProfile() {
+  return static_cast<int>(std::thread::hardware_concurrency());
+}
+
+// Looks up a persisted calibration for this machine profile. The file holds
+// one "profile num_threads num_blocking_threads" triple per line.
+llvm::Optional<WorkQueueCalibration> LoadCalibration(const std::string& path,
+                                                     int profile) {
+  std::ifstream file(path);
+  if (!file) return llvm::None;
+  int file_profile, num_threads, num_blocking_threads;
+  while (file >> file_profile >> num_threads >> num_blocking_threads) {
+    if (file_profile == profile && num_threads > 0 &&
+        num_blocking_threads > 0) {
+      return WorkQueueCalibration{num_threads, num_blocking_threads};
+    }
+  }
+  return llvm::None;
+}
+
+// Appends a calibration result for this machine profile. Best effort: a
+// read-only filesystem just means calibration reruns next startup.
+void SaveCalibration(const std::string& path, int profile,
+                     const WorkQueueCalibration& calibration) {
+  std::ofstream file(path, std::ios::app);
+  if (!file) {
+    TFRT_LOG(WARNING) << "Could not persist work queue calibration to "
+                      << path;
+    return;
+  }
+  file << profile << ' ' << calibration.num_threads << ' '
+       << calibration.num_blocking_threads << '\n';
+}
+
+// Spins long enough to look like a small kernel rather than an empty task, so
+// measured throughput reflects scheduling overhead at a realistic task size.
+void ComputeTask() {
+  volatile uint32_t x = 1;
+  for (int i = 0; i < 2048; ++i) x = x * 1664525 + 1013904223;
+}
+
+// Runs one round of the synthetic mix on `host` and returns the wall time.
+// The mix mirrors what the BEF executor produces: a batch of independent
+// compute tasks, a recursive fan-out that forces worker-to-worker stealing,
+// and a few blocking tasks to exercise the blocking pool handoff.
+std::chrono::nanoseconds RunTaskMix(HostContext* host) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < kNumComputeTasks; ++i) host->EnqueueWork(ComputeTask);
+
+  latch fan_out_done(kNumFanOutLeaves);
+  std::function<void(int)> fan_out = [&](int leaves) {
+    while (leaves > 1) {
+      int half = leaves / 2;
+      host->EnqueueWork([&fan_out, half] { fan_out(half); });
+      leaves -= half;
+    }
+    ComputeTask();
+    fan_out_done.count_down();
+  };
+  host->EnqueueWork([&fan_out] { fan_out(kNumFanOutLeaves); });
+
+  for (int i = 0; i < kNumBlockingTasks; ++i) {
+    host->EnqueueBlockingWork(
+        [] { std::this_thread::sleep_for(std::chrono::microseconds(100)); });
+  }
+
+  fan_out_done.wait();
+  host->Quiesce();
+  return std::chrono::steady_clock::now() - start;
+}
+
+// Measures the median enqueue-to-run handoff latency on an idle queue.
+int64_t MeasureLatencyNs(HostContext* host) {
+  constexpr int kNumProbes = 9;
+  std::vector<int64_t> samples;
+  samples.reserve(kNumProbes);
+  for (int i = 0; i < kNumProbes; ++i) {
+    latch done(1);
+    auto start = std::chrono::steady_clock::now();
+    host->EnqueueWork([&done] { done.count_down(); });
+    done.wait();
+    samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+// Measured behavior of one candidate worker count.
+struct CandidateResult {
+  int num_threads;
+  double tasks_per_second;
+  int64_t latency_ns;
+};
+
+// Runs the task mix and latency probe on a throwaway HostContext wrapping a
+// work queue with `num_threads` workers.
+CandidateResult MeasureCandidate(int num_threads, int num_blocking_threads) {
+  auto host = std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads, num_blocking_threads));
+
+  // One untimed round to warm up the worker threads.
+  RunTaskMix(host.get());
+
+  std::chrono::nanoseconds total{0};
+  for (int i = 0; i < kNumRounds; ++i) total += RunTaskMix(host.get());
+  const int64_t num_tasks =
+      kNumRounds * (kNumComputeTasks + kNumFanOutLeaves + kNumBlockingTasks);
+  double tasks_per_second = num_tasks * 1e9 / total.count();
+
+  return CandidateResult{num_threads, tasks_per_second,
+                         MeasureLatencyNs(host.get())};
+}
+
+// Measures all candidate worker counts and picks the throughput winner among
+// the candidates within the latency bound.
+WorkQueueCalibration Calibrate(int num_cpus) {
+  // Blocking threads follow the same fraction as the default mstd config;
+  // only the non-blocking worker count is swept.
+  const int num_blocking_threads = std::max(num_cpus / 8, 1);
+
+  std::vector<int> candidates;
+  for (int n = 1; n < num_cpus; n *= 2) candidates.push_back(n);
+  candidates.push_back(std::max(num_cpus - num_blocking_threads, 1));
+
+  std::vector<CandidateResult> results;
+  results.reserve(candidates.size());
+  int64_t best_latency_ns = INT64_MAX;
+  for (int num_threads : candidates) {
+    results.push_back(MeasureCandidate(num_threads, num_blocking_threads));
+    best_latency_ns = std::min(best_latency_ns, results.back().latency_ns);
+  }
+
+  const CandidateResult* best = &results.front();
+  for (const CandidateResult& result : results) {
+    if (result.latency_ns > kLatencyBoundFactor * best_latency_ns) continue;
+    if (result.tasks_per_second > best->tasks_per_second) best = &result;
+  }
+
+  TFRT_LOG(INFO) << "Work queue calibration picked " << best->num_threads
+                 << " threads (" << best->tasks_per_second << " tasks/s, "
+                 << best->latency_ns << "ns handoff latency)";
+  return WorkQueueCalibration{best->num_threads, num_blocking_threads};
+}
+
+}  // namespace
+
+std::unique_ptr<ConcurrentWorkQueue> CreateCalibratedWorkQueue() {
+  const int profile = MachineProfile();
+  const std::string path = CalibrationFilePath();
+
+  WorkQueueCalibration calibration;
+  llvm::Optional<WorkQueueCalibration> persisted =
+      path.empty() ? llvm::None : LoadCalibration(path, profile);
+  if (persisted.hasValue()) {
+    calibration = persisted.getValue();
+  } else {
+    calibration = Calibrate(profile);
+    if (!path.empty()) SaveCalibration(path, profile, calibration);
+  }
+
+  return CreateMultiThreadedWorkQueue(calibration.num_threads,
+                                      calibration.num_blocking_threads);
+}
+
+}  // namespace tfrt
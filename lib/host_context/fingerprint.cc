@@ -0,0 +1,98 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- fingerprint.cc -----------------------------------------------------===//
+//
+// This file implements buffer fingerprinting, including the parallel variant
+// that fans chunk hashes out over the work queue.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/fingerprint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/hash_util.h"
+
+namespace tfrt {
+namespace {
+
+// Seed for the per-chunk hashes. The buffer size is folded into the final
+// combination, so equal prefixes of different buffers do not collide.
+constexpr uint64_t kFingerprintSeed = 0xf19e4b01dull;
+
+size_t NumFingerprintChunks(size_t size) {
+  return size == 0 ? 1 : (size - 1) / kFingerprintChunkSize + 1;
+}
+
+uint64_t HashChunk(const char* data, size_t size, size_t chunk) {
+  const size_t begin = chunk * kFingerprintChunkSize;
+  const size_t length = std::min(size - begin, kFingerprintChunkSize);
+  return Hash64Bulk(data + begin, length, kFingerprintSeed);
+}
+
+uint64_t CombineChunks(size_t size, const uint64_t* partials,
+                       size_t num_chunks) {
+  uint64_t h = Hash64Combine(kFingerprintSeed, size);
+  for (size_t i = 0; i < num_chunks; ++i) h = Hash64Combine(h, partials[i]);
+  return h;
+}
+
+}  // namespace
+
+uint64_t FingerprintBuffer(const char* data, size_t size) {
+  const size_t num_chunks = NumFingerprintChunks(size);
+  uint64_t h = Hash64Combine(kFingerprintSeed, size);
+  for (size_t i = 0; i < num_chunks; ++i)
+    h = Hash64Combine(h, HashChunk(data, size, i));
+  return h;
+}
+
+AsyncValueRef<uint64_t> FingerprintBufferAsync(const char* data, size_t size,
+                                               HostContext* host) {
+  const size_t num_chunks = NumFingerprintChunks(size);
+
+  // A single chunk gains nothing from the work queue; hash inline.
+  if (num_chunks == 1)
+    return host->MakeConcreteAsyncValueRef<uint64_t>(
+        FingerprintBuffer(data, size));
+
+  // Each task fills its slot in `partials`; the last task to finish combines
+  // them in chunk order, so the result is independent of completion order.
+  struct FingerprintState {
+    explicit FingerprintState(size_t num_chunks)
+        : partials(num_chunks), remaining(num_chunks) {}
+    std::vector<uint64_t> partials;
+    std::atomic<size_t> remaining;
+  };
+  auto state = std::make_shared<FingerprintState>(num_chunks);
+  auto result = host->MakeUnconstructedAsyncValueRef<uint64_t>();
+
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    host->EnqueueWork([data, size, chunk, state, result = result.CopyRef()] {
+      state->partials[chunk] = HashChunk(data, size, chunk);
+      if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        result.emplace(CombineChunks(size, state->partials.data(),
+                                     state->partials.size()));
+      }
+    });
+  }
+  return result;
+}
+
+}  // namespace tfrt
@@ -30,6 +30,7 @@ namespace tfrt {
 RCReference<HostBuffer> HostBuffer::CreateUninitialized(
     size_t size, size_t alignment, HostAllocator *allocator) {
   assert(alignof(std::max_align_t) >= alignment && "Invalid alignment");
+  AllocationTagScope tag_scope("HostBuffer");
   auto *buf =
       allocator->AllocateBytes(sizeof(HostBuffer) + size, alignof(HostBuffer));
   if (!buf) return {};
@@ -52,6 +53,7 @@ HostBuffer::~HostBuffer() {
 
 void HostBuffer::Destroy() {
   if (is_inlined_) {
+    AllocationTagScope tag_scope("HostBuffer");
     this->~HostBuffer();
     inlined_.allocator->DeallocateBytes(this, sizeof(HostBuffer) + size_);
   } else {
@@ -0,0 +1,88 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- host_buffer_pool.cc - Pool of recycled buffer memory ---------------===//
+//
+// This file implements HostBufferPool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/host_buffer_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+
+namespace tfrt {
+
+int HostBufferPool::BucketIndex(size_t size) {
+  assert(size >= 1 && size <= kMaxPooledSize);
+  constexpr int kMinPooledSizeLog2 = 12;  // log2(kMinPooledSize).
+  return std::max<int>(llvm::Log2_64_Ceil(size), kMinPooledSizeLog2) -
+         kMinPooledSizeLog2;
+}
+
+HostBufferPool::~HostBufferPool() {
+  mutex_lock lock(mu_);
+  for (int index = 0; index < kNumBuckets; ++index) {
+    for (void* ptr : buckets_[index])
+      allocator_->DeallocateBytes(ptr, BucketSize(index));
+    buckets_[index].clear();
+  }
+}
+
+void* HostBufferPool::AllocateBytes(size_t size, size_t alignment) {
+  if (LLVM_UNLIKELY(size == 0 || size > kMaxPooledSize))
+    return allocator_->AllocateBytes(size, alignment);
+
+  const int index = BucketIndex(size);
+
+  // Pooled buffers are only guaranteed max_align_t alignment, so a request
+  // with a stricter alignment cannot be served from the pool; it still gets
+  // the full bucket size below so it is poolable when it comes back.
+  if (LLVM_LIKELY(alignment <= alignof(std::max_align_t))) {
+    mutex_lock lock(mu_);
+    if (!buckets_[index].empty()) return buckets_[index].pop_back_val();
+  }
+
+  // The pool is empty; allocate the full bucket size so the buffer can be
+  // reused for any request in this bucket when it comes back. DeallocateBytes
+  // relies on every pooled-range allocation being bucket sized.
+  return allocator_->AllocateBytes(BucketSize(index), alignment);
+}
+
+void HostBufferPool::DeallocateBytes(void* ptr, size_t size) {
+  if (LLVM_UNLIKELY(size == 0 || size > kMaxPooledSize)) {
+    allocator_->DeallocateBytes(ptr, size);
+    return;
+  }
+
+  const int index = BucketIndex(size);
+  {
+    mutex_lock lock(mu_);
+    if (buckets_[index].size() < kMaxBuffersPerBucket) {
+      buckets_[index].push_back(ptr);
+      return;
+    }
+  }
+
+  // The bucket is at its high watermark; release the buffer. It was allocated
+  // at the full bucket size by AllocateBytes above.
+  allocator_->DeallocateBytes(ptr, BucketSize(index));
+}
+
+}  // namespace tfrt
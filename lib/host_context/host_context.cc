@@ -20,11 +20,15 @@
 
 #include "tfrt/host_context/host_context.h"
 
+#include <algorithm>
+
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_buffer_pool.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/shared_context.h"
 #include "tfrt/support/mutex.h"
@@ -44,6 +48,7 @@ HostContext::HostContext(
     std::unique_ptr<ConcurrentWorkQueue> work_queue)
     : diag_handler_(std::move(diag_handler)),
       allocator_(std::move(allocator)),
+      host_buffer_pool_(std::make_unique<HostBufferPool>(allocator_.get())),
       work_queue_(std::move(work_queue)),
       shared_context_mgr_(std::make_unique<SharedContextManager>(this)),
       instance_ptr_{next_host_context_index.fetch_add(1)} {
@@ -57,14 +62,107 @@ HostContext::~HostContext() {
   // We need to free the ready chain AsyncValue first, as the destructor of the
   // AsyncValue calls the HostContext to free its memory.
   ready_chain_.reset();
+  // Return the AsyncValue slabs to the allocator. Free blocks all point into
+  // slabs, so they need no individual deallocation.
+  for (auto& shard : async_value_cache_shards_) {
+    while (shard.slabs) {
+      AsyncValueSlab* slab = shard.slabs;
+      shard.slabs = slab->next;
+      allocator_->DeallocateBytes(slab, kAsyncValueSlabSize);
+    }
+  }
   all_host_contexts_[instance_index()] = nullptr;
 }
 
+// Defined out of line because HostBufferPool is incomplete in the header.
+HostAllocator* HostContext::host_buffer_pool() {
+  return host_buffer_pool_.get();
+}
+
+// The block sizes of the AsyncValue size classes. Every class is a multiple
+// of the cache line size, so two distinct AsyncValues never share a line: a
+// waiter spinning on one value's state cannot be stalled by refcount drops
+// on a neighboring value. AsyncValue itself relies on this (see the layout
+// note next to its sizeof static_assert).
+static constexpr size_t kAsyncValueSizeClassBytes[] = {64, 128, 256};
+static_assert(kAsyncValueSizeClassBytes[0] % 64 == 0 &&
+                  kAsyncValueSizeClassBytes[1] % 64 == 0 &&
+                  kAsyncValueSizeClassBytes[2] % 64 == 0,
+              "AsyncValue size classes must be cache line multiples");
+
+// Returns the size class whose blocks can hold `size` bytes.
+static size_t AsyncValueSizeClass(size_t size) {
+  if (size <= 64) return 0;
+  if (size <= 128) return 1;
+  assert(size <= 256);
+  return 2;
+}
+
+// Returns a small dense id for the calling thread. Ids are assigned
+// round-robin, so the work queue's threads spread evenly over the cache
+// shards.
+static uint32_t HostThreadId() {
+  static std::atomic<uint32_t> next_thread_id{0};
+  static thread_local uint32_t thread_id = next_thread_id.fetch_add(1);
+  return thread_id;
+}
+
+void* HostContext::AllocateAsyncValueBytes(size_t size, size_t alignment) {
+  AllocationTagScope tag_scope("AsyncValue");
+
+  // AsyncValues larger than the largest size class go to the general-purpose
+  // allocator. Any type whose size fits in a class has alignment of at most
+  // the class's block size, which the block's own alignment satisfies.
+  if (size > kMaxSlabAsyncValueSize) return AllocateBytes(size, alignment);
+
+  const size_t size_class = AsyncValueSizeClass(size);
+  const size_t block_bytes = kAsyncValueSizeClassBytes[size_class];
+  AsyncValueCacheShard& shard =
+      async_value_cache_shards_[HostThreadId() % kNumAsyncValueShards];
+
+  mutex_lock lock(shard.mu);
+  if (AsyncValueFreeBlock* block = shard.free_lists[size_class]) {
+    shard.free_lists[size_class] = block->next;
+    return block;
+  }
+
+  if (shard.slab_next[size_class] + block_bytes > shard.slab_end[size_class]) {
+    // Carve a fresh slab for this size class. Slabs are allocated with the
+    // largest block alignment, and block_bytes divides the slab offsets, so
+    // every block ends up aligned to its class size.
+    char* slab = static_cast<char*>(
+        allocator_->AllocateBytes(kAsyncValueSlabSize, kMaxSlabAsyncValueSize));
+    auto* header = new (slab) AsyncValueSlab{shard.slabs};
+    shard.slabs = header;
+    shard.slab_next[size_class] = slab + block_bytes;
+    shard.slab_end[size_class] = slab + kAsyncValueSlabSize;
+  }
+
+  char* block = shard.slab_next[size_class];
+  shard.slab_next[size_class] = block + block_bytes;
+  return block;
+}
+
+void HostContext::DeallocateAsyncValueBytes(void* ptr, size_t size) {
+  AllocationTagScope tag_scope("AsyncValue");
+
+  if (size > kMaxSlabAsyncValueSize) return DeallocateBytes(ptr, size);
+
+  const size_t size_class = AsyncValueSizeClass(size);
+  auto* block = static_cast<AsyncValueFreeBlock*>(ptr);
+  AsyncValueCacheShard& shard =
+      async_value_cache_shards_[HostThreadId() % kNumAsyncValueShards];
+
+  mutex_lock lock(shard.mu);
+  block->next = shard.free_lists[size_class];
+  shard.free_lists[size_class] = block;
+}
+
 void Function::VtableAnchor() {}
 
 // Construct an empty IndirectAsyncValue, not forwarding to anything.
 RCReference<IndirectAsyncValue> HostContext::MakeIndirectAsyncValue() {
-  return TakeRef(Construct<IndirectAsyncValue>(instance_ptr_));
+  return TakeRef(ConstructAsyncValue<IndirectAsyncValue>(instance_ptr_));
 }
 
 //===----------------------------------------------------------------------===//
@@ -84,8 +182,8 @@ void HostContext::EmitError(const DecodedDiagnostic& diagnostic) {
 RCReference<ErrorAsyncValue> HostContext::MakeErrorAsyncValueRef(
     DecodedDiagnostic&& diagnostic) {
   // Create an AsyncValue for this error condition.
-  auto* error_value =
-      Construct<ErrorAsyncValue>(instance_ptr_, std::move(diagnostic));
+  auto* error_value = ConstructAsyncValue<ErrorAsyncValue>(
+      instance_ptr_, std::move(diagnostic));
 
   return TakeRef(error_value);
 }
@@ -151,6 +249,25 @@ void HostContext::EnqueueWork(llvm::unique_function<void()> work) {
   work_queue_->AddTask(TaskFunction(std::move(work)));
 }
 
+// Add some work to the workqueue managed by this CPU device, with a worker
+// affinity hint.
+void HostContext::EnqueueWorkWithAffinity(llvm::unique_function<void()> work,
+                                          uint32_t affinity_tag) {
+  work_queue_->AddTaskWithAffinity(TaskFunction(std::move(work)),
+                                   affinity_tag);
+}
+
+// Add some latency-critical work to the workqueue managed by this CPU device.
+void HostContext::EnqueueCriticalWork(llvm::unique_function<void()> work) {
+  work_queue_->AddCriticalTask(TaskFunction(std::move(work)));
+}
+
+// Pin the worker spin-then-park policy of the underlying work queue.
+void HostContext::PinWorkerSpinPolicy(int max_spinning_threads,
+                                      int spin_count) {
+  work_queue_->PinWorkerSpinPolicy(max_spinning_threads, spin_count);
+}
+
 // Add some work to the workqueue managed by this CPU device.
 bool HostContext::EnqueueBlockingWork(llvm::unique_function<void()> work) {
   Optional<TaskFunction> task = work_queue_->AddBlockingTask(
@@ -162,6 +279,10 @@ int HostContext::GetNumWorkerThreads() const {
   return work_queue_->GetParallelismLevel();
 }
 
+int HostContext::GetNumIdleWorkerThreads() const {
+  return work_queue_->GetIdleParallelismLevel();
+}
+
 // Run the specified function when the specified set of AsyncValue's are all
 // resolved.  This is a set-version of "AndThen".
 void HostContext::RunWhenReady(ArrayRef<AsyncValue*> values,
@@ -188,23 +309,38 @@ void HostContext::RunWhenReady(ArrayRef<AsyncValue*> values,
     llvm::unique_function<void()> callee;
   };
 
-  // Otherwise, we have multiple unavailable values.  Put a counter on the heap
-  // and have each unavailable value decrement and test it.
-  auto* data =
-      new CounterAndCallee{{unavailable_values.size()}, std::move(callee)};
+  // Otherwise, we have multiple unavailable values. All of them share a single
+  // counter object, so the whole batch costs one allocation plus one atomic
+  // decrement per value. The counter recycles through the AsyncValue slab
+  // cache, like the waiter nodes that reference it.
+  void* storage = AllocateAsyncValueBytes(sizeof(CounterAndCallee),
+                                          alignof(CounterAndCallee));
+  auto* data = new (storage)
+      CounterAndCallee{{unavailable_values.size()}, std::move(callee)};
 
   for (auto* val : unavailable_values) {
-    val->AndThen([data]() {
-      // Decrement the counter unless we're the last to be here.
-      if (data->counter.fetch_sub(1) != 1) return;
+    val->AndThen([this, data]() {
+      // Decrement the counter unless we're the last to be here. The release
+      // pairs with the acquire of the last decrement, so the callee sees all
+      // effects that precede each value becoming available.
+      if (data->counter.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
 
       // If we are the last one, then run the callee and free the data.
       data->callee();
-      delete data;
+      data->~CounterAndCallee();
+      this->DeallocateAsyncValueBytes(data, sizeof(CounterAndCallee));
     });
   }
 }
 
+void HostContext::RunWhenReady(ArrayRef<RCReference<AsyncValue>> values,
+                               llvm::unique_function<void()>&& callee) {
+  SmallVector<AsyncValue*, 8> pointers;
+  pointers.reserve(values.size());
+  for (auto& ref : values) pointers.push_back(ref.get());
+  RunWhenReady(pointers, std::move(callee));
+}
+
 namespace {
 
 // If ParallelFor will choose to execute `compute` function asynchronously, it
@@ -302,6 +438,48 @@ void HostContext::ParallelFor(
   ctx->EvalBlocks(0, ctx->PendingBlocks());
 }
 
+size_t HostContext::ChooseParallelForBlockSize(
+    size_t n, const ParallelForCost& cost) const {
+  // A work queue operation (enqueue plus steal) costs on the order of a few
+  // thousand cycles; size blocks so that this overhead stays in the low
+  // single digit percent range of the block's own cost.
+  static constexpr size_t kTaskOverheadCycles = 20000;
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr size_t kMaxOversharding = 4;
+
+  if (n == 0) return 1;
+
+  // Memory bound loops cost at least a couple of cycles per byte moved, so a
+  // large bytes_per_element raises the effective per-element cost even when
+  // the arithmetic estimate is tiny.
+  size_t cycles = std::max<size_t>(1, cost.cycles_per_element);
+  cycles = std::max(cycles, cost.bytes_per_element / 2);
+
+  size_t block_size = (kTaskOverheadCycles + cycles - 1) / cycles;
+
+  // Do not create more blocks than the workers can usefully steal.
+  block_size =
+      std::max(block_size, n / (kMaxOversharding * GetNumWorkerThreads()));
+
+  // Align block boundaries to cache lines of the data so two workers never
+  // write to the two halves of one line.
+  if (cost.bytes_per_element > 0 && cost.bytes_per_element < kCacheLineSize) {
+    const size_t elements_per_line =
+        (kCacheLineSize + cost.bytes_per_element - 1) / cost.bytes_per_element;
+    block_size = llvm::alignTo(block_size, elements_per_line);
+  }
+
+  return std::min(block_size, n);
+}
+
+void HostContext::ParallelFor(
+    size_t n, const ParallelForCost& cost,
+    llvm::unique_function<void(size_t, size_t)> compute,
+    llvm::unique_function<void()> on_done) {
+  ParallelFor(n, std::move(compute), std::move(on_done),
+              ChooseParallelForBlockSize(n, cost));
+}
+
 //===----------------------------------------------------------------------===//
 // SharedContext management
 //===----------------------------------------------------------------------===//
@@ -313,24 +491,33 @@ class HostContext::SharedContextManager {
   // Create one if the requested shared context instance does not exist yet.
   SharedContext& GetOrCreateSharedContext(int shared_context_id,
                                           SharedContextFactory factory) {
-    assert(shared_context_id < shared_context_instances_.size() &&
+    assert(shared_context_id < kNumSharedContextSlots &&
            "The requested SharedContext ID exceeds the maximum allowed");
 
-    auto& item = shared_context_instances_[shared_context_id];
-
-    std::call_once(item.second, [&] {
-      assert(!item.first);
-      item.first = factory(host_);
-    });
-
-    return *item.first;
+    auto& slot = host_->shared_context_slots_[shared_context_id];
+
+    mutex_lock lock(mu_);
+    // Re-check under the lock: another thread may have created the instance
+    // after our caller's lock-free check failed.
+    if (SharedContext* context = slot.load(std::memory_order_relaxed))
+      return *context;
+
+    auto& instance = shared_context_instances_[shared_context_id];
+    assert(!instance);
+    instance = factory(host_);
+    // Publish the instance with a release store, pairing with the acquire
+    // load on the lock-free fast path in HostContext::GetOrCreateSharedContext.
+    slot.store(instance.get(), std::memory_order_release);
+    return *instance;
   }
 
  private:
   HostContext* const host_;
-  // We allow up to 256 ShareContext instances.
-  std::array<std::pair<std::unique_ptr<SharedContext>, std::once_flag>, 256>
-      shared_context_instances_{};
+  mutex mu_;
+  // Owns the shared context instances. The pointers consumed by readers are
+  // published in HostContext::shared_context_slots_.
+  std::array<std::unique_ptr<SharedContext>, kNumSharedContextSlots>
+      shared_context_instances_ TFRT_GUARDED_BY(mu_){};
 };
 
 SharedContext& HostContext::GetOrCreateSharedContext(
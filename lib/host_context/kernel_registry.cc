@@ -24,40 +24,116 @@
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
-#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/MathExtras.h"
 #include "tfrt/host_context/type_name.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/hash_util.h"
+#include "tfrt/support/string_interner.h"
 
 namespace tfrt {
 
 using llvm::StringMap;
-using llvm::StringSet;
 
 struct KernelRegistry::Impl {
-  StringMap<KernelImplementation> implementations;
-  StringSet<> type_names;
+  struct KernelRecord {
+    KernelImplementation implementation;
+    KernelCostClass cost_class;
+    // Features required by the currently bound implementation; kBaseline for
+    // the portable kernel. Lets a later, more specialized variant win
+    // independent of registration order.
+    CpuFeatures variant_features = CpuFeatures::kBaseline;
+    // Id of the kernel name in StringInterner::Global().
+    StringInterner::Id name_id = StringInterner::kInvalidId;
+  };
+  // Maps kernel names to indices into `records`, which holds the kernels in
+  // registration order - the index is the kernel's ordinal.
+  StringMap<size_t> ordinals;
+  std::vector<KernelRecord> records;
+  // Running hash over the registered names, in order; see GetFingerprint().
+  uint64_t fingerprint = 0;
 };
 
 KernelRegistry::KernelRegistry() : impl_(std::make_unique<Impl>()) {}
 
 KernelRegistry::~KernelRegistry() {}
 
-void KernelRegistry::AddKernel(string_view kernel_name,
-                               KernelImplementation fn) {
-  bool added = impl_->implementations.try_emplace(kernel_name, fn).second;
+void KernelRegistry::AddKernel(string_view kernel_name, KernelImplementation fn,
+                               KernelCostClass cost_class) {
+  bool added =
+      impl_->ordinals.try_emplace(kernel_name, impl_->records.size()).second;
   (void)added;
   assert(added && "Re-registered existing kernel_name");
+  Impl::KernelRecord record{fn, cost_class};
+  record.name_id = StringInterner::Global().Intern(kernel_name);
+  impl_->records.push_back(record);
+  impl_->fingerprint =
+      Hash64Combine(impl_->fingerprint, Hash64(kernel_name));
+}
+
+uint32_t KernelRegistry::GetKernelNameIdByOrdinal(size_t ordinal) const {
+  assert(ordinal < impl_->records.size());
+  return impl_->records[ordinal].name_id;
+}
+
+void KernelRegistry::AddKernelVariant(string_view kernel_name,
+                                      KernelImplementation fn,
+                                      CpuFeatures required_features) {
+  auto it = impl_->ordinals.find(kernel_name);
+  assert(it != impl_->ordinals.end() &&
+         "Kernel variant registered before its baseline kernel");
+  if (it == impl_->ordinals.end()) return;
+  if (!HostSupportsCpuFeatures(required_features)) return;
+
+  auto& record = impl_->records[it->second];
+  // The variant requiring the most features is the most specialized one; the
+  // baseline implementation requires none.
+  if (llvm::countPopulation(static_cast<uint32_t>(required_features)) <=
+      llvm::countPopulation(static_cast<uint32_t>(record.variant_features)))
+    return;
+  record.implementation = fn;
+  record.variant_features = required_features;
 }
 
 KernelImplementation KernelRegistry::GetKernel(string_view kernel_name) const {
-  auto it = impl_->implementations.find(kernel_name);
-  return it == impl_->implementations.end() ? KernelImplementation()
-                                            : it->second;
+  auto it = impl_->ordinals.find(kernel_name);
+  return it == impl_->ordinals.end()
+             ? KernelImplementation()
+             : impl_->records[it->second].implementation;
+}
+
+KernelCostClass KernelRegistry::GetKernelCostClass(
+    string_view kernel_name) const {
+  auto it = impl_->ordinals.find(kernel_name);
+  return it == impl_->ordinals.end() ? KernelCostClass::kNormal
+                                     : impl_->records[it->second].cost_class;
+}
+
+size_t KernelRegistry::GetKernelOrdinal(string_view kernel_name) const {
+  auto it = impl_->ordinals.find(kernel_name);
+  return it == impl_->ordinals.end() ? kInvalidKernelOrdinal : it->second;
+}
+
+KernelImplementation KernelRegistry::GetKernelByOrdinal(size_t ordinal) const {
+  assert(ordinal < impl_->records.size());
+  return impl_->records[ordinal].implementation;
 }
 
+KernelCostClass KernelRegistry::GetKernelCostClassByOrdinal(
+    size_t ordinal) const {
+  assert(ordinal < impl_->records.size());
+  return impl_->records[ordinal].cost_class;
+}
+
+size_t KernelRegistry::GetNumKernels() const { return impl_->records.size(); }
+
+uint64_t KernelRegistry::GetFingerprint() const { return impl_->fingerprint; }
+
+// Type names are uniqued in the global interning table rather than a
+// per-registry set, so the same type name resolves to the same bytes in every
+// registry and TypeName's pointer-equality fast path holds process-wide.
 TypeName KernelRegistry::GetType(string_view type_name) const {
-  auto it = impl_->type_names.insert(type_name).first;
-  return TypeName(it->getKeyData());
+  auto& interner = StringInterner::Global();
+  return TypeName(interner.GetCString(interner.Intern(type_name)));
 }
 
 static std::vector<KernelRegistration>* GetStaticKernelRegistrations() {
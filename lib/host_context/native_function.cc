@@ -24,9 +24,11 @@
 
 namespace tfrt {
 
-void NativeFunction::Execute(ArrayRef<AsyncValue*> arguments,
-                             MutableArrayRef<RCReference<AsyncValue>> results,
-                             HostContext* host) const {
+void NativeFunction::Execute(const ExecutionContext& exec_ctx,
+                             ArrayRef<AsyncValue*> arguments,
+                             MutableArrayRef<RCReference<AsyncValue>> results)
+    const {
+  HostContext* host = exec_ctx.host();
   SmallVector<AsyncValue*, 4> unavailable_args;
   for (auto* av : arguments)
     if (!av->IsAvailable()) unavailable_args.push_back(av);
@@ -15,15 +15,24 @@
 //===- profiled_allocator.cc - Profiled Memory Allocator ------------------===//
 //
 // This file implements a profiling host memory allocator that does a memory
-// leak check and prints allocation statistics when destroyed.
+// leak check and prints allocation statistics when destroyed. It also records
+// an allocation size histogram and per-subsystem attribution (see
+// AllocationTagScope), published live through the metrics registry so RSS
+// growth can be traced to a subsystem without an external heap profiler.
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/metrics/metrics_api.h"
+#include "tfrt/support/string_util.h"
 
 namespace tfrt {
 
@@ -38,6 +47,16 @@ void AtomicUpdateMax(T const& value, std::atomic<T>* max_value) noexcept {
   }
 }
 
+// Allocation sizes are histogrammed into power-of-two buckets: bucket i
+// counts sizes up to 8 << i, and the last bucket counts everything larger
+// than 128KB.
+constexpr int kNumSizeBuckets = 16;
+
+int SizeBucket(size_t size) {
+  if (size <= 8) return 0;
+  return std::min<int>(llvm::Log2_64_Ceil(size) - 3, kNumSizeBuckets - 1);
+}
+
 }  // namespace
 
 class ProfiledAllocator : public HostAllocator {
@@ -53,12 +72,23 @@ class ProfiledAllocator : public HostAllocator {
 
   void* AllocateBytes(size_t size, size_t alignment) override {
     ++curr_num_allocations_;
-    ++cum_num_allocations_;
+    int64_t cum_num_allocations = ++cum_num_allocations_;
     curr_num_bytes_allocated_.fetch_add(size);
+    cum_num_bytes_allocated_.fetch_add(size, std::memory_order_relaxed);
     AtomicUpdateMax<int64_t>(curr_num_allocations_, &max_num_allocations_);
     AtomicUpdateMax<int64_t>(curr_num_bytes_allocated_,
                              &max_num_bytes_allocated_);
 
+    size_histogram_[SizeBucket(size)].fetch_add(1, std::memory_order_relaxed);
+    TagStats& tag_stats = GetTagStats(CurrentAllocationTag());
+    tag_stats.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    tag_stats.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    // Refresh the exported profile periodically, so it can be read live
+    // from the metrics registry without waiting for destruction.
+    if (LLVM_UNLIKELY(cum_num_allocations % kExportInterval == 0))
+      ExportProfile();
+
     return allocator_->AllocateBytes(size, alignment);
   }
 
@@ -66,9 +96,23 @@ class ProfiledAllocator : public HostAllocator {
     --curr_num_allocations_;
     curr_num_bytes_allocated_.fetch_sub(size);
 
+    // Deallocations are attributed to the tag live at the free site. Entry
+    // points that tag their allocations tag the matching free path too, so
+    // allocated minus freed bytes per tag tracks that subsystem's footprint.
+    GetTagStats(CurrentAllocationTag())
+        .freed_bytes.fetch_add(size, std::memory_order_relaxed);
+
     allocator_->DeallocateBytes(ptr, size);
   }
 
+  int64_t GetCumulativeAllocationCount() const override {
+    return cum_num_allocations_.load(std::memory_order_relaxed);
+  }
+
+  int64_t GetCumulativeAllocatedBytes() const override {
+    return cum_num_bytes_allocated_.load(std::memory_order_relaxed);
+  }
+
  protected:
   void PrintStats() const {
     printf("HostAllocator profile:\n");
@@ -80,7 +124,27 @@ class ProfiledAllocator : public HostAllocator {
            curr_num_bytes_allocated_.load());
     printf("Max number of bytes allocated = %ld\n",
            max_num_bytes_allocated_.load());
+    for (int i = 0; i < kNumSizeBuckets; ++i) {
+      int64_t count = size_histogram_[i].load(std::memory_order_relaxed);
+      if (count == 0) continue;
+      if (i < kNumSizeBuckets - 1) {
+        printf("Allocations of size <= %ld bytes = %ld\n", 8L << i, count);
+      } else {
+        printf("Allocations of size > %ld bytes = %ld\n", 8L << (i - 1),
+               count);
+      }
+    }
+    for (const TagStats& tag_stats : tag_stats_) {
+      const char* tag = tag_stats.tag.load(std::memory_order_acquire);
+      if (tag == nullptr) break;
+      printf("Tag %s: allocations = %ld, allocated bytes = %ld, "
+             "freed bytes = %ld\n",
+             tag, tag_stats.allocations.load(std::memory_order_relaxed),
+             tag_stats.allocated_bytes.load(std::memory_order_relaxed),
+             tag_stats.freed_bytes.load(std::memory_order_relaxed));
+    }
     fflush(stdout);
+    ExportProfile();
   }
 
   bool print_profile_ = true;
@@ -89,8 +153,76 @@ class ProfiledAllocator : public HostAllocator {
   std::atomic<int64_t> cum_num_allocations_{0};
   std::atomic<int64_t> curr_num_bytes_allocated_{0};
   std::atomic<int64_t> max_num_bytes_allocated_{0};
+  std::atomic<int64_t> cum_num_bytes_allocated_{0};
 
  private:
+  // The exported profile is refreshed once per this many allocations.
+  static constexpr int64_t kExportInterval = 1 << 16;
+
+  // Statistics for one allocation tag (see AllocationTagScope).
+  struct TagStats {
+    std::atomic<const char*> tag{nullptr};
+    std::atomic<int64_t> allocations{0};
+    std::atomic<int64_t> allocated_bytes{0};
+    std::atomic<int64_t> freed_bytes{0};
+  };
+
+  // Tags beyond the table capacity fold into the last slot.
+  static constexpr int kMaxTags = 16;
+
+  // Returns the stats slot for `tag`, claiming an empty slot on first use.
+  // Tags are string literals, so slots are keyed on pointer identity and the
+  // scan is a few pointer compares.
+  TagStats& GetTagStats(const char* tag) {
+    for (int i = 0; i < kMaxTags - 1; ++i) {
+      const char* slot_tag = tag_stats_[i].tag.load(std::memory_order_acquire);
+      if (slot_tag == tag) return tag_stats_[i];
+      if (slot_tag == nullptr) {
+        if (tag_stats_[i].tag.compare_exchange_strong(
+                slot_tag, tag, std::memory_order_acq_rel))
+          return tag_stats_[i];
+        // Another thread claimed the slot; re-examine it for a match.
+        if (slot_tag == tag) return tag_stats_[i];
+      }
+    }
+    tag_stats_[kMaxTags - 1].tag.store("other", std::memory_order_release);
+    return tag_stats_[kMaxTags - 1];
+  }
+
+  // Renders the counters into one metric value, in the flat key=value form
+  // used by the other exported runtime stats.
+  std::string ProfileString() const {
+    std::string profile = StrCat(
+        "curr_allocations=", curr_num_allocations_.load(),
+        " max_allocations=", max_num_allocations_.load(),
+        " cum_allocations=", cum_num_allocations_.load(),
+        " curr_bytes=", curr_num_bytes_allocated_.load(),
+        " max_bytes=", max_num_bytes_allocated_.load());
+    for (int i = 0; i < kNumSizeBuckets; ++i) {
+      int64_t count = size_histogram_[i].load(std::memory_order_relaxed);
+      if (count == 0) continue;
+      profile += StrCat(" le_", 8L << i, "=", count);
+    }
+    for (const TagStats& tag_stats : tag_stats_) {
+      const char* tag = tag_stats.tag.load(std::memory_order_acquire);
+      if (tag == nullptr) break;
+      profile += StrCat(
+          " ", tag, "=",
+          tag_stats.allocations.load(std::memory_order_relaxed), "/",
+          tag_stats.allocated_bytes.load(std::memory_order_relaxed), "/",
+          tag_stats.freed_bytes.load(std::memory_order_relaxed));
+    }
+    return profile;
+  }
+
+  void ExportProfile() const {
+    static auto* profile_metric =
+        metrics::NewGauge<std::string>("/tfrt/host_allocator/profile");
+    profile_metric->SetValue(ProfileString());
+  }
+
+  std::atomic<int64_t> size_histogram_[kNumSizeBuckets] = {};
+  TagStats tag_stats_[kMaxTags];
   std::unique_ptr<HostAllocator> allocator_;
 };
 
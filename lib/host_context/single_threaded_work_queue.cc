@@ -47,7 +47,13 @@ class SingleThreadedWorkQueue : public ConcurrentWorkQueue {
  private:
   void DoWork(std::function<bool()> stop_predicate);
 
+  // Bound on how deep AddTask may recurse when running tasks inline. Past
+  // this depth tasks are buffered in work_items_ instead, which unwinds the
+  // stack and preserves the old behavior for pathological task chains.
+  static constexpr int kMaxInlineDepth = 64;
+
   std::vector<TaskFunction> work_items_;
+  int inline_depth_ = 0;
 };
 }  // namespace
 
@@ -56,6 +62,18 @@ class SingleThreadedWorkQueue : public ConcurrentWorkQueue {
 // non-threaded environment so synchronization is not needed.
 // TODO(b/137227366): Revisit this design.
 void SingleThreadedWorkQueue::AddTask(TaskFunction work) {
+  // Run-to-completion fast path: there is only one thread, so a task
+  // submitted while nothing is buffered can run right now without touching
+  // the vector at all. Tasks it spawns recurse through here up to
+  // kMaxInlineDepth frames deep. Buffered items must drain first to keep
+  // tasks running in submission order, so once anything is queued (including
+  // past the depth limit) we fall back to buffering.
+  if (inline_depth_ < kMaxInlineDepth && work_items_.empty()) {
+    ++inline_depth_;
+    work();
+    --inline_depth_;
+    return;
+  }
   work_items_.push_back(std::move(work));
 }
 
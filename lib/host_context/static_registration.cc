@@ -52,6 +52,19 @@ struct MakeMultiThreadedWorkQueue {
   }
 };
 
+// Factory function for a calibrated multi-threaded thread pool. The argument
+// must be empty; the worker count is measured at startup (or loaded from the
+// persisted calibration file) rather than parsed from the config string.
+std::unique_ptr<ConcurrentWorkQueue> CalibratedWorkQueueFactory(
+    string_view arg) {
+  if (!arg.empty()) {
+    TFRT_LOG(ERROR) << "Invalid argument for auto work queue: "
+                    << std::string(arg);
+    return nullptr;
+  }
+  return CreateCalibratedWorkQueue();
+}
+
 // Factory function for a multi-threaded thread pool.  Parses the given argument
 // to determine the construction parameters.  The argument must be either "X" or
 // "X,Y", where X and Y are integers. X will determine the number of threads to
@@ -107,6 +120,7 @@ std::unique_ptr<ConcurrentWorkQueue> MultiThreadedWorkQueueFactory(
 }  // namespace
 
 TFRT_WORK_QUEUE_FACTORY("s", SingleThreadedWorkQueueFactory);
+TFRT_WORK_QUEUE_FACTORY("auto", CalibratedWorkQueueFactory);
 TFRT_WORK_QUEUE_FACTORY(
     "mstd", MultiThreadedWorkQueueFactory<MakeMultiThreadedWorkQueue>);
 
@@ -0,0 +1,246 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- thread_caching_allocator.cc - Thread Caching Memory Allocator ------===//
+//
+// This file implements a host memory allocator that serves small allocations
+// from per-thread caches over central size-class free lists, so hot
+// allocation paths (AsyncValues, closures, small tensors) do not contend on
+// the global malloc locks.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/alloc.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace {
+
+// Small allocations are rounded up to a power-of-two size class between
+// kMinBlockSize and kMaxBlockSize; anything larger forwards to the underlying
+// allocator.
+constexpr size_t kMinBlockSize = 8;
+constexpr size_t kMaxBlockSize = 4096;
+constexpr int kNumSizeClasses = 10;  // 8, 16, ..., 4096.
+
+// Number of blocks moved between a thread cache and a central free list at a
+// time. Batched transfers amortize the central lock over many allocations.
+constexpr int kTransferBatchSize = 32;
+
+// A thread cache returns a batch to the central list once it holds more than
+// this many blocks of one class, so one thread freeing what another thread
+// allocates does not accumulate memory forever.
+constexpr int kMaxBlocksPerClass = 2 * kTransferBatchSize;
+
+// Size of the slabs carved into blocks when a central free list runs empty.
+// Slabs are aligned to kMaxBlockSize, so a block at an offset that is a
+// multiple of its size class is aligned to its size class.
+constexpr size_t kSlabSize = 64 * 1024;
+
+// Returns the index of the smallest size class that fits `size` bytes.
+int SizeClassIndex(size_t size) {
+  assert(size >= 1 && size <= kMaxBlockSize);
+  return std::max<int>(llvm::Log2_64_Ceil(size), 3) - 3;
+}
+
+// Returns the block size of the size class at `index`.
+size_t ClassBlockSize(int index) { return kMinBlockSize << index; }
+
+// Free blocks are chained through their first word; every size class is large
+// enough to hold the link.
+struct FreeBlock {
+  FreeBlock* next;
+};
+static_assert(sizeof(FreeBlock) <= kMinBlockSize,
+              "free list link must fit in the smallest size class");
+
+// Central free lists, shared by every thread cache and every
+// ThreadCachingAllocator instance in the process. Slab memory is obtained
+// with AlignedAlloc rather than through the decorated allocator because it is
+// retained for the process lifetime and recycled through these lists, like in
+// a traditional thread-caching malloc; it is never returned to the system.
+//
+// Heap-allocated and intentionally leaked: tfrt::mutex must not have static
+// storage duration, and thread caches flush here from thread exit.
+struct CentralFreeList {
+  mutex mu;
+  FreeBlock* free_list TFRT_GUARDED_BY(mu) = nullptr;
+};
+
+CentralFreeList* GetCentralFreeLists() {
+  static CentralFreeList* lists = new CentralFreeList[kNumSizeClasses];
+  return lists;
+}
+
+// Pops up to kTransferBatchSize blocks of the given class off the central
+// list, carving a fresh slab first if the list is empty. Returns the head of
+// the popped chain (linked through FreeBlock::next) and stores its length in
+// `*count`, zero if slab allocation failed.
+FreeBlock* PopCentralBatch(int size_class, int* count) {
+  CentralFreeList& central = GetCentralFreeLists()[size_class];
+  mutex_lock lock(central.mu);
+
+  if (central.free_list == nullptr) {
+    void* slab = AlignedAlloc(kMaxBlockSize, kSlabSize);
+    if (slab == nullptr) {
+      *count = 0;
+      return nullptr;
+    }
+    const size_t block_size = ClassBlockSize(size_class);
+    char* base = static_cast<char*>(slab);
+    for (size_t offset = 0; offset + block_size <= kSlabSize;
+         offset += block_size) {
+      auto* block = reinterpret_cast<FreeBlock*>(base + offset);
+      block->next = central.free_list;
+      central.free_list = block;
+    }
+  }
+
+  FreeBlock* head = central.free_list;
+  FreeBlock* tail = head;
+  int popped = 1;
+  while (popped < kTransferBatchSize && tail->next != nullptr) {
+    tail = tail->next;
+    ++popped;
+  }
+  central.free_list = tail->next;
+  tail->next = nullptr;
+  *count = popped;
+  return head;
+}
+
+// Pushes a chain of `count` blocks (linked through FreeBlock::next, ending in
+// nullptr at `tail`) onto the central list.
+void PushCentralBatch(int size_class, FreeBlock* head, FreeBlock* tail) {
+  CentralFreeList& central = GetCentralFreeLists()[size_class];
+  mutex_lock lock(central.mu);
+  tail->next = central.free_list;
+  central.free_list = head;
+}
+
+// Per-thread block caches. Allocation and deallocation touch only the calling
+// thread's cache in the common case; the central lists are involved once per
+// kTransferBatchSize operations.
+struct ThreadCache {
+  struct ClassCache {
+    FreeBlock* head = nullptr;
+    int count = 0;
+  };
+
+  std::array<ClassCache, kNumSizeClasses> classes;
+
+  // Return everything to the central lists when the thread exits, so memory
+  // allocated by short-lived threads is not stranded.
+  ~ThreadCache() {
+    for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      ClassCache& cache = classes[size_class];
+      if (cache.head == nullptr) continue;
+      FreeBlock* tail = cache.head;
+      while (tail->next != nullptr) tail = tail->next;
+      PushCentralBatch(size_class, cache.head, tail);
+      cache.head = nullptr;
+      cache.count = 0;
+    }
+  }
+};
+
+ThreadCache* GetThreadCache() {
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+class ThreadCachingAllocator : public HostAllocator {
+ public:
+  explicit ThreadCachingAllocator(std::unique_ptr<HostAllocator> allocator)
+      : allocator_(std::move(allocator)) {}
+
+  void* AllocateBytes(size_t size, size_t alignment) override {
+    if (LLVM_UNLIKELY(size == 0 || size > kMaxBlockSize ||
+                      alignment > kMaxBlockSize))
+      return allocator_->AllocateBytes(size, alignment);
+
+    // Serve from the class that satisfies both the size and the alignment
+    // (blocks are aligned to their class size). DeallocateBytes refiles the
+    // block under the class derived from `size` alone, which may be smaller
+    // in the rare alignment > size case; that is safe because a pooled block
+    // is only ever reused for requests no larger and no more aligned than
+    // the class it is filed under.
+    const int size_class = SizeClassIndex(std::max(size, alignment));
+
+    ThreadCache::ClassCache& cache = GetThreadCache()->classes[size_class];
+    if (LLVM_UNLIKELY(cache.head == nullptr)) {
+      cache.head = PopCentralBatch(size_class, &cache.count);
+      if (cache.head == nullptr) {
+        // Could not carve a slab. Request the full class block size and
+        // alignment from the underlying allocator, so the block still
+        // upholds the reuse invariant above when it is later pooled by
+        // DeallocateBytes.
+        const size_t block_size = ClassBlockSize(size_class);
+        return allocator_->AllocateBytes(block_size, block_size);
+      }
+    }
+    FreeBlock* block = cache.head;
+    cache.head = block->next;
+    --cache.count;
+    return block;
+  }
+
+  void DeallocateBytes(void* ptr, size_t size) override {
+    if (LLVM_UNLIKELY(size == 0 || size > kMaxBlockSize)) {
+      allocator_->DeallocateBytes(ptr, size);
+      return;
+    }
+    const int size_class = SizeClassIndex(size);
+    ThreadCache::ClassCache& cache = GetThreadCache()->classes[size_class];
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = cache.head;
+    cache.head = block;
+    ++cache.count;
+
+    // The cache has grown past its watermark: hand a batch back to the
+    // central list so cross-thread producer/consumer patterns do not strand
+    // memory in the consumer's cache.
+    if (LLVM_UNLIKELY(cache.count > kMaxBlocksPerClass)) {
+      FreeBlock* head = cache.head;
+      FreeBlock* tail = head;
+      for (int i = 1; i < kTransferBatchSize; ++i) tail = tail->next;
+      cache.head = tail->next;
+      cache.count -= kTransferBatchSize;
+      tail->next = nullptr;
+      PushCentralBatch(size_class, head, tail);
+    }
+  }
+
+ private:
+  std::unique_ptr<HostAllocator> allocator_;
+};
+
+}  // namespace
+
+std::unique_ptr<HostAllocator> CreateThreadCachingAllocator(
+    std::unique_ptr<HostAllocator> allocator) {
+  return std::make_unique<ThreadCachingAllocator>(std::move(allocator));
+}
+
+}  // namespace tfrt
@@ -19,6 +19,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdint>
+
 #include "tfrt/metrics/metrics_api.h"
 
 namespace tfrt {
@@ -44,6 +46,7 @@ Gauge<T>* NewGauge(std::string name) {
 }
 
 template Gauge<std::string>* NewGauge<std::string>(std::string name);
+template Gauge<int64_t>* NewGauge<int64_t>(std::string name);
 #endif
 
 }  // namespace metrics
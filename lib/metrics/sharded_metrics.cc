@@ -0,0 +1,136 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- sharded_metrics.cc -------------------------------------------------===//
+//
+// This file implements the Counter and Histogram metrics with per-thread
+// sharded atomic cells. A single shared atomic becomes the bottleneck when
+// every request thread increments it - the cache line ping-pongs between
+// cores - so updates go to one of several cache-line padded shards chosen per
+// thread, and the shards are only summed when the metric is scraped.
+//
+// Like the dummy gauges, these definitions step aside when
+// ENABLE_TFRT_METRICS is set and an external metrics backend supplies the
+// factories instead.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/metrics/metrics_api.h"
+
+namespace tfrt {
+namespace metrics {
+
+#if !defined(ENABLE_TFRT_METRICS)
+
+namespace {
+
+// Number of shards per metric. Enough that a machine's worth of threads
+// rarely collide on a shard, small enough that scraping stays trivial.
+constexpr uint32_t kNumShards = 16;
+static_assert((kNumShards & (kNumShards - 1)) == 0,
+              "shard selection relies on a power-of-two shard count");
+
+// The shard this thread updates. Threads are spread round-robin over the
+// shards once at thread creation; the assignment is shared by all metrics so
+// each thread touches one cache line per metric.
+uint32_t ThisThreadShard() {
+  static std::atomic<uint32_t> next_thread{0};
+  static thread_local const uint32_t shard =
+      next_thread.fetch_add(1, std::memory_order_relaxed) & (kNumShards - 1);
+  return shard;
+}
+
+// One shard of a counter, padded so neighboring shards never share a cache
+// line.
+struct alignas(64) CounterShard {
+  std::atomic<int64_t> value{0};
+};
+
+class ShardedCounter : public Counter {
+ public:
+  explicit ShardedCounter(std::string name) : name_(std::move(name)) {}
+
+  void Add(int64_t delta) override {
+    shards_[ThisThreadShard()].value.fetch_add(delta,
+                                               std::memory_order_relaxed);
+  }
+
+  int64_t Value() override {
+    int64_t total = 0;
+    for (const CounterShard& shard : shards_)
+      total += shard.value.load(std::memory_order_relaxed);
+    return total;
+  }
+
+ private:
+  const std::string name_;
+  CounterShard shards_[kNumShards];
+};
+
+// One shard of a histogram. The buckets within a shard are written by one
+// set of threads only, so padding is needed between shards, not between
+// buckets; the array size is a multiple of a cache line, which keeps the
+// alignas sufficient.
+struct alignas(64) HistogramShard {
+  std::atomic<int64_t> buckets[Histogram::kNumBuckets] = {};
+};
+
+class ShardedHistogram : public Histogram {
+ public:
+  explicit ShardedHistogram(std::string name) : name_(std::move(name)) {}
+
+  void Record(int64_t value) override {
+    uint32_t bucket = 0;
+    if (value > 0) {
+      bucket = llvm::Log2_64(static_cast<uint64_t>(value)) + 1;
+      if (bucket >= kNumBuckets) bucket = kNumBuckets - 1;
+    }
+    shards_[ThisThreadShard()].buckets[bucket].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  std::vector<int64_t> GetBuckets() override {
+    std::vector<int64_t> merged(kNumBuckets, 0);
+    for (const HistogramShard& shard : shards_)
+      for (int i = 0; i < kNumBuckets; ++i)
+        merged[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    return merged;
+  }
+
+ private:
+  const std::string name_;
+  HistogramShard shards_[kNumShards];
+};
+
+}  // namespace
+
+Counter* NewCounter(std::string name) {
+  return new ShardedCounter(std::move(name));
+}
+
+Histogram* NewHistogram(std::string name) {
+  return new ShardedHistogram(std::move(name));
+}
+
+#endif  // !defined(ENABLE_TFRT_METRICS)
+
+}  // namespace metrics
+}  // namespace tfrt
@@ -15,7 +15,8 @@
 //===- alloc.cc -----------------------------------------------------------===//
 //
 // This file defines AlignedAlloc() for allocating dynamic buffer with
-// explicit alignment.
+// explicit alignment, and HugePageAlloc()/HugePageFree() for large buffers
+// backed by transparent huge pages.
 //
 //===----------------------------------------------------------------------===//
 
@@ -23,6 +24,10 @@
 
 #include <cstdlib>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 namespace tfrt {
 
 void* AlignedAlloc(size_t alignment, size_t size) {
@@ -41,4 +46,40 @@ void* AlignedAlloc(size_t alignment, size_t size) {
 #endif
 }
 
+#if defined(__linux__)
+
+// Transparent huge pages on x86 and arm64 are 2MB. Rounding the mapping up
+// to a huge page multiple lets the kernel back the whole range with huge
+// pages instead of leaving a 4KB-mapped tail.
+static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+void* HugePageAlloc(size_t size) {
+  size = (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) return nullptr;
+#if defined(MADV_HUGEPAGE)
+  // Advisory only: if transparent huge pages are disabled the mapping still
+  // works, just with base pages.
+  madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return ptr;
+}
+
+void HugePageFree(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+  size = (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  munmap(ptr, size);
+}
+
+#else  // !__linux__
+
+// No transparent huge page support; fall back to an ordinary page-aligned
+// allocation so callers need no platform-specific handling.
+void* HugePageAlloc(size_t size) { return AlignedAlloc(4096, size); }
+
+void HugePageFree(void* ptr, size_t size) { free(ptr); }
+
+#endif  // __linux__
+
 }  // namespace tfrt
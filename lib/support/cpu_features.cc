@@ -0,0 +1,53 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- cpu_features.cc ----------------------------------------------------===//
+//
+// This file implements runtime CPU feature detection.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/cpu_features.h"
+
+namespace tfrt {
+
+static CpuFeatures ProbeHostCpuFeatures() {
+  CpuFeatures features = CpuFeatures::kBaseline;
+
+#if defined(__x86_64__) || defined(__i386__)
+  // __builtin_cpu_supports compiles to a CPUID probe cached by the runtime.
+  if (__builtin_cpu_supports("avx")) features = features | CpuFeatures::kAVX;
+  if (__builtin_cpu_supports("avx2")) features = features | CpuFeatures::kAVX2;
+  if (__builtin_cpu_supports("fma")) features = features | CpuFeatures::kFMA;
+  if (__builtin_cpu_supports("avx512f"))
+    features = features | CpuFeatures::kAVX512F;
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+  features = features | CpuFeatures::kNEON;
+#endif
+
+  return features;
+}
+
+CpuFeatures GetHostCpuFeatures() {
+  static const CpuFeatures features = ProbeHostCpuFeatures();
+  return features;
+}
+
+bool HostSupportsCpuFeatures(CpuFeatures features) {
+  return (GetHostCpuFeatures() & features) == features;
+}
+
+}  // namespace tfrt
@@ -0,0 +1,75 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- string_interner.cc -------------------------------------------------===//
+//
+// This file implements the process-wide string interning table.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/string_interner.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "tfrt/support/concurrent_block_vector.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+
+struct StringInterner::Impl {
+  mutex mu;
+  // Owns the string bytes. StringMap allocates each entry (key bytes plus
+  // value) once and never moves it, so the key data handed out below is
+  // stable and NUL-terminated.
+  llvm::StringMap<Id> ids TFRT_GUARDED_BY(mu);
+  // Id-to-entry lookup. ConcurrentBlockVector gives wait-free indexed reads
+  // against concurrent interning, and entries never move.
+  ConcurrentBlockVector<const llvm::StringMapEntry<Id>*> entries{256};
+};
+
+StringInterner::StringInterner() : impl_(std::make_unique<Impl>()) {}
+
+StringInterner::~StringInterner() {}
+
+StringInterner& StringInterner::Global() {
+  static StringInterner* interner = new StringInterner;
+  return *interner;
+}
+
+StringInterner::Id StringInterner::Intern(string_view str) {
+  mutex_lock lock(impl_->mu);
+  auto it = impl_->ids.try_emplace(str, kInvalidId).first;
+  if (it->second == kInvalidId) {
+    it->second = static_cast<Id>(impl_->entries.emplace_back(&*it));
+    assert(it->second != kInvalidId && "Interning table overflow");
+  }
+  return it->second;
+}
+
+StringInterner::Id StringInterner::Find(string_view str) const {
+  mutex_lock lock(impl_->mu);
+  auto it = impl_->ids.find(str);
+  return it == impl_->ids.end() ? kInvalidId : it->second;
+}
+
+string_view StringInterner::GetString(Id id) const {
+  return impl_->entries[id]->getKey();
+}
+
+const char* StringInterner::GetCString(Id id) const {
+  return impl_->entries[id]->getKeyData();
+}
+
+size_t StringInterner::size() const { return impl_->entries.size(); }
+
+}  // namespace tfrt
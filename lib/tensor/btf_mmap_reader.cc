@@ -0,0 +1,137 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- btf_mmap_reader.cc -------------------------------------------------===//
+//
+// This file implements the memory mapped reader for BTF.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/btf_mmap_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "tfrt/tensor/tensor_metadata.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+
+Expected<MappedBTFFile> MappedBTFFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return MakeStringError("failed to open file ", path, " for reading");
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return MakeStringError("failed to stat file ", path);
+  }
+  size_t file_size = file_stat.st_size;
+  if (file_size < sizeof(uint64_t)) {
+    close(fd);
+    return MakeStringError(path, " is too small to be a BTF file");
+  }
+
+  void* base = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return MakeStringError("failed to mmap file ", path);
+  }
+
+  auto mapping = HostBuffer::CreateFromExternal(
+      base, file_size,
+      [](void* ptr, size_t mapped_size) { munmap(ptr, mapped_size); });
+  return MappedBTFFile(std::move(mapping));
+}
+
+uint64_t MappedBTFFile::NumTensors() const {
+  uint64_t num_tensors;
+  std::memcpy(&num_tensors, mapping_->data(), sizeof(uint64_t));
+  return num_tensors;
+}
+
+Expected<DenseHostTensor> MappedBTFFile::ReadDenseTensorImpl(
+    int32_t index, btf::TensorDType btf_dtype, size_t rank,
+    DType dtype) const {
+  const char* base = static_cast<const char*>(mapping_->data());
+  size_t file_size = mapping_->size();
+
+  uint64_t num_tensors = NumTensors();
+  if (index < 0 || index >= num_tensors) {
+    return MakeStringError("invalid tensor index ", index,
+                           " for a BTF file with ", num_tensors, " tensors");
+  }
+  if ((1 + num_tensors) * sizeof(uint64_t) > file_size) {
+    return MakeStringError("BTF offset table is truncated");
+  }
+
+  uint64_t offset;
+  std::memcpy(&offset, base + (1 + index) * sizeof(uint64_t),
+              sizeof(uint64_t));
+  if (offset + sizeof(btf::TensorHeader) > file_size) {
+    return MakeStringError("failed to read tensor header at offset ", offset);
+  }
+  btf::TensorHeader header;
+  std::memcpy(&header, base + offset, sizeof(header));
+
+  if (header.dtype != btf_dtype) {
+    return MakeStringError("unexpected tensor dtype ", header.dtype,
+                           ". Expected dtype is ", btf_dtype);
+  }
+  uint64_t header_rank = header.rank;
+  if (header_rank != rank) {
+    return MakeStringError("unexpected tensor rank ", header_rank,
+                           ". Expected rank is ", rank);
+  }
+  if (header.layout != btf::TensorLayout::kRMD) {
+    return MakeStringError("unexpected tensor layout ", header.layout);
+  }
+
+  size_t dims_offset = offset + sizeof(header);
+  if (dims_offset + rank * sizeof(uint64_t) > file_size) {
+    return MakeStringError("failed to read tensor dims at offset ", offset);
+  }
+  SmallVector<ssize_t, 4> dims(rank);
+  ssize_t num_elements = 1;
+  for (size_t i = 0; i != rank; ++i) {
+    uint64_t dim;
+    std::memcpy(&dim, base + dims_offset + i * sizeof(uint64_t),
+                sizeof(uint64_t));
+    dims[i] = dim;
+    num_elements *= dim;
+  }
+
+  size_t data_offset = dims_offset + rank * sizeof(uint64_t);
+  size_t data_size = num_elements * dtype.GetHostSize();
+  if (data_offset + data_size > file_size) {
+    return MakeStringError("tensor data at offset ", offset,
+                           " runs past the end of the file");
+  }
+
+  // The tensor buffer aliases the mapped region; its deallocator just drops a
+  // reference that keeps the mapping alive while the tensor exists.
+  auto buffer = HostBuffer::CreateFromExternal(
+      const_cast<char*>(base) + data_offset, data_size,
+      [mapping = mapping_.CopyRef()](void*, size_t) {});
+  return DenseHostTensor(TensorMetadata(dtype, TensorShape(dims)),
+                         std::move(buffer));
+}
+
+}  // namespace tfrt
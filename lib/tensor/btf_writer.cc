@@ -0,0 +1,175 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- btf_writer.cc ------------------------------------------------------===//
+//
+// This file implements the streaming writer for BTF.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/btf_writer.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/tensor/btf.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace {
+
+// Maps a host dtype to its BTF encoding. Returns false for dtypes BTF cannot
+// represent.
+bool ConvertDTypeToTensorDType(DType dtype, btf::TensorDType* result) {
+  switch (dtype.kind()) {
+    case DType::I8:
+      *result = btf::TensorDType::kInt8;
+      return true;
+    case DType::I16:
+      *result = btf::TensorDType::kInt16;
+      return true;
+    case DType::I32:
+      *result = btf::TensorDType::kInt32;
+      return true;
+    case DType::I64:
+      *result = btf::TensorDType::kInt64;
+      return true;
+    case DType::F32:
+      *result = btf::TensorDType::kFloat32;
+      return true;
+    case DType::F64:
+      *result = btf::TensorDType::kFloat64;
+      return true;
+    case DType::UI8:
+      *result = btf::TensorDType::kUInt8;
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+BTFWriterSink::~BTFWriterSink() {}
+
+Expected<std::unique_ptr<BTFFileSink>> BTFFileSink::Create(
+    const std::string& path) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return MakeStringError("failed to open file ", path, " for writing");
+  }
+  return std::unique_ptr<BTFFileSink>(new BTFFileSink(fd));
+}
+
+BTFFileSink::~BTFFileSink() { close(fd_); }
+
+bool BTFFileSink::Write(uint64_t offset, ArrayRef<uint8_t> data) {
+  const uint8_t* ptr = data.data();
+  size_t remaining = data.size();
+  while (remaining != 0) {
+    ssize_t written = pwrite(fd_, ptr, remaining, offset);
+    if (written <= 0) return false;
+    ptr += written;
+    offset += written;
+    remaining -= written;
+  }
+  return true;
+}
+
+AsyncValueRef<Chain> SerializeTensorsToBTF(
+    ArrayRef<const DenseHostTensor*> tensors, BTFWriterSink* sink,
+    HostContext* host) {
+  size_t num_tensors = tensors.size();
+
+  // Lay out the file up front: record i starts at offsets[i], 8-byte aligned
+  // so dims and payloads stay naturally aligned for memory mapped readers.
+  SmallVector<uint64_t, 16> offsets;
+  offsets.reserve(num_tensors);
+  uint64_t offset = (1 + num_tensors) * sizeof(uint64_t);
+  for (const DenseHostTensor* tensor : tensors) {
+    btf::TensorDType dtype;
+    if (!ConvertDTypeToTensorDType(tensor->dtype(), &dtype)) {
+      return host->MakeErrorAsyncValueRef(
+          "cannot serialize tensor dtype to BTF");
+    }
+    offsets.push_back(offset);
+    offset += sizeof(btf::TensorHeader) +
+              tensor->shape().GetRank() * sizeof(uint64_t) +
+              tensor->DataSizeInBytes();
+    offset = (offset + 7) & ~uint64_t{7};
+  }
+
+  // The prelude (tensor count plus offset table) fixes the ordering, so the
+  // record writes below are independent and can run in any order.
+  SmallVector<uint8_t, 64> prelude((1 + num_tensors) * sizeof(uint64_t));
+  uint64_t count = num_tensors;
+  std::memcpy(prelude.data(), &count, sizeof(uint64_t));
+  std::memcpy(prelude.data() + sizeof(uint64_t), offsets.data(),
+              num_tensors * sizeof(uint64_t));
+  if (!sink->Write(0, prelude)) {
+    return host->MakeErrorAsyncValueRef("failed to write BTF offset table");
+  }
+
+  if (num_tensors == 0) return host->GetReadyChain();
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto ok = std::make_shared<std::atomic<bool>>(true);
+  auto compute = [tensors, sink, offsets, ok](size_t start, size_t end) {
+    for (size_t i = start; i != end; ++i) {
+      const DenseHostTensor* tensor = tensors[i];
+      size_t rank = tensor->shape().GetRank();
+
+      SmallVector<uint8_t, 64> head(sizeof(btf::TensorHeader) +
+                                    rank * sizeof(uint64_t));
+      btf::TensorHeader header;
+      std::memset(&header, 0, sizeof(header));
+      header.rank = rank;
+      ConvertDTypeToTensorDType(tensor->dtype(), &header.dtype);
+      header.layout = btf::TensorLayout::kRMD;
+      std::memcpy(head.data(), &header, sizeof(header));
+      for (size_t d = 0; d != rank; ++d) {
+        uint64_t dim = tensor->shape().GetDimensionSize(d);
+        std::memcpy(head.data() + sizeof(header) + d * sizeof(uint64_t), &dim,
+                    sizeof(uint64_t));
+      }
+
+      bool write_ok =
+          sink->Write(offsets[i], head) &&
+          sink->Write(offsets[i] + head.size(),
+                      ArrayRef<uint8_t>(
+                          static_cast<const uint8_t*>(tensor->data()),
+                          tensor->DataSizeInBytes()));
+      if (!write_ok) ok->store(false, std::memory_order_relaxed);
+    }
+  };
+  auto on_done = [chain = chain.CopyRef(), ok]() mutable {
+    if (ok->load(std::memory_order_relaxed)) {
+      chain.emplace();
+    } else {
+      chain.SetError("failed to write BTF tensor record");
+    }
+  };
+  host->ParallelFor(num_tensors, std::move(compute), std::move(on_done),
+                    /*min_block_size=*/1);
+  return chain;
+}
+
+}  // namespace tfrt
@@ -0,0 +1,82 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- chunked_host_tensor.cc ---------------------------------------------===//
+//
+// This file implements the ChunkedHostTensor class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/chunked_host_tensor.h"
+
+#include <cstring>
+
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+AsyncValueRef<HostTensor> ChunkedHostTensor::ConvertToHostTensor(
+    HostContext* host, uint32_t allowed_formats) const {
+  assert(allowed_formats &
+         (1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost)));
+  auto result_alloc = DenseHostTensor::CreateUninitialized(metadata(), host);
+  if (!result_alloc)
+    return host->MakeErrorAsyncValueRef(
+        "out of memory converting chunked tensor to dht tensor");
+  auto& result_tensor = result_alloc.getValue();
+
+  // Chunks are contiguous row-major slabs along dimension zero, so the
+  // conversion is one copy per chunk.
+  size_t row_bytes = dtype().GetHostSize();
+  for (int i = 1, rank = shape().GetRank(); i < rank; ++i)
+    row_bytes *= shape().GetDimensionSize(i);
+  char* out = static_cast<char*>(result_tensor.data());
+  for (size_t i = 0, e = NumChunks(); i != e; ++i) {
+    size_t chunk_bytes = chunk_rows_[i] * row_bytes;
+    std::memcpy(out, chunk(i)->data(), chunk_bytes);
+    out += chunk_bytes;
+  }
+
+  auto result = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  result.emplace(std::move(result_tensor));
+  return result;
+}
+
+void ChunkedHostTensor::Print(raw_ostream& os) const {
+  os << "ChunkedHostTensor dtype = " << dtype() << " shape = " << shape();
+  os << ", chunk_rows = [";
+  llvm::interleaveComma(chunk_rows(), os);
+  os << "], values = [";
+
+  auto element_size = dtype().GetHostSize();
+  ssize_t elements_per_row = 1;
+  for (int i = 1, rank = shape().GetRank(); i < rank; ++i)
+    elements_per_row *= shape().GetDimensionSize(i);
+  bool first = true;
+  for (size_t i = 0, e = NumChunks(); i != e; ++i) {
+    auto* data_ptr = static_cast<const char*>(chunk(i)->data());
+    for (ssize_t j = 0, num = chunk_rows_[i] * elements_per_row; j != num;
+         ++j) {
+      if (!first) os << ", ";
+      first = false;
+      dtype().Print(data_ptr + j * element_size, os);
+    }
+  }
+  os << "]\n";
+}
+
+}  // namespace tfrt
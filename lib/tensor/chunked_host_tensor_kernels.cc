@@ -0,0 +1,126 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- chunked_host_tensor_kernels.cc -------------------------------------===//
+//
+// This file implements the kernels for chunked host tensors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/tensor/chunked_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+
+// Concatenates dense tensors along dimension zero into a ChunkedHostTensor
+// without copying: each input's buffer becomes one refcounted chunk.
+static void ConcatDhtToChunked(Argument<Chain> in_chain,
+                               RepeatedArguments<DenseHostTensor> srcs,
+                               Result<ChunkedHostTensor> out,
+                               Result<Chain> out_chain,
+                               KernelErrorHandler handler) {
+  if (srcs.size() == 0) {
+    handler.ReportError("cht.concat_dht needs at least one input");
+    return;
+  }
+  const DenseHostTensor& first = srcs[0];
+  int rank = first.shape().GetRank();
+  if (rank == 0) {
+    handler.ReportError("cht.concat_dht needs inputs of rank at least one");
+    return;
+  }
+
+  SmallVector<HostBuffer*, 4> buffers;
+  SmallVector<ssize_t, 4> chunk_rows;
+  ssize_t total_rows = 0;
+  for (DenseHostTensor& src : srcs) {
+    if (src.dtype() != first.dtype()) {
+      handler.ReportError("cht.concat_dht inputs must have the same dtype");
+      return;
+    }
+    if (src.shape().GetRank() != rank) {
+      handler.ReportError("cht.concat_dht inputs must have the same rank");
+      return;
+    }
+    for (int i = 1; i < rank; ++i) {
+      if (src.shape().GetDimensionSize(i) != first.shape().GetDimensionSize(i)) {
+        handler.ReportError(
+            "cht.concat_dht inputs must match on all trailing dimensions");
+        return;
+      }
+    }
+    buffers.push_back(src.buffer().get());
+    chunk_rows.push_back(src.shape().GetDimensionSize(0));
+    total_rows += chunk_rows.back();
+  }
+
+  SmallVector<ssize_t, 4> dims;
+  first.shape().GetDimensions(&dims);
+  dims[0] = total_rows;
+  out.Emplace(ChunkedHostTensor(
+      TensorMetadata(first.dtype(), TensorShape(dims)),
+      RCArray<HostBuffer>(buffers), std::move(chunk_rows)));
+  out_chain.Set(in_chain);
+}
+
+// Splits a ChunkedHostTensor back into one dense tensor per chunk without
+// copying: each result aliases the corresponding refcounted chunk.
+static void SplitChunked(Argument<ChunkedHostTensor> in,
+                         Argument<Chain> in_chain, Result<Chain> out_chain,
+                         RemainingResults results, KernelErrorHandler handler,
+                         KernelFrame* frame) {
+  if (results.size() != in->NumChunks()) {
+    handler.ReportError("cht.split needs one result per chunk, got ",
+                        results.size(), " results for ", in->NumChunks(),
+                        " chunks");
+    return;
+  }
+
+  HostContext* host = frame->GetHostContext();
+  SmallVector<ssize_t, 4> dims;
+  in->shape().GetDimensions(&dims);
+  for (size_t i = 0, e = in->NumChunks(); i != e; ++i) {
+    dims[0] = in->chunk_rows()[i];
+    auto chunk = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+    chunk.emplace(TensorMetadata(in->dtype(), TensorShape(dims)),
+                  FormRef(in->chunk(i)));
+    results[i] = chunk.ReleaseRCRef();
+  }
+  out_chain.Set(in_chain);
+}
+
+// Converts a ChunkedHostTensor to a contiguous DenseHostTensor (one copy per
+// chunk).
+static void ConvertChunkedToDht(Argument<ChunkedHostTensor> in,
+                                Argument<Chain> in_chain,
+                                Result<DenseHostTensor> out,
+                                Result<Chain> out_chain, KernelFrame* frame) {
+  uint32_t allowed_formats =
+      1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost);
+  auto host_tensor =
+      in.get().ConvertToHostTensor(frame->GetHostContext(), allowed_formats);
+  out.Set(AsyncValueRef<DenseHostTensor>(host_tensor.ReleaseRCRef()));
+  out_chain.Set(in_chain);
+}
+
+void RegisterChunkedHostTensorKernels(KernelRegistry* registry) {
+  registry->AddKernel("cht.concat_dht", TFRT_KERNEL(ConcatDhtToChunked));
+  registry->AddKernel("cht.split", TFRT_KERNEL(SplitChunked));
+  registry->AddKernel("cht.convert_cht_to_dht",
+                      TFRT_KERNEL(ConvertChunkedToDht));
+}
+
+}  // namespace tfrt
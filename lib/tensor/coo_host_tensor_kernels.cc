@@ -18,8 +18,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+
+#include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/tensor/coo_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
 #include "tfrt/tensor/dense_tensor_utils.h"
 
 namespace tfrt {
@@ -105,6 +110,175 @@ static void ConvertFromDHT(ArgumentView<MutableDHTIndexableView<T, Rank>> in,
   out_chain.Set(in_chain);
 }
 
+// Converts a sparse tensor in COO layout to a DenseHostTensor, scattering the
+// non-zero elements across work queue tasks instead of looping over them
+// serially. Indices must be unique, as in the serial conversion.
+template <typename T, size_t Rank>
+static void ScatterCooToDht(Argument<CooHostTensor> in,
+                            Argument<Chain> in_chain,
+                            Result<DenseHostTensor> out,
+                            Result<Chain> out_chain,
+                            KernelErrorHandler handler, KernelFrame* frame) {
+  HostContext* host = frame->GetHostContext();
+  auto dht = DenseHostTensor::CreateUninitialized(in->metadata(), host);
+  if (!dht.hasValue()) {
+    handler.ReportError("Cannot allocate result tensor");
+    return;
+  }
+  // All-zero bytes is T(0) for every numeric dtype.
+  std::memset(dht->data(), 0, dht->DataSizeInBytes());
+
+  auto result =
+      host->MakeConstructedAsyncValueRef<DenseHostTensor>(std::move(*dht));
+  ssize_t num_values = in->Values()->NumElements();
+  if (num_values == 0) {
+    result.SetStateConcrete();
+    out.Set(std::move(result));
+    out_chain.Set(in_chain);
+    return;
+  }
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto compute = [in = in.ValueRef(), result = result.CopyRef()](size_t start,
+                                                                 size_t end) {
+    const CooHostTensor& coo = in.get();
+    auto indices = DHTIndexableView<int64_t, 2>(coo.Indices());
+    auto values = DHTIndexableView<T, 1>(coo.Values());
+    MutableDHTArrayView<T> dest(&result.get());
+    const auto& shape = result.get().shape();
+    for (size_t i = start; i != end; ++i) {
+      size_t offset = 0;
+      size_t stride = 1;
+      for (int j = Rank - 1; j >= 0; --j) {
+        offset += stride * indices.ElementAt(i, j);
+        stride *= shape.GetDimensionSize(j);
+      }
+      dest[offset] = values.ElementAt(i);
+    }
+  };
+  auto on_done = [result = result.CopyRef(),
+                  chain = chain.CopyRef()]() mutable {
+    result.SetStateConcrete();
+    chain.emplace();
+  };
+  host->ParallelFor(num_values, std::move(compute), std::move(on_done),
+                    /*min_block_size=*/256);
+  out.Set(std::move(result));
+  out_chain.Set(std::move(chain));
+}
+
+// Adds the non-zero elements of a COO sparse tensor into a dense tensor of
+// the same shape in place, partitioning the indices across work queue tasks.
+// Indices must be unique for the update to be deterministic.
+template <typename T, size_t Rank>
+static void SparseAddDense(Argument<CooHostTensor> sparse,
+                           Argument<DenseHostTensor> dense,
+                           Argument<Chain> in_chain, Result<Chain> out_chain,
+                           KernelErrorHandler handler, KernelFrame* frame) {
+  if (sparse->shape() != dense->shape() ||
+      dense->dtype() != GetDType<T>()) {
+    handler.ReportError("coo.sparse_add_dense operands must match");
+    return;
+  }
+  ssize_t num_values = sparse->Values()->NumElements();
+  if (num_values == 0) {
+    out_chain.Set(in_chain);
+    return;
+  }
+
+  HostContext* host = frame->GetHostContext();
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto compute = [sparse = sparse.ValueRef(),
+                  dense = dense.ValueRef()](size_t start, size_t end) {
+    const CooHostTensor& coo = sparse.get();
+    auto indices = DHTIndexableView<int64_t, 2>(coo.Indices());
+    auto values = DHTIndexableView<T, 1>(coo.Values());
+    MutableDHTArrayView<T> dest(&dense.get());
+    const auto& shape = dense.get().shape();
+    for (size_t i = start; i != end; ++i) {
+      size_t offset = 0;
+      size_t stride = 1;
+      for (int j = Rank - 1; j >= 0; --j) {
+        offset += stride * indices.ElementAt(i, j);
+        stride *= shape.GetDimensionSize(j);
+      }
+      dest[offset] += values.ElementAt(i);
+    }
+  };
+  host->ParallelFor(num_values, std::move(compute),
+                    [chain = chain.CopyRef()]() mutable { chain.emplace(); },
+                    /*min_block_size=*/256);
+  out_chain.Set(std::move(chain));
+}
+
+// Gathers one row of a dense embedding table per id, with the rows
+// partitioned across work queue tasks.
+template <typename T>
+static void SparseEmbeddingGather(
+    ArgumentView<DHTIndexableView<int64_t, 1>> ids,
+    ArgumentView<DHTIndexableView<T, 2>> table, Argument<Chain> in_chain,
+    Result<DenseHostTensor> out, Result<Chain> out_chain,
+    KernelErrorHandler handler, KernelFrame* frame) {
+  ssize_t num_ids = ids->FixedShape()[0];
+  ssize_t vocab_size = table->FixedShape()[0];
+  ssize_t row_size = table->FixedShape()[1];
+
+  // Validating the ids up front is one cheap pass compared to the row copies
+  // and lets the kernel fail synchronously.
+  for (ssize_t i = 0; i != num_ids; ++i) {
+    int64_t id = ids->ElementAt(i);
+    if (id < 0 || id >= vocab_size) {
+      handler.ReportError("coo.sparse_embedding_gather id ", id,
+                          " is out of range for a table with ", vocab_size,
+                          " rows");
+      return;
+    }
+  }
+
+  HostContext* host = frame->GetHostContext();
+  auto dht = DenseHostTensor::CreateUninitialized<T>(
+      TensorShape({num_ids, row_size}), host);
+  if (!dht.hasValue()) {
+    handler.ReportError("Cannot allocate result tensor");
+    return;
+  }
+  auto result =
+      host->MakeConstructedAsyncValueRef<DenseHostTensor>(std::move(*dht));
+  if (num_ids == 0) {
+    result.SetStateConcrete();
+    out.Set(std::move(result));
+    out_chain.Set(in_chain);
+    return;
+  }
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto compute = [ids_ref = FormRef(ids.value()),
+                  table_ref = FormRef(table.value()),
+                  result = result.CopyRef(), row_size](size_t start,
+                                                       size_t end) {
+    auto ids = DHTIndexableView<int64_t, 1>(
+        &ids_ref->template get<DenseHostTensor>());
+    auto table = DHTIndexableView<T, 2>(
+        &table_ref->template get<DenseHostTensor>());
+    auto dest = MutableDHTIndexableView<T, 2>(&result.get());
+    for (size_t i = start; i != end; ++i) {
+      std::memcpy(&dest.ElementAt(i, 0), &table.ElementAt(ids.ElementAt(i), 0),
+                  row_size * sizeof(T));
+    }
+  };
+  auto on_done = [result = result.CopyRef(),
+                  chain = chain.CopyRef()]() mutable {
+    result.SetStateConcrete();
+    chain.emplace();
+  };
+  size_t row_bytes = row_size * sizeof(T);
+  host->ParallelFor(num_ids, std::move(compute), std::move(on_done),
+                    std::max<size_t>(1, (1 << 16) / std::max<size_t>(
+                                            1, row_bytes)));
+  out.Set(std::move(result));
+  out_chain.Set(std::move(chain));
+}
+
 template <typename T, size_t Rank>
 void RegisterCooHostTensorKernelsForTypeAndRank(KernelRegistry* registry,
                                                 const std::string& t_name) {
@@ -115,6 +289,10 @@ void RegisterCooHostTensorKernelsForTypeAndRank(KernelRegistry* registry,
                       TFRT_KERNEL(SparseTensorEqual<T, Rank>));
   registry->AddKernel("coo.convert_dht_to_coo." + suffix,
                       TFRT_KERNEL(ConvertFromDHT<T, Rank>));
+  registry->AddKernel("coo.scatter_to_dht." + suffix,
+                      TFRT_KERNEL(ScatterCooToDht<T, Rank>));
+  registry->AddKernel("coo.sparse_add_dense." + suffix,
+                      TFRT_KERNEL(SparseAddDense<T, Rank>));
 }
 
 template <typename T>
@@ -124,6 +302,8 @@ void RegisterCooHostTensorKernelsForType(KernelRegistry* registry,
   RegisterCooHostTensorKernelsForTypeAndRank<T, 1>(registry, t_name);
   RegisterCooHostTensorKernelsForTypeAndRank<T, 2>(registry, t_name);
   RegisterCooHostTensorKernelsForTypeAndRank<T, 3>(registry, t_name);
+  registry->AddKernel("coo.sparse_embedding_gather." + t_name,
+                      TFRT_KERNEL(SparseEmbeddingGather<T>));
 }
 
 void RegisterCooHostTensorKernels(KernelRegistry* registry) {
@@ -0,0 +1,400 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- dense_tensor_transforms.cc -----------------------------------------===//
+//
+// This file implements cache-blocked, parallel transpose/slice/concat for
+// dense host tensors, and the dht.transpose, dht.slice and dht.concat kernels.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/dense_tensor_transforms.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace {
+
+constexpr size_t kCacheLineSize = 64;
+
+// Fills `strides` with the byte stride of each dimension of a row-major
+// tensor with the given dimensions and element size.
+void ComputeByteStrides(ArrayRef<ssize_t> dims, size_t elem_size,
+                        SmallVectorImpl<size_t>* strides) {
+  strides->resize(dims.size());
+  size_t stride = elem_size;
+  for (int i = dims.size() - 1; i >= 0; --i) {
+    (*strides)[i] = stride;
+    stride *= dims[i];
+  }
+}
+
+// Copies an na x nb tile where the destination is contiguous along `a` and
+// strided along `b`, and the source is strided along `a` and contiguous along
+// `b`, so the inner loop always reads the source sequentially.
+template <size_t ElemSize>
+void CopyTransposedTile(const char* src, size_t src_stride_a, char* dst,
+                        size_t dst_stride_b, size_t na, size_t nb) {
+  for (size_t ia = 0; ia != na; ++ia) {
+    const char* s = src + ia * src_stride_a;
+    char* d = dst + ia * ElemSize;
+    for (size_t ib = 0; ib != nb; ++ib)
+      std::memcpy(d + ib * dst_stride_b, s + ib * ElemSize, ElemSize);
+  }
+}
+
+// Dispatches to a fixed element size so the element copies compile down to
+// scalar loads and stores instead of memcpy calls.
+void CopyTransposedTileDispatch(size_t elem_size, const char* src,
+                                size_t src_stride_a, char* dst,
+                                size_t dst_stride_b, size_t na, size_t nb) {
+  switch (elem_size) {
+    case 1:
+      return CopyTransposedTile<1>(src, src_stride_a, dst, dst_stride_b, na,
+                                   nb);
+    case 2:
+      return CopyTransposedTile<2>(src, src_stride_a, dst, dst_stride_b, na,
+                                   nb);
+    case 4:
+      return CopyTransposedTile<4>(src, src_stride_a, dst, dst_stride_b, na,
+                                   nb);
+    case 8:
+      return CopyTransposedTile<8>(src, src_stride_a, dst, dst_stride_b, na,
+                                   nb);
+    default:
+      for (size_t ia = 0; ia != na; ++ia) {
+        const char* s = src + ia * src_stride_a;
+        char* d = dst + ia * elem_size;
+        for (size_t ib = 0; ib != nb; ++ib)
+          std::memcpy(d + ib * dst_stride_b, s + ib * elem_size, elem_size);
+      }
+  }
+}
+
+// Tile side for the blocked transpose: one cache line worth of elements in
+// each direction, clamped so tiny and huge element types still get a
+// reasonable block.
+size_t TransposeTileSide(size_t elem_size) {
+  return std::min<size_t>(std::max<size_t>(kCacheLineSize / elem_size, 8), 64);
+}
+
+}  // namespace
+
+AsyncValueRef<Chain> TransposeTensor(const DenseHostTensor& src,
+                                     DenseHostTensor* dst,
+                                     ArrayRef<ssize_t> permutation,
+                                     HostContext* host) {
+  if (dst->dtype() != src.dtype())
+    return host->MakeErrorAsyncValueRef("dht.transpose: dtype mismatch");
+
+  int rank = src.shape().GetRank();
+  if (dst->shape().GetRank() != rank || permutation.size() != rank)
+    return host->MakeErrorAsyncValueRef("dht.transpose: rank mismatch");
+
+  SmallVector<ssize_t, 4> src_dims;
+  src.shape().GetDimensions(&src_dims);
+  SmallVector<ssize_t, 4> dst_dims;
+  dst->shape().GetDimensions(&dst_dims);
+
+  SmallVector<bool, 4> seen(rank, false);
+  for (int i = 0; i < rank; ++i) {
+    ssize_t p = permutation[i];
+    if (p < 0 || p >= rank || seen[p])
+      return host->MakeErrorAsyncValueRef(
+          "dht.transpose: invalid permutation");
+    seen[p] = true;
+    if (dst_dims[i] != src_dims[p])
+      return host->MakeErrorAsyncValueRef("dht.transpose: shape mismatch");
+  }
+
+  size_t elem_size = src.dtype().GetHostSize();
+  const char* src_data = static_cast<const char*>(src.data());
+  char* dst_data = static_cast<char*>(dst->data());
+  size_t num_elements = src.shape().GetNumElements();
+  if (num_elements == 0) return host->GetReadyChain();
+  if (rank == 0) {
+    std::memcpy(dst_data, src_data, elem_size);
+    return host->GetReadyChain();
+  }
+
+  SmallVector<size_t, 4> src_strides;
+  ComputeByteStrides(src_dims, elem_size, &src_strides);
+  SmallVector<size_t, 4> dst_strides;
+  ComputeByteStrides(dst_dims, elem_size, &dst_strides);
+
+  // Byte stride in the source of each *destination* dimension.
+  SmallVector<size_t, 4> ss(rank);
+  for (int i = 0; i < rank; ++i) ss[i] = src_strides[permutation[i]];
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto on_done = [chain = chain.CopyRef()]() mutable { chain.emplace(); };
+
+  if (permutation[rank - 1] == rank - 1) {
+    // The innermost dimension is unchanged, so every destination row is a
+    // contiguous run in the source and the transpose is a parallel row copy.
+    size_t row_bytes = dst_dims[rank - 1] * elem_size;
+    size_t num_rows = num_elements / dst_dims[rank - 1];
+    auto compute = [=](size_t start, size_t end) {
+      for (size_t row = start; row != end; ++row) {
+        size_t rem = row;
+        size_t src_offset = 0;
+        for (int i = rank - 2; i >= 0; --i) {
+          src_offset += (rem % dst_dims[i]) * ss[i];
+          rem /= dst_dims[i];
+        }
+        std::memcpy(dst_data + row * row_bytes, src_data + src_offset,
+                    row_bytes);
+      }
+    };
+    host->ParallelFor(num_rows, std::move(compute), std::move(on_done),
+                      std::max<size_t>(1, (1 << 16) / row_bytes));
+    return chain;
+  }
+
+  // General case. Tile over the destination's innermost dimension `a` and the
+  // destination dimension `b` that maps to the source's innermost dimension,
+  // so both sides touch whole cache lines within a tile.
+  int a = rank - 1;
+  int b = 0;
+  while (permutation[b] != rank - 1) ++b;
+
+  size_t tile = TransposeTileSide(elem_size);
+  size_t na_total = dst_dims[a];
+  size_t nb_total = dst_dims[b];
+  size_t tiles_b = (nb_total + tile - 1) / tile;
+
+  // Flatten the remaining dimensions into a single outer iteration space.
+  SmallVector<ssize_t, 4> outer_dims;
+  SmallVector<size_t, 4> outer_src_strides;
+  SmallVector<size_t, 4> outer_dst_strides;
+  for (int i = 0; i < rank; ++i) {
+    if (i == a || i == b) continue;
+    outer_dims.push_back(dst_dims[i]);
+    outer_src_strides.push_back(ss[i]);
+    outer_dst_strides.push_back(dst_strides[i]);
+  }
+  size_t num_outer = 1;
+  for (ssize_t dim : outer_dims) num_outer *= dim;
+
+  size_t src_stride_a = ss[a];
+  size_t dst_stride_b = dst_strides[b];
+  auto compute = [=](size_t start, size_t end) {
+    for (size_t task = start; task != end; ++task) {
+      size_t rem = task / tiles_b;
+      size_t b0 = (task % tiles_b) * tile;
+      size_t src_base = 0;
+      size_t dst_base = 0;
+      for (int i = outer_dims.size() - 1; i >= 0; --i) {
+        size_t coord = rem % outer_dims[i];
+        rem /= outer_dims[i];
+        src_base += coord * outer_src_strides[i];
+        dst_base += coord * outer_dst_strides[i];
+      }
+      size_t nb = std::min(tile, nb_total - b0);
+      for (size_t a0 = 0; a0 < na_total; a0 += tile) {
+        size_t na = std::min(tile, na_total - a0);
+        CopyTransposedTileDispatch(
+            elem_size, src_data + src_base + a0 * src_stride_a + b0 * elem_size,
+            src_stride_a, dst_data + dst_base + a0 * elem_size + b0 * dst_stride_b,
+            dst_stride_b, na, nb);
+      }
+    }
+  };
+  // One task is a full strip of tiles along `a`; group strips until a task
+  // moves around 64KB.
+  size_t strip_bytes = std::max<size_t>(1, na_total * tile * elem_size);
+  host->ParallelFor(num_outer * tiles_b, std::move(compute), std::move(on_done),
+                    std::max<size_t>(1, (1 << 16) / strip_bytes));
+  return chain;
+}
+
+AsyncValueRef<Chain> SliceTensor(const DenseHostTensor& src,
+                                 ArrayRef<ssize_t> begin, DenseHostTensor* dst,
+                                 HostContext* host) {
+  if (dst->dtype() != src.dtype())
+    return host->MakeErrorAsyncValueRef("dht.slice: dtype mismatch");
+
+  int rank = src.shape().GetRank();
+  if (dst->shape().GetRank() != rank || begin.size() != rank)
+    return host->MakeErrorAsyncValueRef("dht.slice: rank mismatch");
+
+  SmallVector<ssize_t, 4> src_dims;
+  src.shape().GetDimensions(&src_dims);
+  SmallVector<ssize_t, 4> dst_dims;
+  dst->shape().GetDimensions(&dst_dims);
+  for (int i = 0; i < rank; ++i) {
+    if (begin[i] < 0 || begin[i] + dst_dims[i] > src_dims[i])
+      return host->MakeErrorAsyncValueRef("dht.slice: slice out of bounds");
+  }
+
+  if (dst->shape().GetNumElements() == 0) return host->GetReadyChain();
+
+  size_t elem_size = src.dtype().GetHostSize();
+  const char* src_data = static_cast<const char*>(src.data());
+  char* dst_data = static_cast<char*>(dst->data());
+
+  SmallVector<size_t, 4> src_strides;
+  ComputeByteStrides(src_dims, elem_size, &src_strides);
+
+  // Dimensions [t, rank) form the longest suffix that is contiguous in both
+  // tensors, so each run of that many elements is a single memcpy.
+  int t = rank > 0 ? rank - 1 : 0;
+  while (t > 0 && dst_dims[t] == src_dims[t] && begin[t] == 0) --t;
+  size_t run_bytes = elem_size;
+  for (int i = t; i < rank; ++i) run_bytes *= dst_dims[i];
+  size_t num_runs = 1;
+  for (int i = 0; i < t; ++i) num_runs *= dst_dims[i];
+
+  size_t base_offset = 0;
+  for (int i = 0; i < rank; ++i) base_offset += begin[i] * src_strides[i];
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto compute = [=](size_t start, size_t end) {
+    for (size_t run = start; run != end; ++run) {
+      size_t rem = run;
+      size_t src_offset = base_offset;
+      for (int i = t - 1; i >= 0; --i) {
+        src_offset += (rem % dst_dims[i]) * src_strides[i];
+        rem /= dst_dims[i];
+      }
+      std::memcpy(dst_data + run * run_bytes, src_data + src_offset, run_bytes);
+    }
+  };
+  host->ParallelFor(num_runs, std::move(compute),
+                    [chain = chain.CopyRef()]() mutable { chain.emplace(); },
+                    std::max<size_t>(1, (1 << 16) / run_bytes));
+  return chain;
+}
+
+AsyncValueRef<Chain> ConcatTensors(ArrayRef<const DenseHostTensor*> srcs,
+                                   int axis, DenseHostTensor* dst,
+                                   HostContext* host) {
+  if (srcs.empty())
+    return host->MakeErrorAsyncValueRef("dht.concat: no inputs");
+
+  int rank = dst->shape().GetRank();
+  if (axis < 0 || axis >= rank)
+    return host->MakeErrorAsyncValueRef("dht.concat: invalid axis");
+
+  SmallVector<ssize_t, 4> dst_dims;
+  dst->shape().GetDimensions(&dst_dims);
+  ssize_t axis_sum = 0;
+  for (const DenseHostTensor* src : srcs) {
+    if (src->dtype() != dst->dtype())
+      return host->MakeErrorAsyncValueRef("dht.concat: dtype mismatch");
+    if (src->shape().GetRank() != rank)
+      return host->MakeErrorAsyncValueRef("dht.concat: rank mismatch");
+    for (int i = 0; i < rank; ++i) {
+      if (i != axis && src->shape().GetDimensionSize(i) != dst_dims[i])
+        return host->MakeErrorAsyncValueRef("dht.concat: shape mismatch");
+    }
+    axis_sum += src->shape().GetDimensionSize(axis);
+  }
+  if (axis_sum != dst_dims[axis])
+    return host->MakeErrorAsyncValueRef(
+        "dht.concat: axis extents do not sum to the output extent");
+
+  if (dst->shape().GetNumElements() == 0) return host->GetReadyChain();
+
+  size_t elem_size = dst->dtype().GetHostSize();
+  char* dst_data = static_cast<char*>(dst->data());
+
+  // Bytes in one axis-slice row, and the outer iteration count over the
+  // dimensions before `axis`. Each (input, outer) pair is one contiguous
+  // block copy.
+  size_t inner_bytes = elem_size;
+  for (int i = axis + 1; i < rank; ++i) inner_bytes *= dst_dims[i];
+  size_t num_outer = 1;
+  for (int i = 0; i < axis; ++i) num_outer *= dst_dims[i];
+  size_t dst_outer_stride = dst_dims[axis] * inner_bytes;
+
+  SmallVector<const char*, 4> src_data;
+  SmallVector<size_t, 4> src_block_bytes;
+  SmallVector<size_t, 4> dst_axis_offset;
+  size_t axis_offset = 0;
+  size_t max_block_bytes = 1;
+  for (const DenseHostTensor* src : srcs) {
+    size_t block = src->shape().GetDimensionSize(axis) * inner_bytes;
+    src_data.push_back(static_cast<const char*>(src->data()));
+    src_block_bytes.push_back(block);
+    dst_axis_offset.push_back(axis_offset);
+    axis_offset += block;
+    max_block_bytes = std::max(max_block_bytes, block);
+  }
+
+  size_t num_srcs = srcs.size();
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto compute = [=](size_t start, size_t end) {
+    for (size_t task = start; task != end; ++task) {
+      size_t s = task / num_outer;
+      size_t outer = task % num_outer;
+      std::memcpy(
+          dst_data + outer * dst_outer_stride + dst_axis_offset[s],
+          src_data[s] + outer * src_block_bytes[s], src_block_bytes[s]);
+    }
+  };
+  host->ParallelFor(num_srcs * num_outer, std::move(compute),
+                    [chain = chain.CopyRef()]() mutable { chain.emplace(); },
+                    std::max<size_t>(1, (1 << 16) / max_block_bytes));
+  return chain;
+}
+
+//===----------------------------------------------------------------------===//
+// Kernels
+//===----------------------------------------------------------------------===//
+
+static void TransposeDenseTensor(Argument<DenseHostTensor> src,
+                                 Argument<DenseHostTensor> dst,
+                                 Argument<Chain> in_chain,
+                                 Result<Chain> out_chain,
+                                 ArrayAttribute<ssize_t> permutation,
+                                 KernelFrame* frame) {
+  out_chain.Set(TransposeTensor(src.get(), &dst.get(), permutation.data(),
+                                frame->GetHostContext()));
+}
+
+static void SliceDenseTensor(Argument<DenseHostTensor> src,
+                             Argument<DenseHostTensor> dst,
+                             Argument<Chain> in_chain, Result<Chain> out_chain,
+                             ArrayAttribute<ssize_t> begin,
+                             KernelFrame* frame) {
+  out_chain.Set(
+      SliceTensor(src.get(), begin.data(), &dst.get(), frame->GetHostContext()));
+}
+
+static void ConcatDenseTensors(Argument<DenseHostTensor> dst,
+                               Argument<Chain> in_chain,
+                               RepeatedArguments<DenseHostTensor> srcs,
+                               Result<Chain> out_chain,
+                               Attribute<int32_t> axis, KernelFrame* frame) {
+  SmallVector<const DenseHostTensor*, 4> src_tensors;
+  src_tensors.reserve(srcs.size());
+  for (DenseHostTensor& src : srcs) src_tensors.push_back(&src);
+  out_chain.Set(ConcatTensors(src_tensors, *axis, &dst.get(),
+                              frame->GetHostContext()));
+}
+
+void RegisterDenseTensorTransformKernels(KernelRegistry* registry) {
+  registry->AddKernel("dht.transpose", TFRT_KERNEL(TransposeDenseTensor));
+  registry->AddKernel("dht.slice", TFRT_KERNEL(SliceDenseTensor));
+  registry->AddKernel("dht.concat", TFRT_KERNEL(ConcatDenseTensors));
+}
+
+}  // namespace tfrt
@@ -0,0 +1,454 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- simd_elementwise_kernels.cc ------------------------------*- C++ -*-===//
+//
+// This file implements explicitly vectorized elementwise kernels for f32
+// dense host tensors, registered under the tfrt_dht.* prefix. The widest
+// instruction set the host supports (AVX-512, AVX2 or NEON, with a portable
+// scalar fallback) is selected once per process through a function pointer
+// table, so a binary built with baseline flags still uses the wide units of
+// the machine it lands on.
+//
+// sigmoid and tanh use a Cephes-style degree-5 polynomial exp (the same
+// scheme as the well-known sse_mathfun/avx_mathfun kernels), accurate to a
+// couple of float ulps over the clamped range; tanh is computed as
+// sign(x) * (1 - e^-2|x|) / (1 + e^-2|x|), whose absolute error stays below
+// ~1e-7 near zero. The scalar fallback calls libm, so exact bit patterns may
+// differ across instruction sets.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/simd_elementwise_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Scalar fallback
+//===----------------------------------------------------------------------===//
+
+void AddF32Scalar(const float* lhs, const float* rhs, float* out, size_t n) {
+  for (size_t i = 0; i != n; ++i) out[i] = lhs[i] + rhs[i];
+}
+
+void MulF32Scalar(const float* lhs, const float* rhs, float* out, size_t n) {
+  for (size_t i = 0; i != n; ++i) out[i] = lhs[i] * rhs[i];
+}
+
+void ReluF32Scalar(const float* in, float* out, size_t n) {
+  for (size_t i = 0; i != n; ++i) out[i] = std::max(0.0f, in[i]);
+}
+
+void SigmoidF32Scalar(const float* in, float* out, size_t n) {
+  for (size_t i = 0; i != n; ++i) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+void TanhF32Scalar(const float* in, float* out, size_t n) {
+  for (size_t i = 0; i != n; ++i) out[i] = std::tanh(in[i]);
+}
+
+//===----------------------------------------------------------------------===//
+// Vector exp polynomial (shared constants)
+//===----------------------------------------------------------------------===//
+
+// exp(x) is evaluated as 2^n * e^r with n = round(x / ln2) and r in
+// [-ln2/2, ln2/2], where e^r is a degree-5 minimax polynomial and 2^n is
+// built directly in the float exponent field. Inputs are clamped to the
+// range where the result is finite.
+constexpr float kExpHi = 88.3762626647950f;
+constexpr float kExpLo = -88.3762626647949f;
+constexpr float kLog2e = 1.44269504088896341f;
+// ln2 split into a high and a low part so that subtracting n * ln2 from x is
+// exact in float.
+constexpr float kExpC1 = 0.693359375f;
+constexpr float kExpC2 = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+//===----------------------------------------------------------------------===//
+// AVX2 and AVX-512 paths
+//===----------------------------------------------------------------------===//
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2,fma"))) inline __m256 ExpAvx2(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  x = _mm256_min_ps(x, _mm256_set1_ps(kExpHi));
+  x = _mm256_max_ps(x, _mm256_set1_ps(kExpLo));
+
+  __m256 fx = _mm256_fmadd_ps(x, _mm256_set1_ps(kLog2e),
+                              _mm256_set1_ps(0.5f));
+  fx = _mm256_floor_ps(fx);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpC1), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpC2), x);
+
+  __m256 y = _mm256_set1_ps(kExpP0);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, one));
+
+  __m256i n = _mm256_cvttps_epi32(fx);
+  n = _mm256_add_epi32(n, _mm256_set1_epi32(127));
+  n = _mm256_slli_epi32(n, 23);
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(n));
+}
+
+__attribute__((target("avx2,fma"))) void AddF32Avx2(const float* lhs,
+                                                    const float* rhs,
+                                                    float* out, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(lhs + i),
+                                            _mm256_loadu_ps(rhs + i)));
+  for (; i != n; ++i) out[i] = lhs[i] + rhs[i];
+}
+
+__attribute__((target("avx2,fma"))) void MulF32Avx2(const float* lhs,
+                                                    const float* rhs,
+                                                    float* out, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(lhs + i),
+                                            _mm256_loadu_ps(rhs + i)));
+  for (; i != n; ++i) out[i] = lhs[i] * rhs[i];
+}
+
+__attribute__((target("avx2,fma"))) void ReluF32Avx2(const float* in,
+                                                     float* out, size_t n) {
+  const __m256 zero = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_loadu_ps(in + i), zero));
+  for (; i != n; ++i) out[i] = std::max(0.0f, in[i]);
+}
+
+__attribute__((target("avx2,fma"))) void SigmoidF32Avx2(const float* in,
+                                                        float* out, size_t n) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 x = _mm256_loadu_ps(in + i);
+    __m256 e = ExpAvx2(_mm256_sub_ps(_mm256_setzero_ps(), x));
+    _mm256_storeu_ps(out + i, _mm256_div_ps(one, _mm256_add_ps(one, e)));
+  }
+  for (; i != n; ++i) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+__attribute__((target("avx2,fma"))) void TanhF32Avx2(const float* in,
+                                                     float* out, size_t n) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 x = _mm256_loadu_ps(in + i);
+    __m256 sign = _mm256_and_ps(x, sign_mask);
+    __m256 abs_x = _mm256_andnot_ps(sign_mask, x);
+    __m256 e = ExpAvx2(_mm256_mul_ps(abs_x, _mm256_set1_ps(-2.0f)));
+    __m256 t = _mm256_div_ps(_mm256_sub_ps(one, e), _mm256_add_ps(one, e));
+    _mm256_storeu_ps(out + i, _mm256_or_ps(t, sign));
+  }
+  for (; i != n; ++i) out[i] = std::tanh(in[i]);
+}
+
+__attribute__((target("avx512f"))) inline __m512 ExpAvx512(__m512 x) {
+  const __m512 one = _mm512_set1_ps(1.0f);
+  x = _mm512_min_ps(x, _mm512_set1_ps(kExpHi));
+  x = _mm512_max_ps(x, _mm512_set1_ps(kExpLo));
+
+  __m512 fx = _mm512_fmadd_ps(x, _mm512_set1_ps(kLog2e),
+                              _mm512_set1_ps(0.5f));
+  fx = _mm512_roundscale_ps(fx, 0x01);  // floor
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpC1), x);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpC2), x);
+
+  __m512 y = _mm512_set1_ps(kExpP0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, one));
+
+  __m512i n = _mm512_cvttps_epi32(fx);
+  n = _mm512_add_epi32(n, _mm512_set1_epi32(127));
+  n = _mm512_slli_epi32(n, 23);
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(n));
+}
+
+__attribute__((target("avx512f"))) void AddF32Avx512(const float* lhs,
+                                                     const float* rhs,
+                                                     float* out, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(lhs + i),
+                                            _mm512_loadu_ps(rhs + i)));
+  for (; i != n; ++i) out[i] = lhs[i] + rhs[i];
+}
+
+__attribute__((target("avx512f"))) void MulF32Avx512(const float* lhs,
+                                                     const float* rhs,
+                                                     float* out, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(lhs + i),
+                                            _mm512_loadu_ps(rhs + i)));
+  for (; i != n; ++i) out[i] = lhs[i] * rhs[i];
+}
+
+__attribute__((target("avx512f"))) void ReluF32Avx512(const float* in,
+                                                      float* out, size_t n) {
+  const __m512 zero = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(out + i, _mm512_max_ps(_mm512_loadu_ps(in + i), zero));
+  for (; i != n; ++i) out[i] = std::max(0.0f, in[i]);
+}
+
+__attribute__((target("avx512f"))) void SigmoidF32Avx512(const float* in,
+                                                         float* out,
+                                                         size_t n) {
+  const __m512 one = _mm512_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 x = _mm512_loadu_ps(in + i);
+    __m512 e = ExpAvx512(_mm512_sub_ps(_mm512_setzero_ps(), x));
+    _mm512_storeu_ps(out + i, _mm512_div_ps(one, _mm512_add_ps(one, e)));
+  }
+  for (; i != n; ++i) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+__attribute__((target("avx512f"))) void TanhF32Avx512(const float* in,
+                                                      float* out, size_t n) {
+  const __m512 one = _mm512_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 x = _mm512_loadu_ps(in + i);
+    __m512 abs_x = _mm512_abs_ps(x);
+    __m512 e = ExpAvx512(_mm512_mul_ps(abs_x, _mm512_set1_ps(-2.0f)));
+    __m512 t = _mm512_div_ps(_mm512_sub_ps(one, e), _mm512_add_ps(one, e));
+    // Copy the sign of x back onto the magnitude.
+    __m512i sign = _mm512_and_epi32(_mm512_castps_si512(x),
+                                    _mm512_set1_epi32(0x80000000));
+    _mm512_storeu_ps(out + i, _mm512_castsi512_ps(_mm512_or_epi32(
+                                  _mm512_castps_si512(t), sign)));
+  }
+  for (; i != n; ++i) out[i] = std::tanh(in[i]);
+}
+
+#endif  // defined(__x86_64__) || defined(__i386__)
+
+//===----------------------------------------------------------------------===//
+// NEON path
+//===----------------------------------------------------------------------===//
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+
+inline float32x4_t ExpNeon(float32x4_t x) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  x = vminq_f32(x, vdupq_n_f32(kExpHi));
+  x = vmaxq_f32(x, vdupq_n_f32(kExpLo));
+
+  float32x4_t fx =
+      vfmaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(kLog2e));
+  fx = vrndmq_f32(fx);  // floor
+  x = vfmsq_f32(x, fx, vdupq_n_f32(kExpC1));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(kExpC2));
+
+  float32x4_t y = vdupq_n_f32(kExpP0);
+  y = vfmaq_f32(vdupq_n_f32(kExpP1), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP2), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP3), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP4), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP5), y, x);
+  y = vfmaq_f32(vaddq_f32(x, one), y, vmulq_f32(x, x));
+
+  int32x4_t n = vcvtq_s32_f32(fx);
+  n = vaddq_s32(n, vdupq_n_s32(127));
+  n = vshlq_n_s32(n, 23);
+  return vmulq_f32(y, vreinterpretq_f32_s32(n));
+}
+
+void AddF32Neon(const float* lhs, const float* rhs, float* out, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(out + i, vaddq_f32(vld1q_f32(lhs + i), vld1q_f32(rhs + i)));
+  for (; i != n; ++i) out[i] = lhs[i] + rhs[i];
+}
+
+void MulF32Neon(const float* lhs, const float* rhs, float* out, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(out + i, vmulq_f32(vld1q_f32(lhs + i), vld1q_f32(rhs + i)));
+  for (; i != n; ++i) out[i] = lhs[i] * rhs[i];
+}
+
+void ReluF32Neon(const float* in, float* out, size_t n) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(out + i, vmaxq_f32(vld1q_f32(in + i), zero));
+  for (; i != n; ++i) out[i] = std::max(0.0f, in[i]);
+}
+
+void SigmoidF32Neon(const float* in, float* out, size_t n) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t x = vld1q_f32(in + i);
+    float32x4_t e = ExpNeon(vnegq_f32(x));
+    vst1q_f32(out + i, vdivq_f32(one, vaddq_f32(one, e)));
+  }
+  for (; i != n; ++i) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+void TanhF32Neon(const float* in, float* out, size_t n) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t x = vld1q_f32(in + i);
+    float32x4_t abs_x = vabsq_f32(x);
+    float32x4_t e = ExpNeon(vmulq_f32(abs_x, vdupq_n_f32(-2.0f)));
+    float32x4_t t = vdivq_f32(vsubq_f32(one, e), vaddq_f32(one, e));
+    // Copy the sign of x back onto the magnitude.
+    uint32x4_t sign =
+        vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000));
+    vst1q_f32(out + i, vreinterpretq_f32_u32(
+                           vorrq_u32(vreinterpretq_u32_f32(t), sign)));
+  }
+  for (; i != n; ++i) out[i] = std::tanh(in[i]);
+}
+
+#endif  // defined(__aarch64__) && defined(__ARM_NEON)
+
+//===----------------------------------------------------------------------===//
+// Instruction set dispatch
+//===----------------------------------------------------------------------===//
+
+struct ElementwiseOps {
+  void (*add)(const float*, const float*, float*, size_t);
+  void (*mul)(const float*, const float*, float*, size_t);
+  void (*relu)(const float*, float*, size_t);
+  void (*sigmoid)(const float*, float*, size_t);
+  void (*tanh)(const float*, float*, size_t);
+};
+
+// Returns the kernel table for the widest instruction set this host
+// supports. Resolved once; an instruction set is a process-wide property, so
+// every HostContext in the process shares the table.
+const ElementwiseOps& GetElementwiseOps() {
+  static const ElementwiseOps ops = [] {
+    ElementwiseOps ops{AddF32Scalar, MulF32Scalar, ReluF32Scalar,
+                       SigmoidF32Scalar, TanhF32Scalar};
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx512f")) {
+      ops = {AddF32Avx512, MulF32Avx512, ReluF32Avx512, SigmoidF32Avx512,
+             TanhF32Avx512};
+    } else if (__builtin_cpu_supports("avx2") &&
+               __builtin_cpu_supports("fma")) {
+      ops = {AddF32Avx2, MulF32Avx2, ReluF32Avx2, SigmoidF32Avx2,
+             TanhF32Avx2};
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    ops = {AddF32Neon, MulF32Neon, ReluF32Neon, SigmoidF32Neon, TanhF32Neon};
+#endif
+    return ops;
+  }();
+  return ops;
+}
+
+//===----------------------------------------------------------------------===//
+// Kernels
+//===----------------------------------------------------------------------===//
+
+static Expected<Chain> SimdAddF32(DHTArrayView<float> lhs,
+                                  DHTArrayView<float> rhs,
+                                  MutableDHTArrayView<float> dest) {
+  if (lhs.NumElements() != dest.NumElements() ||
+      rhs.NumElements() != dest.NumElements())
+    return MakeStringError("tfrt_dht.add.f32: tensor sizes do not match");
+  GetElementwiseOps().add(lhs.data(), rhs.data(), dest.data(),
+                          dest.NumElements());
+  return Chain();
+}
+
+static Expected<Chain> SimdMulF32(DHTArrayView<float> lhs,
+                                  DHTArrayView<float> rhs,
+                                  MutableDHTArrayView<float> dest) {
+  if (lhs.NumElements() != dest.NumElements() ||
+      rhs.NumElements() != dest.NumElements())
+    return MakeStringError("tfrt_dht.mul.f32: tensor sizes do not match");
+  GetElementwiseOps().mul(lhs.data(), rhs.data(), dest.data(),
+                          dest.NumElements());
+  return Chain();
+}
+
+static Expected<Chain> SimdReluF32(DHTArrayView<float> in,
+                                   MutableDHTArrayView<float> dest) {
+  if (in.NumElements() != dest.NumElements())
+    return MakeStringError("tfrt_dht.relu.f32: tensor sizes do not match");
+  GetElementwiseOps().relu(in.data(), dest.data(), dest.NumElements());
+  return Chain();
+}
+
+static Expected<Chain> SimdSigmoidF32(DHTArrayView<float> in,
+                                      MutableDHTArrayView<float> dest) {
+  if (in.NumElements() != dest.NumElements())
+    return MakeStringError("tfrt_dht.sigmoid.f32: tensor sizes do not match");
+  GetElementwiseOps().sigmoid(in.data(), dest.data(), dest.NumElements());
+  return Chain();
+}
+
+static Expected<Chain> SimdTanhF32(DHTArrayView<float> in,
+                                   MutableDHTArrayView<float> dest) {
+  if (in.NumElements() != dest.NumElements())
+    return MakeStringError("tfrt_dht.tanh.f32: tensor sizes do not match");
+  GetElementwiseOps().tanh(in.data(), dest.data(), dest.NumElements());
+  return Chain();
+}
+
+}  // namespace
+
+void RegisterSimdElementwiseKernels(KernelRegistry* registry) {
+  registry->AddKernel("tfrt_dht.add.f32", TFRT_KERNEL(SimdAddF32));
+  registry->AddKernel("tfrt_dht.mul.f32", TFRT_KERNEL(SimdMulF32));
+  registry->AddKernel("tfrt_dht.relu.f32", TFRT_KERNEL(SimdReluF32));
+  registry->AddKernel("tfrt_dht.sigmoid.f32", TFRT_KERNEL(SimdSigmoidF32));
+  registry->AddKernel("tfrt_dht.tanh.f32", TFRT_KERNEL(SimdTanhF32));
+}
+
+}  // namespace tfrt
@@ -21,9 +21,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/tensor/chunked_host_tensor.h"
 #include "tfrt/tensor/coo_host_tensor.h"
 #include "tfrt/tensor/dense_host_tensor_kernels.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/dense_tensor_transforms.h"
+#include "tfrt/tensor/simd_elementwise_kernels.h"
+#include "tfrt/tensor/strided_host_tensor.h"
 #include "tfrt/tensor/string_host_tensor_kernels.h"
 #include "tfrt/tensor/tensor_shape.h"
 
@@ -33,7 +37,11 @@ namespace tfrt {
 static void Register(KernelRegistry* registry) {
   RegisterTensorShapeKernels(registry);
   RegisterDenseHostTensorKernels(registry);
+  RegisterDenseTensorTransformKernels(registry);
   RegisterCooHostTensorKernels(registry);
+  RegisterChunkedHostTensorKernels(registry);
+  RegisterSimdElementwiseKernels(registry);
+  RegisterStridedHostTensorKernels(registry);
   RegisterStringHostTensorKernels(registry);
 }
 
@@ -0,0 +1,179 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- strided_host_tensor.cc ---------------------------------------------===//
+//
+// This file implements the StridedHostTensor class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/strided_host_tensor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+// Returns the row-major element strides of `shape`.
+static SmallVector<ssize_t, 4> ContiguousStrides(const TensorShape& shape) {
+  int rank = shape.GetRank();
+  SmallVector<ssize_t, 4> strides(rank);
+  ssize_t stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= shape.GetDimensionSize(i);
+  }
+  return strides;
+}
+
+StridedHostTensor StridedHostTensor::SliceView(const DenseHostTensor& dht,
+                                               ArrayRef<ssize_t> begin,
+                                               ArrayRef<ssize_t> sizes) {
+  int rank = dht.shape().GetRank();
+  assert(begin.size() == static_cast<size_t>(rank) &&
+         sizes.size() == static_cast<size_t>(rank));
+  auto strides = ContiguousStrides(dht.shape());
+  ssize_t offset = 0;
+  for (int i = 0; i != rank; ++i) {
+    assert(begin[i] >= 0 &&
+           begin[i] + sizes[i] <= dht.shape().GetDimensionSize(i));
+    offset += begin[i] * strides[i];
+  }
+  return StridedHostTensor(TensorMetadata(dht.dtype(), sizes),
+                           dht.buffer().CopyRef(),
+                           offset * dht.dtype().GetHostSize(),
+                           std::move(strides));
+}
+
+StridedHostTensor StridedHostTensor::TransposeView(const DenseHostTensor& dht,
+                                                   ArrayRef<ssize_t> perm) {
+  int rank = dht.shape().GetRank();
+  assert(perm.size() == static_cast<size_t>(rank));
+  auto src_strides = ContiguousStrides(dht.shape());
+  SmallVector<ssize_t, 4> dims(rank);
+  SmallVector<ssize_t, 4> strides(rank);
+  for (int i = 0; i != rank; ++i) {
+    dims[i] = dht.shape().GetDimensionSize(perm[i]);
+    strides[i] = src_strides[perm[i]];
+  }
+  return StridedHostTensor(TensorMetadata(dht.dtype(), dims),
+                           dht.buffer().CopyRef(), /*offset_in_bytes=*/0,
+                           std::move(strides));
+}
+
+AsyncValueRef<HostTensor> StridedHostTensor::ConvertToHostTensor(
+    HostContext* host, uint32_t allowed_formats) const {
+  // If the caller allows StridedHostTensor, the conversion is another view of
+  // the same buffer.
+  if (allowed_formats &
+      (1 << static_cast<uint32_t>(Tensor::Subclass::StridedHost))) {
+    return host->MakeConcreteAsyncValueRef<StridedHostTensor>(
+        metadata(), buffer_.CopyRef(), offset_in_bytes_,
+        SmallVector<ssize_t, 4>(strides_.begin(), strides_.end()));
+  }
+
+  assert(allowed_formats &
+         (1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost)));
+  auto result_alloc = DenseHostTensor::CreateUninitialized(metadata(), host);
+  if (!result_alloc)
+    return host->MakeErrorAsyncValueRef(
+        "out of memory converting strided tensor to dht tensor");
+  auto& result_tensor = result_alloc.getValue();
+
+  int rank = shape().GetRank();
+  size_t elem_size = dtype().GetHostSize();
+  const char* src = static_cast<const char*>(data());
+  char* dst = static_cast<char*>(result_tensor.data());
+
+  if (rank == 0) {
+    std::memcpy(dst, src, elem_size);
+  } else {
+    // Walk the view in destination (row-major) order. When the innermost
+    // stride is 1 the innermost dimension is contiguous in the source, so
+    // copy it row by row; otherwise copy element by element.
+    SmallVector<ssize_t, 4> dims(rank);
+    shape().GetDimensions(dims);
+    bool rows_contiguous = strides_[rank - 1] == 1;
+    ssize_t row_elems = dims[rank - 1];
+    ssize_t num_rows = 1;
+    for (int i = 0; i < rank - 1; ++i) num_rows *= dims[i];
+
+    SmallVector<ssize_t, 4> index(rank, 0);
+    for (ssize_t row = 0; row != num_rows; ++row) {
+      ssize_t src_offset = 0;
+      for (int i = 0; i < rank - 1; ++i) src_offset += index[i] * strides_[i];
+      if (rows_contiguous) {
+        std::memcpy(dst, src + src_offset * elem_size, row_elems * elem_size);
+        dst += row_elems * elem_size;
+      } else {
+        for (ssize_t j = 0; j != row_elems; ++j) {
+          std::memcpy(dst, src + (src_offset + j * strides_[rank - 1]) * elem_size,
+                      elem_size);
+          dst += elem_size;
+        }
+      }
+      for (int i = rank - 2; i >= 0; --i) {
+        if (++index[i] != dims[i]) break;
+        index[i] = 0;
+      }
+    }
+  }
+
+  auto result = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  result.emplace(std::move(result_tensor));
+  return result;
+}
+
+void StridedHostTensor::Print(raw_ostream& os) const {
+  os << "StridedHostTensor dtype = " << dtype() << " shape = " << shape()
+     << " strides = [";
+  for (size_t i = 0, e = strides_.size(); i != e; ++i) {
+    if (i != 0) os << ", ";
+    os << strides_[i];
+  }
+  os << ']';
+
+  auto element_size = dtype().GetHostSize();
+  const char* data_ptr = static_cast<const char*>(data());
+
+  int rank = shape().GetRank();
+  SmallVector<ssize_t, 4> dims(rank);
+  shape().GetDimensions(dims);
+  SmallVector<ssize_t, 4> index(rank, 0);
+
+  // Print at most 32 elements for a tensor.
+  static const ssize_t kThreshold = 32;
+  os << ", values = [";
+  for (ssize_t i = 0, e = std::min(kThreshold, NumElements()); i != e; ++i) {
+    if (i != 0) os << ", ";
+    ssize_t offset = 0;
+    for (int d = 0; d != rank; ++d) offset += index[d] * strides_[d];
+    dtype().Print(data_ptr + offset * element_size, os);
+    for (int d = rank - 1; d >= 0; --d) {
+      if (++index[d] != dims[d]) break;
+      index[d] = 0;
+    }
+  }
+  if (NumElements() > kThreshold) {
+    os << ", ... ";
+  }
+  os << ']';
+}
+
+}  // namespace tfrt
@@ -0,0 +1,106 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- strided_host_tensor_kernels.cc -------------------------------------===//
+//
+// This file implements the kernels for strided host tensors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/strided_host_tensor.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+
+// Creates a view of the region of a dense tensor starting at `begin` with
+// extents `sizes` without copying: the view aliases the source buffer.
+static void SliceViewDht(Argument<DenseHostTensor> in, Argument<Chain> in_chain,
+                         Result<StridedHostTensor> out, Result<Chain> out_chain,
+                         ArrayAttribute<ssize_t> begin,
+                         ArrayAttribute<ssize_t> sizes,
+                         KernelErrorHandler handler) {
+  size_t rank = in->shape().GetRank();
+  if (begin.size() != rank || sizes.size() != rank) {
+    handler.ReportError("dht.slice_view begin and sizes must match the rank ",
+                        rank, " of the input");
+    return;
+  }
+  for (size_t i = 0; i != rank; ++i) {
+    if (begin[i] < 0 || sizes[i] < 0 ||
+        begin[i] + sizes[i] > in->shape().GetDimensionSize(i)) {
+      handler.ReportError("dht.slice_view region is out of bounds for input "
+                          "shape ",
+                          in->shape());
+      return;
+    }
+  }
+  out.Emplace(StridedHostTensor::SliceView(in.get(), begin.data(),
+                                           sizes.data()));
+  out_chain.Set(in_chain);
+}
+
+// Creates a transposed view of a dense tensor without copying: result
+// dimension i is source dimension perm[i] and the view aliases the source
+// buffer.
+static void TransposeViewDht(Argument<DenseHostTensor> in,
+                             Argument<Chain> in_chain,
+                             Result<StridedHostTensor> out,
+                             Result<Chain> out_chain,
+                             ArrayAttribute<ssize_t> perm,
+                             KernelErrorHandler handler) {
+  size_t rank = in->shape().GetRank();
+  if (perm.size() != rank) {
+    handler.ReportError("dht.transpose_view permutation must match the rank ",
+                        rank, " of the input");
+    return;
+  }
+  SmallVector<bool, 4> seen(rank, false);
+  for (size_t i = 0; i != rank; ++i) {
+    if (perm[i] < 0 || static_cast<size_t>(perm[i]) >= rank ||
+        seen[perm[i]]) {
+      handler.ReportError(
+          "dht.transpose_view permutation is not a permutation of the input "
+          "dimensions");
+      return;
+    }
+    seen[perm[i]] = true;
+  }
+  out.Emplace(StridedHostTensor::TransposeView(in.get(), perm.data()));
+  out_chain.Set(in_chain);
+}
+
+// Converts a StridedHostTensor to a contiguous DenseHostTensor (this is where
+// the element data is finally copied).
+static void ConvertStridedToDht(Argument<StridedHostTensor> in,
+                                Argument<Chain> in_chain,
+                                Result<DenseHostTensor> out,
+                                Result<Chain> out_chain, KernelFrame* frame) {
+  uint32_t allowed_formats =
+      1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost);
+  auto host_tensor =
+      in.get().ConvertToHostTensor(frame->GetHostContext(), allowed_formats);
+  out.Set(AsyncValueRef<DenseHostTensor>(host_tensor.ReleaseRCRef()));
+  out_chain.Set(in_chain);
+}
+
+void RegisterStridedHostTensorKernels(KernelRegistry* registry) {
+  registry->AddKernel("dht.slice_view", TFRT_KERNEL(SliceViewDht));
+  registry->AddKernel("dht.transpose_view", TFRT_KERNEL(TransposeViewDht));
+  registry->AddKernel("strided.convert_strided_to_dht",
+                      TFRT_KERNEL(ConvertStridedToDht));
+}
+
+}  // namespace tfrt
@@ -20,26 +20,45 @@
 
 #include "tfrt/tensor/string_host_tensor.h"
 
+#include <cstring>
+
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/host_context/host_context.h"
 
 namespace tfrt {
 
-llvm::Optional<StringHostTensor> StringHostTensor::CreateUninitialized(
-    const TensorMetadata& metadata, HostContext* host) {
+llvm::Optional<StringHostTensor> StringHostTensor::CreateFromStrings(
+    const TensorMetadata& metadata, ArrayRef<string_view> strings,
+    HostContext* host) {
   auto num_elements = metadata.shape.GetNumElements();
-  HostArray<std::string> strings(num_elements, host->allocator());
-  for (auto& str : strings.mutable_array()) {
-    new (&str) std::string();
+  assert(strings.size() == num_elements &&
+         "strings must have one entry per element");
+
+  size_t arena_size = 0;
+  for (string_view str : strings) arena_size += str.size();
+
+  HostArray<size_t> offsets(num_elements + 1, host->allocator());
+  auto characters = HostBuffer::CreateUninitialized(
+      arena_size, /*alignment=*/1, host->allocator());
+  if (!characters) return llvm::None;
+
+  char* arena = static_cast<char*>(characters->data());
+  size_t offset = 0;
+  for (ssize_t i = 0; i != num_elements; ++i) {
+    new (&offsets.mutable_array()[i]) size_t(offset);
+    std::memcpy(arena + offset, strings[i].data(), strings[i].size());
+    offset += strings[i].size();
   }
+  new (&offsets.mutable_array()[num_elements]) size_t(offset);
 
-  return StringHostTensor(metadata, std::move(strings));
+  return StringHostTensor(metadata, std::move(offsets), std::move(characters));
 }
 
 AsyncValueRef<StringHostTensor> StringHostTensor::MakeConstructedAsyncValueRef(
-    const TensorMetadata& metadata, HostContext* host) {
-  if (auto result = CreateUninitialized(metadata, host))
+    const TensorMetadata& metadata, ArrayRef<string_view> strings,
+    HostContext* host) {
+  if (auto result = CreateFromStrings(metadata, strings, host))
     return host->MakeConstructedAsyncValueRef<StringHostTensor>(
         std::move(result).getValue());
 
@@ -55,13 +74,11 @@ void StringHostTensor::Print(raw_ostream& os) const {
   const auto& shape = this->shape();
   os << "SHT shape = " << shape;
 
-  auto strings = this->strings();
-
-  static constexpr size_t kThreshold = 32;
+  static constexpr ssize_t kThreshold = 32;
   if (NumElements() > kThreshold) {
     llvm::MD5 hash;
-    for (auto& str : strings) {
-      hash.update(str);
+    for (ssize_t i = 0, e = NumElements(); i != e; ++i) {
+      hash.update(GetString(i));
     }
     llvm::MD5::MD5Result result;
     hash.final(result);
@@ -70,12 +87,12 @@ void StringHostTensor::Print(raw_ostream& os) const {
 
   os << ", values = [";
   // Print at most 32 elements for a tensor.
-  for (size_t i = 0, e = std::min(kThreshold, strings.size()); i != e; ++i) {
+  for (ssize_t i = 0, e = std::min(kThreshold, NumElements()); i != e; ++i) {
     if (i != 0) os << ", ";
-    os << '"' << strings[i] << '"';
+    os << '"' << GetString(i) << '"';
   }
 
-  if (NumElements() > 32) {
+  if (NumElements() > kThreshold) {
     os << ", ... ";
   }
 
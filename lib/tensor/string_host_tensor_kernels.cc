@@ -30,18 +30,20 @@ namespace {
 llvm::Expected<StringHostTensor> CreateStringTensor(
     ArrayAttribute<ssize_t> shape, AggregateAttribute values,
     HostContext* host) {
-  auto result = StringHostTensor::CreateUninitialized(
-      TensorMetadata(DType(DType::String), shape.data()), host);
-  if (!result) {
-    return MakeStringError("Failed to create SHT");
-  }
-
-  auto strings = result->strings();
-  if (strings.size() != values.size()) {
+  TensorMetadata metadata(DType(DType::String), shape.data());
+  if (metadata.shape.GetNumElements() != values.size()) {
     return MakeStringError("Shape mismatch");
   }
+
+  SmallVector<string_view, 8> strings;
+  strings.reserve(values.size());
   for (int i = 0, e = values.size(); i != e; ++i) {
-    strings[i] = values.GetStringAttribute(i).str();
+    strings.push_back(values.GetStringAttribute(i).get());
+  }
+
+  auto result = StringHostTensor::CreateFromStrings(metadata, strings, host);
+  if (!result) {
+    return MakeStringError("Failed to create SHT");
   }
 
   return std::move(result).getValue();
@@ -20,13 +20,73 @@
 
 #include "tfrt/tensor/tensor.h"
 
+#include <utility>
+
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 #include "tfrt/tensor/host_tensor.h"
 
 namespace tfrt {
 
-Tensor::~Tensor() {}
+class Tensor::ConversionMemo {
+ public:
+  // Return the memoized conversion for `allowed_formats`, or a null ref if
+  // none has been recorded yet.
+  AsyncValueRef<HostTensor> Lookup(uint32_t allowed_formats) {
+    mutex_lock lock(mu_);
+    for (auto& entry : entries_)
+      if (entry.first == allowed_formats) return entry.second.CopyRef();
+    return AsyncValueRef<HostTensor>();
+  }
+
+  // Record `converted` as the conversion for `allowed_formats`. If another
+  // thread raced us here, the first recorded conversion wins.
+  void Insert(uint32_t allowed_formats, AsyncValueRef<HostTensor> converted) {
+    mutex_lock lock(mu_);
+    for (auto& entry : entries_)
+      if (entry.first == allowed_formats) return;
+    entries_.emplace_back(allowed_formats, std::move(converted));
+  }
+
+ private:
+  mutex mu_;
+  // Ops on one op_handler ask for the same format mask, so one entry is the
+  // common case.
+  llvm::SmallVector<std::pair<uint32_t, AsyncValueRef<HostTensor>>, 1> entries_
+      TFRT_GUARDED_BY(mu_);
+};
+
+Tensor::~Tensor() { DropConversionMemo(); }
+
+void Tensor::DropConversionMemo() const {
+  delete conversion_memo_.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+AsyncValueRef<HostTensor> Tensor::ConvertToHostTensorCached(
+    HostContext* host, uint32_t allowed_formats) const {
+  auto* memo = conversion_memo_.load(std::memory_order_acquire);
+  if (!memo) {
+    auto* new_memo = new ConversionMemo();
+    if (conversion_memo_.compare_exchange_strong(memo, new_memo,
+                                                 std::memory_order_acq_rel)) {
+      memo = new_memo;
+    } else {
+      // Another thread installed a memo first; use theirs.
+      delete new_memo;
+    }
+  }
+
+  if (auto cached = memo->Lookup(allowed_formats)) return cached;
+
+  auto converted = ConvertToHostTensor(host, allowed_formats);
+  // A failed conversion (e.g. OOM) is not worth pinning for the lifetime of
+  // the tensor; retry it on the next request instead.
+  if (!converted.IsError()) memo->Insert(allowed_formats, converted.CopyRef());
+  return converted;
+}
 
 raw_ostream& operator<<(raw_ostream& os, const TensorMetadata& metadata) {
   if (metadata.dtype.kind() == DType::Invalid) {
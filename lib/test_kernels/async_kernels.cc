@@ -60,12 +60,30 @@ static void TestAsyncCopy2(Argument<int32_t> in, Result<int32_t> out,
   });
 }
 
+// Adds three numbers in two background stages. Each intermediate result is
+// awaited with HostContext::Await, so the kernel reads as straight-line code
+// even though each stage may suspend into the work queue.
+static void TestAsyncAdd3(Argument<int32_t> a, Argument<int32_t> b,
+                          Argument<int32_t> c, Result<int32_t> out,
+                          HostContext* host) {
+  host->Await(HexAsyncAddI32(*a, *b, host),
+              [c = *c, out_ref = out.Allocate(),
+               host](AsyncValueRef<int32_t> ab) mutable {
+                host->Await(HexAsyncAddI32(ab.get(), c, host),
+                            [out_ref = std::move(out_ref)](
+                                AsyncValueRef<int32_t> abc) mutable {
+                              out_ref.emplace(abc.get());
+                            });
+              });
+}
+
 // Install some async kernels for use by the test driver.
 void RegisterAsyncKernels(KernelRegistry* registry) {
   registry->AddKernel("hex.async_constant.i1", TFRT_KERNEL(HexAsyncConstantI1));
   registry->AddKernel("hex.async_constant.i32",
                       TFRT_KERNEL(HexAsyncConstantI32));
   registry->AddKernel("hex.async_add.i32", TFRT_KERNEL(HexAsyncAddI32));
+  registry->AddKernel("hex.async_add3.i32", TFRT_KERNEL(TestAsyncAdd3));
   registry->AddKernel("hex.async_copy.i32", TFRT_KERNEL(TestAsyncCopy));
   registry->AddKernel("hex.async_copy_2.i32", TFRT_KERNEL(TestAsyncCopy2));
 }
@@ -20,11 +20,15 @@
 
 #include <cassert>
 #include <chrono>
+#include <cstdlib>
 #include <ctime>
 
 #include "llvm/ADT/FunctionExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/host_context/function.h"
+#include "tfrt/host_context/host_allocator.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/support/ostream.h"
@@ -66,6 +70,7 @@ class BenchmarkRunner {
   void Start(llvm::unique_function<void()> clean_up) {
     clean_up_ = std::move(clean_up);
     total_duration_walltime_ = std::chrono::microseconds(0);
+    SnapshotAllocatorBaseline();
     StartNewRun();
   }
 
@@ -107,11 +112,22 @@ class BenchmarkRunner {
     });
   }
 
+  // Re-read the allocator's cumulative counters. Taken when the benchmark
+  // starts and again after every warm-up run, so the reported per-iteration
+  // numbers cover exactly the measured runs.
+  void SnapshotAllocatorBaseline() {
+    allocs_at_start_ = host_->allocator()->GetCumulativeAllocationCount();
+    bytes_at_start_ = host_->allocator()->GetCumulativeAllocatedBytes();
+  }
+
   // Stop benchmarking a function execution.
   void StopRun() {
     // Do not collect the runtime statistics if we are still in the warm up
     // period.
-    if (cur_count_ < num_warmup_runs_) return;
+    if (cur_count_ < num_warmup_runs_) {
+      SnapshotAllocatorBaseline();
+      return;
+    }
 
     // Stop the wall clock timer.
     auto cur_stop_walltime_ = std::chrono::steady_clock::now();
@@ -140,6 +156,11 @@ class BenchmarkRunner {
 
   // Return true if more runs of func are needed.
   bool MoreRun() const {
+    // A zero duration selects fixed-iteration mode: exactly max_count
+    // measured runs regardless of how long they take, which makes totals
+    // directly comparable across work-queue configurations.
+    if (benchmark_duration_.count() == 0)
+      return cur_count_ < max_count_ + num_warmup_runs_;
     return cur_count_ < max_count_ + num_warmup_runs_ &&
            total_duration_walltime_ < benchmark_duration_;
   }
@@ -185,7 +206,90 @@ class BenchmarkRunner {
     tfrt::outs() << prefix
                  << "CPU 99%(us): " << percentile(0.99, run_times_cpu_).count()
                  << '\n';
+
+    // Throughput over the measured runs. The runs execute serially, so this
+    // is the inverse of mean latency; in fixed-iteration mode it is the
+    // number to compare across work-queue configurations.
+    const size_t count = run_times_walltime_.size();
+    const double total_secs = total_duration_walltime_.count() / 1e6;
+    const double iters_per_sec = total_secs > 0 ? count / total_secs : 0.0;
+    tfrt::outs() << prefix << "Throughput(iters/s): "
+                 << llvm::format("%.1f", iters_per_sec) << '\n';
+
+    // Per-iteration allocator traffic, when the host allocator counts it
+    // (e.g. the profiled allocator).
+    int64_t allocs_per_iter = -1;
+    int64_t bytes_per_iter = -1;
+    if (count > 0 && allocs_at_start_ >= 0)
+      allocs_per_iter =
+          (host_->allocator()->GetCumulativeAllocationCount() -
+           allocs_at_start_) /
+          static_cast<int64_t>(count);
+    if (count > 0 && bytes_at_start_ >= 0)
+      bytes_per_iter = (host_->allocator()->GetCumulativeAllocatedBytes() -
+                        bytes_at_start_) /
+                       static_cast<int64_t>(count);
+    if (allocs_per_iter >= 0)
+      tfrt::outs() << prefix << "Allocs/Iter: " << allocs_per_iter << '\n';
+    if (bytes_per_iter >= 0)
+      tfrt::outs() << prefix << "Bytes/Iter: " << bytes_per_iter << '\n';
+
+    // Optional latency SLO gate: when TFRT_BENCHMARK_P99_SLO_US is set,
+    // compare p99 wall time against it and print a PASS/FAIL line that
+    // integration benchmarks FileCheck, so a latency regression fails CI
+    // instead of first showing up in a production canary.
+    if (const char* slo_env = getenv("TFRT_BENCHMARK_P99_SLO_US")) {
+      const int64_t slo_us = atoll(slo_env);
+      if (slo_us > 0) {
+        const int64_t p99_us = percentile(0.99, run_times_walltime_).count();
+        tfrt::outs() << prefix << "SLO(p99<=" << slo_us
+                     << "us): " << (p99_us <= slo_us ? "PASS" : "FAIL")
+                     << " (p99=" << p99_us << "us)\n";
+      }
+    }
     tfrt::outs().flush();
+
+    AppendCsvRow(count, iters_per_sec, allocs_per_iter, bytes_per_iter);
+  }
+
+  // Append one machine-readable row for this benchmark to the file named by
+  // the TFRT_BENCHMARK_CSV environment variable, creating it with a header
+  // row first. Regression harnesses diff these files instead of parsing the
+  // BM: lines above.
+  void AppendCsvRow(size_t count, double iters_per_sec,
+                    int64_t allocs_per_iter, int64_t bytes_per_iter) {
+    const char* path = getenv("TFRT_BENCHMARK_CSV");
+    if (path == nullptr) return;
+
+    auto percentile =
+        [](double p, const std::vector<std::chrono::microseconds>& run_times) {
+          return run_times[run_times.size() * p].count();
+        };
+
+    const bool write_header = !llvm::sys::fs::exists(path);
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_Append);
+    if (ec) {
+      tfrt::outs() << "could not append benchmark CSV to " << path << ": "
+                   << ec.message() << '\n';
+      tfrt::outs().flush();
+      return;
+    }
+    if (write_header)
+      os << "name,count,total_us,min_us,p50_us,p95_us,p99_us,cpu_min_us,"
+            "cpu_p50_us,cpu_p95_us,cpu_p99_us,iters_per_sec,allocs_per_iter,"
+            "bytes_per_iter\n";
+    os << name_ << ',' << count << ',' << total_duration_walltime_.count()
+       << ',' << run_times_walltime_.front().count() << ','
+       << percentile(0.5, run_times_walltime_) << ','
+       << percentile(0.95, run_times_walltime_) << ','
+       << percentile(0.99, run_times_walltime_) << ','
+       << run_times_cpu_.front().count() << ','
+       << percentile(0.5, run_times_cpu_) << ','
+       << percentile(0.95, run_times_cpu_) << ','
+       << percentile(0.99, run_times_cpu_) << ','
+       << llvm::format("%.1f", iters_per_sec) << ',' << allocs_per_iter << ','
+       << bytes_per_iter << '\n';
   }
 
   const std::string name_;
@@ -202,6 +306,10 @@ class BenchmarkRunner {
   std::vector<std::chrono::microseconds> run_times_walltime_;
   // CPU run times in microseconds.
   std::vector<std::chrono::microseconds> run_times_cpu_;
+  // Allocator counters at the start of the measured runs, or -1 when the
+  // host allocator does not count them.
+  int64_t allocs_at_start_ = -1;
+  int64_t bytes_at_start_ = -1;
   HostContext* const host_;
 
   // Clean up function to run after the end of the benchmark.
@@ -212,7 +320,9 @@ class BenchmarkRunner {
 // up to a max count or max time as specified in the function's attributes.
 //
 // Attributes:
-// duration_secs: Benchmark duration in seconds.
+// duration_secs: Benchmark duration in seconds. Zero selects fixed-iteration
+//   throughput mode: exactly max_count measured runs regardless of how long
+//   they take.
 // max_count: Max run count of input function.
 // name: The name used to tag the benchmark results.
 // num_warmup_runs: Number of warm up runs before benchmarking starts.
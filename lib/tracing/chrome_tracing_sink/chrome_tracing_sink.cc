@@ -0,0 +1,214 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- chrome_tracing_sink.cc - Chrome Trace Event Sink -------------------===//
+//
+// This file implements a tracing sink that keeps each thread's activities in
+// a per-thread lane and serializes the lanes to Chrome trace-event JSON on
+// demand. Kernel scopes become complete ("X") events and instant events
+// become "i" events, each on the row of the thread that recorded it, so the
+// exported timeline shows exactly how kernel work interleaved across workers
+// and where workers sat idle. The format is documented at
+// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+// and loads in chrome://tracing and Perfetto.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef NO_TFRT_TRACING
+#include "tfrt/tracing/chrome_tracing_sink/chrome_tracing_sink.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/logging.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace internal {
+namespace tracing {
+namespace {
+
+static auto process_start = CurrentSteadyClockTime();
+
+// One recorded activity. duration_ns is negative for instant events.
+struct LaneEvent {
+  uint64_t start_ns;  // Relative to process start.
+  int64_t duration_ns;
+  std::string title;
+};
+
+// Cap per lane so a tracing run left on by accident cannot grow without
+// bound. ~100 bytes per event puts a full lane in the low hundreds of MB.
+constexpr size_t kMaxEventsPerLane = 1 << 21;
+
+class ThreadLane;
+
+// All live thread lanes, plus the lanes of threads that have exited.
+struct LaneRegistry {
+  mutex mu;
+  std::vector<ThreadLane*> lanes TFRT_GUARDED_BY(mu);
+  std::vector<std::pair<uint32_t, std::vector<LaneEvent>>> retired
+      TFRT_GUARDED_BY(mu);
+  uint32_t next_tid TFRT_GUARDED_BY(mu) = 0;
+};
+
+LaneRegistry& GetLaneRegistry() {
+  static LaneRegistry* registry = new LaneRegistry();
+  return *registry;
+}
+
+// One thread's events. Appends and snapshots take the lane mutex; only the
+// export path ever contends with the owning thread, so recording is an
+// uncontended lock plus a vector push in the steady state.
+class ThreadLane {
+ public:
+  ThreadLane() {
+    auto& registry = GetLaneRegistry();
+    mutex_lock lock(registry.mu);
+    tid_ = registry.next_tid++;
+    registry.lanes.push_back(this);
+  }
+
+  ~ThreadLane() {
+    auto& registry = GetLaneRegistry();
+    mutex_lock lock(registry.mu);
+    auto& lanes = registry.lanes;
+    lanes.erase(std::remove(lanes.begin(), lanes.end(), this), lanes.end());
+    mutex_lock lane_lock(mu_);
+    registry.retired.emplace_back(tid_, std::move(events_));
+  }
+
+  void Record(LaneEvent event) {
+    mutex_lock lock(mu_);
+    if (events_.size() < kMaxEventsPerLane)
+      events_.push_back(std::move(event));
+  }
+
+  uint32_t tid() const { return tid_; }
+
+  std::vector<LaneEvent> Snapshot() const {
+    mutex_lock lock(mu_);
+    return events_;
+  }
+
+ private:
+  uint32_t tid_;
+  mutable mutex mu_;
+  std::vector<LaneEvent> events_ TFRT_GUARDED_BY(mu_);
+};
+
+// Writes `str` as a JSON string literal, escaping the characters the format
+// requires.
+void WriteJsonString(llvm::raw_ostream& os, const std::string& str) {
+  os << '"';
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          os << llvm::format("\\u%04x", c);
+        else
+          os << c;
+    }
+  }
+  os << '"';
+}
+
+void WriteEvent(llvm::raw_ostream& os, uint32_t tid, const LaneEvent& event,
+                bool* first) {
+  if (!*first) os << ",\n";
+  *first = false;
+  const double ts_us = event.start_ns / 1000.0;
+  if (event.duration_ns >= 0) {
+    os << R"({"ph":"X","pid":0,"tid":)" << tid << ",\"ts\":"
+       << llvm::format("%.3f", ts_us) << ",\"dur\":"
+       << llvm::format("%.3f", event.duration_ns / 1000.0) << ",\"name\":";
+  } else {
+    os << R"({"ph":"i","s":"t","pid":0,"tid":)" << tid << ",\"ts\":"
+       << llvm::format("%.3f", ts_us) << ",\"name\":";
+  }
+  WriteJsonString(os, event.title);
+  os << '}';
+}
+
+}  // namespace
+
+void ChromeTracingRecordActivity(TracingActivity& activity) {
+  static thread_local ThreadLane lane;
+
+  LaneEvent event;
+  event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       activity.start_time - process_start)
+                       .count();
+  event.duration_ns =
+      activity.end_time.hasValue()
+          ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+                activity.end_time.getValue() - activity.start_time)
+                .count()
+          : -1;
+  event.title = activity.title;
+
+  lane.Record(std::move(event));
+}
+
+bool WriteChromeTrace(string_view path) {
+  // Snapshot under the registry lock so lanes cannot retire mid-export.
+  std::vector<std::pair<uint32_t, std::vector<LaneEvent>>> lanes;
+  {
+    auto& registry = GetLaneRegistry();
+    mutex_lock lock(registry.mu);
+    lanes = registry.retired;
+    for (const ThreadLane* lane : registry.lanes)
+      lanes.emplace_back(lane->tid(), lane->Snapshot());
+  }
+
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path.str(), ec);
+  if (ec) {
+    TFRT_LOG_ERROR << "could not write chrome trace to " << path.str() << ": "
+                   << ec.message();
+    return false;
+  }
+
+  os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  bool first = true;
+  for (const auto& lane : lanes)
+    for (const LaneEvent& event : lane.second)
+      WriteEvent(os, lane.first, event, &first);
+  os << "\n]}\n";
+  return true;
+}
+
+}  // namespace tracing
+}  // namespace internal
+}  // namespace tfrt
+#endif  // NO_TFRT_TRACING
@@ -19,6 +19,7 @@
 #include <queue>
 #include <ratio>
 
+#include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/None.h"
 #include "llvm/Support/Compiler.h"
 #include "task_queue.h"
@@ -64,6 +65,20 @@ class BlockingWorkQueue
   // wrapped in optional if can't assign it to a worker thread.
   Optional<TaskFunction> RunBlockingTask(TaskFunction task);
 
+  // Allows dynamic threads that run out of blocking work to temporarily join
+  // another work queue's steal set instead of idling: while there is no
+  // blocking task to pick up, a thread repeatedly invokes `steal` and runs
+  // the stolen tasks. `max_lent_threads` is a watermark bounding how many
+  // threads may be lent out at once, so an I/O burst still finds threads
+  // (and the thread spawn path) responsive. Must be called before any tasks
+  // are submitted to this queue.
+  void LendIdleThreadsTo(
+      llvm::unique_function<llvm::Optional<TaskFunction>()> steal,
+      int max_lent_threads) {
+    steal_lent_task_ = std::move(steal);
+    max_lent_threads_ = max_lent_threads;
+  }
+
   void Quiesce();
 
  private:
@@ -118,6 +133,14 @@ class BlockingWorkQueue
 
   // Idle threads must stop waiting for the next task in the `idle_task_queue_`.
   bool stop_waiting_ = false;
+
+  // Thread lending (see LendIdleThreadsTo). `steal_lent_task_` is set once
+  // before any task submission and never changes afterwards.
+  llvm::unique_function<llvm::Optional<TaskFunction>()> steal_lent_task_;
+  int max_lent_threads_ = 0;
+
+  // Number of dynamic threads currently lent out running stolen tasks.
+  int num_lent_threads_ TFRT_GUARDED_BY(mutex_) = 0;
 };
 
 template <typename ThreadingEnvironment>
@@ -221,10 +244,34 @@ Optional<TaskFunction> BlockingWorkQueue<ThreadingEnvironment>::RunBlockingTask(
 
       mutex_lock lock(mutex_);
 
-      // Try to get the next task. If one is found, run it. If there is no
-      // task to execute, GetNextTask will return None that converts to
-      // false.
-      while (llvm::Optional<TaskFunction> task = WaitNextTask(&lock)) {
+      for (;;) {
+        // Before going idle, lend this thread to another work queue (see
+        // LendIdleThreadsTo): steal and run its tasks for as long as it has
+        // work, there is no blocking task to pick up, and the number of lent
+        // threads is below the watermark. While lent, the thread is not
+        // counted as idle, so a burst of blocking tasks starts new threads
+        // instead of waiting for stolen tasks to finish.
+        while (steal_lent_task_ && !stop_waiting_ && idle_task_queue_.empty() &&
+               num_lent_threads_ < max_lent_threads_) {
+          ++num_lent_threads_;
+          mutex_.unlock();
+          llvm::Optional<TaskFunction> stolen = steal_lent_task_();
+          const bool executed = stolen.hasValue();
+          if (executed) {
+            (*stolen)();
+            stolen.reset();
+          }
+          mutex_.lock();
+          --num_lent_threads_;
+          // Nothing left to steal. Fall through to waiting for blocking work.
+          if (!executed) break;
+        }
+
+        // Try to get the next task. If one is found, run it. If there is no
+        // task to execute, WaitNextTask will return None that converts to
+        // false.
+        llvm::Optional<TaskFunction> task = WaitNextTask(&lock);
+        if (!task) break;
         mutex_.unlock();
         // Do not hold the lock while executing and destructing the task.
         (*task)();
@@ -154,6 +154,10 @@ class EventCount {
   // Must be called after changing the associated wait predicate.
   void Notify(bool notify_all) {
     std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!notify_all) {
+      NotifyOneAfterFence();
+      return;
+    }
     uint64_t state = state_.load(std::memory_order_acquire);
     for (;;) {
       CheckState(state);
@@ -161,34 +165,31 @@ class EventCount {
       const uint64_t signals = (state & kSignalMask) >> kSignalShift;
       // Easy case: no waiters.
       if ((state & kStackMask) == kStackMask && waiters == signals) return;
-      uint64_t newstate;
-      if (notify_all) {
-        // Empty wait stack and set signal to number of pre-wait threads.
-        newstate =
-            (state & kWaiterMask) | (waiters << kSignalShift) | kStackMask;
-      } else if (signals < waiters) {
-        // There is a thread in pre-wait state, unblock it.
-        newstate = state + kSignalInc;
-      } else {
-        // Pop a waiter from list and unpark it.
-        Waiter* w = &waiters_[state & kStackMask];
-        uint64_t next = w->next.load(std::memory_order_relaxed);
-        newstate = (state & (kWaiterMask | kSignalMask)) | next;
-      }
+      // Empty wait stack and set signal to number of pre-wait threads.
+      uint64_t newstate =
+          (state & kWaiterMask) | (waiters << kSignalShift) | kStackMask;
       CheckState(newstate);
       if (state_.compare_exchange_weak(state, newstate,
                                        std::memory_order_acq_rel)) {
-        if (!notify_all && (signals < waiters))
-          return;  // unblocked pre-wait thread
         if ((state & kStackMask) == kStackMask) return;
         Waiter* w = &waiters_[state & kStackMask];
-        if (!notify_all) w->next.store(kStackMask, std::memory_order_relaxed);
         Unpark(w);
         return;
       }
     }
   }
 
+  // NotifyMany wakes up to `count` waiting threads after a batch of wait
+  // predicate changes, issuing the expensive seq_cst fence only once instead
+  // of once per notification. Must be called after changing the associated
+  // wait predicates.
+  void NotifyMany(unsigned count) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (unsigned i = 0; i < count; ++i) {
+      if (!NotifyOneAfterFence()) return;
+    }
+  }
+
   struct Waiter {
     friend class EventCount;
     // Align to 128 byte boundary to prevent false sharing with other Waiter
@@ -237,6 +238,40 @@ class EventCount {
   std::atomic<uint64_t> state_;
   std::vector<Waiter> waiters_;
 
+  // Wake a single waiting thread. Returns false if there was nobody to wake.
+  // The caller must have issued the seq_cst fence that separates the wait
+  // predicate change from this check.
+  bool NotifyOneAfterFence() {
+    uint64_t state = state_.load(std::memory_order_acquire);
+    for (;;) {
+      CheckState(state);
+      const uint64_t waiters = (state & kWaiterMask) >> kWaiterShift;
+      const uint64_t signals = (state & kSignalMask) >> kSignalShift;
+      // Easy case: no waiters.
+      if ((state & kStackMask) == kStackMask && waiters == signals)
+        return false;
+      uint64_t newstate;
+      if (signals < waiters) {
+        // There is a thread in pre-wait state, unblock it.
+        newstate = state + kSignalInc;
+      } else {
+        // Pop a waiter from list and unpark it.
+        Waiter* w = &waiters_[state & kStackMask];
+        uint64_t next = w->next.load(std::memory_order_relaxed);
+        newstate = (state & (kWaiterMask | kSignalMask)) | next;
+      }
+      CheckState(newstate);
+      if (state_.compare_exchange_weak(state, newstate,
+                                       std::memory_order_acq_rel)) {
+        if (signals < waiters) return true;  // unblocked pre-wait thread
+        Waiter* w = &waiters_[state & kStackMask];
+        w->next.store(kStackMask, std::memory_order_relaxed);
+        Unpark(w);
+        return true;
+      }
+    }
+  }
+
   void Park(Waiter* w) {
     mutex_lock lock(w->mu);
     while (w->state != Waiter::kSignaled) {
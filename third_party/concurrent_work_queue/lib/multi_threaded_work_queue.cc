@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <memory>
 #include <thread>
 
@@ -19,6 +20,9 @@
 #include "tfrt/host_context/async_value.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
 #include "tfrt/host_context/task_function.h"
+#if defined(TFRT_ENABLE_WORK_QUEUE_METRICS)
+#include "tfrt/metrics/metrics_api.h"
+#endif
 #include "tfrt/support/latch.h"
 #include "tfrt/support/ref_count.h"
 #include "tfrt/support/string_util.h"
@@ -29,7 +33,8 @@ class MultiThreadedWorkQueue : public ConcurrentWorkQueue {
   using ThreadingEnvironment = ::tfrt::internal::StdThreadingEnvironment;
 
  public:
-  MultiThreadedWorkQueue(int num_threads, int max_blocking_work_queue_threads);
+  MultiThreadedWorkQueue(int num_threads, int max_blocking_work_queue_threads,
+                         int num_steal_domains);
   ~MultiThreadedWorkQueue() override;
 
   std::string name() const override {
@@ -38,9 +43,18 @@ class MultiThreadedWorkQueue : public ConcurrentWorkQueue {
 
   int GetParallelismLevel() const final { return num_threads_; }
 
+  int GetIdleParallelismLevel() const final {
+    return non_blocking_work_queue_.NumIdleThreads();
+  }
+
   void AddTask(TaskFunction task) final;
+  void AddTasks(MutableArrayRef<TaskFunction> tasks) final;
+  void AddCriticalTask(TaskFunction task) final;
+  void AddTaskWithAffinity(TaskFunction task, uint32_t affinity_tag) final;
+  void AddTaskInDomain(TaskFunction task, uint32_t domain_hint) final;
   Optional<TaskFunction> AddBlockingTask(TaskFunction task,
                                          bool allow_queuing) final;
+  void PinWorkerSpinPolicy(int max_spinning_threads, int spin_count) final;
   void Quiesce() final;
   void Await(ArrayRef<RCReference<AsyncValue>> values) final;
 
@@ -52,21 +66,56 @@ class MultiThreadedWorkQueue : public ConcurrentWorkQueue {
 };
 
 MultiThreadedWorkQueue::MultiThreadedWorkQueue(
-    int num_threads, int max_blocking_work_queue_threads)
+    int num_threads, int max_blocking_work_queue_threads,
+    int num_steal_domains)
     : num_threads_(num_threads),
-      non_blocking_work_queue_(num_threads),
-      blocking_work_queue_(max_blocking_work_queue_threads) {}
+      non_blocking_work_queue_(num_threads, num_steal_domains),
+      blocking_work_queue_(max_blocking_work_queue_threads) {
+  // Lend idle blocking-pool threads to the compute pool: a dynamic thread
+  // that runs out of blocking tasks steals compute tasks instead of parking.
+  // The watermark keeps most of the blocking pool available for I/O bursts
+  // and bounds oversubscription of the compute workers.
+  blocking_work_queue_.LendIdleThreadsTo(
+      [this]() { return non_blocking_work_queue_.Steal(); },
+      /*max_lent_threads=*/std::max(1, num_threads / 4));
+}
 
 MultiThreadedWorkQueue::~MultiThreadedWorkQueue() {
   // Pending tasks in the underlying queues might submit new tasks to each other
   // during destruction.
   Quiesce();
+
+#if defined(TFRT_ENABLE_WORK_QUEUE_METRICS)
+  // Publish the lifetime per-worker scheduling counters, so worker counts can
+  // be tuned from production data.
+  static auto* stats_metric =
+      metrics::NewGauge<std::string>("/tfrt/work_queue/worker_stats");
+  stats_metric->SetValue(non_blocking_work_queue_.StatsString());
+#endif
 }
 
 void MultiThreadedWorkQueue::AddTask(TaskFunction task) {
   non_blocking_work_queue_.AddTask(std::move(task));
 }
 
+void MultiThreadedWorkQueue::AddTasks(MutableArrayRef<TaskFunction> tasks) {
+  non_blocking_work_queue_.AddTasks(tasks);
+}
+
+void MultiThreadedWorkQueue::AddCriticalTask(TaskFunction task) {
+  non_blocking_work_queue_.AddCriticalTask(std::move(task));
+}
+
+void MultiThreadedWorkQueue::AddTaskWithAffinity(TaskFunction task,
+                                                 uint32_t affinity_tag) {
+  non_blocking_work_queue_.AddTaskWithAffinity(std::move(task), affinity_tag);
+}
+
+void MultiThreadedWorkQueue::AddTaskInDomain(TaskFunction task,
+                                             uint32_t domain_hint) {
+  non_blocking_work_queue_.AddTaskInDomain(std::move(task), domain_hint);
+}
+
 Optional<TaskFunction> MultiThreadedWorkQueue::AddBlockingTask(
     TaskFunction task, bool allow_queuing) {
   if (allow_queuing) {
@@ -76,6 +125,13 @@ Optional<TaskFunction> MultiThreadedWorkQueue::AddBlockingTask(
   }
 }
 
+void MultiThreadedWorkQueue::PinWorkerSpinPolicy(int max_spinning_threads,
+                                                 int spin_count) {
+  // Only the non-blocking workers spin; blocking workers park waiting for
+  // their next task and are latency insensitive.
+  non_blocking_work_queue_.PinSpinPolicy(max_spinning_threads, spin_count);
+}
+
 void MultiThreadedWorkQueue::Quiesce() {
   // Turn on pending tasks counter inside both work queues.
   auto quiescing_non_blocking = non_blocking_work_queue_.StartQuiescing();
@@ -128,10 +184,10 @@ void MultiThreadedWorkQueue::Await(ArrayRef<RCReference<AsyncValue>> values) {
 }
 
 std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
-    int num_threads, int num_blocking_threads) {
+    int num_threads, int num_blocking_threads, int num_steal_domains) {
   assert(num_threads > 0 && num_blocking_threads > 0);
-  return std::make_unique<MultiThreadedWorkQueue>(num_threads,
-                                                  num_blocking_threads);
+  return std::make_unique<MultiThreadedWorkQueue>(
+      num_threads, num_blocking_threads, num_steal_domains);
 }
 
 }  // namespace tfrt
@@ -58,10 +58,14 @@ class NonBlockingWorkQueue
   using PendingTask = typename Base::PendingTask;
 
  public:
-  explicit NonBlockingWorkQueue(int num_threads);
+  explicit NonBlockingWorkQueue(int num_threads, int num_steal_domains = 1);
   ~NonBlockingWorkQueue() = default;
 
   void AddTask(TaskFunction task);
+  void AddTasks(llvm::MutableArrayRef<TaskFunction> tasks);
+  void AddTaskWithAffinity(TaskFunction task, uint32_t affinity_tag);
+  void AddTaskInDomain(TaskFunction task, uint32_t domain_hint);
+  void AddCriticalTask(TaskFunction task);
 
   using Base::Steal;
 
@@ -76,9 +80,15 @@ class NonBlockingWorkQueue
 
   using Base::coprimes_;
   using Base::event_count_;
+  using Base::num_steal_domains_;
   using Base::num_threads_;
   using Base::thread_data_;
 
+  using Base::DomainBegin;
+  using Base::DomainEnd;
+
+  using Base::priority_queue_;
+
   LLVM_NODISCARD Optional<TaskFunction> NextTask(Queue* queue);
   LLVM_NODISCARD Optional<TaskFunction> Steal(Queue* queue);
   LLVM_NODISCARD bool Empty(Queue* queue);
@@ -86,8 +96,8 @@ class NonBlockingWorkQueue
 
 template <typename ThreadingEnvironment>
 NonBlockingWorkQueue<ThreadingEnvironment>::NonBlockingWorkQueue(
-    int num_threads)
-    : WorkQueueBase<NonBlockingWorkQueue>(num_threads) {}
+    int num_threads, int num_steal_domains)
+    : WorkQueueBase<NonBlockingWorkQueue>(num_threads, num_steal_domains) {}
 
 template <typename ThreadingEnvironment>
 void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task) {
@@ -108,14 +118,33 @@ void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task) {
 
   PerThread* pt = GetPerThread();
   if (pt->parent == this) {
-    // Worker thread of this pool, push onto the thread's queue.
-    Queue& q = thread_data_[pt->thread_id].queue;
-    inline_task = q.PushFront(std::move(task));
+    // Worker thread of this pool. Park the task in the worker's single-slot
+    // "next task" buffer so it runs next on this core with its caches still
+    // hot, displacing any previously parked task to the front of the deque
+    // (LIFO execution order). A task in the slot is invisible to stealers and
+    // needs no notification: the owning worker picks it up in NextTask as
+    // soon as the current task returns.
+    ThreadData& thread_data = thread_data_[pt->thread_id];
+    if (!thread_data.next_task.hasValue()) {
+      thread_data.next_task = std::move(task);
+      TFRT_WORK_QUEUE_STAT(thread_data.stats.pushes);
+      return;
+    }
+    // The slot is occupied: displace the previously parked task to the front
+    // of the deque, where it is visible to stealers and gets the usual
+    // notification below, and keep the newest task in the slot.
+    inline_task =
+        thread_data.queue.PushFront(std::move(*thread_data.next_task));
+    thread_data.next_task = std::move(task);
+    if (!inline_task.hasValue())
+      TFRT_WORK_QUEUE_STAT(thread_data.stats.pushes);
   } else {
     // A free-standing thread (or worker of another pool).
     unsigned rnd = FastReduce(pt->rng(), num_threads_);
     Queue& q = thread_data_[rnd].queue;
     inline_task = q.PushBack(std::move(task));
+    if (!inline_task.hasValue())
+      TFRT_WORK_QUEUE_STAT(thread_data_[rnd].stats.pushes);
   }
   // Note: below we touch `*this` after making `task` available to worker
   // threads. Strictly speaking, this can lead to a racy-use-after-free.
@@ -133,9 +162,156 @@ void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task) {
   }
 }
 
+// Push a span of tasks onto one worker queue, paying the queue mutex and the
+// wakeup fence once for the whole batch instead of once per task. Workers are
+// woken for up to tasks.size() of the inserted tasks with a single
+// notification. Tasks that do not fit in the queue execute in the caller
+// thread, matching the single-task AddTask overflow behavior.
+template <typename ThreadingEnvironment>
+void NonBlockingWorkQueue<ThreadingEnvironment>::AddTasks(
+    llvm::MutableArrayRef<TaskFunction> tasks) {
+  if (tasks.empty()) return;
+
+  // Keep track of the number of pending tasks.
+  if (IsQuiescing()) {
+    for (TaskFunction& task : tasks)
+      task = WithPendingTaskCounter(std::move(task));
+  }
+
+  PerThread* pt = GetPerThread();
+  unsigned pushed = 0;
+  unsigned target = 0;
+  if (pt->parent == this) {
+    target = pt->thread_id;
+    // Worker thread of this pool: the front of the thread's own queue is
+    // lock free, so push elements one by one and rely on the batched wakeup
+    // below for the savings.
+    Queue& q = thread_data_[pt->thread_id].queue;
+    while (pushed < tasks.size()) {
+      llvm::Optional<TaskFunction> rejected =
+          q.PushFront(std::move(tasks[pushed]));
+      if (rejected.hasValue()) {
+        tasks[pushed] = std::move(*rejected);
+        break;
+      }
+      ++pushed;
+    }
+  } else {
+    // A free-standing thread (or worker of another pool): insert the whole
+    // span into a random queue under a single mutex acquisition.
+    unsigned rnd = FastReduce(pt->rng(), num_threads_);
+    pushed = thread_data_[rnd].queue.PushBackBatch(tasks);
+    target = rnd;
+  }
+  TFRT_WORK_QUEUE_STAT_ADD(thread_data_[target].stats.pushes, pushed);
+
+  // Wake up to `pushed` parked workers with a single notification. The
+  // spinning-thread bookkeeping used by AddTask covers at most one task, so
+  // for a batch we just notify unconditionally; a spurious wakeup is cheaper
+  // than a missed one.
+  if (pushed > 0) event_count_.NotifyMany(pushed);
+
+  // Push failed for the rest, execute directly.
+  for (unsigned i = pushed; i < tasks.size(); ++i) {
+    TaskFunction task = std::move(tasks[i]);
+    task();
+  }
+}
+
+// Push the task onto the worker queue selected by `affinity_tag`, so tasks
+// carrying the same tag are steered to the same worker. Stable task-to-worker
+// placement keeps kernels that share hot data on a warm core across repeated
+// submissions. This is only a hint: the task lands at the back of the chosen
+// worker's queue and can still be stolen by idle workers.
+template <typename ThreadingEnvironment>
+void NonBlockingWorkQueue<ThreadingEnvironment>::AddTaskWithAffinity(
+    TaskFunction task, uint32_t affinity_tag) {
+  // Keep track of the number of pending tasks.
+  if (IsQuiescing()) task = WithPendingTaskCounter(std::move(task));
+
+  // If the worker queue is full, we will execute `task` in the current thread.
+  llvm::Optional<TaskFunction> inline_task;
+
+  unsigned worker = FastReduce(affinity_tag, num_threads_);
+  Queue& q = thread_data_[worker].queue;
+  inline_task = q.PushBack(std::move(task));
+  if (!inline_task.hasValue())
+    TFRT_WORK_QUEUE_STAT(thread_data_[worker].stats.pushes);
+
+  if (!inline_task.hasValue()) {
+    if (IsNotifyParkedThreadRequired())
+      event_count_.Notify(/*notify_all=*/false);
+  } else {
+    (*inline_task)();  // Push failed, execute directly.
+  }
+}
+
+// Push a latency-critical task into the shared high-priority lane, where
+// every worker picks it up ahead of anything in the per-thread queues. A
+// parked worker is always woken, skipping the spinning-thread bookkeeping:
+// for interactive work a spurious wakeup is cheaper than waiting for a
+// spinner to come around.
+template <typename ThreadingEnvironment>
+void NonBlockingWorkQueue<ThreadingEnvironment>::AddCriticalTask(
+    TaskFunction task) {
+  // Keep track of the number of pending tasks.
+  if (IsQuiescing()) task = WithPendingTaskCounter(std::move(task));
+
+  llvm::Optional<TaskFunction> inline_task =
+      priority_queue_.PushFront(std::move(task));
+
+  if (!inline_task.hasValue()) {
+    event_count_.Notify(/*notify_all=*/false);
+  } else {
+    (*inline_task)();  // Lane full, execute directly.
+  }
+}
+
+// Push the task onto a random worker queue inside the steal domain selected
+// by `domain_hint`, so tasks producing and consuming the same buffers stay on
+// the socket that owns them. This is only a hint: same-domain victims are
+// preferred when stealing, but an imbalanced load can still migrate the task
+// to another domain.
+template <typename ThreadingEnvironment>
+void NonBlockingWorkQueue<ThreadingEnvironment>::AddTaskInDomain(
+    TaskFunction task, uint32_t domain_hint) {
+  // Keep track of the number of pending tasks.
+  if (IsQuiescing()) task = WithPendingTaskCounter(std::move(task));
+
+  // If the worker queue is full, we will execute `task` in the current thread.
+  llvm::Optional<TaskFunction> inline_task;
+
+  unsigned domain = FastReduce(domain_hint, num_steal_domains_);
+  unsigned begin = DomainBegin(domain);
+  unsigned end = DomainEnd(domain);
+  unsigned worker = begin + FastReduce(GetPerThread()->rng(), end - begin);
+  Queue& q = thread_data_[worker].queue;
+  inline_task = q.PushBack(std::move(task));
+  if (!inline_task.hasValue())
+    TFRT_WORK_QUEUE_STAT(thread_data_[worker].stats.pushes);
+
+  if (!inline_task.hasValue()) {
+    if (IsNotifyParkedThreadRequired())
+      event_count_.Notify(/*notify_all=*/false);
+  } else {
+    (*inline_task)();  // Push failed, execute directly.
+  }
+}
+
 template <typename ThreadingEnvironment>
 LLVM_NODISCARD Optional<TaskFunction>
 NonBlockingWorkQueue<ThreadingEnvironment>::NextTask(Queue* queue) {
+  // Drain the worker's "next task" slot first: the task parked there was
+  // produced by the task that just finished, so its data is still hot in
+  // this core's caches.
+  PerThread* pt = GetPerThread();
+  assert(pt->parent == this && "NextTask called from a non-worker thread");
+  llvm::Optional<TaskFunction>& slot = thread_data_[pt->thread_id].next_task;
+  if (slot.hasValue()) {
+    llvm::Optional<TaskFunction> task = std::move(slot);
+    slot.reset();
+    return task;
+  }
   return queue->PopFront();
 }
 
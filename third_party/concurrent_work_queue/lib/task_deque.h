@@ -44,6 +44,7 @@
 #include <atomic>
 #include <cstdint>
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
@@ -129,6 +130,32 @@ class TaskDeque {
     return llvm::None;
   }
 
+  // PushBackBatch() inserts a span of tasks at the end of the queue under a
+  // single mutex acquisition.
+  //
+  // Returns the number of tasks inserted; tasks past that index did not fit
+  // and are left in `tasks` for the caller to handle.
+  LLVM_NODISCARD unsigned PushBackBatch(
+      llvm::MutableArrayRef<TaskFunction> tasks) {
+    mutex_lock lock(mutex_);
+    unsigned pushed = 0;
+    for (TaskFunction& task : tasks) {
+      unsigned back = back_.load(std::memory_order_relaxed);
+      Elem* e = &array_[(back - 1) & kMask];
+      uint8_t s = e->state.load(std::memory_order_relaxed);
+      if (s != kEmpty || !e->state.compare_exchange_strong(
+                             s, kBusy, std::memory_order_acquire)) {
+        break;
+      }
+      back = ((back - 1) & kMask2) | (back & ~kMask2);
+      back_.store(back, std::memory_order_relaxed);
+      e->task = std::move(task);
+      e->state.store(kReady, std::memory_order_release);
+      ++pushed;
+    }
+    return pushed;
+  }
+
   // PopBack() removes and returns the last elements in the queue.
   //
   // If the queue is empty returns empty optional.
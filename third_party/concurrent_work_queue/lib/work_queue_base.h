@@ -58,6 +58,7 @@
 #ifndef TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_WORK_QUEUE_BASE_H_
 #define TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_WORK_QUEUE_BASE_H_
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <string>
@@ -72,6 +73,24 @@
 #include "tfrt/support/mutex.h"
 #include "tfrt/support/string_util.h"
 
+// Define TFRT_ENABLE_WORK_QUEUE_METRICS to tally per-worker scheduling
+// events: queue pushes and pops, successful and failed steal walks, and
+// thread parks. Counters live in each worker's cache-line-padded ThreadData
+// slot, so tallying introduces no sharing between workers. Without the
+// define, the counter updates compile away entirely.
+#if defined(TFRT_ENABLE_WORK_QUEUE_METRICS)
+#define TFRT_WORK_QUEUE_STAT(counter) \
+  (counter).fetch_add(1, std::memory_order_relaxed)
+#define TFRT_WORK_QUEUE_STAT_ADD(counter, n) \
+  (counter).fetch_add((n), std::memory_order_relaxed)
+#else
+// The sizeof keeps the counter expression type-checked (and its operands
+// "used") without evaluating anything at run time.
+#define TFRT_WORK_QUEUE_STAT(counter) ((void)sizeof(counter))
+#define TFRT_WORK_QUEUE_STAT_ADD(counter, n) \
+  ((void)sizeof(counter), (void)sizeof(n))
+#endif
+
 namespace tfrt {
 namespace internal {
 
@@ -186,6 +205,10 @@ class WorkQueueBase {
   // yet unparked and running. For strong guarantee must use use Quiesce.
   bool AllBlocked() const { return NumBlockedThreads() == num_threads_; }
 
+  // Returns the number of worker threads currently parked waiting for work.
+  // Like AllBlocked() this is a weak signal, suitable only for heuristics.
+  int NumIdleThreads() const { return static_cast<int>(NumBlockedThreads()); }
+
   // CheckCallerThread() will abort the program if the caller thread is managed
   // by `*this`. This is required to prevent deadlocks from calling `Quiesce`
   // from a thread managed by the current worker queue.
@@ -194,6 +217,24 @@ class WorkQueueBase {
   // Stop all threads managed by this work queue.
   void Cancel();
 
+  // Pin the spin-then-park policy to fixed values and disable adaptation.
+  // `max_spinning_threads` bounds the number of threads that spin in the
+  // steal loop instead of parking, and `spin_count` is the number of steal
+  // iterations each of them runs before parking. Useful for known-bursty
+  // deployments where the cost of park/unpark on every work burst dominates
+  // the cycles burned by spinning.
+  void PinSpinPolicy(int max_spinning_threads, int spin_count) {
+    max_spinning_threads_.store(std::max(max_spinning_threads, 0),
+                                std::memory_order_relaxed);
+    spin_count_.store(std::max(spin_count, 0), std::memory_order_relaxed);
+    spin_policy_pinned_.store(true, std::memory_order_relaxed);
+  }
+
+  // Returns a human-readable summary of the per-worker scheduling counters,
+  // suitable for publishing through the metrics API. All values are zero
+  // unless compiled with TFRT_ENABLE_WORK_QUEUE_METRICS.
+  std::string StatsString() const;
+
  private:
   template <typename ThreadingEnvironment>
   friend class BlockingWorkQueue;
@@ -208,10 +249,31 @@ class WorkQueueBase {
     int thread_id;  // Worker thread index in the workers queue
   };
 
+  // Per-worker scheduling event counters (see TFRT_WORK_QUEUE_STAT). Written
+  // with relaxed atomics - mostly by the owning worker - and summed by
+  // StatsString().
+  struct WorkerStats {
+    std::atomic<uint64_t> pushes{0};
+    std::atomic<uint64_t> pops{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> failed_steals{0};
+    std::atomic<uint64_t> parks{0};
+  };
+
   struct ThreadData {
     ThreadData() : thread(), queue() {}
     std::unique_ptr<Thread> thread;
     Queue queue;
+    // Counters are padded onto their own cache line so tallying events for
+    // one worker does not bounce lines touched by its neighbors.
+    alignas(128) WorkerStats stats;
+    // Single-slot LIFO buffer holding the task this worker should run next,
+    // bypassing `queue`. The slot is written and consumed only by the owning
+    // worker thread, so it needs no synchronization; tasks in it are
+    // invisible to Steal() and Empty(), which is safe because a worker always
+    // drains its own slot (in NextTask) before it can park. Only used by
+    // NonBlockingWorkQueue.
+    alignas(128) llvm::Optional<TaskFunction> next_task;
   };
 
   // RAII helper for keeping track of the number of pending tasks.
@@ -250,14 +312,20 @@ class WorkQueueBase {
                          p = PendingTask(&derived_)]() mutable { task(); });
   }
 
-  // TODO(ezhulenev): Make this a runtime parameter? More spinning threads help
-  // to reduce latency at the cost of wasted CPU cycles.
+  // Default bound on the number of spinning threads. More spinning threads
+  // help to reduce latency at the cost of wasted CPU cycles; the runtime
+  // value lives in `max_spinning_threads_` and can be pinned via
+  // PinSpinPolicy.
   static constexpr int kMaxSpinningThreads = 1;
 
   // The number of steal loop spin iterations before parking (this number is
   // divided by the number of threads, to get spin count for each thread).
   static constexpr int kSpinCount = 5000;
 
+  // Lower bound for the adaptive per-thread spin count, so a long quiet
+  // period can not drive the budget all the way to zero.
+  static constexpr int kMinSpinCount = 8;
+
   // If there are enough active threads with an empty pending task queues, there
   // is no need for spinning before parking a thread that is out of work to do,
   // because these active threads will go into a steal loop after finishing with
@@ -268,9 +336,31 @@ class WorkQueueBase {
   // will be unparked, however this should be very rare in practice.
   static constexpr int kMinActiveThreadsToStartSpinning = 4;
 
-  explicit WorkQueueBase(int num_threads);
+  // Workers are partitioned into `num_steal_domains` contiguous blocks of
+  // roughly equal size, intended to map to NUMA domains. Workers steal from
+  // their own domain first, so tasks tend to stay on the socket that owns
+  // the memory they touch. The default of one domain keeps the previous flat
+  // random-victim stealing.
+  explicit WorkQueueBase(int num_threads, int num_steal_domains = 1);
   ~WorkQueueBase();
 
+  // Domain `d` covers thread ids [DomainBegin(d), DomainEnd(d)).
+  unsigned DomainOf(unsigned thread_id) const {
+    return thread_id * num_steal_domains_ / num_threads_;
+  }
+  unsigned DomainBegin(unsigned domain) const {
+    return (domain * num_threads_ + num_steal_domains_ - 1) /
+           num_steal_domains_;
+  }
+  unsigned DomainEnd(unsigned domain) const {
+    return ((domain + 1) * num_threads_ + num_steal_domains_ - 1) /
+           num_steal_domains_;
+  }
+
+  // Steal() tries to steal a task from workers with ids in [begin, end).
+  LLVM_NODISCARD llvm::Optional<TaskFunction> StealInRange(unsigned begin,
+                                                           unsigned end);
+
   // Main worker thread loop.
   void WorkerLoop(int thread_id);
 
@@ -319,11 +409,26 @@ class WorkQueueBase {
   unsigned NumActiveThreads() const { return num_threads_ - blocked_.load(); }
 
   const int num_threads_;
+  const int num_steal_domains_;
   ThreadingEnvironment threading_environment_;
 
   std::vector<ThreadData> thread_data_;
   std::vector<unsigned> coprimes_;
 
+  // Dedicated lane for latency-critical tasks, shared by all workers and
+  // checked ahead of the per-thread queues in the worker loop and in the
+  // steal loop, so interactive work does not wait behind bulk tasks. Tasks
+  // are pushed here by the derived queue's critical-task entry point.
+  TaskQueue priority_queue_;
+
+  // Returns the next task from the high-priority lane, or None if the lane
+  // is empty. The leading Empty() check keeps the common lane-unused case to
+  // two shared loads.
+  LLVM_NODISCARD llvm::Optional<TaskFunction> NextPriorityTask() {
+    if (priority_queue_.Empty()) return llvm::None;
+    return priority_queue_.PopBack();
+  }
+
   std::atomic<unsigned> blocked_;
   std::atomic<bool> done_;
   std::atomic<bool> cancelled_;
@@ -378,6 +483,16 @@ class WorkQueueBase {
     }
   };
 
+  // Spin-then-park policy. `spin_count_` is the per-thread number of steal
+  // iterations run before parking. Unless the policy is pinned, it adapts to
+  // the observed task inter-arrival pattern: a spin phase that found a task
+  // means arrivals fit in the spin window, so the budget doubles (up to the
+  // kSpinCount-derived maximum); a spin phase that ended in parking halves
+  // it (down to kMinSpinCount), so idle periods stop burning cycles.
+  std::atomic<int> max_spinning_threads_;
+  std::atomic<int> spin_count_;
+  std::atomic<bool> spin_policy_pinned_;
+
   EventCount event_count_;
   Derived& derived_;
 };
@@ -407,8 +522,9 @@ inline std::vector<unsigned> ComputeCoprimes(int n) {
 }
 
 template <typename Derived>
-WorkQueueBase<Derived>::WorkQueueBase(int num_threads)
+WorkQueueBase<Derived>::WorkQueueBase(int num_threads, int num_steal_domains)
     : num_threads_(num_threads),
+      num_steal_domains_(std::min(std::max(num_steal_domains, 1), num_threads)),
       thread_data_(num_threads),
       coprimes_(ComputeCoprimes(num_threads)),
       blocked_(0),
@@ -417,6 +533,9 @@ WorkQueueBase<Derived>::WorkQueueBase(int num_threads)
       num_quiescing_(0),
       num_pending_tasks_(0),
       spinning_state_(0),
+      max_spinning_threads_(kMaxSpinningThreads),
+      spin_count_(num_threads > 0 ? kSpinCount / num_threads : 0),
+      spin_policy_pinned_(false),
       event_count_(num_threads),
       derived_(static_cast<Derived&>(*this)) {
   assert(num_threads >= 1);
@@ -441,6 +560,7 @@ WorkQueueBase<Derived>::~WorkQueueBase() {
     for (ThreadData& thread_data : thread_data_) {
       thread_data.queue.Flush();
     }
+    priority_queue_.Flush();
   }
   // Join to all worker threads before calling destructors.
   for (ThreadData& thread_data : thread_data_) {
@@ -449,6 +569,26 @@ WorkQueueBase<Derived>::~WorkQueueBase() {
   }
 }
 
+template <typename Derived>
+std::string WorkQueueBase<Derived>::StatsString() const {
+  uint64_t pushes = 0;
+  uint64_t pops = 0;
+  uint64_t steals = 0;
+  uint64_t failed_steals = 0;
+  uint64_t parks = 0;
+  for (const ThreadData& thread_data : thread_data_) {
+    pushes += thread_data.stats.pushes.load(std::memory_order_relaxed);
+    pops += thread_data.stats.pops.load(std::memory_order_relaxed);
+    steals += thread_data.stats.steals.load(std::memory_order_relaxed);
+    failed_steals +=
+        thread_data.stats.failed_steals.load(std::memory_order_relaxed);
+    parks += thread_data.stats.parks.load(std::memory_order_relaxed);
+  }
+  return StrCat("num_threads=", num_threads_, " pushes=", pushes,
+                " pops=", pops, " steals=", steals,
+                " failed_steals=", failed_steals, " parks=", parks);
+}
+
 template <typename Derived>
 void WorkQueueBase<Derived>::CheckCallerThread(
     const char* function_name) const {
@@ -486,21 +626,54 @@ void WorkQueueBase<Derived>::Quiesce() {
 
 template <typename Derived>
 LLVM_NODISCARD llvm::Optional<TaskFunction> WorkQueueBase<Derived>::Steal() {
+  // The high-priority lane outranks every per-thread queue, and checking it
+  // here also lets Quiesce and free-standing callers drain it.
+  llvm::Optional<TaskFunction> priority_task = NextPriorityTask();
+  if (priority_task.hasValue()) return priority_task;
+
+  // Steal from the caller's own domain first: stolen tasks usually touch
+  // memory allocated near their producer, so a same-domain steal keeps the
+  // accesses on the local socket.
+  if (num_steal_domains_ > 1) {
+    int thread_id = CurrentThreadId();
+    if (thread_id != -1) {
+      unsigned domain = DomainOf(thread_id);
+      llvm::Optional<TaskFunction> t =
+          StealInRange(DomainBegin(domain), DomainEnd(domain));
+      if (t.hasValue()) return t;
+    }
+  }
+  return StealInRange(0, num_threads_);
+}
+
+template <typename Derived>
+LLVM_NODISCARD llvm::Optional<TaskFunction> WorkQueueBase<Derived>::StealInRange(
+    unsigned begin, unsigned end) {
   PerThread* pt = GetPerThread();
+  unsigned size = end - begin;
   unsigned r = pt->rng();
-  unsigned victim = FastReduce(r, num_threads_);
-  unsigned inc = coprimes_[FastReduce(r, coprimes_.size())];
-
-  for (unsigned i = 0; i < num_threads_; i++) {
+  unsigned victim = begin + FastReduce(r, size);
+  // Walk the full worker range as a pseudo-random permutation. Domains are
+  // small enough that a linear walk from a random start spreads victims well.
+  unsigned inc = 1;
+  if (size == static_cast<unsigned>(num_threads_))
+    inc = coprimes_[FastReduce(r, coprimes_.size())];
+
+  for (unsigned i = 0; i < size; i++) {
     llvm::Optional<TaskFunction> t =
         derived_.Steal(&(thread_data_[victim].queue));
-    if (t.hasValue()) return t;
+    if (t.hasValue()) {
+      TFRT_WORK_QUEUE_STAT(thread_data_[victim].stats.steals);
+      return t;
+    }
 
     victim += inc;
-    if (victim >= num_threads_) {
-      victim -= num_threads_;
+    if (victim >= end) {
+      victim -= size;
     }
   }
+  if (pt->parent == &derived_)
+    TFRT_WORK_QUEUE_STAT(thread_data_[pt->thread_id].stats.failed_steals);
   return llvm::None;
 }
 
@@ -516,22 +689,39 @@ void WorkQueueBase<Derived>::WorkerLoop(int thread_id) {
 
   // TODO(dvyukov,rmlarsen): The time spent in NonEmptyQueueIndex() is
   // proportional to num_threads_ and we assume that new work is scheduled at
-  // a constant rate, so we set spin_count to 5000 / num_threads_. The
+  // a constant rate, so the initial spin count is 5000 / num_threads_. The
   // constant was picked based on a fair dice roll, tune it.
-  const int spin_count = num_threads_ > 0 ? kSpinCount / num_threads_ : 0;
+  const int max_spin_count = num_threads_ > 0 ? kSpinCount / num_threads_ : 0;
 
   while (!cancelled_) {
-    Optional<TaskFunction> t = derived_.NextTask(q);
+    // Latency-critical tasks always run ahead of anything in the per-thread
+    // queues.
+    Optional<TaskFunction> t = NextPriorityTask();
+    if (!t.hasValue()) t = derived_.NextTask(q);
+    if (t.hasValue())
+      TFRT_WORK_QUEUE_STAT(thread_data_[thread_id].stats.pops);
     if (!t.hasValue()) {
       t = Steal();
       if (!t.hasValue()) {
         // Maybe leave thread spinning. This reduces latency.
         const bool start_spinning = StartSpinning();
         if (start_spinning) {
+          const int spin_count = spin_count_.load(std::memory_order_relaxed);
           for (int i = 0; i < spin_count && !t.hasValue(); ++i) {
             t = Steal();
           }
 
+          // Whether this spin phase found a task is a direct observation of
+          // the task inter-arrival time relative to the spin window, so use
+          // it to adjust the budget multiplicatively unless the policy has
+          // been pinned.
+          if (!spin_policy_pinned_.load(std::memory_order_relaxed)) {
+            const int new_spin_count =
+                t.hasValue() ? std::min(spin_count * 2 + 1, max_spin_count)
+                             : std::max(spin_count / 2, kMinSpinCount);
+            spin_count_.store(new_spin_count, std::memory_order_relaxed);
+          }
+
           const bool stopped_spinning = StopSpinning();
           // If a task was submitted to the queue without a call to
           // `event_count_.Notify()`, and we didn't steal anything above, we
@@ -563,7 +753,13 @@ bool WorkQueueBase<Derived>::WaitForWork(EventCount::Waiter* waiter,
   // We already did best-effort emptiness check in Steal, so prepare for
   // blocking.
   event_count_.Prewait();
-  // Now do a reliable emptiness check.
+  // Now do a reliable emptiness check, including the high-priority lane.
+  if (!priority_queue_.Empty()) {
+    event_count_.CancelWait();
+    if (cancelled_) return false;
+    *task = NextPriorityTask();
+    return true;
+  }
   int victim = NonEmptyQueueIndex();
   if (victim != -1) {
     event_count_.CancelWait();
@@ -593,7 +789,7 @@ bool WorkQueueBase<Derived>::WaitForWork(EventCount::Waiter* waiter,
     // right after incrementing blocked_ above. Now a free-standing thread
     // submits work and calls destructor (which sets done_). If we don't
     // re-check queues, we will exit leaving the work unexecuted.
-    if (NonEmptyQueueIndex() != -1) {
+    if (NonEmptyQueueIndex() != -1 || !priority_queue_.Empty()) {
       // Note: we must not pop from queues before we decrement blocked_,
       // otherwise the following scenario is possible. Consider that instead
       // of checking for emptiness we popped the only element from queues.
@@ -608,6 +804,8 @@ bool WorkQueueBase<Derived>::WaitForWork(EventCount::Waiter* waiter,
     return false;
   }
 
+  TFRT_WORK_QUEUE_STAT(
+      thread_data_[GetPerThread()->thread_id].stats.parks);
   event_count_.CommitWait(waiter);
   blocked_.fetch_sub(1);
   return true;
@@ -621,7 +819,9 @@ bool WorkQueueBase<Derived>::StartSpinning() {
   for (;;) {
     SpinningState state = SpinningState::Decode(spinning);
 
-    if ((state.num_spinning - state.num_no_notification) >= kMaxSpinningThreads)
+    if ((state.num_spinning - state.num_no_notification) >=
+        static_cast<uint64_t>(max_spinning_threads_.load(
+            std::memory_order_relaxed)))
       return false;
 
     // Increment the number of spinning threads.
@@ -66,6 +66,27 @@ static llvm::cl::opt<bool> cl_enable_tracing(  // NOLINT
     "enable_tracing", llvm::cl::desc("Enable Performance Tracing"),
     llvm::cl::Optional, llvm::cl::ValueDisallowed);
 
+static llvm::cl::opt<bool> cl_bench(  // NOLINT
+    "bench",
+    llvm::cl::desc("Benchmark each function instead of printing its results"),
+    llvm::cl::Optional, llvm::cl::ValueDisallowed);
+
+static llvm::cl::opt<int> cl_bench_warmup(  // NOLINT
+    "bench_warmup",
+    llvm::cl::desc("Number of untimed warm-up runs per function in --bench"),
+    llvm::cl::init(2));
+
+static llvm::cl::opt<int> cl_bench_runs(  // NOLINT
+    "bench_runs",
+    llvm::cl::desc("Number of timed runs per function in --bench"),
+    llvm::cl::init(50));
+
+static llvm::cl::opt<std::string> cl_chrome_trace(  // NOLINT
+    "chrome_trace",
+    llvm::cl::desc("Write the run's timeline to this file as Chrome "
+                   "trace-event JSON (implies -enable_tracing)"),
+    llvm::cl::init(""));
+
 //===----------------------------------------------------------------------===//
 // Driver main
 //===----------------------------------------------------------------------===//
@@ -81,6 +102,10 @@ int main(int argc, char** argv) {
   run_config.devices = cl_devices;
   run_config.work_queue_type = cl_work_queue_type;
   run_config.host_allocator_type = cl_host_allocator_type;
+  run_config.bench = cl_bench;
+  run_config.bench_warmup_runs = cl_bench_warmup;
+  run_config.bench_num_runs = cl_bench_runs;
+  run_config.chrome_trace_filename = cl_chrome_trace;
 
   if (cl_enable_tracing) {
     TFRT_TRACE_ON();